@@ -0,0 +1,45 @@
+<?php
+/**
+ * This file is part of Swow
+ *
+ * @link    https://github.com/swow/swow
+ * @contact twosee <twosee@php.net>
+ *
+ * For the full copyright and license information,
+ * please view the LICENSE file that was distributed with this source code
+ */
+
+declare(strict_types=1);
+
+use Swow\Channel;
+use Swow\Coroutine;
+use Swow\Sync\WaitReference;
+
+$concurrency = (int) ($argv[1] ?? 1000);
+$rounds = (int) ($argv[2] ?? 1000);
+
+/* every pop() below arms a timeout which is almost always cancelled,
+ * this is the pattern of socket recv() with timeout on a busy server */
+$wr = new WaitReference();
+$use = microtime(true);
+for ($c = 0; $c < $concurrency; $c++) {
+    Coroutine::run(static function () use ($rounds, $wr): void {
+        $channel = new Channel();
+        Coroutine::run(static function () use ($channel, $rounds): void {
+            for ($n = $rounds; $n--;) {
+                $channel->push(true);
+            }
+        });
+        for ($n = $rounds; $n--;) {
+            $channel->pop(60 * 1000);
+        }
+    });
+}
+WaitReference::wait($wr);
+$use = microtime(true) - $use;
+
+$times = $concurrency * $rounds;
+$ns = $use * (1000 * 1000 * 1000) / $times;
+$qps = $times * (1 / $use);
+
+echo sprintf('Use %fs for %d times, %fns/t, qps=%f' . PHP_EOL, $use, $times, $ns, $qps);
@@ -0,0 +1,68 @@
+<?php
+/**
+ * This file is part of Swow
+ *
+ * @link    https://github.com/swow/swow
+ * @contact twosee <twosee@php.net>
+ *
+ * For the full copyright and license information,
+ * please view the LICENSE file that was distributed with this source code
+ */
+
+declare(strict_types=1);
+
+use Swow\Coroutine;
+use Swow\CoroutineException;
+use Swow\Errno;
+use Swow\Http\Protocol\ProtocolException as HttpProtocolException;
+use Swow\Psr7\Server\Server;
+use Swow\Psr7\Server\WorkerPool;
+use Swow\Socket;
+use Swow\SocketException;
+
+require __DIR__ . '/../autoload.php';
+
+ini_set('memory_limit', '1G');
+
+$host = getenv('SERVER_HOST') ?: '127.0.0.1';
+$port = (int) ((($port = getenv('SERVER_PORT')) !== '' && $port !== false) ? $port : 9764);
+$backlog = (int) (getenv('SERVER_BACKLOG') ?: Socket::DEFAULT_BACKLOG);
+$workerCount = (int) (getenv('SERVER_WORKERS') ?: 4);
+
+/* send SIGHUP to the master to reload workers one by one, SIGTERM or SIGINT to stop them */
+$pool = new WorkerPool(static function (Server $server, int $workerId): void {
+    echo sprintf('Worker#%d (pid=%d) is listening', $workerId, getmypid()) . PHP_EOL;
+    while (true) {
+        try {
+            $connection = $server->acceptConnection();
+        } catch (SocketException|CoroutineException $exception) {
+            if (in_array($exception->getCode(), [Errno::EMFILE, Errno::ENFILE, Errno::ENOMEM], true)) {
+                sleep(1);
+                continue;
+            }
+            /* server was closed, stop accepting */
+            break;
+        }
+        Coroutine::run(static function () use ($connection, $workerId): void {
+            try {
+                while (true) {
+                    try {
+                        $connection->recvHttpRequest();
+                        $connection->respond(sprintf('Hello from worker#%d', $workerId));
+                    } catch (HttpProtocolException $exception) {
+                        $connection->error($exception->getCode(), $exception->getMessage(), close: true);
+                        break;
+                    }
+                    if (!$connection->shouldKeepAlive()) {
+                        break;
+                    }
+                }
+            } catch (Exception) {
+                // you can log error here
+            } finally {
+                $connection->close();
+            }
+        });
+    }
+}, $workerCount, $host, $port, $backlog);
+$pool->run();
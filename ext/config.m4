@@ -340,6 +340,7 @@ EOF
     swow_signal.c \
     swow_watchdog.c \
     swow_closure.c \
+    swow_thread.c \
     swow_ipaddress.c \
     swow_http.c \
     swow_websocket.c \
@@ -430,7 +431,9 @@ EOF
       cat_fs.c \
       cat_signal.c \
       cat_os_wait.c \
+      cat_io_uring.c \
       cat_async.c \
+      cat_thread_channel.c \
       cat_watchdog.c \
       cat_http.c \
       cat_websocket.c, SWOW_CAT_INCLUDES, SWOW_CAT_CFLAGS)
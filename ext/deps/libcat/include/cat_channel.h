@@ -28,6 +28,9 @@ extern "C" {
 typedef enum cat_channel_flag_e {
     CAT_CHANNEL_FLAG_NONE    = 0,
     CAT_CHANNEL_FLAG_CLOSED  = 1 << 1,
+    /* store buffered data in linked buckets instead of the ring buffer,
+     * only channels created with it support channel_get_storage() */
+    CAT_CHANNEL_FLAG_LINKED_STORAGE = 1 << 2,
 } cat_channel_flag_t;
 
 typedef uint8_t cat_channel_flags_t;
@@ -44,6 +47,10 @@ typedef uint8_t cat_channel_data_size_t;
 
 typedef void (*cat_channel_data_dtor_t)(const cat_data_t *data);
 
+#ifndef CAT_CHANNEL_RING_INITIAL_SIZE
+#define CAT_CHANNEL_RING_INITIAL_SIZE 8
+#endif
+
 /* Note: this should be public, it's used by channel_get_storage() */
 typedef struct cat_channel_bucket_s {
     cat_queue_node_t node;
@@ -70,6 +77,13 @@ typedef struct cat_channel_s {
             } able;
         } unbuffered;
         struct {
+            /* ring buffer, it grows on demand (up to capacity) and never shrinks */
+            struct {
+                char *data;
+                cat_channel_size_t size;
+                cat_channel_size_t head;
+            } ring;
+            /* linked buckets (CAT_CHANNEL_FLAG_LINKED_STORAGE) */
             cat_queue_t storage;
         } buffered;
     } u;
@@ -78,9 +92,15 @@ typedef struct cat_channel_s {
 /* common */
 
 CAT_API cat_channel_t *cat_channel_create(cat_channel_t *channel, cat_channel_size_t capacity, cat_channel_data_size_t data_size, cat_channel_data_dtor_t dtor);
+CAT_API cat_channel_t *cat_channel_create_ex(cat_channel_t *channel, cat_channel_size_t capacity, cat_channel_data_size_t data_size, cat_channel_data_dtor_t dtor, cat_channel_flags_t flags);
 
 CAT_API cat_bool_t cat_channel_push(cat_channel_t *channel, const cat_data_t *data, cat_timeout_t timeout);
 CAT_API cat_bool_t cat_channel_pop(cat_channel_t *channel, cat_data_t *data, cat_timeout_t timeout);
+/* push/pop a contiguous array of data, waiters on the other side are woken up after the whole batch is done,
+ * push_batch() waits until all data has been pushed and returns the number of pushed items
+ * (error is set if it is less than count), pop_batch() waits for at least one item and returns 0 on error */
+CAT_API size_t cat_channel_push_batch(cat_channel_t *channel, const cat_data_t *data, size_t count, cat_timeout_t timeout);
+CAT_API size_t cat_channel_pop_batch(cat_channel_t *channel, cat_data_t *data, size_t max, cat_timeout_t timeout);
 
 /* close channel without clean storage */
 CAT_API cat_bool_t cat_channel_close(cat_channel_t *channel);
@@ -131,6 +151,11 @@ CAT_API cat_channel_data_dtor_t cat_channel_set_dtor(cat_channel_t *channel, cat
 
 /* ext */
 
+typedef void (*cat_channel_storage_walker_t)(cat_data_t *data, cat_data_t *arg);
+
+/* visit the buffered data from head to tail (works with any kind of storage) */
+CAT_API void cat_channel_walk_storage(cat_channel_t *channel, cat_channel_storage_walker_t walker, cat_data_t *arg);
+/* return NULL if channel was not created with CAT_CHANNEL_FLAG_LINKED_STORAGE */
 CAT_API cat_queue_t *cat_channel_get_storage(cat_channel_t *channel); CAT_INTERNAL
 
 #ifdef __cplusplus
@@ -29,6 +29,9 @@ extern "C" {
 #define CAT_COROUTINE_RECOMMENDED_STACK_SIZE    (256UL * 1024UL)
 #define CAT_COROUTINE_MAX_STACK_SIZE            (16UL * 1024UL * 1024UL)
 
+#define CAT_COROUTINE_DEFAULT_STACK_POOL_SIZE   32
+#define CAT_COROUTINE_STACK_POOL_BIN_COUNT      4
+
 #define CAT_COROUTINE_MIN_ID                    0ULL
 #define CAT_COROUTINE_MAX_ID                    UINT64_MAX
 
@@ -61,6 +64,11 @@ typedef void *cat_coroutine_context_t;
 #define CAT_COROUTINE_USE_ASAN
 #endif
 
+/* ASan tracks fake stacks of fibers, we can not reuse them safely */
+#if defined(CAT_COROUTINE_USE_USER_STACK) && !defined(CAT_COROUTINE_USE_ASAN)
+#define CAT_COROUTINE_USE_STACK_POOL 1
+#endif
+
 typedef uint64_t cat_coroutine_id_t;
 #define CAT_COROUTINE_ID_FMT "%" PRIu64
 #define CAT_COROUTINE_ID_FMT_SPEC PRIu64
@@ -135,6 +143,9 @@ struct cat_coroutine_s
 #ifdef CAT_COROUTINE_USE_USER_STACK
     uint32_t virtual_memory_size;
     void *virtual_memory;
+    /* sampled when coroutine is switched out */
+    cat_coroutine_stack_size_t stack_usage;
+    cat_coroutine_stack_size_t peak_stack_usage;
 #endif
     cat_coroutine_context_t context;
 #ifdef CAT_COROUTINE_USE_USER_TRANSFER_DATA
@@ -162,6 +173,22 @@ typedef uint32_t cat_coroutine_count_t;
 
 typedef void (*cat_coroutine_deadlock_callback_t)(void);
 
+/* cached stacks are size-classed by their virtual memory size */
+typedef struct cat_coroutine_stack_pool_bin_s {
+    uint32_t virtual_memory_size;
+    cat_coroutine_count_t count;
+    cat_queue_t stacks;
+} cat_coroutine_stack_pool_bin_t;
+
+typedef struct cat_coroutine_stack_pool_info_s {
+    /* pool is compiled out (e.g. ASan or thread context builds) if it is false */
+    cat_bool_t available;
+    cat_coroutine_count_t size;
+    cat_coroutine_count_t count;
+    uint64_t hits;
+    uint64_t misses;
+} cat_coroutine_stack_pool_info_t;
+
 CAT_GLOBALS_STRUCT_BEGIN(cat_coroutine) {
     /* options */
     cat_coroutine_stack_size_t default_stack_size;
@@ -185,6 +212,13 @@ CAT_GLOBALS_STRUCT_BEGIN(cat_coroutine) {
     cat_coroutine_count_t peak_count;
     /* global switches (for watchdog) */
     cat_coroutine_switches_t switches;
+    cat_coroutine_stack_size_t peak_stack_usage;
+    /* stack pool */
+    cat_coroutine_count_t stack_pool_size;
+    cat_coroutine_count_t stack_pool_count;
+    uint64_t stack_pool_hits;
+    uint64_t stack_pool_misses;
+    cat_coroutine_stack_pool_bin_t stack_pool_bins[CAT_COROUTINE_STACK_POOL_BIN_COUNT];
 } CAT_GLOBALS_STRUCT_END(cat_coroutine);
 
 extern CAT_API CAT_GLOBALS_DECLARE(cat_coroutine);
@@ -211,6 +245,8 @@ CAT_API cat_coroutine_stack_size_t cat_coroutine_set_default_stack_size(size_t s
 CAT_API cat_log_type_t cat_coroutine_set_deadlock_log_type(cat_log_type_t type);
 /* callback will be called before deadlock() */
 CAT_API cat_coroutine_deadlock_callback_t cat_coroutine_set_deadlock_callback(cat_coroutine_deadlock_callback_t callback);
+/* max number of idle stacks to keep for reuse (0 means disabled), return the original size */
+CAT_API cat_coroutine_count_t cat_coroutine_set_stack_pool_size(cat_coroutine_count_t size);
 
 /* globals */
 CAT_API cat_coroutine_stack_size_t cat_coroutine_get_default_stack_size(void);
@@ -224,6 +260,11 @@ CAT_API cat_coroutine_count_t cat_coroutine_get_count(void);
 CAT_API cat_coroutine_count_t cat_coroutine_get_real_count(void);
 CAT_API cat_coroutine_count_t cat_coroutine_get_peak_count(void);
 CAT_API cat_coroutine_switches_t cat_coroutine_get_global_switches(void);
+CAT_API cat_coroutine_stack_size_t cat_coroutine_get_global_peak_stack_usage(void);
+CAT_API cat_coroutine_count_t cat_coroutine_get_stack_pool_size(void);
+CAT_API void cat_coroutine_get_stack_pool_info(cat_coroutine_stack_pool_info_t *info);
+/* release all idle stacks in the pool */
+CAT_API void cat_coroutine_stack_pool_clear(void);
 
 /* ctor and dtor */
 CAT_API cat_coroutine_t *cat_coroutine_create(cat_coroutine_t *coroutine, cat_coroutine_function_t function);
@@ -244,6 +285,12 @@ CAT_API cat_coroutine_t *cat_coroutine_get_from(const cat_coroutine_t *coroutine
 CAT_API cat_coroutine_t *cat_coroutine_get_previous(const cat_coroutine_t *coroutine);
 CAT_API cat_coroutine_t *cat_coroutine_get_next(const cat_coroutine_t *coroutine);
 CAT_API cat_coroutine_stack_size_t cat_coroutine_get_stack_size(const cat_coroutine_t *coroutine);
+/* stack usage is sampled at switch points, it is always 0 if coroutine does not use user stack */
+CAT_API cat_coroutine_stack_size_t cat_coroutine_get_stack_usage(const cat_coroutine_t *coroutine);
+CAT_API cat_coroutine_stack_size_t cat_coroutine_get_peak_stack_usage(const cat_coroutine_t *coroutine);
+/* give back the physical pages under the stack pointer of a waiting coroutine,
+ * return the number of bytes trimmed */
+CAT_API size_t cat_coroutine_trim_stack(cat_coroutine_t *coroutine);
 
 /* status */
 CAT_API cat_bool_t cat_coroutine_is_available(const cat_coroutine_t *coroutine);
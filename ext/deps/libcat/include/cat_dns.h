@@ -23,20 +23,100 @@ extern "C" {
 #endif
 
 #include "cat.h"
-#include "cat_socket.h"
+#include "cat_queue.h"
 
 /* Notice: this module is a part of Socket */
 
-/*
-typedef struct cat_dns_cache_s {
+#define CAT_DNS_CACHE_DEFAULT_CAPACITY     128
+#define CAT_DNS_CACHE_DEFAULT_TTL          (10 * 1000)
+#define CAT_DNS_CACHE_DEFAULT_NEGATIVE_TTL 1000
+
+typedef struct cat_dns_cache_entry_s cat_dns_cache_entry_t;
+
+typedef struct cat_dns_cache_stats_s {
+    /* lookups which were answered from the cache */
+    uint64_t hits;
+    /* lookups which started a new resolution */
+    uint64_t misses;
+    /* lookups which joined a resolution of the same name in progress */
+    uint64_t coalesced;
+    /* number of entries (including the pending ones) */
+    size_t count;
+} cat_dns_cache_stats_t;
 
+typedef struct cat_dns_cache_s {
+    /* 0 means results are not cached (but concurrent lookups are still coalesced) */
+    size_t capacity;
+    cat_msec_t ttl;
+    /* ttl of failures which mean the name does not exist */
+    cat_msec_t negative_ttl;
+    /* hash table (bucket_count is a power of 2) */
+    cat_dns_cache_entry_t **buckets;
+    size_t bucket_count;
+    /* resolved entries, the least recently used one is the first */
+    cat_queue_t lru;
+    cat_dns_cache_stats_t stats;
 } cat_dns_cache_t;
-*/
+
+/* native stub resolver, queries are sent to nameservers on the event loop
+ * instead of calling getaddrinfo() in the threadpool,
+ * it is disabled by default and can be enabled by CAT_DNS_RESOLVER=1 */
+
+typedef struct cat_dns_resolver_config_s cat_dns_resolver_config_t;
+
+typedef struct cat_dns_resolver_s {
+    cat_bool_t enabled;
+    /* it is loaded on demand and shared by requests in progress */
+    cat_dns_resolver_config_t *config;
+    /* NULL means nameservers of resolv.conf */
+    char *servers;
+    /* for query IDs */
+    uint32_t seed;
+} cat_dns_resolver_t;
+
+typedef struct cat_dns_srv_s cat_dns_srv_t;
+
+struct cat_dns_srv_s {
+    cat_dns_srv_t *next;
+    uint16_t priority;
+    uint16_t weight;
+    uint16_t port;
+    /* in seconds */
+    uint32_t ttl;
+    char target[1];
+};
+
+#include "cat_socket.h"
+
+CAT_API cat_bool_t cat_dns_runtime_init(void);
 
 CAT_API struct addrinfo *cat_dns_getaddrinfo(const char *hostname, const char *service, const struct addrinfo *hints);
 CAT_API struct addrinfo *cat_dns_getaddrinfo_ex(const char *hostname, const char *service, const struct addrinfo *hints, cat_timeout_t timeout);
 CAT_API void cat_dns_freeaddrinfo(struct addrinfo *response);
 
+/* getaddrinfo() does not report TTL of records, so all results share the same TTL,
+ * results of the native resolver are cached for the TTL of records, but not longer than it */
+CAT_API size_t cat_dns_cache_get_capacity(void);
+CAT_API cat_bool_t cat_dns_cache_set_capacity(size_t capacity);
+CAT_API cat_msec_t cat_dns_cache_get_ttl(void);
+CAT_API void cat_dns_cache_set_ttl(cat_msec_t ttl);
+CAT_API cat_msec_t cat_dns_cache_get_negative_ttl(void);
+CAT_API void cat_dns_cache_set_negative_ttl(cat_msec_t ttl);
+CAT_API void cat_dns_cache_get_stats(cat_dns_cache_stats_t *stats);
+CAT_API void cat_dns_cache_flush(void);
+
+CAT_API cat_bool_t cat_dns_resolver_is_enabled(void);
+CAT_API void cat_dns_resolver_set_enabled(cat_bool_t enabled);
+CAT_API const char *cat_dns_resolver_get_servers(void);
+/* servers are separated by commas (e.g. "127.0.0.1:53,[::1]:53"),
+ * NULL means nameservers of resolv.conf, resolv.conf and hosts will be reloaded */
+CAT_API cat_bool_t cat_dns_resolver_set_servers(const char *servers);
+
+/* records are sorted by priority and weight, and they are freed by cat_dns_free_srv() */
+CAT_API cat_dns_srv_t *cat_dns_query_srv(const char *name);
+CAT_API cat_dns_srv_t *cat_dns_query_srv_ex(const char *name, cat_timeout_t timeout);
+CAT_API void cat_dns_free_srv(cat_dns_srv_t *records);
+
 CAT_API cat_bool_t cat_dns_get_ip(char *buffer, size_t buffer_size, const char *name, int af);
 CAT_API cat_bool_t cat_dns_get_ip_ex(char *buffer, size_t buffer_size, const char *name, int af, cat_timeout_t timeout);
 
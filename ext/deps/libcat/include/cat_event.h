@@ -36,11 +36,51 @@ typedef struct cat_event_task_s {
     cat_data_t *data;
 } cat_event_task_t;
 
+#ifndef CAT_EVENT_DEFER_QUEUE_INITIAL_SIZE
+#define CAT_EVENT_DEFER_QUEUE_INITIAL_SIZE 64
+#endif
+
+typedef struct cat_event_defer_task_s {
+    cat_event_round_t round;
+    cat_data_callback_t callback;
+    cat_data_t *data;
+} cat_event_defer_task_t;
+
+typedef struct cat_event_defer_info_s {
+    /* number of tasks waiting to be called */
+    size_t pending;
+    /* number of task slots currently allocated */
+    size_t capacity;
+    /* number of tasks called in the last round */
+    uint64_t last_round;
+    /* max number of tasks called in a single round */
+    uint64_t peak_round;
+    /* number of tasks called since runtime init */
+    uint64_t total;
+} cat_event_defer_info_t;
+
 CAT_GLOBALS_STRUCT_BEGIN(cat_event) {
     uv_loop_t loop;
     uv_timer_t deadlock;
+    /* all timed waits share one timer (managed by cat_time) */
+    uv_timer_t timer;
+    struct {
+        void *min;
+        unsigned int nelts;
+    } timer_heap;
+    uint64_t timer_last_id;
     cat_queue_t runtime_shutdown_tasks;
-    cat_queue_t defer_tasks;
+    /* ring buffer (deque) of defer tasks, it only grows, so that
+     * deferring never touches the allocator in the steady state */
+    struct {
+        cat_event_defer_task_t *tasks;
+        uint32_t capacity;
+        uint32_t head;
+        uint32_t count;
+        uint64_t last_round;
+        uint64_t peak_round;
+        uint64_t total;
+    } defer;
 } CAT_GLOBALS_STRUCT_END(cat_event);
 
 extern CAT_API CAT_GLOBALS_DECLARE(cat_event);
@@ -66,6 +106,7 @@ CAT_API void cat_event_unregister_runtime_shutdown_task(cat_event_task_t *task);
 
 CAT_API cat_bool_t cat_event_defer(cat_data_callback_t callback, cat_data_t *data);
 CAT_API cat_bool_t cat_event_defer_ex(cat_data_callback_t callback, cat_data_t *data, cat_bool_t high_priority);
+CAT_API void cat_event_get_defer_info(cat_event_defer_info_t *info);
 
 CAT_API void cat_event_fork(void);
 
@@ -161,6 +161,8 @@ CAT_API int cat_fs_copyfile(const char *path, const char *new_path, int flags);
 CAT_API int cat_fs_sendfile(cat_file_t out_fd, cat_file_t in_fd, int64_t in_offset, size_t length);
 CAT_API const char *cat_fs_mkdtemp(const char *tpl);
 CAT_API cat_file_t cat_fs_mkstemp(const char *tpl);
+/* like cat_fs_mkstemp(), but the generated path is written back to the template */
+CAT_API cat_file_t cat_fs_mkstemp_ex(char *tpl);
 CAT_API int cat_fs_statfs(const char *path, cat_statfs_t *buf);
 
 CAT_API int cat_fs_flock(cat_file_t fd, int operation);
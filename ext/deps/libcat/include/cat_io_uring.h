@@ -0,0 +1,74 @@
+/*
+  +--------------------------------------------------------------------------+
+  | libcat                                                                   |
+  +--------------------------------------------------------------------------+
+  | Licensed under the Apache License, Version 2.0 (the "License");          |
+  | you may not use this file except in compliance with the License.         |
+  | You may obtain a copy of the License at                                  |
+  | http://www.apache.org/licenses/LICENSE-2.0                               |
+  | Unless required by applicable law or agreed to in writing, software      |
+  | distributed under the License is distributed on an "AS IS" BASIS,        |
+  | WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. |
+  | See the License for the specific language governing permissions and      |
+  | limitations under the License. See accompanying LICENSE file.            |
+  +--------------------------------------------------------------------------+
+  | Author: Twosee <twosee@php.net>                                          |
+  +--------------------------------------------------------------------------+
+ */
+
+#ifndef CAT_IO_URING_H
+#define CAT_IO_URING_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "cat.h"
+
+#if defined(CAT_OS_LINUX) && defined(__has_include)
+# if __has_include(<linux/io_uring.h>)
+#  include <sys/syscall.h>
+#  ifdef __NR_io_uring_setup
+/* io_uring driver for file-system operations,
+ * it is disabled by default and can be enabled by CAT_IO_URING=1,
+ * operations fall back to the threadpool if the kernel does not support it */
+#   define CAT_IO_URING 1
+#  endif
+# endif
+#endif
+
+#ifdef CAT_IO_URING
+
+#include "cat_fs.h"
+
+CAT_API cat_bool_t cat_io_uring_module_init(void);
+CAT_API cat_bool_t cat_io_uring_module_shutdown(void);
+CAT_API cat_bool_t cat_io_uring_runtime_init(void);
+CAT_API cat_bool_t cat_io_uring_runtime_shutdown(void);
+
+CAT_API cat_bool_t cat_io_uring_is_enabled(void);
+/* it only takes effect on rings which are not created yet */
+CAT_API void cat_io_uring_set_enabled(cat_bool_t enabled);
+/* it creates the ring of the current event loop lazily */
+CAT_API cat_bool_t cat_io_uring_is_available(void);
+
+/* fork() support, the ring is shared with the parent process, drop it in the child */
+CAT_API void cat_io_uring_fork(void);
+
+/* These functions return CAT_ENOTSUP without touching the last error
+ * if the operation can not be done via io_uring (the caller should fall back),
+ * otherwise they return the result of the operation, or -1 with the last error set (and errno) on failure. */
+CAT_API int cat_io_uring_open(const char *path, int flags, int mode);
+CAT_API int cat_io_uring_close(cat_file_t fd);
+/* offset -1 means the current file position */
+CAT_API ssize_t cat_io_uring_read(cat_file_t fd, void *buffer, size_t size, int64_t offset);
+CAT_API ssize_t cat_io_uring_write(cat_file_t fd, const void *buffer, size_t length, int64_t offset);
+CAT_API int cat_io_uring_fsync(cat_file_t fd, cat_bool_t datasync);
+/* path is NULL means fstat */
+CAT_API int cat_io_uring_stat(cat_file_t fd, const char *path, cat_bool_t follow_symlink, cat_stat_t *buf);
+
+#endif /* CAT_IO_URING */
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* CAT_IO_URING_H */
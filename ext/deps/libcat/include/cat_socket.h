@@ -23,8 +23,10 @@ extern "C" {
 #endif
 
 #include "cat.h"
+#include "cat_buffer.h"
 #include "cat_coroutine.h"
 #include "cat_dns.h"
+#include "cat_fs.h"
 #include "cat_ssl.h"
 
 #ifdef CAT_OS_UNIX_LIKE
@@ -36,6 +38,11 @@ extern "C" {
 #include <winsock2.h>
 #endif
 
+/* MSG_ZEROCOPY (since Linux 4.14) */
+#if defined(CAT_OS_LINUX) && defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+#define CAT_SOCKET_ZEROCOPY 1
+#endif
+
 /* sockaddr */
 
 #define CAT_SOCKET_DEFAULT_BACKLOG  511
@@ -330,6 +337,9 @@ typedef uint32_t cat_socket_flags_t;
     /* socket may be a pipe file, which is created by pipe2()
      * and can only work with read()/write() */ \
     XX(NOT_SOCK,          1 << 2) \
+    /* data is being written directly on the fd (e.g. sendfile(2) or MSG_ZEROCOPY),
+     * other writes must wait for it to avoid interleaving */ \
+    XX(DIRECT_WRITE,      1 << 3) \
     /* 20 ~ 23 (stream (tcp|pipe|tty)) */ \
     XX(SERVER,            1 << 20) \
     XX(SERVER_CONNECTION, 1 << 21) \
@@ -408,14 +418,23 @@ typedef struct cat_socket_write_context_s {
     cat_queue_t coroutines;
 } cat_socket_write_context_t;
 
-typedef struct cat_socket_write_request_s {
+#ifndef CAT_SOCKET_WRITE_REQUEST_CACHE_SIZE
+/* max number of free write requests kept by each socket for concurrent writers */
+#define CAT_SOCKET_WRITE_REQUEST_CACHE_SIZE 8
+#endif
+
+typedef struct cat_socket_write_request_s cat_socket_write_request_t;
+
+struct cat_socket_write_request_s {
+    /* next one in the free list */
+    cat_socket_write_request_t *next;
     int error;
     union {
         cat_coroutine_t *coroutine;
         uv_write_t stream;
         uv_udp_send_t udp;
     } u;
-} cat_socket_write_request_t;
+};
 
 #ifdef CAT_OS_UNIX_LIKE
 typedef struct uv_udg_s {
@@ -425,12 +444,36 @@ typedef struct uv_udg_s {
 } uv_udg_t;
 #endif
 
+/* inline read means trying to read before waiting for readable (UNIX only),
+ * it saves an event loop round trip when data is ready, but wastes a syscall (EAGAIN) when it is not */
+#define CAT_SOCKET_INLINE_READ_MODE_MAP(XX) \
+    XX(DEFAULT,  0) /* follow the global mode of the socket type */ \
+    XX(ALWAYS,   1) \
+    XX(ADAPTIVE, 2) /* skip it for a while if it keeps missing */ \
+    XX(NEVER,    3) \
+
+typedef enum cat_socket_inline_read_mode_e {
+#define CAT_SOCKET_INLINE_READ_MODE_GEN(name, value) CAT_ENUM_GEN(CAT_SOCKET_INLINE_READ_MODE_, name, value)
+    CAT_SOCKET_INLINE_READ_MODE_MAP(CAT_SOCKET_INLINE_READ_MODE_GEN)
+#undef CAT_SOCKET_INLINE_READ_MODE_GEN
+} cat_socket_inline_read_mode_t;
+
+typedef struct cat_socket_inline_read_stats_s {
+    /* inline reads which got data (or error) */
+    uint64_t hits;
+    /* inline reads which got EAGAIN */
+    uint64_t misses;
+    /* reads which skipped the inline read */
+    uint64_t skips;
+} cat_socket_inline_read_stats_t;
+
 typedef struct cat_socket_s cat_socket_t;
 typedef struct cat_socket_internal_s cat_socket_internal_t;
 
 typedef struct cat_socket_options_s {
     cat_socket_timeout_options_t timeout;
     unsigned int tcp_keepalive_delay;
+    cat_socket_inline_read_mode_t inline_read_mode;
 } cat_socket_options_t;
 
 typedef struct cat_socket_inheritance_info_s {
@@ -463,13 +506,43 @@ struct cat_socket_internal_s
     /* cache */
     struct {
         cat_socket_fd_t fd;
-        cat_socket_write_request_t *write_request;
+        cat_socket_write_request_t *write_requests;
         cat_socket_inheritance_info_t *ipcc_handle_info;
         cat_sockaddr_info_t *sockname;
         cat_sockaddr_info_t *peername;
         int recv_buffer_size;
         int send_buffer_size;
+        uint8_t write_request_count;
     } cache;
+    struct {
+        /* consecutive misses */
+        uint8_t misses;
+        /* the next skip window is (1 << backoff) reads */
+        uint8_t backoff;
+        /* remaining reads to skip */
+        uint16_t skips;
+        cat_socket_inline_read_stats_t stats;
+    } inline_read;
+    struct {
+        /* corked data which has not been written yet */
+        cat_buffer_t buffer;
+        /* buffer will be flushed once its length >= threshold (0 means not corked) */
+        size_t threshold;
+        /* flush buffer when the event loop runs (after the writer yielded) */
+        cat_bool_t auto_flush;
+        /* node of the flush queue (it is in queue if flush is scheduled) */
+        cat_queue_node_t node;
+        /* auto flush failed (stream has been truncated), it is reported by write/uncork/close */
+        cat_errno_t error;
+    } cork;
+#ifdef CAT_SOCKET_ZEROCOPY
+    struct {
+        /* writes whose length >= threshold use MSG_ZEROCOPY (0 means disabled) */
+        size_t threshold;
+        /* number of completion notifications which have not been received yet */
+        uint32_t pending;
+    } zerocopy;
+#endif
     /* ext */
 #ifdef CAT_SSL
     cat_ssl_t *ssl;
@@ -505,9 +578,17 @@ CAT_GLOBALS_STRUCT_BEGIN(cat_socket) {
     struct {
         cat_socket_timeout_options_t timeout;
         unsigned int tcp_keepalive_delay;
+        /* TCP, PIPE, UDP */
+        cat_socket_inline_read_mode_t inline_read_modes[3];
     } options;
+    /* corked sockets which are waiting for auto flush */
+    struct {
+        cat_queue_t queue;
+        cat_bool_t scheduled;
+    } cork;
     /* dns */
-    // TODO: dns_cache (we should implement lru_cache)
+    cat_dns_cache_t dns_cache;
+    cat_dns_resolver_t dns_resolver;
 } CAT_GLOBALS_STRUCT_END(cat_socket);
 
 extern CAT_API CAT_GLOBALS_DECLARE(cat_socket);
@@ -558,6 +639,11 @@ CAT_API void cat_socket_set_global_handshake_timeout(cat_timeout_t timeout);
 CAT_API void cat_socket_set_global_read_timeout(cat_timeout_t timeout);
 CAT_API void cat_socket_set_global_write_timeout(cat_timeout_t timeout);
 
+/* it takes effect on all socket types which match the type (e.g. TYPE_ANY means all),
+ * mode DEFAULT resets them to the builtin default (ADAPTIVE) */
+CAT_API cat_socket_inline_read_mode_t cat_socket_get_global_inline_read_mode(cat_socket_type_t type);
+CAT_API cat_bool_t cat_socket_set_global_inline_read_mode(cat_socket_type_t type, cat_socket_inline_read_mode_t mode);
+
 CAT_API cat_timeout_t cat_socket_get_dns_timeout(const cat_socket_t *socket);
 CAT_API cat_timeout_t cat_socket_get_accept_timeout(const cat_socket_t *socket);
 CAT_API cat_timeout_t cat_socket_get_connect_timeout(const cat_socket_t *socket);
@@ -580,6 +666,8 @@ CAT_API cat_bool_t cat_socket_bind_to_ex(cat_socket_t *socket, const char *name,
 CAT_API cat_bool_t cat_socket_listen(cat_socket_t *socket, int backlog);
 CAT_API cat_bool_t cat_socket_accept(cat_socket_t *server, cat_socket_t *client);
 CAT_API cat_bool_t cat_socket_accept_ex(cat_socket_t *server, cat_socket_t *client, cat_timeout_t timeout);
+/* accept a connection only if it is already pending, it never waits, and fails with CAT_EAGAIN if there is none */
+CAT_API cat_bool_t cat_socket_try_accept(cat_socket_t *server, cat_socket_t *client);
 
 CAT_API cat_bool_t cat_socket_connect(cat_socket_t *socket, const cat_sockaddr_t *address, cat_socklen_t address_length);
 CAT_API cat_bool_t cat_socket_connect_ex(cat_socket_t *socket, const cat_sockaddr_t *address, cat_socklen_t address_length, cat_timeout_t timeout);
@@ -671,6 +759,29 @@ CAT_API ssize_t cat_socket_peek_from_ex(const cat_socket_t *socket, char *buffer
 
 CAT_API cat_bool_t cat_socket_send_handle(cat_socket_t *socket, cat_socket_t *handle);
 CAT_API cat_bool_t cat_socket_send_handle_ex(cat_socket_t *socket, cat_socket_t *handle, cat_timeout_t timeout);
+/* length 0 means sending till the end of file,
+ * it returns the sent length (maybe less than length on failure, or -1 if nothing was sent) */
+CAT_API ssize_t cat_socket_send_file(cat_socket_t *socket, cat_file_t fd, int64_t offset, size_t length);
+CAT_API ssize_t cat_socket_send_file_ex(cat_socket_t *socket, cat_file_t fd, int64_t offset, size_t length, cat_timeout_t timeout);
+
+/* batched datagram IO (recvmmsg(2)/sendmmsg(2) on Linux, one by one on other platforms) */
+typedef struct cat_socket_datagram_s {
+    char *buffer;
+    /* recv only: size of buffer */
+    size_t size;
+    /* recv: length of received datagram, send: length of data */
+    size_t length;
+    /* recv: source address, send: destination address (empty means the connected peer) */
+    cat_sockaddr_info_t address;
+} cat_socket_datagram_t;
+
+/* it waits for the first datagram and then receives all pending ones (up to count),
+ * returns the number of received datagrams */
+CAT_API ssize_t cat_socket_recv_many(cat_socket_t *socket, cat_socket_datagram_t *datagrams, size_t count);
+CAT_API ssize_t cat_socket_recv_many_ex(cat_socket_t *socket, cat_socket_datagram_t *datagrams, size_t count, cat_timeout_t timeout);
+/* returns the number of sent datagrams (maybe less than count on failure, or -1 if nothing was sent) */
+CAT_API ssize_t cat_socket_send_many(cat_socket_t *socket, const cat_socket_datagram_t *datagrams, size_t count);
+CAT_API ssize_t cat_socket_send_many_ex(cat_socket_t *socket, const cat_socket_datagram_t *datagrams, size_t count, cat_timeout_t timeout);
 
 /* @note last_error will not be updated when close failed,  */
 CAT_API cat_bool_t cat_socket_close(cat_socket_t *socket);
@@ -724,6 +835,24 @@ CAT_API cat_bool_t cat_socket_set_tcp_keepalive(cat_socket_t *socket, cat_bool_t
 
 CAT_API cat_bool_t cat_socket_set_tcp_accept_balance(cat_socket_t *socket, cat_bool_t enable);
 
+/* writes whose length >= threshold will be sent with MSG_ZEROCOPY (TCP on Linux only),
+ * they return after the kernel released the data, 0 means disabled */
+CAT_API size_t cat_socket_get_tcp_zerocopy_threshold(const cat_socket_t *socket);
+CAT_API cat_bool_t cat_socket_set_tcp_zerocopy_threshold(cat_socket_t *socket, size_t threshold);
+/* accepted connections inherit the mode of the server */
+CAT_API cat_socket_inline_read_mode_t cat_socket_get_inline_read_mode(const cat_socket_t *socket);
+CAT_API cat_bool_t cat_socket_set_inline_read_mode(cat_socket_t *socket, cat_socket_inline_read_mode_t mode);
+CAT_API cat_bool_t cat_socket_get_inline_read_stats(const cat_socket_t *socket, cat_socket_inline_read_stats_t *stats);
+/* writes of stream sockets are buffered until the buffer length >= threshold (0 means default),
+ * if auto_flush is enabled, buffered data will be flushed when the event loop runs,
+ * uncork() flushes buffered data and stops corking, close() also flushes buffered data before closing,
+ * if auto flush failed, the error is reported by all following write/uncork/close calls */
+#define CAT_SOCKET_CORK_DEFAULT_THRESHOLD (64 * 1024)
+CAT_API cat_bool_t cat_socket_cork(cat_socket_t *socket, size_t threshold, cat_bool_t auto_flush);
+CAT_API cat_bool_t cat_socket_uncork(cat_socket_t *socket);
+CAT_API cat_bool_t cat_socket_uncork_ex(cat_socket_t *socket, cat_timeout_t timeout);
+CAT_API cat_bool_t cat_socket_is_corked(const cat_socket_t *socket);
+
 CAT_API cat_bool_t cat_socket_get_udp_broadcast(const cat_socket_t *socket);
 CAT_API cat_bool_t cat_socket_set_udp_broadcast(cat_socket_t *socket, cat_bool_t enable);
 
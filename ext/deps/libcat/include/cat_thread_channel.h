@@ -0,0 +1,97 @@
+/*
+  +--------------------------------------------------------------------------+
+  | libcat                                                                   |
+  +--------------------------------------------------------------------------+
+  | Licensed under the Apache License, Version 2.0 (the "License");          |
+  | you may not use this file except in compliance with the License.         |
+  | You may obtain a copy of the License at                                  |
+  | http://www.apache.org/licenses/LICENSE-2.0                               |
+  | Unless required by applicable law or agreed to in writing, software      |
+  | distributed under the License is distributed on an "AS IS" BASIS,        |
+  | WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. |
+  | See the License for the specific language governing permissions and      |
+  | limitations under the License. See accompanying LICENSE file.            |
+  +--------------------------------------------------------------------------+
+  | Author: Twosee <twosee@php.net>                                          |
+  +--------------------------------------------------------------------------+
+ */
+
+#ifndef CAT_THREAD_CHANNEL_H
+#define CAT_THREAD_CHANNEL_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "cat.h"
+#include "cat_channel.h"
+#include "cat_atomic.h"
+
+/* thread channel is a bounded channel shared between threads (event loops),
+ * each thread uses it through its own coroutines, waiters are woken up by uv_async,
+ * it is reference counted and only released by the last owner */
+
+enum cat_thread_channel_flag_e {
+    CAT_THREAD_CHANNEL_FLAG_NONE = 0,
+    /* only the thread which created the channel can pop from it,
+     * then it is a lock-free MPSC ring unless producers have to wait for space */
+    CAT_THREAD_CHANNEL_FLAG_SINGLE_CONSUMER = 1 << 0,
+};
+
+typedef uint8_t cat_thread_channel_flags_t;
+
+typedef struct cat_thread_channel_doorbell_s cat_thread_channel_doorbell_t;
+
+typedef struct cat_thread_channel_s {
+    cat_atomic_uint32_t refcount;
+    cat_atomic_bool_t closed;
+    cat_thread_channel_flags_t flags;
+    cat_channel_data_size_t data_size;
+    cat_channel_data_dtor_t dtor;
+    cat_channel_size_t capacity;
+    char *storage;
+    /* producers waiting for space are always queued with mutex held */
+    uv_mutex_t mutex;
+    cat_queue_t producers;
+    union {
+        /* all fields are protected by mutex */
+        struct {
+            cat_channel_size_t length;
+            cat_channel_size_t head;
+            cat_queue_t consumers;
+        } locked;
+        struct {
+            /* slot for position n is free to push when its sequence is n * 2,
+             * and it is ready to pop when its sequence is n * 2 + 1 */
+            cat_atomic_uint64_t *sequences;
+            cat_atomic_uint64_t tail;
+            cat_atomic_uint64_t head;
+            cat_atomic_uint32_t producer_waiters;
+            /* armed by the waiting consumer, producer takes it and rings it */
+            cat_atomic_ptr_t doorbell;
+            /* only accessed in the consumer thread */
+            uv_thread_t consumer;
+            cat_thread_channel_doorbell_t *armed;
+            cat_queue_t consumers;
+        } lockfree;
+    } u;
+} cat_thread_channel_t;
+
+CAT_API cat_thread_channel_t *cat_thread_channel_create(cat_channel_size_t capacity, cat_channel_data_size_t data_size, cat_channel_data_dtor_t dtor);
+CAT_API cat_thread_channel_t *cat_thread_channel_create_ex(cat_channel_size_t capacity, cat_channel_data_size_t data_size, cat_channel_data_dtor_t dtor, cat_thread_channel_flags_t flags);
+CAT_API cat_thread_channel_t *cat_thread_channel_add_ref(cat_thread_channel_t *channel);
+/* remaining data will be destroyed when the last reference is released */
+CAT_API void cat_thread_channel_release(cat_thread_channel_t *channel);
+
+CAT_API cat_bool_t cat_thread_channel_push(cat_thread_channel_t *channel, const cat_data_t *data, cat_timeout_t timeout);
+CAT_API cat_bool_t cat_thread_channel_pop(cat_thread_channel_t *channel, cat_data_t *data, cat_timeout_t timeout);
+CAT_API cat_bool_t cat_thread_channel_close(cat_thread_channel_t *channel);
+
+CAT_API cat_channel_size_t cat_thread_channel_get_capacity(const cat_thread_channel_t *channel);
+CAT_API cat_channel_size_t cat_thread_channel_get_length(cat_thread_channel_t *channel);
+CAT_API cat_thread_channel_flags_t cat_thread_channel_get_flags(const cat_thread_channel_t *channel);
+CAT_API cat_bool_t cat_thread_channel_is_available(cat_thread_channel_t *channel);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* CAT_THREAD_CHANNEL_H */
@@ -24,6 +24,10 @@ extern "C" {
 
 #include "cat.h"
 
+/* timers are owned by event runtime */
+CAT_API void cat_time_runtime_init(void); CAT_INTERNAL
+CAT_API void cat_time_runtime_shutdown(void); CAT_INTERNAL
+
 /* powered by hr_time() */
 CAT_API cat_nsec_t cat_time_nsec(void);
 CAT_API cat_msec_t cat_time_msec(void);
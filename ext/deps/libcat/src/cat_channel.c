@@ -256,43 +256,80 @@ static cat_bool_t cat_channel_unbuffered_pop(cat_channel_t *channel, cat_data_t
     return cat_true;
 }
 
-static cat_always_inline cat_channel_bucket_t *cat_channel_buffered_bucket_create(const cat_data_t *data, size_t data_size)
+static cat_always_inline cat_bool_t cat_channel_buffered_is_linked(const cat_channel_t *channel)
 {
-    cat_channel_bucket_t *bucket;
+    return channel->flags & CAT_CHANNEL_FLAG_LINKED_STORAGE;
+}
 
-    bucket = (cat_channel_bucket_t *) cat_malloc(offsetof(cat_channel_bucket_t, data) + data_size);
+static cat_always_inline char *cat_channel_ring_slot(const cat_channel_t *channel, cat_channel_size_t index)
+{
+    index = (channel->u.buffered.ring.head + index) & (channel->u.buffered.ring.size - 1);
+    return channel->u.buffered.ring.data + (size_t) index * channel->data_size;
+}
 
+static cat_never_inline cat_bool_t cat_channel_ring_grow(cat_channel_t *channel)
+{
+    size_t data_size = channel->data_size;
+    cat_channel_size_t size = channel->u.buffered.ring.size;
+    cat_channel_size_t head = channel->u.buffered.ring.head;
+    uint64_t new_size;
+    char *data;
+
+    if (size == 0) {
+        new_size = CAT_CHANNEL_RING_INITIAL_SIZE;
+    } else {
+        new_size = ((uint64_t) size) << 1;
+    }
+    /* do not allocate slots which would never be used */
+    while ((new_size >> 1) >= channel->capacity) {
+        new_size >>= 1;
+    }
+    if (unlikely(new_size > CAT_CHANNEL_SIZE_MAX)) {
+        cat_update_last_error(CAT_ENOMEM, "Channel storage is too large");
+        return cat_false;
+    }
+    data = (char *) cat_malloc((size_t) new_size * data_size);
 #if CAT_ALLOC_HANDLE_ERRORS
-    if (unlikely(bucket == NULL)) {
-        cat_update_last_error_of_syscall("Malloc for channel bucket failed");
-        return NULL;
+    if (unlikely(data == NULL)) {
+        cat_update_last_error_of_syscall("Malloc for channel storage failed");
+        return cat_false;
     }
 #endif
+    /* it is only called when ring is full, unwrap it to the front of the new one */
+    CAT_ASSERT(channel->length == size);
+    if (size != 0) {
+        memcpy(data, channel->u.buffered.ring.data + (size_t) head * data_size, (size_t) (size - head) * data_size);
+        memcpy(data + (size_t) (size - head) * data_size, channel->u.buffered.ring.data, (size_t) head * data_size);
+        cat_free(channel->u.buffered.ring.data);
+    }
+    channel->u.buffered.ring.data = data;
+    channel->u.buffered.ring.size = (cat_channel_size_t) new_size;
+    channel->u.buffered.ring.head = 0;
 
-    memcpy(bucket->data, data, data_size);
-
-    return bucket;
+    return cat_true;
 }
 
-static cat_always_inline cat_bool_t cat_channel_buffered_push_data(cat_channel_t *channel, const cat_data_t *data)
+static cat_never_inline cat_bool_t cat_channel_linked_push_data(cat_channel_t *channel, const cat_data_t *data)
 {
     cat_channel_bucket_t *bucket;
 
-    bucket = cat_channel_buffered_bucket_create(data, channel->data_size);
+    bucket = (cat_channel_bucket_t *) cat_malloc(offsetof(cat_channel_bucket_t, data) + channel->data_size);
 
 #if CAT_ALLOC_HANDLE_ERRORS
     if (unlikely(bucket == NULL)) {
+        cat_update_last_error_of_syscall("Malloc for channel bucket failed");
         return cat_false;
     }
 #endif
 
+    memcpy(bucket->data, data, channel->data_size);
     cat_queue_push_back(&channel->u.buffered.storage, &bucket->node);
     channel->length++;
 
     return cat_true;
 }
 
-static cat_always_inline void cat_channel_buffered_pop_data(cat_channel_t *channel, cat_data_t *data)
+static cat_never_inline void cat_channel_linked_pop_data(cat_channel_t *channel, cat_data_t *data)
 {
     cat_channel_bucket_t *bucket;
 
@@ -307,6 +344,40 @@ static cat_always_inline void cat_channel_buffered_pop_data(cat_channel_t *chann
     channel->length--;
 }
 
+static cat_always_inline cat_bool_t cat_channel_buffered_push_data(cat_channel_t *channel, const cat_data_t *data)
+{
+    if (unlikely(cat_channel_buffered_is_linked(channel))) {
+        return cat_channel_linked_push_data(channel, data);
+    }
+    if (unlikely(channel->length == channel->u.buffered.ring.size)) {
+        if (unlikely(!cat_channel_ring_grow(channel))) {
+            return cat_false;
+        }
+    }
+    memcpy(cat_channel_ring_slot(channel, channel->length), data, channel->data_size);
+    channel->length++;
+
+    return cat_true;
+}
+
+static cat_always_inline void cat_channel_buffered_pop_data(cat_channel_t *channel, cat_data_t *data)
+{
+    char *slot;
+
+    if (unlikely(cat_channel_buffered_is_linked(channel))) {
+        cat_channel_linked_pop_data(channel, data);
+        return;
+    }
+    slot = cat_channel_ring_slot(channel, 0);
+    if (data != NULL) {
+        memcpy(data, slot, channel->data_size);
+    } else if (channel->dtor != NULL) {
+        channel->dtor(slot);
+    }
+    channel->u.buffered.ring.head = (channel->u.buffered.ring.head + 1) & (channel->u.buffered.ring.size - 1);
+    channel->length--;
+}
+
 static cat_always_inline void cat_channel_notify_possible_consumer(cat_channel_t *channel)
 {
     cat_coroutine_t *consumer = cat_queue_front_data(&channel->consumers, cat_coroutine_t, waiter.node);
@@ -327,6 +398,9 @@ static cat_always_inline void cat_channel_notify_possible_producer(cat_channel_t
     }
 }
 
+/* Note: buffered channel may have both data and waiting consumers (or free space and waiting producers)
+ * for a while, because batch operations wake the waiters up one by one after they were done */
+
 static cat_bool_t cat_channel_buffered_push(cat_channel_t *channel, const cat_data_t *data, cat_timeout_t timeout)
 {
     /* if it is full, just wait */
@@ -341,11 +415,9 @@ static cat_bool_t cat_channel_buffered_push(cat_channel_t *channel, const cat_da
             cat_update_last_error(CAT_ECANCELED, "Channel push has been canceled");
             return cat_false;
         }
-        CAT_ASSERT(!cat_channel__has_consumers(channel));
         /* push data to the storage queue and return */
         return cat_channel_buffered_push_data(channel, data);
     } else {
-        CAT_ASSERT(!cat_channel__has_producers(channel));
         /* push data to the storage queue */
 #if CAT_ALLOC_HANDLE_ERRORS
         if (unlikely(!cat_channel_buffered_push_data(channel, data))) {
@@ -374,11 +446,9 @@ static cat_bool_t cat_channel_buffered_pop(cat_channel_t *channel, cat_data_t *d
             cat_update_last_error(CAT_ECANCELED, "Channel pop has been canceled");
             return cat_false;
         }
-        CAT_ASSERT(!cat_channel__has_producers(channel));
         /* pop data from the storage queue and return */
         cat_channel_buffered_pop_data(channel, data);
     } else {
-        CAT_ASSERT(!cat_channel__has_consumers(channel));
         /* pop data from the storage queue */
         cat_channel_buffered_pop_data(channel, data);
         /* try to notify one for balance */
@@ -392,16 +462,24 @@ static cat_bool_t cat_channel_buffered_pop(cat_channel_t *channel, cat_data_t *d
 
 CAT_API cat_channel_t *cat_channel_create(cat_channel_t *channel, cat_channel_size_t capacity, cat_channel_data_size_t data_size, cat_channel_data_dtor_t dtor)
 {
+    return cat_channel_create_ex(channel, capacity, data_size, dtor, CAT_CHANNEL_FLAG_NONE);
+}
+
+CAT_API cat_channel_t *cat_channel_create_ex(cat_channel_t *channel, cat_channel_size_t capacity, cat_channel_data_size_t data_size, cat_channel_data_dtor_t dtor, cat_channel_flags_t flags)
+{
+    CAT_ASSERT((flags & ~CAT_CHANNEL_FLAG_LINKED_STORAGE) == 0);
     channel->capacity = capacity;
     channel->data_size = data_size;
     channel->length = 0;
-    channel->flags = CAT_CHANNEL_FLAG_NONE;
+    channel->flags = flags;
     channel->dtor = dtor;
     cat_queue_init(&channel->producers);
     cat_queue_init(&channel->consumers);
     if (cat_channel__is_unbuffered(channel)) {
         memset(&channel->u.unbuffered, 0, sizeof(channel->u.unbuffered));
     } else {
+        /* storage will be allocated on the first push */
+        memset(&channel->u.buffered.ring, 0, sizeof(channel->u.buffered.ring));
         cat_queue_init(&channel->u.buffered.storage);
     }
 
@@ -431,6 +509,114 @@ CAT_API cat_bool_t cat_channel_pop(cat_channel_t *channel, cat_data_t *data, cat
     }
 }
 
+static cat_always_inline cat_timeout_t cat_channel_get_timeout_left(cat_timeout_t timeout, cat_msec_t start)
+{
+    cat_msec_t elapsed;
+
+    if (timeout <= 0) {
+        return timeout;
+    }
+    elapsed = cat_time_msec() - start;
+
+    return elapsed >= (cat_msec_t) timeout ? 0 : (cat_timeout_t) (timeout - elapsed);
+}
+
+CAT_API size_t cat_channel_push_batch(cat_channel_t *channel, const cat_data_t *data, size_t count, cat_timeout_t timeout)
+{
+    const char *p = (const char *) data;
+    cat_msec_t start = timeout > 0 ? cat_time_msec() : 0;
+    cat_bool_t failed = cat_false;
+    size_t n = 0;
+
+    while (n < count) {
+        CAT_CHANNEL_CHECK_STATE(channel, break);
+        if (cat_channel__is_unbuffered(channel)) {
+            /* every item has to be handed over to a consumer */
+            if (unlikely(!cat_channel_unbuffered_push(channel, p, cat_channel_get_timeout_left(timeout, start)))) {
+                break;
+            }
+            n++;
+            p += channel->data_size;
+            continue;
+        }
+        if (cat_channel__is_full(channel)) {
+            if (unlikely(!cat_channel_wait_on(channel, &channel->producers, cat_channel_get_timeout_left(timeout, start)))) {
+                /* sleep failed or timedout */
+                cat_update_last_error_with_previous("Channel wait consumer failed");
+                break;
+            }
+            if (unlikely(cat_channel__is_available(channel) && cat_channel__is_full(channel))) {
+                /* still full, must be canceled */
+                cat_update_last_error(CAT_ECANCELED, "Channel push has been canceled");
+                break;
+            }
+            continue;
+        }
+        /* fill as much as we can, then wake consumers up */
+        do {
+            if (unlikely(!cat_channel_buffered_push_data(channel, p))) {
+                failed = cat_true;
+                break;
+            }
+            n++;
+            p += channel->data_size;
+        } while (n < count && !cat_channel__is_full(channel));
+        while (!cat_channel__is_empty(channel) && cat_channel__has_consumers(channel)) {
+            cat_channel_notify_possible_consumer(channel);
+        }
+        if (unlikely(failed)) {
+            break;
+        }
+    }
+
+    return n;
+}
+
+CAT_API size_t cat_channel_pop_batch(cat_channel_t *channel, cat_data_t *data, size_t max, cat_timeout_t timeout)
+{
+    char *p = (char *) data;
+    size_t n;
+
+    CAT_ASSERT(data != NULL && max > 0);
+    CAT_CHANNEL_CHECK_STATE_FOR_READING(channel, return 0);
+
+    if (cat_channel__is_unbuffered(channel)) {
+        if (unlikely(!cat_channel_unbuffered_pop(channel, p, timeout))) {
+            return 0;
+        }
+        /* take what producers are offering, but never wait for more */
+        for (n = 1, p += channel->data_size; n < max && cat_channel__has_producers(channel); n++, p += channel->data_size) {
+            cat_channel_unbuffered_notify_producer(channel, p);
+        }
+        return n;
+    }
+
+    if (cat_channel__is_empty(channel)) {
+        if (unlikely(!cat_channel_wait_on(channel, &channel->consumers, timeout))) {
+            /* sleep failed or timedout */
+            cat_update_last_error_with_previous("Channel wait producer failed");
+            return 0;
+        }
+        if (unlikely(cat_channel__is_empty(channel))) {
+            /* still empty, must be canceled */
+            cat_update_last_error(CAT_ECANCELED, "Channel pop has been canceled");
+            return 0;
+        }
+    }
+    n = 0;
+    do {
+        cat_channel_buffered_pop_data(channel, p);
+        n++;
+        p += channel->data_size;
+    } while (n < max && !cat_channel__is_empty(channel));
+    /* wake producers up */
+    while (!cat_channel__is_full(channel) && cat_channel__has_producers(channel)) {
+        cat_channel_notify_possible_producer(channel);
+    }
+
+    return n;
+}
+
 CAT_API cat_bool_t cat_channel_close(cat_channel_t *channel)
 {
     CAT_CHANNEL_CHECK_STATE(channel, return cat_false);
@@ -459,18 +645,14 @@ CAT_API void cat_channel_cleanup(cat_channel_t *channel)
         (void) cat_channel_close(channel);
     }
 
-    /* clean up the data bucket (no more consumers) */
+    /* clean up the storage (no more consumers) */
     if (!cat_channel__is_unbuffered(channel)) {
-        cat_queue_t *storage = &channel->u.buffered.storage;
-        cat_channel_data_dtor_t dtor = channel->dtor;
-        cat_channel_bucket_t *bucket;
-        while ((bucket = cat_queue_front_data(storage, cat_channel_bucket_t, node))) {
-            cat_queue_remove(&bucket->node);
-            if (dtor != NULL) {
-                dtor(bucket->data);
-            }
-            cat_free(bucket);
-            channel->length--;
+        while (!cat_channel__is_empty(channel)) {
+            cat_channel_buffered_pop_data(channel, NULL);
+        }
+        if (channel->u.buffered.ring.data != NULL) {
+            cat_free(channel->u.buffered.ring.data);
+            memset(&channel->u.buffered.ring, 0, sizeof(channel->u.buffered.ring));
         }
     }
 
@@ -657,9 +839,27 @@ CAT_API cat_channel_data_dtor_t cat_channel_set_dtor(cat_channel_t *channel, cat
 
 /* ext */
 
+CAT_API void cat_channel_walk_storage(cat_channel_t *channel, cat_channel_storage_walker_t walker, cat_data_t *arg)
+{
+    cat_channel_size_t n;
+
+    if (cat_channel__is_unbuffered(channel)) {
+        return;
+    }
+    if (unlikely(cat_channel_buffered_is_linked(channel))) {
+        CAT_QUEUE_FOREACH_DATA_START(&channel->u.buffered.storage, cat_channel_bucket_t, node, bucket) {
+            walker(bucket->data, arg);
+        } CAT_QUEUE_FOREACH_DATA_END();
+        return;
+    }
+    for (n = 0; n < channel->length; n++) {
+        walker(cat_channel_ring_slot(channel, n), arg);
+    }
+}
+
 CAT_API cat_queue_t *cat_channel_get_storage(cat_channel_t *channel)
 {
-    if (unlikely(cat_channel__is_unbuffered(channel))) {
+    if (unlikely(cat_channel__is_unbuffered(channel) || !cat_channel_buffered_is_linked(channel))) {
         return NULL;
     }
     return &channel->u.buffered.storage;
@@ -54,6 +54,10 @@
 #  undef MAP_STACK
 #  define MAP_STACK 0
 # endif
+/* stack is only reserved here, pages will be committed on demand */
+# ifndef MAP_NORESERVE
+#  define MAP_NORESERVE 0
+# endif
 # ifndef MAP_FAILED
 #  define MAP_FAILED ((void * ) -1)
 # endif
@@ -72,6 +76,15 @@
 # define CAT_COROUTINE_STACK_PADDING_PAGE_COUNT  0
 #endif
 
+/* give back physical pages of the idle stacks (in pool or under the stack pointer) */
+#if defined(CAT_COROUTINE_USE_MMAP) && defined(MADV_DONTNEED)
+# define CAT_COROUTINE_USE_STACK_MADVISE 1
+#endif
+
+/* pages under the stack pointer which are kept when trimming,
+ * context switching may still write a little bit under it */
+#define CAT_COROUTINE_STACK_TRIM_RESERVED_PAGE_COUNT 1
+
 #ifdef CAT_HAVE_VALGRIND
 # include <valgrind/valgrind.h>
 #endif
@@ -172,6 +185,22 @@ CAT_API cat_bool_t cat_coroutine_runtime_init(void)
     CAT_COROUTINE_G(count) = 0;
     CAT_COROUTINE_G(peak_count) = 0;
     CAT_COROUTINE_G(switches) = 0;
+    CAT_COROUTINE_G(peak_stack_usage) = 0;
+
+    /* init stack pool */
+    do {
+        size_t i;
+        CAT_COROUTINE_G(stack_pool_size) = CAT_COROUTINE_DEFAULT_STACK_POOL_SIZE;
+        CAT_COROUTINE_G(stack_pool_count) = 0;
+        CAT_COROUTINE_G(stack_pool_hits) = 0;
+        CAT_COROUTINE_G(stack_pool_misses) = 0;
+        for (i = 0; i < CAT_COROUTINE_STACK_POOL_BIN_COUNT; i++) {
+            cat_coroutine_stack_pool_bin_t *bin = &CAT_COROUTINE_G(stack_pool_bins)[i];
+            bin->virtual_memory_size = 0;
+            bin->count = 0;
+            cat_queue_init(&bin->stacks);
+        }
+    } while (0);
 
     /* init main coroutine properties */
     do {
@@ -190,6 +219,8 @@ CAT_API cat_bool_t cat_coroutine_runtime_init(void)
 #ifdef CAT_COROUTINE_USE_USER_STACK
         main_coroutine->virtual_memory = NULL;
         main_coroutine->virtual_memory_size = 0;
+        main_coroutine->stack_usage = 0;
+        main_coroutine->peak_stack_usage = 0;
         memset(&main_coroutine->context, 0, sizeof(cat_coroutine_context_t));
 #endif
 #ifdef CAT_COROUTINE_USE_USER_TRANSFER_DATA
@@ -234,6 +265,10 @@ CAT_API cat_bool_t cat_coroutine_runtime_shutdown(void)
     CAT_ASSERT(cat_coroutine_get_scheduler() == NULL && "Coroutine scheduler should have been stopped");
     CAT_ASSERT(CAT_COROUTINE_G(count) == 1 && "Coroutine count should be 1");
 
+    /* stacks of coroutines which are closed after here will be released immediately */
+    CAT_COROUTINE_G(stack_pool_size) = 0;
+    cat_coroutine_stack_pool_clear();
+
     return cat_true;
 }
 
@@ -258,6 +293,16 @@ CAT_API cat_coroutine_deadlock_callback_t cat_coroutine_set_deadlock_callback(ca
     return original_callback;
 }
 
+static void cat_coroutine_stack_pool_trim(cat_coroutine_count_t size);
+
+CAT_API cat_coroutine_count_t cat_coroutine_set_stack_pool_size(cat_coroutine_count_t size)
+{
+    cat_coroutine_count_t original_size = CAT_COROUTINE_G(stack_pool_size);
+    CAT_COROUTINE_G(stack_pool_size) = size;
+    cat_coroutine_stack_pool_trim(size);
+    return original_size;
+}
+
 CAT_API cat_coroutine_jump_t cat_coroutine_register_jump(cat_coroutine_jump_t jump)
 {
     cat_coroutine_jump_t original_jump = cat_coroutine_jump;
@@ -363,6 +408,195 @@ CAT_API cat_coroutine_switches_t cat_coroutine_get_global_switches(void)
     return CAT_COROUTINE_G(switches);
 }
 
+CAT_API cat_coroutine_stack_size_t cat_coroutine_get_global_peak_stack_usage(void)
+{
+    return CAT_COROUTINE_G(peak_stack_usage);
+}
+
+CAT_API cat_coroutine_count_t cat_coroutine_get_stack_pool_size(void)
+{
+    return CAT_COROUTINE_G(stack_pool_size);
+}
+
+CAT_API void cat_coroutine_get_stack_pool_info(cat_coroutine_stack_pool_info_t *info)
+{
+#ifdef CAT_COROUTINE_USE_STACK_POOL
+    info->available = cat_true;
+#else
+    info->available = cat_false;
+#endif
+    info->size = CAT_COROUTINE_G(stack_pool_size);
+    info->count = CAT_COROUTINE_G(stack_pool_count);
+    info->hits = CAT_COROUTINE_G(stack_pool_hits);
+    info->misses = CAT_COROUTINE_G(stack_pool_misses);
+}
+
+/* stack pool */
+
+#ifdef CAT_COROUTINE_USE_USER_STACK
+static void cat_coroutine_stack_free(void *virtual_memory, size_t virtual_memory_size)
+{
+#if defined(CAT_COROUTINE_USE_MEMORY_PROTECT) && defined(CAT_COROUTINE_USE_SYS_MALLOC)
+    do {
+        void *page = cat_getpageafter(virtual_memory);
+        cat_bool_t ret;
+# ifndef CAT_OS_WIN
+        ret = mprotect(page, cat_getpagesize(), PROT_READ | PROT_WRITE) == 0;
+# else
+        DWORD old_protect;
+        ret = VirtualProtect(page, cat_getpagesize(), PAGE_READWRITE, &old_protect) != 0;
+# endif
+        CAT_LOG_DEBUG_V2(COROUTINE, "Unprotect stack page at %p with %zu bytes %s", page, cat_getpagesize(), ret ? "successfully" : "failed");
+        if (unlikely(!ret)) {
+            CAT_SYSCALL_FAILURE(NOTICE, COROUTINE, "Unprotect stack page failed");
+        }
+    } while (0);
+#endif
+#if defined(CAT_COROUTINE_USE_MMAP)
+    munmap(virtual_memory, virtual_memory_size);
+#elif defined(CAT_COROUTINE_USE_VIRTUAL_ALLOC)
+    (void) virtual_memory_size;
+    VirtualFree(virtual_memory, 0, MEM_RELEASE);
+#elif defined(CAT_COROUTINE_USE_SYS_MALLOC)
+    (void) virtual_memory_size;
+    cat_sys_free(virtual_memory);
+#endif
+}
+#endif
+
+#ifdef CAT_COROUTINE_USE_STACK_MADVISE
+/* MADV_FREE is lazy (and cheaper), but RSS will not drop until there is memory pressure */
+static cat_bool_t cat_coroutine_stack_advise(void *start, size_t length, cat_bool_t lazy)
+{
+# ifdef MADV_FREE
+    if (lazy && madvise(start, length, MADV_FREE) == 0) {
+        return cat_true;
+    }
+# else
+    (void) lazy;
+# endif
+    if (unlikely(madvise(start, length, MADV_DONTNEED) != 0)) {
+        CAT_SYSCALL_FAILURE(NOTICE, COROUTINE, "Advise stack pages failed");
+        return cat_false;
+    }
+    return cat_true;
+}
+#endif
+
+#ifdef CAT_COROUTINE_USE_STACK_POOL
+/* Note: idle stack is linked by the node which is placed at the bottom of
+ * its usable area (just after the padding), so the pool needs no extra memory */
+static cat_always_inline cat_queue_node_t *cat_coroutine_stack_pool_get_node(void *virtual_memory)
+{
+    return (cat_queue_node_t *) (((char *) virtual_memory) + cat_getpagesize() * CAT_COROUTINE_STACK_PADDING_PAGE_COUNT);
+}
+
+static cat_always_inline void *cat_coroutine_stack_pool_get_virtual_memory(cat_queue_node_t *node)
+{
+    return ((char *) node) - cat_getpagesize() * CAT_COROUTINE_STACK_PADDING_PAGE_COUNT;
+}
+
+static cat_coroutine_stack_pool_bin_t *cat_coroutine_stack_pool_find_bin(size_t virtual_memory_size, cat_bool_t create)
+{
+    cat_coroutine_stack_pool_bin_t *bin, *free_bin = NULL;
+    size_t i;
+
+    for (i = 0; i < CAT_COROUTINE_STACK_POOL_BIN_COUNT; i++) {
+        bin = &CAT_COROUTINE_G(stack_pool_bins)[i];
+        if (bin->virtual_memory_size == virtual_memory_size) {
+            return bin;
+        }
+        if (free_bin == NULL && bin->count == 0) {
+            free_bin = bin;
+        }
+    }
+    if (create && free_bin != NULL) {
+        free_bin->virtual_memory_size = (uint32_t) virtual_memory_size;
+        return free_bin;
+    }
+
+    return NULL;
+}
+
+static void *cat_coroutine_stack_pool_acquire(size_t virtual_memory_size)
+{
+    cat_coroutine_stack_pool_bin_t *bin;
+    cat_queue_node_t *node;
+
+    if (CAT_COROUTINE_G(stack_pool_count) == 0) {
+        return NULL;
+    }
+    bin = cat_coroutine_stack_pool_find_bin(virtual_memory_size, cat_false);
+    if (bin == NULL || bin->count == 0) {
+        return NULL;
+    }
+    /* LIFO, the most recently used stack is more likely to be warm */
+    node = (cat_queue_node_t *) cat_queue_front(&bin->stacks);
+    cat_queue_remove(node);
+    bin->count--;
+    CAT_COROUTINE_G(stack_pool_count)--;
+
+    return cat_coroutine_stack_pool_get_virtual_memory(node);
+}
+
+static cat_bool_t cat_coroutine_stack_pool_release(void *virtual_memory, size_t virtual_memory_size)
+{
+    cat_coroutine_stack_pool_bin_t *bin;
+    cat_queue_node_t *node;
+
+    if (CAT_COROUTINE_G(stack_pool_count) >= CAT_COROUTINE_G(stack_pool_size)) {
+        return cat_false;
+    }
+    bin = cat_coroutine_stack_pool_find_bin(virtual_memory_size, cat_true);
+    if (unlikely(bin == NULL)) {
+        /* all bins are occupied by other size classes */
+        return cat_false;
+    }
+    node = cat_coroutine_stack_pool_get_node(virtual_memory);
+#ifdef CAT_COROUTINE_USE_STACK_MADVISE
+    /* keep the page which holds the node, and give back the others */
+    do {
+        char *start = ((char *) node) + cat_getpagesize();
+        size_t length = (((char *) virtual_memory) + virtual_memory_size) - start;
+        (void) cat_coroutine_stack_advise(start, length, cat_true);
+    } while (0);
+#endif
+    cat_queue_push_front(&bin->stacks, node);
+    bin->count++;
+    CAT_COROUTINE_G(stack_pool_count)++;
+
+    return cat_true;
+}
+#endif
+
+static void cat_coroutine_stack_pool_trim(cat_coroutine_count_t size)
+{
+#ifdef CAT_COROUTINE_USE_STACK_POOL
+    size_t i = 0;
+
+    while (CAT_COROUTINE_G(stack_pool_count) > size) {
+        cat_coroutine_stack_pool_bin_t *bin = &CAT_COROUTINE_G(stack_pool_bins)[i];
+        cat_queue_node_t *node = (cat_queue_node_t *) cat_queue_back(&bin->stacks);
+        if (node == NULL) {
+            i++;
+            CAT_ASSERT(i < CAT_COROUTINE_STACK_POOL_BIN_COUNT);
+            continue;
+        }
+        cat_queue_remove(node);
+        bin->count--;
+        CAT_COROUTINE_G(stack_pool_count)--;
+        cat_coroutine_stack_free(cat_coroutine_stack_pool_get_virtual_memory(node), bin->virtual_memory_size);
+    }
+#else
+    (void) size;
+#endif
+}
+
+CAT_API void cat_coroutine_stack_pool_clear(void)
+{
+    cat_coroutine_stack_pool_trim(0);
+}
+
 static void cat_coroutine_context_function(cat_coroutine_transfer_t transfer)
 {
     cat_coroutine_t *coroutine;
@@ -483,9 +717,18 @@ CAT_API cat_coroutine_t *cat_coroutine_create_ex(cat_coroutine_t *coroutine, cat
     *       stack                                         stack_start
     */
     virtual_memory_size = padding_size + stack_size;
+#ifdef CAT_COROUTINE_USE_STACK_POOL
+    /* reuse an idle stack (it has been protected) */
+    virtual_memory = cat_coroutine_stack_pool_acquire(virtual_memory_size);
+    if (virtual_memory != NULL) {
+        CAT_COROUTINE_G(stack_pool_hits)++;
+        goto _stack_allocated;
+    }
+    CAT_COROUTINE_G(stack_pool_misses)++;
+#endif
     /* alloc memory */
 #if defined(CAT_COROUTINE_USE_MMAP)
-    virtual_memory = mmap(NULL, virtual_memory_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    virtual_memory = mmap(NULL, virtual_memory_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK | MAP_NORESERVE, -1, 0);
 #elif defined(CAT_COROUTINE_USE_VIRTUAL_ALLOC)
     virtual_memory = VirtualAlloc(0, virtual_memory_size, MEM_COMMIT, PAGE_READWRITE);
 #else // if defined(CAT_COROUTINE_USE_SYS_MALLOC)
@@ -498,8 +741,6 @@ CAT_API cat_coroutine_t *cat_coroutine_create_ex(cat_coroutine_t *coroutine, cat
         }
         return NULL;
     }
-    stack = ((char *) virtual_memory) + padding_size;
-    stack_start = ((char *) stack) + stack_size;
 
 #ifdef CAT_COROUTINE_USE_MEMORY_PROTECT
     /* protect a page of memory after the stack top
@@ -523,6 +764,11 @@ CAT_API cat_coroutine_t *cat_coroutine_create_ex(cat_coroutine_t *coroutine, cat
         }
     } while (0);
 #endif /* CAT_COROUTINE_USE_MEMORY_PROTECT */
+#ifdef CAT_COROUTINE_USE_STACK_POOL
+    _stack_allocated:
+#endif
+    stack = ((char *) virtual_memory) + padding_size;
+    stack_start = ((char *) stack) + stack_size;
 #endif /* CAT_COROUTINE_USE_USER_STACK */
 
     /* make context */
@@ -551,6 +797,8 @@ CAT_API cat_coroutine_t *cat_coroutine_create_ex(cat_coroutine_t *coroutine, cat
 #ifdef CAT_COROUTINE_USE_USER_STACK
     coroutine->virtual_memory = virtual_memory;
     coroutine->virtual_memory_size = (uint32_t) virtual_memory_size;
+    coroutine->stack_usage = 0;
+    coroutine->peak_stack_usage = 0;
 #endif
     coroutine->context = context;
 #ifdef CAT_COROUTINE_USE_USER_TRANSFER_DATA
@@ -593,28 +841,13 @@ CAT_API void cat_coroutine_free(cat_coroutine_t *coroutine)
 #ifdef CAT_HAVE_VALGRIND
     VALGRIND_STACK_DEREGISTER(coroutine->valgrind_stack_id);
 #endif
-#if defined(CAT_COROUTINE_USE_MEMORY_PROTECT) && defined(CAT_COROUTINE_USE_SYS_MALLOC)
-    do {
-        void *page = cat_getpageafter(coroutine->virtual_memory);
-        cat_bool_t ret;
-# ifndef CAT_OS_WIN
-        ret = mprotect(page, cat_getpagesize(), PROT_READ | PROT_WRITE) == 0;
-# else
-        DWORD old_protect;
-        ret = VirtualProtect(page, cat_getpagesize(), PAGE_READWRITE, &old_protect) != 0;
+#ifdef CAT_COROUTINE_USE_USER_STACK
+# ifdef CAT_COROUTINE_USE_STACK_POOL
+    if (!cat_coroutine_stack_pool_release(coroutine->virtual_memory, coroutine->virtual_memory_size))
 # endif
-        CAT_LOG_DEBUG_V2(COROUTINE, "Unprotect stack page at %p with %zu bytes %s", page, cat_getpagesize(), ret ? "successfully" : "failed");
-        if (unlikely(!ret)) {
-            CAT_SYSCALL_FAILURE(NOTICE, COROUTINE, "Unprotect stack page failed");
-        }
-    } while (0);
-#endif
-#if defined(CAT_COROUTINE_USE_MMAP)
-    munmap(coroutine->virtual_memory, coroutine->virtual_memory_size);
-#elif defined(CAT_COROUTINE_USE_VIRTUAL_ALLOC)
-    VirtualFree(coroutine->virtual_memory, 0, MEM_RELEASE);
-#elif defined(CAT_COROUTINE_USE_SYS_MALLOC)
-    cat_sys_free(coroutine->virtual_memory);
+    {
+        cat_coroutine_stack_free(coroutine->virtual_memory, coroutine->virtual_memory_size);
+    }
 #endif
     if (coroutine->flags & CAT_COROUTINE_FLAG_ALLOCATED) {
         cat_free(coroutine);
@@ -637,12 +870,41 @@ CAT_API cat_bool_t cat_coroutine_close(cat_coroutine_t *coroutine)
     return cat_true;
 }
 
+#ifdef CAT_COROUTINE_USE_USER_STACK
+static cat_always_inline size_t cat_coroutine_calc_stack_usage(const cat_coroutine_t *coroutine, const void *stack_pointer)
+{
+    return (((const char *) coroutine->virtual_memory) + coroutine->virtual_memory_size) - ((const char *) stack_pointer);
+}
+
+static cat_always_inline void cat_coroutine_update_stack_usage(cat_coroutine_t *coroutine, const void *stack_pointer)
+{
+    cat_coroutine_stack_size_t usage;
+
+    if (unlikely(coroutine->virtual_memory == NULL)) {
+        /* main coroutine is running on the system stack */
+        return;
+    }
+    usage = (cat_coroutine_stack_size_t) cat_coroutine_calc_stack_usage(coroutine, stack_pointer);
+    coroutine->stack_usage = usage;
+    if (unlikely(usage > coroutine->peak_stack_usage)) {
+        coroutine->peak_stack_usage = usage;
+        if (unlikely(usage > CAT_COROUTINE_G(peak_stack_usage))) {
+            CAT_COROUTINE_G(peak_stack_usage) = usage;
+        }
+    }
+}
+#endif
+
 CAT_API void cat_coroutine_jump_standard(cat_coroutine_t *coroutine, cat_data_t *data, cat_data_t **retval)
 {
     cat_coroutine_t *current_coroutine = CAT_COROUTINE_G(current);
 
     CAT_ASSERT((data == NULL || (coroutine->flags & CAT_COROUTINE_FLAG_ACCEPT_DATA)) && "Coroutine does not accept data");
 
+#ifdef CAT_COROUTINE_USE_USER_STACK
+    /* the address of local variable is close enough to the stack pointer */
+    cat_coroutine_update_stack_usage(current_coroutine, &current_coroutine);
+#endif
     /* global switches++ */
     CAT_COROUTINE_G(switches)++;
     /* current switches++ */
@@ -875,6 +1137,60 @@ CAT_API cat_coroutine_stack_size_t cat_coroutine_get_stack_size(const cat_corout
     return coroutine->stack_size;
 }
 
+CAT_API cat_coroutine_stack_size_t cat_coroutine_get_stack_usage(const cat_coroutine_t *coroutine)
+{
+#ifdef CAT_COROUTINE_USE_USER_STACK
+    if (coroutine == CAT_COROUTINE_G(current) && coroutine->virtual_memory != NULL) {
+        const void *stack_pointer = &coroutine;
+        return (cat_coroutine_stack_size_t) cat_coroutine_calc_stack_usage(coroutine, stack_pointer);
+    }
+    return coroutine->stack_usage;
+#else
+    (void) coroutine;
+    return 0;
+#endif
+}
+
+CAT_API cat_coroutine_stack_size_t cat_coroutine_get_peak_stack_usage(const cat_coroutine_t *coroutine)
+{
+#ifdef CAT_COROUTINE_USE_USER_STACK
+    cat_coroutine_stack_size_t usage = cat_coroutine_get_stack_usage(coroutine);
+    return usage > coroutine->peak_stack_usage ? usage : coroutine->peak_stack_usage;
+#else
+    (void) coroutine;
+    return 0;
+#endif
+}
+
+CAT_API size_t cat_coroutine_trim_stack(cat_coroutine_t *coroutine)
+{
+#ifdef CAT_COROUTINE_USE_STACK_MADVISE
+    size_t pagesize = cat_getpagesize();
+    char *stack, *stack_pointer, *end;
+
+    if (coroutine->virtual_memory == NULL ||
+        coroutine == CAT_COROUTINE_G(current) ||
+        coroutine->state != CAT_COROUTINE_STATE_WAITING ||
+        coroutine->start_time == 0) {
+        return 0;
+    }
+    stack = ((char *) coroutine->virtual_memory) + pagesize * CAT_COROUTINE_STACK_PADDING_PAGE_COUNT;
+    stack_pointer = ((char *) coroutine->virtual_memory) + coroutine->virtual_memory_size - coroutine->stack_usage;
+    end = ((char *) cat_getpageof(stack_pointer)) - pagesize * CAT_COROUTINE_STACK_TRIM_RESERVED_PAGE_COUNT;
+    if (end <= stack) {
+        return 0;
+    }
+    if (unlikely(!cat_coroutine_stack_advise(stack, end - stack, cat_false))) {
+        return 0;
+    }
+    CAT_LOG_DEBUG_V2(COROUTINE, "Trim stack of R" CAT_COROUTINE_ID_FMT " at %p with %zu bytes", coroutine->id, stack, (size_t) (end - stack));
+    return end - stack;
+#else
+    (void) coroutine;
+    return 0;
+#endif
+}
+
 /* status */
 
 CAT_API cat_bool_t cat_coroutine_is_available(const cat_coroutine_t *coroutine)
@@ -18,82 +18,2354 @@
 
 #include "cat_dns.h"
 #include "cat_coroutine.h"
+#include "cat_env.h"
 #include "cat_event.h"
 #include "cat_time.h"
 
-typedef struct cat_getaddrinfo_context_s {
-    union {
-        cat_coroutine_t *coroutine;
-        uv_req_t req;
-        uv_getaddrinfo_t getaddrinfo;
-    } request;
+#include <sys/stat.h>
+
+#ifndef CAT_DNS_CACHE_KEY_SIZE
+#define CAT_DNS_CACHE_KEY_SIZE 320
+#endif
+
+#define CAT_DNS_CACHE_MIN_BUCKET_COUNT 16
+
+/* the whole list is in one memory block, so that it can be freed by cat_free() */
+static struct addrinfo *cat_dns_addrinfo_dup(const struct addrinfo *response)
+{
+    const struct addrinfo *ai;
+    struct addrinfo *copy, *current, *previous = NULL;
+    size_t size = 0;
+    char *p;
+
+    for (ai = response; ai != NULL; ai = ai->ai_next) {
+        size += CAT_MEMORY_ALIGNED_SIZE(sizeof(*ai)) + CAT_MEMORY_ALIGNED_SIZE(ai->ai_addrlen);
+        if (ai->ai_canonname != NULL) {
+            size += CAT_MEMORY_ALIGNED_SIZE(strlen(ai->ai_canonname) + 1);
+        }
+    }
+    p = (char *) cat_malloc(size);
+#if CAT_ALLOC_HANDLE_ERRORS
+    if (unlikely(p == NULL)) {
+        cat_update_last_error_of_syscall("Malloc for DNS response failed");
+        return NULL;
+    }
+#endif
+    copy = (struct addrinfo *) p;
+    for (ai = response; ai != NULL; ai = ai->ai_next) {
+        current = (struct addrinfo *) p;
+        p += CAT_MEMORY_ALIGNED_SIZE(sizeof(*ai));
+        *current = *ai;
+        current->ai_addr = (struct sockaddr *) p;
+        memcpy(p, ai->ai_addr, ai->ai_addrlen);
+        p += CAT_MEMORY_ALIGNED_SIZE(ai->ai_addrlen);
+        if (ai->ai_canonname != NULL) {
+            size_t length = strlen(ai->ai_canonname) + 1;
+            current->ai_canonname = p;
+            memcpy(p, ai->ai_canonname, length);
+            p += CAT_MEMORY_ALIGNED_SIZE(length);
+        }
+        current->ai_next = NULL;
+        if (previous != NULL) {
+            previous->ai_next = current;
+        }
+        previous = current;
+    }
+
+    return copy;
+}
+
+/* resolver */
+
+#ifndef CAT_DNS_RESOLVER_RESOLV_CONF
+#define CAT_DNS_RESOLVER_RESOLV_CONF "/etc/resolv.conf"
+#endif
+
+#ifndef CAT_DNS_RESOLVER_HOSTS
+#define CAT_DNS_RESOLVER_HOSTS "/etc/hosts"
+#endif
+
+#define CAT_DNS_RESOLVER_MAX_SERVERS      8
+#define CAT_DNS_RESOLVER_MAX_SEARCH       6
+#define CAT_DNS_RESOLVER_MAX_ADDRESSES    32
+#define CAT_DNS_RESOLVER_MAX_CNAME_DEPTH  8
+#define CAT_DNS_RESOLVER_DEFAULT_PORT     53
+#define CAT_DNS_RESOLVER_DEFAULT_NDOTS    1
+#define CAT_DNS_RESOLVER_DEFAULT_ATTEMPTS 2
+#define CAT_DNS_RESOLVER_DEFAULT_TIMEOUT  (5 * 1000)
+/* resolv.conf, hosts and addresses of interfaces are checked at most once in this interval */
+#define CAT_DNS_RESOLVER_CHECK_INTERVAL   1000
+
+/* max length of a name in text form is 253 */
+#define CAT_DNS_NAME_SIZE          256
+#define CAT_DNS_HEADER_LENGTH      12
+/* 2 bytes length prefix (for TCP) + header + encoded name (max 255) + type + class */
+#define CAT_DNS_QUERY_SIZE         (2 + CAT_DNS_HEADER_LENGTH + 255 + 4)
+/* we do not send EDNS0, so that servers truncate responses at 512 bytes, but be tolerant */
+#define CAT_DNS_UDP_PACKET_SIZE    1232
+
+#define CAT_DNS_TYPE_A     1
+#define CAT_DNS_TYPE_CNAME 5
+#define CAT_DNS_TYPE_AAAA  28
+#define CAT_DNS_TYPE_SRV   33
+#define CAT_DNS_CLASS_IN   1
+
+#define CAT_DNS_FLAG_QR      0x8000
+#define CAT_DNS_FLAG_OPCODE  0x7800
+#define CAT_DNS_FLAG_TC      0x0200
+#define CAT_DNS_FLAG_RD      0x0100
+#define CAT_DNS_FLAG_RCODE   0x000f
+
+#define CAT_DNS_RCODE_NOERROR  0
+#define CAT_DNS_RCODE_NXDOMAIN 3
+
+#define CAT_DNS_TTL_UNKNOWN ((cat_msec_t) -1)
+
+typedef struct cat_dns_hosts_entry_s {
+    int family;
+    unsigned char address[16];
+    /* offset of name in hosts_names */
+    size_t name;
+} cat_dns_hosts_entry_t;
+
+typedef struct cat_dns_resolver_file_state_s {
+    cat_bool_t exists;
+    time_t mtime;
+    off_t size;
+    ino_t inode;
+} cat_dns_resolver_file_state_t;
+
+struct cat_dns_resolver_config_s {
+    size_t refcount;
+    cat_sockaddr_inet_info_t servers[CAT_DNS_RESOLVER_MAX_SERVERS];
+    size_t server_count;
+    /* the first server which will be used by the next request */
+    size_t server_index;
+    cat_bool_t rotate;
+    unsigned int ndots;
+    unsigned int attempts;
+    cat_msec_t timeout;
+    char search[CAT_DNS_RESOLVER_MAX_SEARCH][CAT_DNS_NAME_SIZE];
+    size_t search_count;
+    cat_dns_hosts_entry_t *hosts;
+    size_t hosts_count;
+    char *hosts_names;
+    /* config is reloaded if files have been changed */
+    cat_dns_resolver_file_state_t resolv_conf_state;
+    cat_dns_resolver_file_state_t hosts_state;
+    cat_msec_t check_time;
+    /* families of non-loopback addresses for AI_ADDRCONFIG (AF_UNSPEC means both or neither) */
+    int addrconfig_family;
+    cat_msec_t addrconfig_time;
+};
+
+typedef struct cat_dns_resolver_hints_s {
+    int family;
+    int socktype;
+    int protocol;
+    int flags;
+    uint16_t port;
+} cat_dns_resolver_hints_t;
+
+typedef struct cat_dns_resolver_address_s {
+    int family;
+    unsigned char bytes[16];
+} cat_dns_resolver_address_t;
+
+typedef struct cat_dns_resolver_question_s {
+    uint16_t type;
+    uint16_t id;
+    /* answered, or the name does not exist */
+    cat_bool_t done;
+    /* the answer was truncated, it is asked again over TCP */
+    cat_bool_t tcp;
+    int status;
+    size_t length;
+    /* it starts with 2 bytes length prefix which is only sent over TCP */
+    unsigned char packet[CAT_DNS_QUERY_SIZE];
+} cat_dns_resolver_question_t;
+
+typedef struct cat_dns_resolver_request_s cat_dns_resolver_request_t;
+
+typedef void (*cat_dns_resolver_callback_t)(cat_dns_resolver_request_t *request);
+
+typedef struct cat_dns_resolver_tcp_s {
+    uv_tcp_t tcp;
+    uv_connect_t connect_request;
+    uv_write_t write_requests[2];
+    cat_dns_resolver_request_t *request;
+    cat_bool_t connected;
+    unsigned char *buffer;
+    size_t length;
+    size_t size;
+} cat_dns_resolver_tcp_t;
+
+struct cat_dns_resolver_request_s {
+    /* it is called after all handles have been closed */
+    cat_dns_resolver_callback_t callback;
+    void *data;
+    cat_dns_resolver_config_t *config;
+    cat_dns_resolver_hints_t hints;
+    /* for IPv4 and IPv6 nameservers, fd of UDP handle is bound to the family of the first address it connected to */
+    uv_udp_t udp[2];
+    uv_timer_t timer;
+    /* connection for truncated answers */
+    cat_dns_resolver_tcp_t *tcp;
+    unsigned int handle_count;
+    cat_bool_t finished;
+    int status;
+    /* index of the server in use */
+    size_t server;
+    /* number of servers which have been tried for the current name */
+    size_t tries;
+    /* name itself and names with search domains, in order */
+    char names[CAT_DNS_RESOLVER_MAX_SEARCH + 1][CAT_DNS_NAME_SIZE];
+    size_t name_count;
+    size_t name_index;
+    cat_dns_resolver_question_t questions[2];
+    size_t question_count;
+    /* results */
+    char canonname[CAT_DNS_NAME_SIZE];
+    /* min TTL of records in seconds */
+    uint32_t ttl;
+    cat_dns_resolver_address_t addresses[CAT_DNS_RESOLVER_MAX_ADDRESSES];
+    size_t address_count;
+    cat_dns_srv_t *srv;
+    unsigned char buffer[CAT_DNS_UDP_PACKET_SIZE];
+};
+
+typedef enum cat_dns_response_result_e {
+    CAT_DNS_RESPONSE_INVALID,
+    CAT_DNS_RESPONSE_DONE,
+    CAT_DNS_RESPONSE_TRUNCATED,
+    CAT_DNS_RESPONSE_SERVER_FAILURE,
+} cat_dns_response_result_t;
+
+static cat_always_inline cat_dns_resolver_t *cat_dns_resolver_get(void)
+{
+    return &CAT_SOCKET_G(dns_resolver);
+}
+
+static cat_always_inline uint16_t cat_dns_read_u16(const unsigned char *p)
+{
+    return (uint16_t) ((p[0] << 8) | p[1]);
+}
+
+static cat_always_inline uint32_t cat_dns_read_u32(const unsigned char *p)
+{
+    return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | (uint32_t) p[3];
+}
+
+static cat_always_inline void cat_dns_write_u16(unsigned char *p, uint16_t value)
+{
+    p[0] = (unsigned char) (value >> 8);
+    p[1] = (unsigned char) value;
+}
+
+static cat_bool_t cat_dns_name_equals(const char *a, const char *b)
+{
+    for (; *a != '\0' && *b != '\0'; a++, b++) {
+        char ca = *a, cb = *b;
+        if (ca >= 'A' && ca <= 'Z') {
+            ca += 'a' - 'A';
+        }
+        if (cb >= 'A' && cb <= 'Z') {
+            cb += 'a' - 'A';
+        }
+        if (ca != cb) {
+            return cat_false;
+        }
+    }
+
+    return *a == *b;
+}
+
+/* returns length of the encoded name, or 0 if the name is invalid */
+static size_t cat_dns_name_encode(unsigned char *buffer, const char *name)
+{
+    unsigned char *p = buffer;
+    const char *label = name;
+
+    while (1) {
+        size_t length = strcspn(label, ".");
+        if (length == 0 || length > 63 || (size_t) (p - buffer) + 1 + length + 1 > 255) {
+            return 0;
+        }
+        *p++ = (unsigned char) length;
+        memcpy(p, label, length);
+        p += length;
+        if (label[length] == '\0') {
+            break;
+        }
+        label += length + 1;
+    }
+    *p++ = 0;
+
+    return p - buffer;
+}
+
+/* name compression is supported, *offset will be moved to the end of the name */
+static cat_bool_t cat_dns_name_decode(const unsigned char *packet, size_t length, size_t *offset, char *name)
+{
+    size_t position = *offset, name_length = 0;
+    cat_bool_t jumped = cat_false;
+    unsigned int hops = 0;
+
+    while (1) {
+        unsigned char c;
+        if (unlikely(position >= length)) {
+            return cat_false;
+        }
+        c = packet[position];
+        if ((c & 0xc0) == 0xc0) {
+            if (unlikely(position + 1 >= length || ++hops > 32)) {
+                return cat_false;
+            }
+            if (!jumped) {
+                *offset = position + 2;
+                jumped = cat_true;
+            }
+            position = ((size_t) (c & 0x3f) << 8) | packet[position + 1];
+            continue;
+        }
+        if (unlikely((c & 0xc0) != 0)) {
+            return cat_false;
+        }
+        position++;
+        if (c == 0) {
+            break;
+        }
+        if (unlikely(position + c > length || name_length + c + 2 > CAT_DNS_NAME_SIZE)) {
+            return cat_false;
+        }
+        if (name_length > 0) {
+            name[name_length++] = '.';
+        }
+        memcpy(name + name_length, packet + position, c);
+        name_length += c;
+        position += c;
+    }
+    if (!jumped) {
+        *offset = position;
+    }
+    name[name_length] = '\0';
+
+    return cat_true;
+}
+
+static cat_bool_t cat_dns_record_read(
+    const unsigned char *packet, size_t length, size_t *offset,
+    char *owner, uint16_t *type, uint32_t *ttl, size_t *rdata, uint16_t *rdlength
+)
+{
+    const unsigned char *p;
+
+    if (unlikely(!cat_dns_name_decode(packet, length, offset, owner) || *offset + 10 > length)) {
+        return cat_false;
+    }
+    p = packet + *offset;
+    *type = cat_dns_read_u16(p);
+    *ttl = cat_dns_read_u32(p + 4);
+    /* RFC 2181: TTL with the most significant bit set is treated as zero */
+    if (*ttl & 0x80000000u) {
+        *ttl = 0;
+    }
+    *rdlength = cat_dns_read_u16(p + 8);
+    *rdata = *offset + 10;
+    if (unlikely(*rdata + *rdlength > length)) {
+        return cat_false;
+    }
+    *offset = *rdata + *rdlength;
+
+    return cat_true;
+}
+
+/* "ip", "ip:port", "[ipv6]" or "[ipv6]:port" */
+static cat_bool_t cat_dns_resolver_parse_server(cat_sockaddr_inet_info_t *server, const char *string, size_t length)
+{
+    char ip[CAT_SOCKADDR_MAX_PATH];
+    const char *end = string + length, *ip_end = end, *port_string = NULL;
+    int port = CAT_DNS_RESOLVER_DEFAULT_PORT;
+
+    if (length == 0) {
+        return cat_false;
+    }
+    if (string[0] == '[') {
+        ip_end = (const char *) memchr(string, ']', length);
+        if (ip_end == NULL) {
+            return cat_false;
+        }
+        if (ip_end + 1 < end) {
+            if (ip_end[1] != ':') {
+                return cat_false;
+            }
+            port_string = ip_end + 2;
+        }
+        string++;
+    } else {
+        const char *colon = (const char *) memchr(string, ':', length);
+        /* only one colon means IPv4 with port, otherwise it is an IPv6 address */
+        if (colon != NULL && memchr(colon + 1, ':', end - colon - 1) == NULL) {
+            ip_end = colon;
+            port_string = colon + 1;
+        }
+    }
+    if (port_string != NULL) {
+        const char *p;
+        if (port_string == end) {
+            return cat_false;
+        }
+        port = 0;
+        for (p = port_string; p < end; p++) {
+            if (*p < '0' || *p > '9' || (port = port * 10 + (*p - '0')) > 65535) {
+                return cat_false;
+            }
+        }
+        if (port == 0) {
+            return cat_false;
+        }
+    }
+    if ((size_t) (ip_end - string) >= sizeof(ip)) {
+        return cat_false;
+    }
+    memcpy(ip, string, ip_end - string);
+    ip[ip_end - string] = '\0';
+    memset(&server->address, 0, sizeof(server->address));
+    if (uv_ip4_addr(ip, port, &server->address.in) == 0) {
+        server->length = sizeof(server->address.in);
+    } else if (uv_ip6_addr(ip, port, &server->address.in6) == 0) {
+        server->length = sizeof(server->address.in6);
+    } else {
+        return cat_false;
+    }
+
+    return cat_true;
+}
+
+/* returns number of servers, or -1 if any of them is invalid */
+static int cat_dns_resolver_parse_servers(cat_sockaddr_inet_info_t *servers, size_t size, const char *string)
+{
+    size_t count = 0;
+
+    while (*string != '\0') {
+        size_t length;
+        string += strspn(string, " \t,");
+        length = strcspn(string, " \t,");
+        if (length == 0) {
+            break;
+        }
+        if (count == size || !cat_dns_resolver_parse_server(&servers[count], string, length)) {
+            return -1;
+        }
+        count++;
+        string += length;
+    }
+
+    return (int) count;
+}
+
+static void cat_dns_resolver_config_add_search(cat_dns_resolver_config_t *config, const char *domain, size_t length)
+{
+    while (length > 0 && domain[length - 1] == '.') {
+        length--;
+    }
+    if (length == 0 || length >= CAT_DNS_NAME_SIZE || config->search_count == CAT_DNS_RESOLVER_MAX_SEARCH) {
+        return;
+    }
+    memcpy(config->search[config->search_count], domain, length);
+    config->search[config->search_count][length] = '\0';
+    config->search_count++;
+}
+
+static void cat_dns_resolver_config_load_resolv_conf(cat_dns_resolver_config_t *config)
+{
+    char line[1024];
+    FILE *file;
+
+    file = fopen(CAT_DNS_RESOLVER_RESOLV_CONF, "r");
+    if (file == NULL) {
+        return;
+    }
+    while (fgets(line, sizeof(line), file) != NULL) {
+        const char *p = line, *keyword;
+        size_t keyword_length, length;
+        if (*p == '#' || *p == ';') {
+            continue;
+        }
+        p += strspn(p, " \t");
+        keyword = p;
+        keyword_length = strcspn(p, " \t\r\n");
+        p += keyword_length;
+#define CAT_DNS_RESOLVER_NEXT_TOKEN() \
+        (p += strspn(p, " \t"), length = strcspn(p, " \t\r\n"), length > 0)
+        if (keyword_length == 10 && strncmp(keyword, "nameserver", 10) == 0) {
+            if (CAT_DNS_RESOLVER_NEXT_TOKEN() && config->server_count < CAT_DNS_RESOLVER_MAX_SERVERS &&
+                cat_dns_resolver_parse_server(&config->servers[config->server_count], p, length)) {
+                config->server_count++;
+            }
+        } else if ((keyword_length == 6 && strncmp(keyword, "domain", 6) == 0) ||
+                   (keyword_length == 6 && strncmp(keyword, "search", 6) == 0)) {
+            /* the last one wins */
+            config->search_count = 0;
+            while (CAT_DNS_RESOLVER_NEXT_TOKEN()) {
+                cat_dns_resolver_config_add_search(config, p, length);
+                p += length;
+            }
+        } else if (keyword_length == 7 && strncmp(keyword, "options", 7) == 0) {
+            while (CAT_DNS_RESOLVER_NEXT_TOKEN()) {
+                if (length > 6 && strncmp(p, "ndots:", 6) == 0) {
+                    config->ndots = (unsigned int) CAT_MIN(atoi(p + 6), 15);
+                } else if (length > 8 && strncmp(p, "timeout:", 8) == 0) {
+                    config->timeout = (cat_msec_t) CAT_MAX(CAT_MIN(atoi(p + 8), 30), 1) * 1000;
+                } else if (length > 9 && strncmp(p, "attempts:", 9) == 0) {
+                    config->attempts = (unsigned int) CAT_MAX(CAT_MIN(atoi(p + 9), 5), 1);
+                } else if (length == 6 && strncmp(p, "rotate", 6) == 0) {
+                    config->rotate = cat_true;
+                }
+                p += length;
+            }
+        }
+#undef CAT_DNS_RESOLVER_NEXT_TOKEN
+    }
+    fclose(file);
+}
+
+static void cat_dns_resolver_config_load_hosts(cat_dns_resolver_config_t *config)
+{
+    char line[1024];
+    size_t hosts_size = 0, names_size = 0, names_length = 0;
+    FILE *file;
+
+    file = fopen(CAT_DNS_RESOLVER_HOSTS, "r");
+    if (file == NULL) {
+        return;
+    }
+    while (fgets(line, sizeof(line), file) != NULL) {
+        cat_dns_hosts_entry_t entry;
+        char *p = line, *comment;
+        size_t length;
+        comment = strchr(line, '#');
+        if (comment != NULL) {
+            *comment = '\0';
+        }
+        p += strspn(p, " \t");
+        length = strcspn(p, " \t\r\n");
+        if (length == 0) {
+            continue;
+        }
+        p[length] = '\0';
+        if (uv_inet_pton(AF_INET, p, entry.address) == 0) {
+            entry.family = AF_INET;
+        } else if (uv_inet_pton(AF_INET6, p, entry.address) == 0) {
+            entry.family = AF_INET6;
+        } else {
+            continue;
+        }
+        p += length + 1;
+        while (p += strspn(p, " \t"), (length = strcspn(p, " \t\r\n")) > 0) {
+            if (config->hosts_count == hosts_size) {
+                cat_dns_hosts_entry_t *hosts;
+                hosts_size = hosts_size == 0 ? 16 : hosts_size * 2;
+                hosts = (cat_dns_hosts_entry_t *) cat_realloc(config->hosts, hosts_size * sizeof(*hosts));
+#if CAT_ALLOC_HANDLE_ERRORS
+                if (unlikely(hosts == NULL)) {
+                    goto _out;
+                }
+#endif
+                config->hosts = hosts;
+            }
+            if (names_length + length + 1 > names_size) {
+                char *names;
+                names_size = CAT_MAX(names_size * 2, names_length + length + 1 + 256);
+                names = (char *) cat_realloc(config->hosts_names, names_size);
+#if CAT_ALLOC_HANDLE_ERRORS
+                if (unlikely(names == NULL)) {
+                    goto _out;
+                }
+#endif
+                config->hosts_names = names;
+            }
+            memcpy(config->hosts_names + names_length, p, length);
+            config->hosts_names[names_length + length] = '\0';
+            entry.name = names_length;
+            names_length += length + 1;
+            config->hosts[config->hosts_count++] = entry;
+            p += length;
+        }
+    }
+#if CAT_ALLOC_HANDLE_ERRORS
+    _out:
+#endif
+    fclose(file);
+}
+
+static void cat_dns_resolver_file_state_get(const char *path, cat_dns_resolver_file_state_t *state)
+{
+    struct stat buf;
+
+    memset(state, 0, sizeof(*state));
+    if (stat(path, &buf) == 0) {
+        state->exists = cat_true;
+        state->mtime = buf.st_mtime;
+        state->size = buf.st_size;
+        state->inode = buf.st_ino;
+    }
+}
+
+static cat_bool_t cat_dns_resolver_file_is_changed(const char *path, const cat_dns_resolver_file_state_t *state)
+{
+    cat_dns_resolver_file_state_t current;
+
+    cat_dns_resolver_file_state_get(path, &current);
+
+    return memcmp(&current, state, sizeof(current)) != 0;
+}
+
+static cat_dns_resolver_config_t *cat_dns_resolver_config_load(const char *servers)
+{
+    cat_dns_resolver_config_t *config;
+
+    config = (cat_dns_resolver_config_t *) cat_malloc(sizeof(*config));
+#if CAT_ALLOC_HANDLE_ERRORS
+    if (unlikely(config == NULL)) {
+        cat_update_last_error_of_syscall("Malloc for DNS resolver config failed");
+        return NULL;
+    }
+#endif
+    memset(config, 0, sizeof(*config));
+    config->refcount = 1;
+    config->ndots = CAT_DNS_RESOLVER_DEFAULT_NDOTS;
+    config->attempts = CAT_DNS_RESOLVER_DEFAULT_ATTEMPTS;
+    config->timeout = CAT_DNS_RESOLVER_DEFAULT_TIMEOUT;
+    config->addrconfig_family = AF_UNSPEC;
+    /* states are got before reading, so that changes during reading are not missed */
+    cat_dns_resolver_file_state_get(CAT_DNS_RESOLVER_RESOLV_CONF, &config->resolv_conf_state);
+    cat_dns_resolver_file_state_get(CAT_DNS_RESOLVER_HOSTS, &config->hosts_state);
+    config->check_time = cat_time_msec_cached();
+    /* it is blocking, but files are small and they are only read again if they have been changed */
+    cat_dns_resolver_config_load_resolv_conf(config);
+    cat_dns_resolver_config_load_hosts(config);
+    if (servers != NULL) {
+        int count = cat_dns_resolver_parse_servers(config->servers, CAT_ARRAY_SIZE(config->servers), servers);
+        config->server_count = count > 0 ? (size_t) count : 0;
+    }
+#ifndef CAT_OS_WIN
+    else if (config->server_count == 0) {
+        /* the same as libc */
+        (void) cat_dns_resolver_parse_server(&config->servers[0], "127.0.0.1", CAT_STRLEN("127.0.0.1"));
+        config->server_count = 1;
+    }
+#endif
+    CAT_LOG_DEBUG(DNS, "Resolver config loaded with %zu nameservers, %zu search domains and %zu hosts",
+        config->server_count, config->search_count, config->hosts_count);
+
+    return config;
+}
+
+static void cat_dns_resolver_config_release(cat_dns_resolver_config_t *config)
+{
+    if (--config->refcount != 0) {
+        return;
+    }
+    if (config->hosts != NULL) {
+        cat_free(config->hosts);
+    }
+    if (config->hosts_names != NULL) {
+        cat_free(config->hosts_names);
+    }
+    cat_free(config);
+}
+
+static void cat_dns_resolver_drop_config(void)
+{
+    cat_dns_resolver_t *resolver = cat_dns_resolver_get();
+
+    if (resolver->config != NULL) {
+        cat_dns_resolver_config_release(resolver->config);
+        resolver->config = NULL;
+    }
+}
+
+static cat_dns_resolver_config_t *cat_dns_resolver_get_config(void)
+{
+    cat_dns_resolver_t *resolver = cat_dns_resolver_get();
+    cat_dns_resolver_config_t *config = resolver->config;
+
+    if (config != NULL) {
+        cat_msec_t now = cat_time_msec_cached();
+        if (now - config->check_time < CAT_DNS_RESOLVER_CHECK_INTERVAL) {
+            return config;
+        }
+        config->check_time = now;
+        if (!cat_dns_resolver_file_is_changed(CAT_DNS_RESOLVER_RESOLV_CONF, &config->resolv_conf_state) &&
+            !cat_dns_resolver_file_is_changed(CAT_DNS_RESOLVER_HOSTS, &config->hosts_state)) {
+            return config;
+        }
+        CAT_LOG_DEBUG(DNS, "Resolver config files have been changed, reload them");
+        /* requests in progress keep the old one */
+        cat_dns_resolver_drop_config();
+    }
+    resolver->config = cat_dns_resolver_config_load(resolver->servers);
+
+    return resolver->config;
+}
+
+/* returns the family which is configured on non-loopback interfaces only, otherwise AF_UNSPEC */
+static int cat_dns_resolver_get_addrconfig_family(cat_dns_resolver_config_t *config)
+{
+    cat_msec_t now = cat_time_msec_cached();
+    uv_interface_address_t *interfaces;
+    cat_bool_t has_inet = cat_false, has_inet6 = cat_false;
+    int count, n;
+
+    if (config->addrconfig_time != 0 && now - config->addrconfig_time < CAT_DNS_RESOLVER_CHECK_INTERVAL) {
+        return config->addrconfig_family;
+    }
+    config->addrconfig_time = now;
+    config->addrconfig_family = AF_UNSPEC;
+    if (uv_interface_addresses(&interfaces, &count) != 0) {
+        return AF_UNSPEC;
+    }
+    for (n = 0; n < count; n++) {
+        if (interfaces[n].is_internal) {
+            continue;
+        }
+        if (interfaces[n].address.address4.sin_family == AF_INET) {
+            has_inet = cat_true;
+        } else if (interfaces[n].address.address6.sin6_family == AF_INET6) {
+            has_inet6 = cat_true;
+        }
+    }
+    uv_free_interface_addresses(interfaces, count);
+    if (has_inet != has_inet6) {
+        config->addrconfig_family = has_inet ? AF_INET : AF_INET6;
+    }
+
+    return config->addrconfig_family;
+}
+
+static uint16_t cat_dns_resolver_make_id(void)
+{
+    cat_dns_resolver_t *resolver = cat_dns_resolver_get();
+    uint32_t x = resolver->seed;
+
+    /* xorshift32 */
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    resolver->seed = x;
+
+    return (uint16_t) (x >> 16);
+}
+
+static size_t cat_dns_resolver_hosts_lookup(const cat_dns_resolver_config_t *config, const char *name, int family, cat_dns_resolver_address_t *addresses, size_t size)
+{
+    size_t n, count = 0;
+
+    for (n = 0; n < config->hosts_count && count < size; n++) {
+        const cat_dns_hosts_entry_t *entry = &config->hosts[n];
+        if ((family == AF_UNSPEC || family == entry->family) &&
+            cat_dns_name_equals(config->hosts_names + entry->name, name)) {
+            addresses[count].family = entry->family;
+            memcpy(addresses[count].bytes, entry->address, sizeof(entry->address));
+            count++;
+        }
+    }
+
+    return count;
+}
+
+static void cat_dns_resolver_add_address(cat_dns_resolver_request_t *request, int family, const unsigned char *bytes, size_t length)
+{
+    cat_dns_resolver_address_t *address;
+
+    if (request->address_count == CAT_ARRAY_SIZE(request->addresses)) {
+        return;
+    }
+    address = &request->addresses[request->address_count++];
+    address->family = family;
+    memcpy(address->bytes, bytes, length);
+}
+
+static cat_bool_t cat_dns_resolver_add_srv(cat_dns_resolver_request_t *request, const unsigned char *packet, size_t length, size_t rdata, uint32_t ttl)
+{
+    char target[CAT_DNS_NAME_SIZE];
+    size_t offset = rdata + 6, target_length;
+    cat_dns_srv_t *record;
+
+    if (unlikely(!cat_dns_name_decode(packet, length, &offset, target))) {
+        return cat_false;
+    }
+    target_length = strlen(target);
+    record = (cat_dns_srv_t *) cat_malloc(offsetof(cat_dns_srv_t, target) + target_length + 1);
+#if CAT_ALLOC_HANDLE_ERRORS
+    if (unlikely(record == NULL)) {
+        return cat_true;
+    }
+#endif
+    record->priority = cat_dns_read_u16(packet + rdata);
+    record->weight = cat_dns_read_u16(packet + rdata + 2);
+    record->port = cat_dns_read_u16(packet + rdata + 4);
+    record->ttl = ttl;
+    memcpy(record->target, target, target_length + 1);
+    record->next = request->srv;
+    request->srv = record;
+
+    return cat_true;
+}
+
+static cat_dns_response_result_t cat_dns_resolver_parse_response(
+    cat_dns_resolver_request_t *request, cat_dns_resolver_question_t *question,
+    const unsigned char *packet, size_t length, cat_bool_t tcp
+)
+{
+    const char *name = request->names[request->name_index];
+    char owner[CAT_DNS_NAME_SIZE], target[CAT_DNS_NAME_SIZE];
+    uint16_t flags, answer_count, type, rdlength;
+    uint32_t ttl, min_ttl = UINT32_MAX;
+    size_t offset, answers, rdata, n, count = 0;
+    unsigned int depth;
+
+    if (unlikely(length < CAT_DNS_HEADER_LENGTH)) {
+        return CAT_DNS_RESPONSE_INVALID;
+    }
+    flags = cat_dns_read_u16(packet + 2);
+    if (unlikely(!(flags & CAT_DNS_FLAG_QR) || (flags & CAT_DNS_FLAG_OPCODE) || cat_dns_read_u16(packet + 4) != 1)) {
+        return CAT_DNS_RESPONSE_INVALID;
+    }
+    answer_count = cat_dns_read_u16(packet + 6);
+    offset = CAT_DNS_HEADER_LENGTH;
+    if (unlikely(!cat_dns_name_decode(packet, length, &offset, owner) || offset + 4 > length ||
+        !cat_dns_name_equals(owner, name) ||
+        cat_dns_read_u16(packet + offset) != question->type ||
+        cat_dns_read_u16(packet + offset + 2) != CAT_DNS_CLASS_IN)) {
+        return CAT_DNS_RESPONSE_INVALID;
+    }
+    offset += 4;
+    if ((flags & CAT_DNS_FLAG_TC) && !tcp) {
+        return CAT_DNS_RESPONSE_TRUNCATED;
+    }
+    switch (flags & CAT_DNS_FLAG_RCODE) {
+        case CAT_DNS_RCODE_NOERROR:
+            break;
+        case CAT_DNS_RCODE_NXDOMAIN:
+            question->status = CAT_EAI_NONAME;
+            return CAT_DNS_RESPONSE_DONE;
+        default:
+            /* SERVFAIL, REFUSED and so on, try the next server */
+            return CAT_DNS_RESPONSE_SERVER_FAILURE;
+    }
+    answers = offset;
+    /* follow the CNAME chain */
+    strcpy(target, name);
+    for (depth = 0; depth < CAT_DNS_RESOLVER_MAX_CNAME_DEPTH; depth++) {
+        cat_bool_t found = cat_false;
+        offset = answers;
+        for (n = 0; n < answer_count; n++) {
+            if (unlikely(!cat_dns_record_read(packet, length, &offset, owner, &type, &ttl, &rdata, &rdlength))) {
+                return CAT_DNS_RESPONSE_INVALID;
+            }
+            if (type == CAT_DNS_TYPE_CNAME && cat_dns_name_equals(owner, target)) {
+                if (unlikely(!cat_dns_name_decode(packet, rdata + rdlength, &rdata, target))) {
+                    return CAT_DNS_RESPONSE_INVALID;
+                }
+                min_ttl = CAT_MIN(min_ttl, ttl);
+                found = cat_true;
+                break;
+            }
+        }
+        if (!found) {
+            break;
+        }
+    }
+    offset = answers;
+    for (n = 0; n < answer_count; n++) {
+        if (unlikely(!cat_dns_record_read(packet, length, &offset, owner, &type, &ttl, &rdata, &rdlength))) {
+            return CAT_DNS_RESPONSE_INVALID;
+        }
+        if (type != question->type || !cat_dns_name_equals(owner, target)) {
+            continue;
+        }
+        switch (type) {
+            case CAT_DNS_TYPE_A:
+                if (rdlength != 4) {
+                    continue;
+                }
+                cat_dns_resolver_add_address(request, AF_INET, packet + rdata, 4);
+                break;
+            case CAT_DNS_TYPE_AAAA:
+                if (rdlength != 16) {
+                    continue;
+                }
+                cat_dns_resolver_add_address(request, AF_INET6, packet + rdata, 16);
+                break;
+            case CAT_DNS_TYPE_SRV:
+                if (rdlength < 7 || !cat_dns_resolver_add_srv(request, packet, rdata + rdlength, rdata, ttl)) {
+                    continue;
+                }
+                break;
+            default:
+                continue;
+        }
+        min_ttl = CAT_MIN(min_ttl, ttl);
+        count++;
+    }
+    if (count == 0) {
+        question->status = CAT_EAI_NODATA;
+        return CAT_DNS_RESPONSE_DONE;
+    }
+    if (request->canonname[0] == '\0') {
+        strcpy(request->canonname, target);
+    }
+    request->ttl = CAT_MIN(request->ttl, min_ttl);
+    question->status = 0;
+
+    return CAT_DNS_RESPONSE_DONE;
+}
+
+static void cat_dns_resolver_request_release(cat_dns_resolver_request_t *request)
+{
+    cat_dns_srv_t *record, *next;
+
+    if (--request->handle_count != 0) {
+        return;
+    }
+    request->callback(request);
+    for (record = request->srv; record != NULL; record = next) {
+        next = record->next;
+        cat_free(record);
+    }
+    cat_dns_resolver_config_release(request->config);
+    cat_free(request);
+}
+
+static void cat_dns_resolver_request_close_callback(uv_handle_t *handle)
+{
+    cat_dns_resolver_request_release((cat_dns_resolver_request_t *) handle->data);
+}
+
+static void cat_dns_resolver_tcp_close_callback(uv_handle_t *handle)
+{
+    cat_dns_resolver_tcp_t *tcp = (cat_dns_resolver_tcp_t *) handle->data;
+    cat_dns_resolver_request_t *request = tcp->request;
+
+    if (tcp->buffer != NULL) {
+        cat_free(tcp->buffer);
+    }
+    cat_free(tcp);
+    cat_dns_resolver_request_release(request);
+}
+
+static void cat_dns_resolver_request_close_tcp(cat_dns_resolver_request_t *request)
+{
+    cat_dns_resolver_tcp_t *tcp = request->tcp;
+
+    if (tcp == NULL) {
+        return;
+    }
+    request->tcp = NULL;
+    uv_close((uv_handle_t *) &tcp->tcp, cat_dns_resolver_tcp_close_callback);
+}
+
+/* the callback will be called when all handles have been closed */
+static void cat_dns_resolver_request_finish(cat_dns_resolver_request_t *request, int status)
+{
+    if (request->finished) {
+        return;
+    }
+    request->finished = cat_true;
+    request->status = status;
+    cat_dns_resolver_request_close_tcp(request);
+    uv_close((uv_handle_t *) &request->timer, cat_dns_resolver_request_close_callback);
+    uv_close((uv_handle_t *) &request->udp[0], cat_dns_resolver_request_close_callback);
+    uv_close((uv_handle_t *) &request->udp[1], cat_dns_resolver_request_close_callback);
+}
+
+static void cat_dns_resolver_request_cancel(cat_dns_resolver_request_t *request)
+{
+    cat_dns_resolver_request_finish(request, CAT_EAI_CANCELED);
+}
+
+static void cat_dns_resolver_request_send(cat_dns_resolver_request_t *request);
+
+static void cat_dns_resolver_request_next_server(cat_dns_resolver_request_t *request)
+{
+    const cat_dns_resolver_config_t *config = request->config;
+
+    CAT_LOG_DEBUG(DNS, "Nameserver #%zu did not answer for \"%s\"", request->server, request->names[request->name_index]);
+    cat_dns_resolver_request_close_tcp(request);
+    if (++request->tries >= config->server_count * config->attempts) {
+        cat_dns_resolver_request_finish(request, CAT_EAI_AGAIN);
+        return;
+    }
+    request->server = (request->server + 1) % config->server_count;
+    cat_dns_resolver_request_send(request);
+}
+
+static void cat_dns_resolver_request_check(cat_dns_resolver_request_t *request)
+{
+    cat_bool_t nonexistent = cat_true;
+    size_t n;
+
+    for (n = 0; n < request->question_count; n++) {
+        if (!request->questions[n].done) {
+            return;
+        }
+    }
+    if (request->address_count > 0 || request->srv != NULL) {
+        cat_dns_resolver_request_finish(request, 0);
+        return;
+    }
+    for (n = 0; n < request->question_count; n++) {
+        if (request->questions[n].status != CAT_EAI_NONAME) {
+            nonexistent = cat_false;
+        }
+    }
+    /* try the next name of search list */
+    if (request->name_index + 1 < request->name_count) {
+        request->name_index++;
+        request->tries = 0;
+        for (n = 0; n < request->question_count; n++) {
+            request->questions[n].done = cat_false;
+        }
+        cat_dns_resolver_request_close_tcp(request);
+        cat_dns_resolver_request_send(request);
+        return;
+    }
+    cat_dns_resolver_request_finish(request, nonexistent ? CAT_EAI_NONAME : CAT_EAI_NODATA);
+}
+
+static void cat_dns_resolver_request_send_tcp(cat_dns_resolver_request_t *request, cat_dns_resolver_question_t *question);
+
+static void cat_dns_resolver_request_on_packet(cat_dns_resolver_request_t *request, const unsigned char *packet, size_t length, cat_bool_t truncated, cat_bool_t tcp)
+{
+    cat_dns_resolver_question_t *question = NULL;
+    cat_dns_response_result_t result;
+    uint16_t id;
+    size_t n;
+
+    if (unlikely(length < CAT_DNS_HEADER_LENGTH)) {
+        return;
+    }
+    id = cat_dns_read_u16(packet);
+    for (n = 0; n < request->question_count; n++) {
+        cat_dns_resolver_question_t *current = &request->questions[n];
+        /* answers over UDP are ignored once we switch to TCP */
+        if (current->id == id && !current->done && current->tcp == tcp) {
+            question = current;
+            break;
+        }
+    }
+    if (question == NULL) {
+        return;
+    }
+    if (truncated && !tcp) {
+        result = CAT_DNS_RESPONSE_TRUNCATED;
+    } else {
+        result = cat_dns_resolver_parse_response(request, question, packet, length, tcp);
+    }
+    switch (result) {
+        case CAT_DNS_RESPONSE_INVALID:
+            /* maybe it is forged, wait for the right one */
+            return;
+        case CAT_DNS_RESPONSE_TRUNCATED:
+            cat_dns_resolver_request_send_tcp(request, question);
+            return;
+        case CAT_DNS_RESPONSE_SERVER_FAILURE:
+            cat_dns_resolver_request_next_server(request);
+            return;
+        case CAT_DNS_RESPONSE_DONE:
+            question->done = cat_true;
+            cat_dns_resolver_request_check(request);
+            return;
+    }
+}
+
+static void cat_dns_resolver_tcp_write_callback(uv_write_t *write_request, int status)
+{
+    cat_dns_resolver_tcp_t *tcp = (cat_dns_resolver_tcp_t *) write_request->handle->data;
+
+    if (unlikely(status != 0) && status != CAT_ECANCELED && tcp == tcp->request->tcp) {
+        cat_dns_resolver_request_next_server(tcp->request);
+    }
+}
+
+static cat_bool_t cat_dns_resolver_tcp_write(cat_dns_resolver_tcp_t *tcp, cat_dns_resolver_question_t *question)
+{
+    cat_dns_resolver_request_t *request = tcp->request;
+    uv_buf_t buffer = uv_buf_init((char *) question->packet, (unsigned int) (question->length + 2));
+    int error;
+
+    error = uv_write(
+        &tcp->write_requests[question - request->questions], (uv_stream_t *) &tcp->tcp,
+        &buffer, 1, cat_dns_resolver_tcp_write_callback
+    );
+    if (unlikely(error != 0)) {
+        cat_dns_resolver_request_next_server(request);
+        return cat_false;
+    }
+
+    return cat_true;
+}
+
+static void cat_dns_resolver_tcp_alloc_callback(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf)
+{
+    cat_dns_resolver_tcp_t *tcp = (cat_dns_resolver_tcp_t *) handle->data;
+    (void) suggested_size;
+
+    if (tcp->size - tcp->length < 1024) {
+        size_t size = tcp->size == 0 ? 4096 : tcp->size * 2;
+        unsigned char *buffer = (unsigned char *) cat_realloc(tcp->buffer, size);
+#if CAT_ALLOC_HANDLE_ERRORS
+        if (unlikely(buffer == NULL)) {
+            /* read callback will get ENOBUFS */
+            *buf = uv_buf_init(NULL, 0);
+            return;
+        }
+#endif
+        tcp->buffer = buffer;
+        tcp->size = size;
+    }
+    *buf = uv_buf_init((char *) tcp->buffer + tcp->length, (unsigned int) (tcp->size - tcp->length));
+}
+
+static void cat_dns_resolver_tcp_read_callback(uv_stream_t *stream, ssize_t nread, const uv_buf_t *buf)
+{
+    cat_dns_resolver_tcp_t *tcp = (cat_dns_resolver_tcp_t *) stream->data;
+    cat_dns_resolver_request_t *request = tcp->request;
+    (void) buf;
+
+    if (nread == 0) {
+        return;
+    }
+    if (nread < 0) {
+        cat_dns_resolver_request_next_server(request);
+        return;
+    }
+    tcp->length += nread;
+    while (tcp->length >= 2) {
+        size_t length = cat_dns_read_u16(tcp->buffer);
+        if (tcp->length < 2 + length) {
+            break;
+        }
+        cat_dns_resolver_request_on_packet(request, tcp->buffer + 2, length, cat_false, cat_true);
+        if (tcp != request->tcp) {
+            return;
+        }
+        tcp->length -= 2 + length;
+        memmove(tcp->buffer, tcp->buffer + 2 + length, tcp->length);
+    }
+}
+
+static void cat_dns_resolver_tcp_connect_callback(uv_connect_t *connect_request, int status)
+{
+    cat_dns_resolver_tcp_t *tcp = cat_container_of(connect_request, cat_dns_resolver_tcp_t, connect_request);
+    cat_dns_resolver_request_t *request = tcp->request;
+    size_t n;
+
+    if (status == CAT_ECANCELED || tcp != request->tcp) {
+        return;
+    }
+    if (unlikely(status != 0 ||
+        uv_read_start((uv_stream_t *) &tcp->tcp, cat_dns_resolver_tcp_alloc_callback, cat_dns_resolver_tcp_read_callback) != 0)) {
+        cat_dns_resolver_request_next_server(request);
+        return;
+    }
+    tcp->connected = cat_true;
+    for (n = 0; n < request->question_count; n++) {
+        cat_dns_resolver_question_t *question = &request->questions[n];
+        if (!question->done && question->tcp && !cat_dns_resolver_tcp_write(tcp, question)) {
+            return;
+        }
+    }
+}
+
+static void cat_dns_resolver_request_send_tcp(cat_dns_resolver_request_t *request, cat_dns_resolver_question_t *question)
+{
+    cat_dns_resolver_tcp_t *tcp = request->tcp;
+    int error;
+
+    CAT_LOG_DEBUG(DNS, "Answer for \"%s\" was truncated, retry over TCP", request->names[request->name_index]);
+    question->tcp = cat_true;
+    if (tcp != NULL) {
+        if (tcp->connected) {
+            (void) cat_dns_resolver_tcp_write(tcp, question);
+        }
+        return;
+    }
+    tcp = (cat_dns_resolver_tcp_t *) cat_malloc(sizeof(*tcp));
+#if CAT_ALLOC_HANDLE_ERRORS
+    if (unlikely(tcp == NULL)) {
+        cat_dns_resolver_request_next_server(request);
+        return;
+    }
+#endif
+    error = uv_tcp_init(&CAT_EVENT_G(loop), &tcp->tcp);
+    if (unlikely(error != 0)) {
+        cat_free(tcp);
+        cat_dns_resolver_request_next_server(request);
+        return;
+    }
+    tcp->tcp.data = tcp;
+    tcp->request = request;
+    tcp->connected = cat_false;
+    tcp->buffer = NULL;
+    tcp->length = 0;
+    tcp->size = 0;
+    request->tcp = tcp;
+    request->handle_count++;
+    error = uv_tcp_connect(
+        &tcp->connect_request, &tcp->tcp,
+        &request->config->servers[request->server].address.common,
+        cat_dns_resolver_tcp_connect_callback
+    );
+    if (unlikely(error != 0)) {
+        cat_dns_resolver_request_next_server(request);
+    }
+}
+
+static void cat_dns_resolver_udp_alloc_callback(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf)
+{
+    cat_dns_resolver_request_t *request = (cat_dns_resolver_request_t *) handle->data;
+    (void) suggested_size;
+
+    *buf = uv_buf_init((char *) request->buffer, sizeof(request->buffer));
+}
+
+static void cat_dns_resolver_udp_read_callback(uv_udp_t *udp, ssize_t nread, const uv_buf_t *buf, const struct sockaddr *address, unsigned int flags)
+{
+    cat_dns_resolver_request_t *request = (cat_dns_resolver_request_t *) udp->data;
+    (void) address;
+
+    if (nread == 0) {
+        return;
+    }
+    if (nread < 0) {
+        /* e.g. ECONNREFUSED */
+        cat_dns_resolver_request_next_server(request);
+        return;
+    }
+    cat_dns_resolver_request_on_packet(request, (const unsigned char *) buf->base, nread, !!(flags & UV_UDP_PARTIAL), cat_false);
+}
+
+static void cat_dns_resolver_timer_callback(uv_timer_t *timer)
+{
+    cat_dns_resolver_request_next_server((cat_dns_resolver_request_t *) timer->data);
+}
+
+/* answers are matched by id, so unanswered questions of the request must not share it */
+static uint16_t cat_dns_resolver_request_make_id(const cat_dns_resolver_request_t *request, const cat_dns_resolver_question_t *question)
+{
+    uint16_t id;
+    size_t n;
+
+    _retry:
+    id = cat_dns_resolver_make_id();
+    for (n = 0; n < request->question_count; n++) {
+        const cat_dns_resolver_question_t *other = &request->questions[n];
+        if (other != question && !other->done && other->id == id) {
+            goto _retry;
+        }
+    }
+
+    return id;
+}
+
+static void cat_dns_resolver_question_build(cat_dns_resolver_request_t *request, cat_dns_resolver_question_t *question, const char *name)
+{
+    unsigned char *header = question->packet + 2, *p;
+    size_t name_length;
+
+    question->id = cat_dns_resolver_request_make_id(request, question);
+    memset(header, 0, CAT_DNS_HEADER_LENGTH);
+    cat_dns_write_u16(header, question->id);
+    cat_dns_write_u16(header + 2, CAT_DNS_FLAG_RD);
+    cat_dns_write_u16(header + 4, 1);
+    /* names have been validated */
+    name_length = cat_dns_name_encode(header + CAT_DNS_HEADER_LENGTH, name);
+    p = header + CAT_DNS_HEADER_LENGTH + name_length;
+    cat_dns_write_u16(p, question->type);
+    cat_dns_write_u16(p + 2, CAT_DNS_CLASS_IN);
+    question->length = CAT_DNS_HEADER_LENGTH + name_length + 4;
+    cat_dns_write_u16(question->packet, (uint16_t) question->length);
+}
+
+/* send questions which have not been answered to the current server */
+static void cat_dns_resolver_request_send(cat_dns_resolver_request_t *request)
+{
+    const cat_sockaddr_inet_info_t *server = &request->config->servers[request->server];
+    const char *name = request->names[request->name_index];
+    cat_bool_t inet6 = server->address.common.sa_family == AF_INET6;
+    uv_udp_t *udp = &request->udp[inet6];
+    int error;
+    size_t n;
+
+    /* errors of the previous server (e.g. ECONNREFUSED) must not be reported on the other one */
+    (void) uv_udp_recv_stop(&request->udp[!inet6]);
+    (void) uv_udp_connect(udp, NULL);
+    error = uv_udp_connect(udp, &server->address.common);
+    if (error == 0 && !uv_is_active((uv_handle_t *) udp)) {
+        error = uv_udp_recv_start(udp, cat_dns_resolver_udp_alloc_callback, cat_dns_resolver_udp_read_callback);
+    }
+    if (unlikely(error != 0)) {
+        cat_dns_resolver_request_next_server(request);
+        return;
+    }
+    for (n = 0; n < request->question_count; n++) {
+        cat_dns_resolver_question_t *question = &request->questions[n];
+        uv_buf_t buffer;
+        if (question->done) {
+            continue;
+        }
+        cat_dns_resolver_question_build(request, question, name);
+        question->tcp = cat_false;
+        buffer = uv_buf_init((char *) question->packet + 2, (unsigned int) question->length);
+        error = uv_udp_try_send(udp, &buffer, 1, NULL);
+        /* it is lost if the socket buffer is full, then we retry on timeout,
+         * otherwise it may be the pending ECONNREFUSED of the previous one */
+        if (unlikely(error < 0) && error != CAT_EAGAIN && error != CAT_ENOBUFS) {
+            cat_dns_resolver_request_next_server(request);
+            return;
+        }
+    }
+    (void) uv_timer_start(&request->timer, cat_dns_resolver_timer_callback, request->config->timeout, 0);
+}
+
+static cat_bool_t cat_dns_resolver_request_add_name(cat_dns_resolver_request_t *request, const char *name, size_t length, const char *domain)
+{
+    unsigned char encoded[255];
+    char *buffer = request->names[request->name_count];
+    size_t domain_length = domain != NULL ? strlen(domain) : 0;
+
+    if (length + (domain != NULL ? 1 + domain_length : 0) > 253) {
+        return cat_false;
+    }
+    memcpy(buffer, name, length);
+    if (domain != NULL) {
+        buffer[length] = '.';
+        memcpy(buffer + length + 1, domain, domain_length);
+        length += 1 + domain_length;
+    }
+    buffer[length] = '\0';
+    if (cat_dns_name_encode(encoded, buffer) == 0) {
+        return cat_false;
+    }
+    request->name_count++;
+
+    return cat_true;
+}
+
+/* the same order as libc: the name itself goes first if it has enough dots */
+static void cat_dns_resolver_request_expand_names(cat_dns_resolver_request_t *request, const char *name)
+{
+    const cat_dns_resolver_config_t *config = request->config;
+    size_t length = strlen(name), dots = 0, n;
+    cat_bool_t absolute = length > 0 && name[length - 1] == '.';
+
+    if (absolute) {
+        length--;
+    }
+    for (n = 0; n < length; n++) {
+        dots += name[n] == '.';
+    }
+    if (absolute || dots >= config->ndots) {
+        (void) cat_dns_resolver_request_add_name(request, name, length, NULL);
+    }
+    if (!absolute) {
+        for (n = 0; n < config->search_count; n++) {
+            (void) cat_dns_resolver_request_add_name(request, name, length, config->search[n]);
+        }
+        if (dots < config->ndots) {
+            (void) cat_dns_resolver_request_add_name(request, name, length, NULL);
+        }
+    }
+}
+
+static cat_dns_resolver_request_t *cat_dns_resolver_request_create(
+    const char *name, const uint16_t *types, size_t type_count,
+    const cat_dns_resolver_hints_t *hints,
+    cat_dns_resolver_callback_t callback, void *data
+)
+{
+    cat_dns_resolver_config_t *config;
+    cat_dns_resolver_request_t *request;
+    size_t n;
+
+    config = cat_dns_resolver_get_config();
+    if (unlikely(config == NULL)) {
+        return NULL;
+    }
+    if (unlikely(config->server_count == 0)) {
+        cat_update_last_error(CAT_ENOTSUP, "DNS resolver has no nameservers");
+        return NULL;
+    }
+    request = (cat_dns_resolver_request_t *) cat_malloc(sizeof(*request));
+#if CAT_ALLOC_HANDLE_ERRORS
+    if (unlikely(request == NULL)) {
+        cat_update_last_error_of_syscall("Malloc for DNS resolver request failed");
+        return NULL;
+    }
+#endif
+    request->config = config;
+    request->name_count = 0;
+    cat_dns_resolver_request_expand_names(request, name);
+    if (unlikely(request->name_count == 0)) {
+        cat_update_last_error(CAT_EAI_NONAME, "DNS name \"%s\" is invalid", name);
+        cat_free(request);
+        return NULL;
+    }
+    /* no socket is created here, it can not fail */
+    (void) uv_udp_init(&CAT_EVENT_G(loop), &request->udp[0]);
+    (void) uv_udp_init(&CAT_EVENT_G(loop), &request->udp[1]);
+    (void) uv_timer_init(&CAT_EVENT_G(loop), &request->timer);
+    request->udp[0].data = request;
+    request->udp[1].data = request;
+    request->timer.data = request;
+    request->callback = callback;
+    request->data = data;
+    config->refcount++;
+    if (hints != NULL) {
+        request->hints = *hints;
+    } else {
+        memset(&request->hints, 0, sizeof(request->hints));
+    }
+    request->tcp = NULL;
+    request->handle_count = 3;
+    request->finished = cat_false;
+    request->status = CAT_ECANCELED;
+    request->server = config->server_index;
+    if (config->rotate) {
+        config->server_index = (config->server_index + 1) % config->server_count;
+    }
+    request->tries = 0;
+    request->name_index = 0;
+    for (n = 0; n < type_count; n++) {
+        request->questions[n].type = types[n];
+        request->questions[n].done = cat_false;
+        request->questions[n].tcp = cat_false;
+        request->questions[n].status = CAT_EAI_NODATA;
+    }
+    request->question_count = type_count;
+    request->canonname[0] = '\0';
+    request->ttl = UINT32_MAX;
+    request->address_count = 0;
+    request->srv = NULL;
+    cat_dns_resolver_request_send(request);
+
+    return request;
+}
+
+/* IPv4 addresses go first, addresses are not sorted by RFC 6724 */
+static struct addrinfo *cat_dns_resolver_addrinfo_build(
+    const cat_dns_resolver_address_t *addresses, size_t address_count,
+    const cat_dns_resolver_hints_t *hints, const char *canonname
+)
+{
+    static const int families[] = { AF_INET, AF_INET6 };
+    static const int socktypes[][2] = {
+        { SOCK_STREAM, IPPROTO_TCP },
+        { SOCK_DGRAM,  IPPROTO_UDP },
+        { SOCK_RAW,    0 },
+    };
+    int types[CAT_ARRAY_SIZE(socktypes)][2];
+    size_t type_count = 0, size = 0, canonname_size = 0, n, m, f;
+    struct addrinfo *response = NULL, *previous = NULL;
+    char *p;
+
+    for (n = 0; n < CAT_ARRAY_SIZE(socktypes); n++) {
+        if (hints->socktype != 0) {
+            types[0][0] = hints->socktype;
+            types[0][1] = hints->protocol != 0 ? hints->protocol :
+                (hints->socktype == SOCK_STREAM ? IPPROTO_TCP : (hints->socktype == SOCK_DGRAM ? IPPROTO_UDP : 0));
+            type_count = 1;
+            break;
+        }
+        if (hints->protocol == 0 || hints->protocol == socktypes[n][1]) {
+            types[type_count][0] = socktypes[n][0];
+            types[type_count][1] = socktypes[n][1];
+            type_count++;
+        }
+    }
+    if (canonname != NULL && (hints->flags & AI_CANONNAME)) {
+        canonname_size = CAT_MEMORY_ALIGNED_SIZE(strlen(canonname) + 1);
+    }
+    for (n = 0; n < address_count; n++) {
+        size += (CAT_MEMORY_ALIGNED_SIZE(sizeof(struct addrinfo)) + CAT_MEMORY_ALIGNED_SIZE(
+            addresses[n].family == AF_INET ? sizeof(struct sockaddr_in) : sizeof(struct sockaddr_in6)
+        )) * type_count;
+    }
+    if (unlikely(size == 0)) {
+        cat_update_last_error(CAT_EAI_NODATA, "DNS resolver got no address");
+        return NULL;
+    }
+    p = (char *) cat_malloc(size + canonname_size);
+#if CAT_ALLOC_HANDLE_ERRORS
+    if (unlikely(p == NULL)) {
+        cat_update_last_error_of_syscall("Malloc for DNS response failed");
+        return NULL;
+    }
+#endif
+    memset(p, 0, size);
+    for (f = 0; f < CAT_ARRAY_SIZE(families); f++) {
+        for (n = 0; n < address_count; n++) {
+            const cat_dns_resolver_address_t *address = &addresses[n];
+            if (address->family != families[f]) {
+                continue;
+            }
+            for (m = 0; m < type_count; m++) {
+                struct addrinfo *ai = (struct addrinfo *) p;
+                p += CAT_MEMORY_ALIGNED_SIZE(sizeof(*ai));
+                ai->ai_flags = hints->flags;
+                ai->ai_family = address->family;
+                ai->ai_socktype = types[m][0];
+                ai->ai_protocol = types[m][1];
+                ai->ai_addr = (struct sockaddr *) p;
+                if (address->family == AF_INET) {
+                    struct sockaddr_in *in = (struct sockaddr_in *) p;
+                    in->sin_family = AF_INET;
+                    in->sin_port = htons(hints->port);
+                    memcpy(&in->sin_addr, address->bytes, 4);
+                    ai->ai_addrlen = sizeof(*in);
+                } else {
+                    struct sockaddr_in6 *in6 = (struct sockaddr_in6 *) p;
+                    in6->sin6_family = AF_INET6;
+                    in6->sin6_port = htons(hints->port);
+                    memcpy(&in6->sin6_addr, address->bytes, 16);
+                    ai->ai_addrlen = sizeof(*in6);
+                }
+                p += CAT_MEMORY_ALIGNED_SIZE(ai->ai_addrlen);
+                if (previous != NULL) {
+                    previous->ai_next = ai;
+                } else {
+                    response = ai;
+                }
+                previous = ai;
+            }
+        }
+    }
+    if (canonname_size != 0) {
+        response->ai_canonname = p;
+        strcpy(p, canonname);
+    }
+
+    return response;
+}
+
+/* returns false if the native resolver can not handle it, then we fall back to getaddrinfo() */
+static cat_bool_t cat_dns_resolver_getaddrinfo_prepare(const char *hostname, const char *service, const struct addrinfo *hints, cat_dns_resolver_hints_t *resolver_hints)
+{
+    cat_dns_resolver_config_t *config;
+    int flags = hints != NULL ? hints->ai_flags : 0;
+    unsigned int port = 0;
+
+    if (!cat_dns_resolver_get()->enabled || hostname == NULL || strchr(hostname, '%') != NULL) {
+        return cat_false;
+    }
+    /* e.g. AI_V4MAPPED and AI_ALL */
+    if ((flags & ~(AI_PASSIVE | AI_CANONNAME | AI_NUMERICHOST | AI_NUMERICSERV | AI_ADDRCONFIG)) != 0) {
+        return cat_false;
+    }
+    resolver_hints->family = hints != NULL ? hints->ai_family : AF_UNSPEC;
+    resolver_hints->socktype = hints != NULL ? hints->ai_socktype : 0;
+    resolver_hints->protocol = hints != NULL ? hints->ai_protocol : 0;
+    resolver_hints->flags = flags;
+    if (resolver_hints->family != AF_UNSPEC && resolver_hints->family != AF_INET && resolver_hints->family != AF_INET6) {
+        return cat_false;
+    }
+    if (resolver_hints->socktype != 0 && resolver_hints->socktype != SOCK_STREAM &&
+        resolver_hints->socktype != SOCK_DGRAM && resolver_hints->socktype != SOCK_RAW) {
+        return cat_false;
+    }
+    /* service names need getservbyname() */
+    if (service != NULL) {
+        const char *p;
+        for (p = service; *p != '\0'; p++) {
+            if (*p < '0' || *p > '9' || (port = port * 10 + (*p - '0')) > 65535) {
+                return cat_false;
+            }
+        }
+    }
+    resolver_hints->port = (uint16_t) port;
+    config = cat_dns_resolver_get_config();
+    if (config == NULL || config->server_count == 0) {
+        return cat_false;
+    }
+
+    return cat_true;
+}
+
+/* numeric hosts and names in hosts file are answered without queries */
+static cat_bool_t cat_dns_resolver_getaddrinfo_local(const char *hostname, const cat_dns_resolver_hints_t *hints, struct addrinfo **response)
+{
+    cat_dns_resolver_address_t addresses[CAT_DNS_RESOLVER_MAX_ADDRESSES];
+    size_t count = 0;
+    int family = AF_UNSPEC;
+
+    if (uv_inet_pton(AF_INET, hostname, addresses[0].bytes) == 0) {
+        family = AF_INET;
+    } else if (uv_inet_pton(AF_INET6, hostname, addresses[0].bytes) == 0) {
+        family = AF_INET6;
+    }
+    if (family != AF_UNSPEC) {
+        if (hints->family != AF_UNSPEC && hints->family != family) {
+            cat_update_last_error_with_reason(CAT_EAI_ADDRFAMILY, "DNS getaddrinfo failed");
+            *response = NULL;
+            return cat_true;
+        }
+        addresses[0].family = family;
+        count = 1;
+    } else if (hints->flags & AI_NUMERICHOST) {
+        cat_update_last_error_with_reason(CAT_EAI_NONAME, "DNS getaddrinfo failed");
+        *response = NULL;
+        return cat_true;
+    } else {
+        const char *name = hostname;
+        char buffer[CAT_DNS_NAME_SIZE];
+        size_t length = strlen(hostname);
+        if (length > 1 && length < sizeof(buffer) && hostname[length - 1] == '.') {
+            memcpy(buffer, hostname, length - 1);
+            buffer[length - 1] = '\0';
+            name = buffer;
+        }
+        count = cat_dns_resolver_hosts_lookup(cat_dns_resolver_get_config(), name, hints->family, addresses, CAT_ARRAY_SIZE(addresses));
+        if (count == 0) {
+            return cat_false;
+        }
+    }
+    *response = cat_dns_resolver_addrinfo_build(addresses, count, hints, hostname);
+    if (unlikely(*response == NULL)) {
+        cat_update_last_error_with_previous("DNS getaddrinfo failed");
+    }
+
+    return cat_true;
+}
+
+static cat_dns_resolver_request_t *cat_dns_resolver_getaddrinfo_start(
+    const char *hostname, const cat_dns_resolver_hints_t *hints,
+    cat_dns_resolver_callback_t callback, void *data
+)
+{
+    uint16_t types[2];
+    size_t type_count = 0;
+    int family = hints->family;
+
+    /* do not ask for addresses which we can not connect to */
+    if (family == AF_UNSPEC && (hints->flags & AI_ADDRCONFIG)) {
+        cat_dns_resolver_config_t *config = cat_dns_resolver_get_config();
+        if (likely(config != NULL)) {
+            family = cat_dns_resolver_get_addrconfig_family(config);
+        }
+    }
+    if (family != AF_INET6) {
+        types[type_count++] = CAT_DNS_TYPE_A;
+    }
+    if (family != AF_INET) {
+        types[type_count++] = CAT_DNS_TYPE_AAAA;
+    }
+
+    return cat_dns_resolver_request_create(hostname, types, type_count, hints, callback, data);
+}
+
+static struct addrinfo *cat_dns_resolver_request_get_addrinfo(const cat_dns_resolver_request_t *request)
+{
+    return cat_dns_resolver_addrinfo_build(
+        request->addresses, request->address_count, &request->hints,
+        request->canonname[0] != '\0' ? request->canonname : request->names[request->name_index]
+    );
+}
+
+/* srv */
+
+typedef struct cat_dns_srv_context_s {
+    cat_coroutine_t *coroutine;
+    cat_dns_srv_t *records;
     int status;
+    cat_bool_t done;
+} cat_dns_srv_context_t;
+
+/* by priority (ascending) and weight (descending) */
+static cat_dns_srv_t *cat_dns_srv_sort(cat_dns_srv_t *records)
+{
+    cat_dns_srv_t *sorted = NULL, *record, *next, **position;
+
+    for (record = records; record != NULL; record = next) {
+        next = record->next;
+        position = &sorted;
+        while (*position != NULL && ((*position)->priority < record->priority ||
+               ((*position)->priority == record->priority && (*position)->weight >= record->weight))) {
+            position = &(*position)->next;
+        }
+        record->next = *position;
+        *position = record;
+    }
+
+    return sorted;
+}
+
+static void cat_dns_query_srv_callback(cat_dns_resolver_request_t *request)
+{
+    cat_dns_srv_context_t *context = (cat_dns_srv_context_t *) request->data;
+
+    /* the waiter has gone */
+    if (context == NULL) {
+        return;
+    }
+    context->status = request->status;
+    if (request->status == 0) {
+        context->records = cat_dns_srv_sort(request->srv);
+        request->srv = NULL;
+    }
+    context->done = cat_true;
+    cat_coroutine_schedule(context->coroutine, DNS, "DNS resolver");
+}
+
+/* cache */
+
+struct cat_dns_cache_entry_s {
+    /* next entry of the same bucket */
+    cat_dns_cache_entry_t *next;
+    /* node of lru queue (resolved entries only) */
+    cat_queue_node_t node;
+    /* coroutines which are waiting for the result (pending entries only) */
+    cat_queue_t waiters;
+    uv_getaddrinfo_t request;
+    /* it is not NULL if the entry is resolved by the native resolver */
+    cat_dns_resolver_request_t *native;
+    /* copy of response, it is NULL if status is not 0 */
     struct addrinfo *response;
-} cat_getaddrinfo_context_t;
+    cat_msec_t expire;
+    uint32_t hash;
+    int status;
+    cat_bool_t pending;
+    /* entry has been removed from cache, it will be freed when resolution is done */
+    cat_bool_t detached;
+    size_t key_length;
+    char key[1];
+};
+
+typedef struct cat_dns_waiter_s {
+    cat_queue_node_t node;
+    cat_coroutine_t *coroutine;
+    cat_bool_t done;
+} cat_dns_waiter_t;
+
+static cat_always_inline cat_dns_cache_t *cat_dns_cache_get(void)
+{
+    return &CAT_SOCKET_G(dns_cache);
+}
+
+static uint32_t cat_dns_cache_hash(const char *key, size_t key_length)
+{
+    /* FNV-1a */
+    uint32_t hash = 2166136261u;
+    size_t n;
+
+    for (n = 0; n < key_length; n++) {
+        hash ^= (unsigned char) key[n];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static size_t cat_dns_cache_make_key(char *key, size_t size, const char *hostname, const char *service, const struct addrinfo *hints)
+{
+    int length;
+
+    length = snprintf(
+        key, size, "%d,%d,%d,%d|%s|%s",
+        hints != NULL ? hints->ai_family : 0,
+        hints != NULL ? hints->ai_socktype : 0,
+        hints != NULL ? hints->ai_protocol : 0,
+        hints != NULL ? hints->ai_flags : 0,
+        service != NULL ? service : "",
+        hostname != NULL ? hostname : ""
+    );
+    if (unlikely(length < 0 || (size_t) length >= size)) {
+        return 0;
+    }
+
+    return (size_t) length;
+}
+
+/* buckets grow with entries rather than capacity, which may be huge */
+static cat_bool_t cat_dns_cache_resize(cat_dns_cache_t *cache, size_t count)
+{
+    cat_dns_cache_entry_t **buckets, *entry, *next;
+    size_t bucket_count = CAT_DNS_CACHE_MIN_BUCKET_COUNT, n;
+
+    while (bucket_count < count) {
+        bucket_count <<= 1;
+    }
+    if (bucket_count == cache->bucket_count) {
+        return cat_true;
+    }
+    buckets = (cat_dns_cache_entry_t **) cat_calloc(bucket_count, sizeof(*buckets));
+#if CAT_ALLOC_HANDLE_ERRORS
+    if (unlikely(buckets == NULL)) {
+        cat_update_last_error_of_syscall("Malloc for DNS cache buckets failed");
+        return cat_false;
+    }
+#endif
+    for (n = 0; n < cache->bucket_count; n++) {
+        for (entry = cache->buckets[n]; entry != NULL; entry = next) {
+            cat_dns_cache_entry_t **bucket = &buckets[entry->hash & (bucket_count - 1)];
+            next = entry->next;
+            entry->next = *bucket;
+            *bucket = entry;
+        }
+    }
+    if (cache->buckets != NULL) {
+        cat_free(cache->buckets);
+    }
+    cache->buckets = buckets;
+    cache->bucket_count = bucket_count;
+
+    return cat_true;
+}
+
+static cat_dns_cache_entry_t *cat_dns_cache_find(cat_dns_cache_t *cache, const char *key, size_t key_length, uint32_t hash)
+{
+    cat_dns_cache_entry_t *entry;
+
+    for (entry = cache->buckets[hash & (cache->bucket_count - 1)]; entry != NULL; entry = entry->next) {
+        if (entry->hash == hash && entry->key_length == key_length &&
+            memcmp(entry->key, key, key_length) == 0) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static void cat_dns_cache_unlink(cat_dns_cache_t *cache, cat_dns_cache_entry_t *entry)
+{
+    cat_dns_cache_entry_t **bucket = &cache->buckets[entry->hash & (cache->bucket_count - 1)];
+
+    while (*bucket != entry) {
+        bucket = &(*bucket)->next;
+    }
+    *bucket = entry->next;
+    /* it is a no-op if entry is not in lru yet */
+    cat_queue_remove(&entry->node);
+    cache->stats.count--;
+}
+
+static void cat_dns_cache_entry_free(cat_dns_cache_entry_t *entry)
+{
+    if (entry->response != NULL) {
+        cat_free(entry->response);
+    }
+    cat_free(entry);
+}
+
+/* pending entries are detached from cache, they will be freed when the resolution is done */
+static void cat_dns_cache_remove(cat_dns_cache_t *cache, cat_dns_cache_entry_t *entry)
+{
+    cat_dns_cache_unlink(cache, entry);
+    if (entry->pending) {
+        entry->detached = cat_true;
+    } else {
+        cat_dns_cache_entry_free(entry);
+    }
+}
+
+static void cat_dns_cache_evict(cat_dns_cache_t *cache)
+{
+    cat_dns_cache_entry_t *entry;
+
+    while (cache->stats.count > cache->capacity &&
+           (entry = cat_queue_front_data(&cache->lru, cat_dns_cache_entry_t, node))) {
+        cat_dns_cache_remove(cache, entry);
+    }
+}
+
+static cat_always_inline cat_bool_t cat_dns_status_is_negative(int status)
+{
+    return status == CAT_EAI_NONAME || status == CAT_EAI_NODATA;
+}
+
+/* ttl is TTL of records, response is owned by entry */
+static void cat_dns_cache_entry_complete(cat_dns_cache_entry_t *entry, int status, struct addrinfo *response, cat_msec_t ttl)
+{
+    cat_dns_cache_t *cache = cat_dns_cache_get();
+    cat_dns_waiter_t *waiter;
+
+    entry->response = response;
+    entry->status = status;
+
+    /* entry is still pending during waking up,
+     * so that it would be detached rather than freed if waiters flush the cache,
+     * and new lookups of the same name will join us and get the result */
+    while ((waiter = cat_queue_front_data(&entry->waiters, cat_dns_waiter_t, node))) {
+        cat_queue_remove(&waiter->node);
+        waiter->done = cat_true;
+        cat_coroutine_schedule(waiter->coroutine, DNS, "DNS resolver");
+    }
+    entry->pending = cat_false;
+
+    if (entry->detached) {
+        cat_dns_cache_entry_free(entry);
+        return;
+    }
+    if (status == 0) {
+        ttl = CAT_MIN(ttl, cache->ttl);
+    } else if (cat_dns_status_is_negative(status)) {
+        ttl = cache->negative_ttl;
+    } else {
+        ttl = 0;
+    }
+    if (cache->capacity == 0 || ttl == 0) {
+        cat_dns_cache_unlink(cache, entry);
+        cat_dns_cache_entry_free(entry);
+        return;
+    }
+    entry->expire = cat_time_msec_cached() + ttl;
+    cat_queue_push_back(&cache->lru, &entry->node);
+    cat_dns_cache_evict(cache);
+}
 
-static void cat_dns_getaddrinfo_callback(uv_getaddrinfo_t* request, int status, struct addrinfo *response)
+static void cat_dns_getaddrinfo_callback(uv_getaddrinfo_t *request, int status, struct addrinfo *response)
 {
-    cat_getaddrinfo_context_t *context = cat_container_of(request, cat_getaddrinfo_context_t, request.getaddrinfo);
+    cat_dns_cache_entry_t *entry = cat_container_of(request, cat_dns_cache_entry_t, request);
+    struct addrinfo *copy = NULL;
 
-    if (likely(context->request.coroutine != NULL)) {
-        context->status = status;
-        context->response = response;
-        cat_coroutine_schedule(context->request.coroutine, DNS, "DNS resolver");
-    } else if (response != NULL) {
+    if (response != NULL) {
+        if (status == 0) {
+            CAT_PROTECT_LAST_ERROR_START() {
+                copy = cat_dns_addrinfo_dup(response);
+            } CAT_PROTECT_LAST_ERROR_END();
+            if (unlikely(copy == NULL)) {
+                status = CAT_ENOMEM;
+            }
+        }
         uv_freeaddrinfo(response);
+    } else if (unlikely(status == 0)) {
+        status = CAT_EAI_NODATA;
     }
 
-    cat_free(context);
+    cat_dns_cache_entry_complete(entry, status, copy, CAT_DNS_TTL_UNKNOWN);
 }
 
-CAT_API struct addrinfo *cat_dns_getaddrinfo(const char *hostname, const char *service, const struct addrinfo *hints)
+static void cat_dns_resolver_getaddrinfo_callback(cat_dns_resolver_request_t *request)
 {
-    return cat_dns_getaddrinfo_ex(hostname, service, hints, cat_socket_get_global_dns_timeout());
+    cat_dns_cache_entry_t *entry = (cat_dns_cache_entry_t *) request->data;
+    struct addrinfo *response = NULL;
+    int status = request->status;
+
+    if (status == 0) {
+        CAT_PROTECT_LAST_ERROR_START() {
+            response = cat_dns_resolver_request_get_addrinfo(request);
+        } CAT_PROTECT_LAST_ERROR_END();
+        if (unlikely(response == NULL)) {
+            status = CAT_ENOMEM;
+        }
+    }
+    entry->native = NULL;
+
+    cat_dns_cache_entry_complete(entry, status, response, (cat_msec_t) request->ttl * 1000);
 }
 
-CAT_API struct addrinfo *cat_dns_getaddrinfo_ex(const char *hostname, const char *service, const struct addrinfo *hints, cat_timeout_t timeout)
+static cat_bool_t cat_dns_cache_entry_cancel(cat_dns_cache_entry_t *entry)
 {
-    cat_getaddrinfo_context_t *context = (cat_getaddrinfo_context_t *) cat_malloc(sizeof(*context));
-    cat_bool_t ret;
+    if (entry->native != NULL) {
+        cat_dns_resolver_request_cancel(entry->native);
+        return cat_true;
+    }
+
+    return uv_cancel((uv_req_t *) &entry->request) == 0;
+}
+
+static struct addrinfo *cat_dns_cache_entry_get_result(const cat_dns_cache_entry_t *entry)
+{
+    struct addrinfo *response;
+
+    if (unlikely(entry->status != 0)) {
+        if (entry->status == CAT_EAI_CANCELED) {
+            cat_update_last_error(CAT_ECANCELED, "DNS getaddrinfo has been canceled");
+        } else {
+            cat_update_last_error_with_reason(entry->status, "DNS getaddrinfo failed");
+        }
+        return NULL;
+    }
+    response = cat_dns_addrinfo_dup(entry->response);
+    if (unlikely(response == NULL)) {
+        cat_update_last_error_with_previous("DNS getaddrinfo failed");
+    }
+
+    return response;
+}
+
+static cat_dns_cache_entry_t *cat_dns_cache_entry_create(
+    cat_dns_cache_t *cache,
+    const char *key, size_t key_length, uint32_t hash,
+    const char *hostname, const char *service, const struct addrinfo *hints,
+    const cat_dns_resolver_hints_t *resolver_hints
+)
+{
+    cat_dns_cache_entry_t *entry, **bucket;
     int error;
 
+    entry = (cat_dns_cache_entry_t *) cat_malloc(offsetof(cat_dns_cache_entry_t, key) + key_length + 1);
 #if CAT_ALLOC_HANDLE_ERRORS
-    if (unlikely(context == NULL)) {
+    if (unlikely(entry == NULL)) {
         cat_update_last_error_of_syscall("Malloc for DNS getaddrinfo context failed");
         return NULL;
     }
 #endif
-    error = uv_getaddrinfo(&CAT_EVENT_G(loop), &context->request.getaddrinfo, cat_dns_getaddrinfo_callback, hostname, service, hints);
-    if (error != 0) {
-        cat_update_last_error_with_reason(error, "DNS getaddrinfo init failed");
-        cat_free(context);
-        return NULL;
+    if (resolver_hints != NULL) {
+        entry->native = cat_dns_resolver_getaddrinfo_start(hostname, resolver_hints, cat_dns_resolver_getaddrinfo_callback, entry);
+        if (unlikely(entry->native == NULL)) {
+            cat_update_last_error_with_previous("DNS getaddrinfo init failed");
+            cat_free(entry);
+            return NULL;
+        }
+    } else {
+        error = uv_getaddrinfo(&CAT_EVENT_G(loop), &entry->request, cat_dns_getaddrinfo_callback, hostname, service, hints);
+        if (unlikely(error != 0)) {
+            cat_update_last_error_with_reason(error, "DNS getaddrinfo init failed");
+            cat_free(entry);
+            return NULL;
+        }
+        entry->native = NULL;
+    }
+    cat_queue_init(&entry->node);
+    cat_queue_init(&entry->waiters);
+    entry->response = NULL;
+    entry->expire = 0;
+    entry->hash = hash;
+    entry->status = CAT_ECANCELED;
+    entry->pending = cat_true;
+    entry->detached = cat_false;
+    entry->key_length = key_length;
+    memcpy(entry->key, key, key_length);
+    entry->key[key_length] = '\0';
+    bucket = &cache->buckets[hash & (cache->bucket_count - 1)];
+    entry->next = *bucket;
+    *bucket = entry;
+    cache->stats.count++;
+    if (cache->stats.count > cache->bucket_count) {
+        /* chains just become longer if it fails */
+        CAT_PROTECT_LAST_ERROR_START() {
+            (void) cat_dns_cache_resize(cache, cache->stats.count);
+        } CAT_PROTECT_LAST_ERROR_END();
     }
-    context->status = CAT_ECANCELED;
-    context->request.coroutine = CAT_COROUTINE_G(current);
+
+    return entry;
+}
+
+static struct addrinfo *cat_dns_cache_entry_wait(cat_dns_cache_t *cache, cat_dns_cache_entry_t *entry, cat_timeout_t timeout)
+{
+    cat_dns_waiter_t waiter;
+    cat_bool_t ret;
+
+    waiter.coroutine = CAT_COROUTINE_G(current);
+    waiter.done = cat_false;
+    cat_queue_push_back(&entry->waiters, &waiter.node);
     ret = cat_time_wait(timeout);
-    context->request.coroutine = NULL;
-    if (unlikely(!ret)) {
-        cat_update_last_error_with_previous("DNS getaddrinfo wait failed");
-        (void) uv_cancel(&context->request.req);
+    if (unlikely(!waiter.done)) {
+        cat_queue_remove(&waiter.node);
+        if (!ret) {
+            cat_update_last_error_with_previous("DNS getaddrinfo wait failed");
+        } else {
+            cat_update_last_error(CAT_ECANCELED, "DNS getaddrinfo has been canceled");
+        }
+        /* nobody needs it, cancel the resolution if it has not been started yet,
+         * detached entries (e.g. uncached ones) are freed when it is done */
+        if (cat_queue_empty(&entry->waiters) && cat_dns_cache_entry_cancel(entry) &&
+            !entry->detached) {
+            cat_dns_cache_remove(cache, entry);
+        }
         return NULL;
     }
-    if (unlikely(context->status != 0)) {
-        if (context->status == CAT_ECANCELED) {
-            cat_update_last_error(CAT_ECANCELED, "DNS getaddrinfo has been canceled");
-            (void) uv_cancel(&context->request.req);
-        } else {
-            cat_update_last_error_with_reason(context->status, "DNS getaddrinfo failed");
+
+    return cat_dns_cache_entry_get_result(entry);
+}
+
+static struct addrinfo *cat_dns_getaddrinfo_uncached(
+    const char *hostname, const char *service, const struct addrinfo *hints,
+    const cat_dns_resolver_hints_t *resolver_hints, cat_timeout_t timeout
+)
+{
+    cat_dns_cache_t cache;
+    cat_dns_cache_entry_t *bucket = NULL, *entry;
+
+    /* use a temporary cache which can not hold anything */
+    memset(&cache, 0, sizeof(cache));
+    cache.buckets = &bucket;
+    cache.bucket_count = 1;
+    cat_queue_init(&cache.lru);
+    entry = cat_dns_cache_entry_create(&cache, "", 0, 0, hostname, service, hints, resolver_hints);
+    if (unlikely(entry == NULL)) {
+        return NULL;
+    }
+    /* it is freed when the resolution is done */
+    cat_dns_cache_unlink(&cache, entry);
+    entry->detached = cat_true;
+
+    return cat_dns_cache_entry_wait(&cache, entry, timeout);
+}
+
+static void cat_dns_runtime_shutdown(cat_data_t *data)
+{
+    cat_dns_cache_t *cache = cat_dns_cache_get();
+    cat_dns_resolver_t *resolver = cat_dns_resolver_get();
+    cat_dns_cache_entry_t *entry;
+    size_t n;
+    (void) data;
+
+    /* nobody is waiting for them now, do not let queries keep the loop alive */
+    for (n = 0; n < cache->bucket_count; n++) {
+        for (entry = cache->buckets[n]; entry != NULL; entry = entry->next) {
+            if (entry->native != NULL) {
+                cat_dns_resolver_request_cancel(entry->native);
+            }
+        }
+    }
+    cat_dns_cache_flush();
+    if (cache->buckets != NULL) {
+        cat_free(cache->buckets);
+        cache->buckets = NULL;
+        cache->bucket_count = 0;
+    }
+    cat_dns_resolver_drop_config();
+    if (resolver->servers != NULL) {
+        cat_free(resolver->servers);
+        resolver->servers = NULL;
+    }
+}
+
+CAT_API cat_bool_t cat_dns_runtime_init(void)
+{
+    cat_dns_cache_t *cache = cat_dns_cache_get();
+    cat_dns_resolver_t *resolver = cat_dns_resolver_get();
+
+    memset(cache, 0, sizeof(*cache));
+    cache->capacity = CAT_DNS_CACHE_DEFAULT_CAPACITY;
+    cache->ttl = CAT_DNS_CACHE_DEFAULT_TTL;
+    cache->negative_ttl = CAT_DNS_CACHE_DEFAULT_NEGATIVE_TTL;
+    cat_queue_init(&cache->lru);
+    /* buckets are allocated on demand */
+
+    memset(resolver, 0, sizeof(*resolver));
+    resolver->enabled = cat_env_is_true("CAT_DNS_RESOLVER", cat_false);
+    /* config is loaded on demand */
+    if (uv_random(NULL, NULL, &resolver->seed, sizeof(resolver->seed), 0, NULL) != 0 || resolver->seed == 0) {
+        resolver->seed = (uint32_t) uv_hrtime() | 1;
+    }
+
+    return cat_event_register_runtime_shutdown_task(cat_dns_runtime_shutdown, NULL) != NULL;
+}
+
+CAT_API struct addrinfo *cat_dns_getaddrinfo(const char *hostname, const char *service, const struct addrinfo *hints)
+{
+    return cat_dns_getaddrinfo_ex(hostname, service, hints, cat_socket_get_global_dns_timeout());
+}
+
+CAT_API struct addrinfo *cat_dns_getaddrinfo_ex(const char *hostname, const char *service, const struct addrinfo *hints, cat_timeout_t timeout)
+{
+    cat_dns_cache_t *cache = cat_dns_cache_get();
+    cat_dns_cache_entry_t *entry;
+    cat_dns_resolver_hints_t resolver_hints, *native = NULL;
+    char key[CAT_DNS_CACHE_KEY_SIZE];
+    size_t key_length;
+    uint32_t hash;
+
+    if (cat_dns_resolver_getaddrinfo_prepare(hostname, service, hints, &resolver_hints)) {
+        struct addrinfo *response;
+        if (cat_dns_resolver_getaddrinfo_local(hostname, &resolver_hints, &response)) {
+            return response;
         }
+        native = &resolver_hints;
+    }
+    key_length = cat_dns_cache_make_key(key, sizeof(key), hostname, service, hints);
+    if (unlikely(key_length == 0)) {
+        return cat_dns_getaddrinfo_uncached(hostname, service, hints, native, timeout);
+    }
+    if (unlikely(cache->buckets == NULL) && unlikely(!cat_dns_cache_resize(cache, 0))) {
         return NULL;
     }
+    hash = cat_dns_cache_hash(key, key_length);
+    entry = cat_dns_cache_find(cache, key, key_length, hash);
+    if (entry != NULL && !entry->pending) {
+        if (entry->expire > cat_time_msec_cached()) {
+            cache->stats.hits++;
+            cat_queue_remove(&entry->node);
+            cat_queue_push_back(&cache->lru, &entry->node);
+            return cat_dns_cache_entry_get_result(entry);
+        }
+        cat_dns_cache_remove(cache, entry);
+        entry = NULL;
+    }
+    if (entry == NULL) {
+        entry = cat_dns_cache_entry_create(cache, key, key_length, hash, hostname, service, hints, native);
+        if (unlikely(entry == NULL)) {
+            return NULL;
+        }
+        cache->stats.misses++;
+    } else {
+        cache->stats.coalesced++;
+    }
 
-    return context->response;
+    return cat_dns_cache_entry_wait(cache, entry, timeout);
 }
 
 CAT_API void cat_dns_freeaddrinfo(struct addrinfo *response)
 {
-    uv_freeaddrinfo(response);
+    cat_free(response);
+}
+
+CAT_API size_t cat_dns_cache_get_capacity(void)
+{
+    return cat_dns_cache_get()->capacity;
+}
+
+CAT_API cat_bool_t cat_dns_cache_set_capacity(size_t capacity)
+{
+    cat_dns_cache_t *cache = cat_dns_cache_get();
+
+    cache->capacity = capacity;
+    cat_dns_cache_evict(cache);
+    /* shrink buckets if entries have been evicted, old ones are still usable if it fails */
+    if (cache->buckets != NULL) {
+        CAT_PROTECT_LAST_ERROR_START() {
+            (void) cat_dns_cache_resize(cache, cache->stats.count);
+        } CAT_PROTECT_LAST_ERROR_END();
+    }
+
+    return cat_true;
+}
+
+CAT_API cat_msec_t cat_dns_cache_get_ttl(void)
+{
+    return cat_dns_cache_get()->ttl;
+}
+
+CAT_API void cat_dns_cache_set_ttl(cat_msec_t ttl)
+{
+    cat_dns_cache_get()->ttl = ttl;
+}
+
+CAT_API cat_msec_t cat_dns_cache_get_negative_ttl(void)
+{
+    return cat_dns_cache_get()->negative_ttl;
+}
+
+CAT_API void cat_dns_cache_set_negative_ttl(cat_msec_t ttl)
+{
+    cat_dns_cache_get()->negative_ttl = ttl;
+}
+
+CAT_API void cat_dns_cache_get_stats(cat_dns_cache_stats_t *stats)
+{
+    *stats = cat_dns_cache_get()->stats;
+}
+
+CAT_API void cat_dns_cache_flush(void)
+{
+    cat_dns_cache_t *cache = cat_dns_cache_get();
+    cat_dns_cache_entry_t *entry;
+    size_t n;
+
+    for (n = 0; n < cache->bucket_count; n++) {
+        while ((entry = cache->buckets[n]) != NULL) {
+            cat_dns_cache_remove(cache, entry);
+        }
+    }
+}
+
+CAT_API cat_bool_t cat_dns_resolver_is_enabled(void)
+{
+    return cat_dns_resolver_get()->enabled;
+}
+
+CAT_API void cat_dns_resolver_set_enabled(cat_bool_t enabled)
+{
+    cat_dns_resolver_get()->enabled = enabled;
+}
+
+CAT_API const char *cat_dns_resolver_get_servers(void)
+{
+    return cat_dns_resolver_get()->servers;
+}
+
+CAT_API cat_bool_t cat_dns_resolver_set_servers(const char *servers)
+{
+    cat_dns_resolver_t *resolver = cat_dns_resolver_get();
+    char *copy = NULL;
+
+    if (servers != NULL) {
+        cat_sockaddr_inet_info_t addresses[CAT_DNS_RESOLVER_MAX_SERVERS];
+        if (cat_dns_resolver_parse_servers(addresses, CAT_ARRAY_SIZE(addresses), servers) <= 0) {
+            cat_update_last_error(CAT_EINVAL, "DNS servers \"%s\" are invalid", servers);
+            return cat_false;
+        }
+        copy = cat_strdup(servers);
+#if CAT_ALLOC_HANDLE_ERRORS
+        if (unlikely(copy == NULL)) {
+            cat_update_last_error_of_syscall("Malloc for DNS servers failed");
+            return cat_false;
+        }
+#endif
+    }
+    if (resolver->servers != NULL) {
+        cat_free(resolver->servers);
+    }
+    resolver->servers = copy;
+    /* requests in progress hold their own reference */
+    cat_dns_resolver_drop_config();
+
+    return cat_true;
+}
+
+CAT_API cat_dns_srv_t *cat_dns_query_srv(const char *name)
+{
+    return cat_dns_query_srv_ex(name, cat_socket_get_global_dns_timeout());
+}
+
+CAT_API cat_dns_srv_t *cat_dns_query_srv_ex(const char *name, cat_timeout_t timeout)
+{
+    static const uint16_t types[] = { CAT_DNS_TYPE_SRV };
+    cat_dns_resolver_request_t *request;
+    cat_dns_srv_context_t context;
+    cat_bool_t ret;
+
+    context.coroutine = CAT_COROUTINE_G(current);
+    context.records = NULL;
+    context.status = CAT_ECANCELED;
+    context.done = cat_false;
+    request = cat_dns_resolver_request_create(name, types, CAT_ARRAY_SIZE(types), NULL, cat_dns_query_srv_callback, &context);
+    if (unlikely(request == NULL)) {
+        cat_update_last_error_with_previous("DNS query SRV failed");
+        return NULL;
+    }
+    ret = cat_time_wait(timeout);
+    if (unlikely(!context.done)) {
+        request->data = NULL;
+        cat_dns_resolver_request_cancel(request);
+        if (!ret) {
+            cat_update_last_error_with_previous("DNS query SRV wait failed");
+        } else {
+            cat_update_last_error(CAT_ECANCELED, "DNS query SRV has been canceled");
+        }
+        return NULL;
+    }
+    if (unlikely(context.status != 0)) {
+        cat_update_last_error_with_reason(context.status, "DNS query SRV failed");
+        return NULL;
+    }
+
+    return context.records;
+}
+
+CAT_API void cat_dns_free_srv(cat_dns_srv_t *records)
+{
+    cat_dns_srv_t *next;
+
+    for (; records != NULL; records = next) {
+        next = records->next;
+        cat_free(records);
+    }
 }
 
 CAT_API cat_bool_t cat_dns_get_ip(char *buffer, size_t buffer_size, const char *name, int af)
@@ -17,18 +17,30 @@
  */
 
 #include "cat_event.h"
+#include "cat_time.h"
+#include "cat_io_uring.h"
 
 CAT_API CAT_GLOBALS_DECLARE(cat_event);
 
+/* io_uring belongs to the event loop, it is initialized and shut down (and forked) with it */
+
 CAT_API cat_bool_t cat_event_module_init(void)
 {
     CAT_GLOBALS_REGISTER(cat_event);
+#ifdef CAT_IO_URING
+    if (!cat_io_uring_module_init()) {
+        return cat_false;
+    }
+#endif
 
     return cat_true;
 }
 
 CAT_API cat_bool_t cat_event_module_shutdown(void)
 {
+#ifdef CAT_IO_URING
+    (void) cat_io_uring_module_shutdown();
+#endif
     CAT_GLOBALS_UNREGISTER(cat_event);
 
     return cat_true;
@@ -46,7 +58,12 @@ CAT_API cat_bool_t cat_event_runtime_init(void)
     }
 
     cat_queue_init(&CAT_EVENT_G(runtime_shutdown_tasks));
-    cat_queue_init(&CAT_EVENT_G(defer_tasks));
+    memset(&CAT_EVENT_G(defer), 0, sizeof(CAT_EVENT_G(defer)));
+
+    cat_time_runtime_init();
+#ifdef CAT_IO_URING
+    (void) cat_io_uring_runtime_init();
+#endif
 
     return cat_true;
 }
@@ -64,9 +81,16 @@ CAT_API cat_bool_t cat_event_runtime_shutdown(void)
         }
     } while (0);
 
+#ifdef CAT_IO_URING
+    /* close the ring before we close all handles */
+    (void) cat_io_uring_runtime_shutdown();
+#endif
+
+    cat_time_runtime_shutdown();
+
     /* we must call run to close all handles and clear defer tasks */
     cat_event_schedule();
-    CAT_ASSERT(cat_queue_empty(&CAT_EVENT_G(defer_tasks)));
+    CAT_ASSERT(CAT_EVENT_G(defer).count == 0);
 
     return cat_true;
 }
@@ -87,30 +111,49 @@ CAT_API cat_bool_t cat_event_runtime_close(void)
         return cat_false;
     }
 
+    if (CAT_EVENT_G(defer).tasks != NULL) {
+        cat_free(CAT_EVENT_G(defer).tasks);
+        CAT_EVENT_G(defer).tasks = NULL;
+        CAT_EVENT_G(defer).capacity = 0;
+    }
+
     return cat_true;
 }
 
 static void cat_event_do_defer_tasks(void)
 {
     uint64_t current_round = CAT_EVENT_G(loop).round;
-    cat_queue_t *tasks = &CAT_EVENT_G(defer_tasks);
-    cat_event_task_t *task;
-
-    while ((task = cat_queue_front_data(tasks, cat_event_task_t, node)) != NULL) {
+    uint64_t n = 0;
+
+    /* callbacks may defer new tasks and grow the queue,
+     * so never cache the slot pointer across calls */
+    while (CAT_EVENT_G(defer).count != 0) {
+        cat_event_defer_task_t *task = &CAT_EVENT_G(defer).tasks[CAT_EVENT_G(defer).head];
+        cat_data_callback_t callback;
+        cat_data_t *data;
         if (task->round == current_round) {
             /* must be triggered in the next round */
             break;
         }
-        cat_queue_remove(&task->node);
-        task->callback(task->data);
-        cat_free(task);
+        callback = task->callback;
+        data = task->data;
+        CAT_EVENT_G(defer).head = (CAT_EVENT_G(defer).head + 1) & (CAT_EVENT_G(defer).capacity - 1);
+        CAT_EVENT_G(defer).count--;
+        n++;
+        callback(data);
+    }
+
+    CAT_EVENT_G(defer).last_round = n;
+    if (n > CAT_EVENT_G(defer).peak_round) {
+        CAT_EVENT_G(defer).peak_round = n;
     }
+    CAT_EVENT_G(defer).total += n;
 }
 
 static int cat_event_alive_callback(uv_loop_t *loop)
 {
     (void) loop;
-    return !cat_queue_empty(&CAT_EVENT_G(defer_tasks));
+    return CAT_EVENT_G(defer).count != 0;
 }
 
 static void cat_event_defer_callback(uv_loop_t *loop)
@@ -176,28 +219,78 @@ CAT_API cat_bool_t cat_event_defer(cat_data_callback_t callback, cat_data_t *dat
     return cat_event_defer_ex(callback, data, cat_false);
 }
 
-CAT_API cat_bool_t cat_event_defer_ex(cat_data_callback_t callback, cat_data_t *data, cat_bool_t high_priority)
+static cat_bool_t cat_event_defer_queue_grow(void)
 {
-    cat_event_task_t *task = (cat_event_task_t *) cat_malloc(sizeof(*task));
-
+    cat_event_defer_task_t *tasks;
+    uint32_t capacity = CAT_EVENT_G(defer).capacity;
+    uint32_t new_capacity, head, count, n;
+
+    if (capacity == 0) {
+        new_capacity = CAT_EVENT_DEFER_QUEUE_INITIAL_SIZE;
+    } else if (unlikely(capacity > (UINT32_MAX >> 1))) {
+        cat_update_last_error(CAT_ENOMEM, "Too many defer tasks");
+        return cat_false;
+    } else {
+        new_capacity = capacity << 1;
+    }
+    tasks = (cat_event_defer_task_t *) cat_malloc(sizeof(*tasks) * new_capacity);
 #if CAT_ALLOC_HANDLE_ERRORS
-    if (unlikely(task == NULL)) {
-        cat_update_last_error_of_syscall("Malloc for defer task failed");
+    if (unlikely(tasks == NULL)) {
+        cat_update_last_error_of_syscall("Malloc for defer tasks failed");
         return cat_false;
     }
 #endif
-    task->round = CAT_EVENT_G(loop).round;
-    task->callback = callback;
-    task->data = data;
+    /* unwrap the ring into the front of the new buffer */
+    head = CAT_EVENT_G(defer).head;
+    count = CAT_EVENT_G(defer).count;
+    n = count < capacity - head ? count : capacity - head;
+    if (n > 0) {
+        memcpy(tasks, CAT_EVENT_G(defer).tasks + head, sizeof(*tasks) * n);
+        memcpy(tasks + n, CAT_EVENT_G(defer).tasks, sizeof(*tasks) * (count - n));
+    }
+    if (CAT_EVENT_G(defer).tasks != NULL) {
+        cat_free(CAT_EVENT_G(defer).tasks);
+    }
+    CAT_EVENT_G(defer).tasks = tasks;
+    CAT_EVENT_G(defer).capacity = new_capacity;
+    CAT_EVENT_G(defer).head = 0;
+
+    return cat_true;
+}
+
+CAT_API cat_bool_t cat_event_defer_ex(cat_data_callback_t callback, cat_data_t *data, cat_bool_t high_priority)
+{
+    cat_event_defer_task_t *task;
+    uint32_t index;
+
+    if (unlikely(CAT_EVENT_G(defer).count == CAT_EVENT_G(defer).capacity)) {
+        if (unlikely(!cat_event_defer_queue_grow())) {
+            return cat_false;
+        }
+    }
     if (unlikely(high_priority)) {
-        cat_queue_push_front(&CAT_EVENT_G(defer_tasks), &task->node);
+        index = CAT_EVENT_G(defer).head = (CAT_EVENT_G(defer).head - 1) & (CAT_EVENT_G(defer).capacity - 1);
     } else {
-        cat_queue_push_back(&CAT_EVENT_G(defer_tasks), &task->node);
+        index = (CAT_EVENT_G(defer).head + CAT_EVENT_G(defer).count) & (CAT_EVENT_G(defer).capacity - 1);
     }
+    CAT_EVENT_G(defer).count++;
+    task = &CAT_EVENT_G(defer).tasks[index];
+    task->round = CAT_EVENT_G(loop).round;
+    task->callback = callback;
+    task->data = data;
 
     return cat_true;
 }
 
+CAT_API void cat_event_get_defer_info(cat_event_defer_info_t *info)
+{
+    info->pending = CAT_EVENT_G(defer).count;
+    info->capacity = CAT_EVENT_G(defer).capacity;
+    info->last_round = CAT_EVENT_G(defer).last_round;
+    info->peak_round = CAT_EVENT_G(defer).peak_round;
+    info->total = CAT_EVENT_G(defer).total;
+}
+
 CAT_API void cat_event_fork(void)
 {
 #ifndef CAT_COROUTINE_USE_THREAD_CONTEXT
@@ -206,6 +299,9 @@ CAT_API void cat_event_fork(void)
     if (error != 0) {
         CAT_CORE_ERROR_WITH_REASON(EVENT, error, "Event loop fork failed");
     }
+#ifdef CAT_IO_URING
+    cat_io_uring_fork();
+#endif
 #else
     CAT_ERROR(EVENT, "Function fork() is disabled for internal reasons when using thread-context");
 #endif
@@ -23,6 +23,7 @@
 #include "cat_time.h"
 #include "cat_work.h"
 #include "cat_async.h"
+#include "cat_io_uring.h"
 #ifdef CAT_OS_WIN
 # include <winternl.h>
 #endif // CAT_OS_WIN
@@ -137,6 +138,18 @@ static cat_bool_t cat_fs_do_result(cat_fs_context_t *context, int error, const c
 #define CAT_FS_DO_RESULT(return_type, operation, ...) \
         CAT_FS_DO_RESULT_EX({return -1;}, {return (return_type) context->fs.result;}, operation, __VA_ARGS__)
 
+#ifdef CAT_IO_URING
+/* io_uring returns CAT_ENOTSUP if it is disabled or unavailable, then we fall back to the threadpool */
+#define CAT_FS_TRY_IO_URING(return_type, call) do { \
+    return_type ret = (return_type) call; \
+    if (ret != (return_type) CAT_ENOTSUP) { \
+        return ret; \
+    } \
+} while (0)
+#else
+#define CAT_FS_TRY_IO_URING(return_type, call)
+#endif
+
 static void cat_fs_callback(uv_fs_t *fs)
 {
     cat_fs_context_t *context = cat_container_of(fs, cat_fs_context_t, fs);
@@ -198,6 +211,7 @@ CAT_API cat_file_t cat_fs_open(const char *_path, int flags, ...)
 
     wrappath(_path, path);
 
+    CAT_FS_TRY_IO_URING(cat_file_t, cat_io_uring_open(path, flags, mode));
     CAT_FS_DO_RESULT(cat_file_t, open, path, flags, mode);
 }
 
@@ -205,6 +219,7 @@ CAT_API ssize_t cat_fs_pread(cat_file_t fd, void *buffer, size_t size, off_t off
 {
     uv_buf_t buf = uv_buf_init((char *) buffer, (unsigned int) size);
 
+    CAT_FS_TRY_IO_URING(ssize_t, cat_io_uring_read(fd, buffer, size, offset));
     CAT_FS_DO_RESULT(ssize_t, read, fd, &buf, 1, offset);
 }
 
@@ -212,21 +227,25 @@ CAT_API ssize_t cat_fs_pwrite(cat_file_t fd, const void *buffer, size_t length,
 {
     uv_buf_t buf = uv_buf_init((char *) buffer, (unsigned int) length);
 
+    CAT_FS_TRY_IO_URING(ssize_t, cat_io_uring_write(fd, buffer, length, offset));
     CAT_FS_DO_RESULT(ssize_t, write, fd, &buf, 1, offset);
 }
 
 CAT_API int cat_fs_close(cat_file_t fd)
 {
+    CAT_FS_TRY_IO_URING(int, cat_io_uring_close(fd));
     CAT_FS_DO_RESULT(int, close, fd);
 }
 
 CAT_API int cat_fs_fsync(cat_file_t fd)
 {
+    CAT_FS_TRY_IO_URING(int, cat_io_uring_fsync(fd, cat_false));
     CAT_FS_DO_RESULT(int, fsync, fd);
 }
 
 CAT_API int cat_fs_fdatasync(cat_file_t fd)
 {
+    CAT_FS_TRY_IO_URING(int, cat_io_uring_fsync(fd, cat_true));
     CAT_FS_DO_RESULT(int, fdatasync, fd);
 }
 
@@ -366,17 +385,20 @@ CAT_API int cat_fs_access(const char *_path, int mode)
 CAT_API int cat_fs_stat(const char *_path, cat_stat_t *buf)
 {
     wrappath(_path, path);
+    CAT_FS_TRY_IO_URING(int, cat_io_uring_stat(-1, path, cat_true, buf));
     CAT_FS_DO_STAT(stat, path);
 }
 
 CAT_API int cat_fs_lstat(const char *_path, cat_stat_t *buf)
 {
     wrappath(_path, path);
+    CAT_FS_TRY_IO_URING(int, cat_io_uring_stat(-1, path, cat_false, buf));
     CAT_FS_DO_STAT(lstat, path);
 }
 
 CAT_API int cat_fs_fstat(cat_file_t fd, cat_stat_t *buf)
 {
+    CAT_FS_TRY_IO_URING(int, cat_io_uring_stat(fd, NULL, cat_false, buf));
     CAT_FS_DO_STAT(fstat, fd);
 }
 
@@ -513,6 +535,18 @@ CAT_API int cat_fs_mkstemp(const char *_tpl)
     }, mkstemp, tpl);
 }
 
+CAT_API int cat_fs_mkstemp_ex(char *_tpl)
+{
+    wrappath(_tpl, tpl);
+    CAT_FS_DO_RESULT_EX({return -1;}, {
+        size_t tpl_length = strlen(_tpl);
+        size_t path_length = strlen(context->fs.path);
+        /* only the trailing "XXXXXX" has been replaced */
+        memcpy(_tpl + tpl_length - 6, context->fs.path + path_length - 6, 6);
+        return (int) context->fs.result;
+    }, mkstemp, tpl);
+}
+
 CAT_API int cat_fs_statfs(const char *_path, cat_statfs_t *buf)
 {
     wrappath(_path, path);
@@ -749,6 +783,8 @@ static void cat_fs_read_cb(cat_data_t *ptr)
 
 CAT_API ssize_t cat_fs_read(cat_file_t fd, void *buf, size_t size)
 {
+    CAT_FS_TRY_IO_URING(ssize_t, cat_io_uring_read(fd, buf, size, -1));
+
     cat_fs_read_data_t *data = (cat_fs_read_data_t *) cat_malloc(sizeof(*data));
 #if CAT_ALLOC_HANDLE_ERRORS
     if (data == NULL) {
@@ -786,6 +822,8 @@ static void cat_fs_write_cb(cat_data_t *ptr)
 
 CAT_API ssize_t cat_fs_write(cat_file_t fd, const void *buf, size_t length)
 {
+    CAT_FS_TRY_IO_URING(ssize_t, cat_io_uring_write(fd, buf, length, -1));
+
     cat_fs_write_data_t *data = (cat_fs_write_data_t *) cat_malloc(sizeof(*data));
 #if CAT_ALLOC_HANDLE_ERRORS
     if (data == NULL) {
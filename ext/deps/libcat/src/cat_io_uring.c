@@ -0,0 +1,649 @@
+/*
+  +--------------------------------------------------------------------------+
+  | libcat                                                                   |
+  +--------------------------------------------------------------------------+
+  | Licensed under the Apache License, Version 2.0 (the "License");          |
+  | you may not use this file except in compliance with the License.         |
+  | You may obtain a copy of the License at                                  |
+  | http://www.apache.org/licenses/LICENSE-2.0                               |
+  | Unless required by applicable law or agreed to in writing, software      |
+  | distributed under the License is distributed on an "AS IS" BASIS,        |
+  | WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. |
+  | See the License for the specific language governing permissions and      |
+  | limitations under the License. See accompanying LICENSE file.            |
+  +--------------------------------------------------------------------------+
+  | Author: Twosee <twosee@php.net>                                          |
+  +--------------------------------------------------------------------------+
+ */
+
+#include "cat_io_uring.h"
+
+#ifdef CAT_IO_URING
+
+#include "cat_coroutine.h"
+#include "cat_event.h"
+#include "cat_time.h"
+
+/* for struct uv__statx */
+#ifdef CAT_IDE_HELPER
+#include "unix/internal.h"
+#else
+#include "../deps/libuv/src/unix/internal.h"
+#endif
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/sysmacros.h>
+
+#ifndef CAT_IO_URING_ENTRIES
+#define CAT_IO_URING_ENTRIES 256
+#endif
+
+typedef enum cat_io_uring_state_e {
+    CAT_IO_URING_STATE_UNKNOWN = 0,
+    CAT_IO_URING_STATE_AVAILABLE,
+    CAT_IO_URING_STATE_UNAVAILABLE,
+} cat_io_uring_state_t;
+
+typedef struct cat_io_uring_request_s {
+    cat_queue_t node;
+    /* NULL means it was canceled, then it will be released on completion */
+    cat_coroutine_t *coroutine;
+    int result;
+    cat_bool_t done;
+    struct uv__statx statxbuf;
+} cat_io_uring_request_t;
+
+typedef struct cat_io_uring_s {
+    int fd;
+    unsigned int sq_entries;
+    void *sq_ring;
+    size_t sq_ring_size;
+    void *cq_ring;
+    size_t cq_ring_size;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+    unsigned int *sq_head;
+    unsigned int *sq_tail;
+    unsigned int *sq_mask;
+    unsigned int *sq_array;
+    unsigned int *cq_head;
+    unsigned int *cq_tail;
+    unsigned int *cq_mask;
+    struct io_uring_cqe *cqes;
+    /* prepared but not submitted */
+    unsigned int sq_pending;
+    /* submitted requests which are waiting for completion */
+    cat_queue_t requests;
+    size_t request_count;
+    /* submit all prepared requests at once in the next loop iteration */
+    uv_idle_t flusher;
+    /* the ring fd is readable when there are completions */
+    uv_poll_t poller;
+    uint8_t handle_count;
+} cat_io_uring_t;
+
+CAT_GLOBALS_STRUCT_BEGIN(cat_io_uring) {
+    cat_bool_t enabled;
+    cat_io_uring_state_t state;
+    cat_io_uring_t *ring;
+} CAT_GLOBALS_STRUCT_END(cat_io_uring);
+
+CAT_GLOBALS_DECLARE(cat_io_uring);
+
+#define CAT_IO_URING_G(x) CAT_GLOBALS_GET(cat_io_uring, x)
+
+static int cat_io_uring__setup(unsigned int entries, struct io_uring_params *params)
+{
+    return (int) syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int cat_io_uring__enter(int fd, unsigned int to_submit, unsigned int min_complete, unsigned int flags)
+{
+    return (int) syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int cat_io_uring__register(int fd, unsigned int opcode, void *arg, unsigned int nr_args)
+{
+    return (int) syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+static cat_bool_t cat_io_uring_probe(int fd)
+{
+    static const uint8_t required_ops[] = {
+        IORING_OP_READ, IORING_OP_WRITE, IORING_OP_OPENAT, IORING_OP_CLOSE,
+        IORING_OP_STATX, IORING_OP_FSYNC, IORING_OP_ASYNC_CANCEL,
+    };
+    size_t size = sizeof(struct io_uring_probe) + IORING_OP_LAST * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe *probe;
+    cat_bool_t ret = cat_false;
+    size_t n;
+
+    probe = (struct io_uring_probe *) cat_malloc(size);
+#if CAT_ALLOC_HANDLE_ERRORS
+    if (unlikely(probe == NULL)) {
+        return cat_false;
+    }
+#endif
+    memset(probe, 0, size);
+    if (cat_io_uring__register(fd, IORING_REGISTER_PROBE, probe, IORING_OP_LAST) != 0) {
+        goto _out;
+    }
+    for (n = 0; n < CAT_ARRAY_SIZE(required_ops); n++) {
+        uint8_t op = required_ops[n];
+        if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+            CAT_LOG_DEBUG(IO_URING, "Operation %u is not supported", (unsigned int) op);
+            goto _out;
+        }
+    }
+    ret = cat_true;
+    _out:
+    cat_free(probe);
+    return ret;
+}
+
+static void cat_io_uring_unmap(cat_io_uring_t *ring)
+{
+    if (ring->sqes != NULL) {
+        (void) munmap(ring->sqes, ring->sqes_size);
+    }
+    if (ring->cq_ring != NULL && ring->cq_ring != ring->sq_ring) {
+        (void) munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    if (ring->sq_ring != NULL) {
+        (void) munmap(ring->sq_ring, ring->sq_ring_size);
+    }
+    if (ring->fd != -1) {
+        (void) uv__close(ring->fd);
+    }
+}
+
+static unsigned int cat_io_uring_reap(cat_io_uring_t *ring)
+{
+    unsigned int head = *ring->cq_head;
+    unsigned int tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    unsigned int count = tail - head;
+
+    while (head != tail) {
+        struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+        cat_io_uring_request_t *request = (cat_io_uring_request_t *) (uintptr_t) cqe->user_data;
+        head++;
+        /* cancel requests do not have a context */
+        if (request == NULL) {
+            continue;
+        }
+        cat_queue_remove(&request->node);
+        ring->request_count--;
+        if (request->coroutine == NULL) {
+            CAT_LOG_DEBUG(IO_URING, "Release canceled request %p", request);
+            cat_free(request);
+            continue;
+        }
+        request->result = cqe->res;
+        request->done = cat_true;
+        cat_coroutine_t *coroutine = request->coroutine;
+        request->coroutine = NULL;
+        cat_coroutine_schedule(coroutine, IO_URING, "IO uring");
+    }
+    __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+
+    if (ring->request_count == 0) {
+        uv_unref((uv_handle_t *) &ring->poller);
+    }
+
+    return count;
+}
+
+static cat_bool_t cat_io_uring_flush(cat_io_uring_t *ring)
+{
+    while (ring->sq_pending > 0) {
+        int n = cat_io_uring__enter(ring->fd, ring->sq_pending, 0, 0);
+        if (unlikely(n < 0)) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno == EAGAIN || errno == EBUSY) && cat_io_uring_reap(ring) > 0) {
+                /* completion queue was full, try again after making room */
+                continue;
+            }
+            CAT_SYSCALL_FAILURE(WARNING, IO_URING, "IO uring submit failed");
+            return cat_false;
+        }
+        ring->sq_pending -= (unsigned int) n;
+    }
+    (void) uv_idle_stop(&ring->flusher);
+    return cat_true;
+}
+
+static void cat_io_uring_flusher_callback(uv_idle_t *flusher)
+{
+    cat_io_uring_t *ring = cat_container_of(flusher, cat_io_uring_t, flusher);
+
+    (void) cat_io_uring_flush(ring);
+}
+
+static void cat_io_uring_poller_callback(uv_poll_t *poller, int status, int events)
+{
+    cat_io_uring_t *ring = cat_container_of(poller, cat_io_uring_t, poller);
+    (void) status;
+    (void) events;
+
+    (void) cat_io_uring_reap(ring);
+}
+
+static void cat_io_uring_close_callback(uv_handle_t *handle)
+{
+    cat_io_uring_t *ring = (cat_io_uring_t *) handle->data;
+
+    if (--ring->handle_count == 0) {
+        cat_free(ring);
+    }
+}
+
+static cat_io_uring_t *cat_io_uring_create(void)
+{
+    struct io_uring_params params;
+    cat_io_uring_t *ring;
+    int error;
+
+    ring = (cat_io_uring_t *) cat_malloc(sizeof(*ring));
+#if CAT_ALLOC_HANDLE_ERRORS
+    if (unlikely(ring == NULL)) {
+        return NULL;
+    }
+#endif
+    memset(ring, 0, sizeof(*ring));
+    memset(&params, 0, sizeof(params));
+    ring->fd = cat_io_uring__setup(CAT_IO_URING_ENTRIES, &params);
+    if (ring->fd < 0) {
+        CAT_LOG_DEBUG(IO_URING, "io_uring_setup() failed, errno=%d", errno);
+        goto _error;
+    }
+    if (!cat_io_uring_probe(ring->fd)) {
+        goto _error;
+    }
+
+    ring->sq_entries = params.sq_entries;
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->sq_ring_size = ring->cq_ring_size = CAT_MAX(ring->sq_ring_size, ring->cq_ring_size);
+    }
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED) {
+        ring->sq_ring = NULL;
+        goto _error;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_ring = ring->sq_ring;
+    } else {
+        ring->cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+        if (ring->cq_ring == MAP_FAILED) {
+            ring->cq_ring = NULL;
+            goto _error;
+        }
+    }
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = (struct io_uring_sqe *) mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        ring->sqes = NULL;
+        goto _error;
+    }
+    ring->sq_head = (unsigned int *) ((char *) ring->sq_ring + params.sq_off.head);
+    ring->sq_tail = (unsigned int *) ((char *) ring->sq_ring + params.sq_off.tail);
+    ring->sq_mask = (unsigned int *) ((char *) ring->sq_ring + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned int *) ((char *) ring->sq_ring + params.sq_off.array);
+    ring->cq_head = (unsigned int *) ((char *) ring->cq_ring + params.cq_off.head);
+    ring->cq_tail = (unsigned int *) ((char *) ring->cq_ring + params.cq_off.tail);
+    ring->cq_mask = (unsigned int *) ((char *) ring->cq_ring + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *) ((char *) ring->cq_ring + params.cq_off.cqes);
+
+    error = uv_poll_init(&CAT_EVENT_G(loop), &ring->poller, ring->fd);
+    if (error != 0) {
+        CAT_LOG_DEBUG(IO_URING, "uv_poll_init() failed, error=%d", error);
+        goto _error;
+    }
+    ring->poller.data = ring;
+    (void) uv_idle_init(&CAT_EVENT_G(loop), &ring->flusher);
+    ring->flusher.data = ring;
+    ring->handle_count = 2;
+    (void) uv_poll_start(&ring->poller, UV_READABLE, cat_io_uring_poller_callback);
+    /* only pending requests keep the loop alive */
+    uv_unref((uv_handle_t *) &ring->poller);
+    cat_queue_init(&ring->requests);
+
+    CAT_LOG_DEBUG(IO_URING, "IO uring created, fd=%d, entries=%u, features=%u", ring->fd, params.sq_entries, params.features);
+
+    return ring;
+
+    _error:
+    cat_io_uring_unmap(ring);
+    cat_free(ring);
+    return NULL;
+}
+
+static void cat_io_uring_destroy(cat_io_uring_t *ring, cat_bool_t forked)
+{
+    cat_io_uring_request_t *request;
+
+    while ((request = cat_queue_front_data(&ring->requests, cat_io_uring_request_t, node))) {
+        cat_queue_remove(&request->node);
+        if (request->coroutine == NULL) {
+            cat_free(request);
+            continue;
+        }
+        if (forked) {
+            /* like works of the threadpool, they are lost in the child process */
+            continue;
+        }
+        /* wake up waiters, their requests will never complete on this ring */
+        request->result = CAT_ECANCELED;
+        request->done = cat_true;
+        cat_coroutine_t *coroutine = request->coroutine;
+        request->coroutine = NULL;
+        cat_coroutine_schedule(coroutine, IO_URING, "IO uring");
+    }
+    uv_close((uv_handle_t *) &ring->poller, cat_io_uring_close_callback);
+    uv_close((uv_handle_t *) &ring->flusher, cat_io_uring_close_callback);
+    /* handles no longer watch the fd after uv_close() */
+    if (!forked) {
+        cat_io_uring_unmap(ring);
+    } else {
+        /* the inherited mappings are still shared with the parent,
+         * unmapping them in the child and reusing the address range
+         * corrupts the rings of the parent on some kernels, so just leave them */
+        (void) uv__close(ring->fd);
+    }
+}
+
+CAT_API cat_bool_t cat_io_uring_module_init(void)
+{
+    CAT_GLOBALS_REGISTER(cat_io_uring);
+    return cat_true;
+}
+
+CAT_API cat_bool_t cat_io_uring_module_shutdown(void)
+{
+    CAT_GLOBALS_UNREGISTER(cat_io_uring);
+    return cat_true;
+}
+
+CAT_API cat_bool_t cat_io_uring_runtime_init(void)
+{
+    CAT_IO_URING_G(enabled) = cat_env_is_true("CAT_IO_URING", cat_false);
+    CAT_IO_URING_G(state) = CAT_IO_URING_STATE_UNKNOWN;
+    CAT_IO_URING_G(ring) = NULL;
+    return cat_true;
+}
+
+CAT_API cat_bool_t cat_io_uring_runtime_shutdown(void)
+{
+    cat_io_uring_t *ring = CAT_IO_URING_G(ring);
+
+    if (ring != NULL) {
+        CAT_IO_URING_G(ring) = NULL;
+        cat_io_uring_destroy(ring, cat_false);
+    }
+    CAT_IO_URING_G(state) = CAT_IO_URING_STATE_UNKNOWN;
+    return cat_true;
+}
+
+CAT_API cat_bool_t cat_io_uring_is_enabled(void)
+{
+    return CAT_IO_URING_G(enabled);
+}
+
+CAT_API void cat_io_uring_set_enabled(cat_bool_t enabled)
+{
+    CAT_IO_URING_G(enabled) = enabled;
+}
+
+static cat_io_uring_t *cat_io_uring_get(void)
+{
+    cat_io_uring_t *ring = CAT_IO_URING_G(ring);
+
+    if (likely(ring != NULL)) {
+        return ring;
+    }
+    if (!CAT_IO_URING_G(enabled) || CAT_IO_URING_G(state) == CAT_IO_URING_STATE_UNAVAILABLE) {
+        return NULL;
+    }
+    ring = cat_io_uring_create();
+    if (ring == NULL) {
+        CAT_LOG_DEBUG(IO_URING, "IO uring is unavailable, fall back to the threadpool");
+        CAT_IO_URING_G(state) = CAT_IO_URING_STATE_UNAVAILABLE;
+        return NULL;
+    }
+    CAT_IO_URING_G(state) = CAT_IO_URING_STATE_AVAILABLE;
+    CAT_IO_URING_G(ring) = ring;
+
+    return ring;
+}
+
+CAT_API cat_bool_t cat_io_uring_is_available(void)
+{
+    return cat_io_uring_get() != NULL;
+}
+
+CAT_API void cat_io_uring_fork(void)
+{
+    cat_io_uring_t *ring = CAT_IO_URING_G(ring);
+
+    if (ring != NULL) {
+        /* the ring is shared with the parent, completions may be reaped by either side */
+        CAT_IO_URING_G(ring) = NULL;
+        CAT_IO_URING_G(state) = CAT_IO_URING_STATE_UNKNOWN;
+        cat_io_uring_destroy(ring, cat_true);
+    }
+}
+
+static struct io_uring_sqe *cat_io_uring_get_sqe(cat_io_uring_t *ring)
+{
+    unsigned int head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    struct io_uring_sqe *sqe;
+    unsigned int index;
+
+    if (*ring->sq_tail - head >= ring->sq_entries) {
+        /* submission queue is full, submit prepared requests right now */
+        if (!cat_io_uring_flush(ring)) {
+            return NULL;
+        }
+        head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+        if (*ring->sq_tail - head >= ring->sq_entries) {
+            return NULL;
+        }
+    }
+    index = *ring->sq_tail & *ring->sq_mask;
+    sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    ring->sq_array[index] = index;
+
+    return sqe;
+}
+
+static void cat_io_uring_push_sqe(cat_io_uring_t *ring)
+{
+    __atomic_store_n(ring->sq_tail, *ring->sq_tail + 1, __ATOMIC_RELEASE);
+    if (ring->sq_pending++ == 0) {
+        (void) uv_idle_start(&ring->flusher, cat_io_uring_flusher_callback);
+    }
+}
+
+static int cat_io_uring_wait(cat_io_uring_t *ring, cat_io_uring_request_t *request, const char *operation)
+{
+    cat_bool_t ret;
+    int result;
+
+    cat_queue_push_back(&ring->requests, &request->node);
+    if (ring->request_count++ == 0) {
+        uv_ref((uv_handle_t *) &ring->poller);
+    }
+    request->coroutine = CAT_COROUTINE_G(current);
+    ret = cat_time_wait(CAT_TIMEOUT_FOREVER);
+    if (unlikely(!request->done)) {
+        struct io_uring_sqe *sqe;
+        /* the request will be released on completion */
+        request->coroutine = NULL;
+        if (!ret) {
+            cat_update_last_error_with_previous("File-System %s wait failed", operation);
+        } else {
+            cat_update_last_error(CAT_ECANCELED, "File-System %s has been canceled", operation);
+        }
+        errno = cat_orig_errno(cat_get_last_error_code());
+        /* the request may be still in the submission queue */
+        if (cat_io_uring_flush(ring) && (sqe = cat_io_uring_get_sqe(ring)) != NULL) {
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->fd = -1;
+            sqe->addr = (uint64_t) (uintptr_t) request;
+            sqe->user_data = 0;
+            cat_io_uring_push_sqe(ring);
+            /* submit it right now, the buffer may be reused by the caller soon */
+            (void) cat_io_uring_flush(ring);
+        }
+        CAT_LOG_DEBUG(IO_URING, "Failed %s() request=%p canceled", operation, request);
+        return -1;
+    }
+    result = request->result;
+    if (unlikely(result < 0)) {
+        cat_update_last_error_with_reason((cat_errno_t) result, "File-System %s failed", operation);
+        errno = cat_orig_errno((cat_errno_t) result);
+        CAT_LOG_DEBUG(IO_URING, "Failed %s() request=%p, uv_errno=%d", operation, request, result);
+        return -1;
+    }
+    CAT_LOG_DEBUG(IO_URING, "Done %s() request=%p, result=%d", operation, request, result);
+    return result;
+}
+
+#define CAT_IO_URING_DO(on_prepare, on_done, operation) do { \
+    cat_io_uring_t *ring = cat_io_uring_get(); \
+    cat_io_uring_request_t *request; \
+    struct io_uring_sqe *sqe; \
+    int result; \
+    if (ring == NULL) { \
+        return CAT_ENOTSUP; \
+    } \
+    request = (cat_io_uring_request_t *) cat_malloc(sizeof(*request)); \
+    if (unlikely(request == NULL)) { \
+        return CAT_ENOTSUP; \
+    } \
+    request->coroutine = NULL; \
+    request->result = 0; \
+    request->done = cat_false; \
+    sqe = cat_io_uring_get_sqe(ring); \
+    if (unlikely(sqe == NULL)) { \
+        cat_free(request); \
+        return CAT_ENOTSUP; \
+    } \
+    CAT_LOG_DEBUG(IO_URING, "Start " operation "() request=%p", request); \
+    on_prepare \
+    sqe->user_data = (uint64_t) (uintptr_t) request; \
+    cat_io_uring_push_sqe(ring); \
+    result = cat_io_uring_wait(ring, request, operation); \
+    if (result < 0) { \
+        if (request->done) { \
+            cat_free(request); \
+        } \
+        return -1; \
+    } \
+    on_done \
+    cat_free(request); \
+    return result; \
+} while (0)
+
+CAT_API int cat_io_uring_open(const char *path, int flags, int mode)
+{
+    CAT_IO_URING_DO({
+        sqe->opcode = IORING_OP_OPENAT;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = (uint64_t) (uintptr_t) path;
+        sqe->len = (uint32_t) mode;
+        sqe->open_flags = (uint32_t) (flags | O_CLOEXEC);
+    }, {}, "open");
+}
+
+CAT_API int cat_io_uring_close(cat_file_t fd)
+{
+    CAT_IO_URING_DO({
+        sqe->opcode = IORING_OP_CLOSE;
+        sqe->fd = fd;
+    }, {}, "close");
+}
+
+CAT_API ssize_t cat_io_uring_read(cat_file_t fd, void *buffer, size_t size, int64_t offset)
+{
+    if (unlikely(size > INT_MAX)) {
+        size = INT_MAX;
+    }
+    CAT_IO_URING_DO({
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = fd;
+        sqe->addr = (uint64_t) (uintptr_t) buffer;
+        sqe->len = (uint32_t) size;
+        sqe->off = (uint64_t) offset;
+    }, {}, "read");
+}
+
+CAT_API ssize_t cat_io_uring_write(cat_file_t fd, const void *buffer, size_t length, int64_t offset)
+{
+    if (unlikely(length > INT_MAX)) {
+        length = INT_MAX;
+    }
+    CAT_IO_URING_DO({
+        sqe->opcode = IORING_OP_WRITE;
+        sqe->fd = fd;
+        sqe->addr = (uint64_t) (uintptr_t) buffer;
+        sqe->len = (uint32_t) length;
+        sqe->off = (uint64_t) offset;
+    }, {}, "write");
+}
+
+CAT_API int cat_io_uring_fsync(cat_file_t fd, cat_bool_t datasync)
+{
+    CAT_IO_URING_DO({
+        sqe->opcode = IORING_OP_FSYNC;
+        sqe->fd = fd;
+        sqe->fsync_flags = datasync ? IORING_FSYNC_DATASYNC : 0;
+    }, {}, "fsync");
+}
+
+CAT_API int cat_io_uring_stat(cat_file_t fd, const char *path, cat_bool_t follow_symlink, cat_stat_t *buf)
+{
+    CAT_IO_URING_DO({
+        sqe->opcode = IORING_OP_STATX;
+        if (path == NULL) {
+            sqe->fd = fd;
+            sqe->addr = (uint64_t) (uintptr_t) "";
+            sqe->statx_flags = AT_EMPTY_PATH;
+        } else {
+            sqe->fd = AT_FDCWD;
+            sqe->addr = (uint64_t) (uintptr_t) path;
+            sqe->statx_flags = follow_symlink ? 0 : AT_SYMLINK_NOFOLLOW;
+        }
+        sqe->len = 0xFFF; /* STATX_BASIC_STATS | STATX_BTIME */
+        sqe->off = (uint64_t) (uintptr_t) &request->statxbuf;
+    }, {
+        const struct uv__statx *statxbuf = &request->statxbuf;
+        buf->st_dev = makedev(statxbuf->stx_dev_major, statxbuf->stx_dev_minor);
+        buf->st_mode = statxbuf->stx_mode;
+        buf->st_nlink = statxbuf->stx_nlink;
+        buf->st_uid = statxbuf->stx_uid;
+        buf->st_gid = statxbuf->stx_gid;
+        buf->st_rdev = makedev(statxbuf->stx_rdev_major, statxbuf->stx_rdev_minor);
+        buf->st_ino = statxbuf->stx_ino;
+        buf->st_size = statxbuf->stx_size;
+        buf->st_blksize = statxbuf->stx_blksize;
+        buf->st_blocks = statxbuf->stx_blocks;
+        buf->st_atim.tv_sec = statxbuf->stx_atime.tv_sec;
+        buf->st_atim.tv_nsec = statxbuf->stx_atime.tv_nsec;
+        buf->st_mtim.tv_sec = statxbuf->stx_mtime.tv_sec;
+        buf->st_mtim.tv_nsec = statxbuf->stx_mtime.tv_nsec;
+        buf->st_ctim.tv_sec = statxbuf->stx_ctime.tv_sec;
+        buf->st_ctim.tv_nsec = statxbuf->stx_ctime.tv_nsec;
+        buf->st_birthtim.tv_sec = statxbuf->stx_btime.tv_sec;
+        buf->st_birthtim.tv_nsec = statxbuf->stx_btime.tv_nsec;
+        buf->st_flags = 0;
+        buf->st_gen = 0;
+    }, "stat");
+}
+
+#endif /* CAT_IO_URING */
@@ -472,6 +472,13 @@ CAT_API cat_bool_t cat_socket_runtime_init(void)
     CAT_SOCKET_G(last_id) = 0;
     CAT_SOCKET_G(options.timeout) = cat_socket_default_global_timeout_options;
     CAT_SOCKET_G(options.tcp_keepalive_delay) = 60;
+    (void) cat_socket_set_global_inline_read_mode(CAT_SOCKET_TYPE_ANY, CAT_SOCKET_INLINE_READ_MODE_DEFAULT);
+    cat_queue_init(&CAT_SOCKET_G(cork.queue));
+    CAT_SOCKET_G(cork.scheduled) = cat_false;
+
+    if (unlikely(!cat_dns_runtime_init())) {
+        return cat_false;
+    }
 
     return cat_true;
 }
@@ -621,6 +628,7 @@ static cat_always_inline cat_bool_t cat_socket_internal_is_established(cat_socke
 } while (0)
 
 static void cat_socket_internal_close(cat_socket_internal_t *socket_i, cat_bool_t unrecoverable_error);
+static void cat_socket_internal_cork_schedule_flush(cat_socket_internal_t *socket_i);
 
 static CAT_COLD void cat_socket_internal_unrecoverable_io_error(cat_socket_internal_t *socket_i);
 #ifdef CAT_SSL
@@ -974,7 +982,8 @@ static cat_always_inline cat_socket_t *cat_socket_create_impl(cat_socket_t *sock
     cat_queue_init(&socket_i->context.io.write.coroutines);
     /* part of cache */
     socket_i->cache.fd = CAT_SOCKET_INVALID_FD;
-    socket_i->cache.write_request = NULL;
+    socket_i->cache.write_requests = NULL;
+    socket_i->cache.write_request_count = 0;
     socket_i->cache.ipcc_handle_info = NULL;
     socket_i->cache.sockname = NULL;
     socket_i->cache.peername = NULL;
@@ -984,6 +993,17 @@ static cat_always_inline cat_socket_t *cat_socket_create_impl(cat_socket_t *sock
     socket_i->option_flags = CAT_SOCKET_OPTION_FLAG_NONE;
     socket_i->options.timeout = cat_socket_default_timeout_options;
     socket_i->options.tcp_keepalive_delay = 0;
+    socket_i->options.inline_read_mode = CAT_SOCKET_INLINE_READ_MODE_DEFAULT;
+    memset(&socket_i->inline_read, 0, sizeof(socket_i->inline_read));
+    cat_buffer_init(&socket_i->cork.buffer);
+    socket_i->cork.threshold = 0;
+    socket_i->cork.auto_flush = cat_false;
+    cat_queue_init(&socket_i->cork.node);
+    socket_i->cork.error = 0;
+#ifdef CAT_SOCKET_ZEROCOPY
+    socket_i->zerocopy.threshold = 0;
+    socket_i->zerocopy.pending = 0;
+#endif
 #ifdef CAT_SSL
     socket_i->ssl = NULL;
     socket_i->ssl_peer_name = NULL;
@@ -1320,6 +1340,78 @@ CAT_SOCKET_TIMEOUT_API_GEN(write)
 
 #undef CAT_SOCKET_TIMEOUT_API_GEN
 
+/* inline read */
+
+#define CAT_SOCKET_INLINE_READ_MISS_THRESHOLD 4
+#define CAT_SOCKET_INLINE_READ_MAX_BACKOFF    6 /* skip 64 reads at most */
+
+static const cat_socket_type_t cat_socket_inline_read_types[] = {
+    CAT_SOCKET_TYPE_TCP, CAT_SOCKET_TYPE_PIPE, CAT_SOCKET_TYPE_UDP
+};
+
+static cat_always_inline int cat_socket_inline_read_type_index(cat_socket_type_t type)
+{
+    size_t i;
+
+    for (i = 0; i < CAT_ARRAY_SIZE(cat_socket_inline_read_types); i++) {
+        if ((type & cat_socket_inline_read_types[i]) == cat_socket_inline_read_types[i]) {
+            return (int) i;
+        }
+    }
+
+    return -1;
+}
+
+CAT_API cat_socket_inline_read_mode_t cat_socket_get_global_inline_read_mode(cat_socket_type_t type)
+{
+    int index = cat_socket_inline_read_type_index(type);
+
+    if (unlikely(index < 0)) {
+        return CAT_SOCKET_INLINE_READ_MODE_DEFAULT;
+    }
+
+    return CAT_SOCKET_G(options.inline_read_modes)[index];
+}
+
+CAT_API cat_bool_t cat_socket_set_global_inline_read_mode(cat_socket_type_t type, cat_socket_inline_read_mode_t mode)
+{
+    cat_bool_t matched = cat_false;
+    size_t i;
+
+    if (unlikely(mode < CAT_SOCKET_INLINE_READ_MODE_DEFAULT || mode > CAT_SOCKET_INLINE_READ_MODE_NEVER)) {
+        cat_update_last_error(CAT_EINVAL, "Socket inline read mode %d is invalid", (int) mode);
+        return cat_false;
+    }
+    if (mode == CAT_SOCKET_INLINE_READ_MODE_DEFAULT) {
+        mode = CAT_SOCKET_INLINE_READ_MODE_ADAPTIVE;
+    }
+    for (i = 0; i < CAT_ARRAY_SIZE(cat_socket_inline_read_types); i++) {
+        if (type == CAT_SOCKET_TYPE_ANY ||
+            (type & cat_socket_inline_read_types[i]) == cat_socket_inline_read_types[i]) {
+            CAT_SOCKET_G(options.inline_read_modes)[i] = mode;
+            matched = cat_true;
+        }
+    }
+    if (unlikely(!matched)) {
+        cat_update_last_error(CAT_EINVAL, "Socket type %s does not support inline read mode", cat_socket_type_get_name(type));
+        return cat_false;
+    }
+
+    return cat_true;
+}
+
+static cat_always_inline cat_socket_inline_read_mode_t cat_socket_internal_get_inline_read_mode(const cat_socket_internal_t *socket_i)
+{
+    cat_socket_inline_read_mode_t mode = socket_i->options.inline_read_mode;
+
+    if (mode == CAT_SOCKET_INLINE_READ_MODE_DEFAULT) {
+        int index = cat_socket_inline_read_type_index(socket_i->type);
+        mode = likely(index >= 0) ? CAT_SOCKET_G(options.inline_read_modes)[index] : CAT_SOCKET_INLINE_READ_MODE_ALWAYS;
+    }
+
+    return mode;
+}
+
 #ifdef CAT_ENABLE_DEBUG_LOG
 static CAT_BUFFER_STR_FREE char *cat_socket_bind_flags_str(cat_socket_bind_flags_t flags)
 {
@@ -1539,31 +1631,46 @@ CAT_API cat_bool_t cat_socket_listen(cat_socket_t *socket, int backlog)
     return ret;
 }
 
+static cat_always_inline void cat_socket_internal_on_accepted(
+    cat_socket_internal_t *iserver, cat_socket_internal_t *iconnection,
+    const cat_socket_inheritance_info_t *handle_info
+) {
+    /* init client properties */
+    iconnection->flags |= (CAT_SOCKET_INTERNAL_FLAG_ESTABLISHED | CAT_SOCKET_INTERNAL_FLAG_SERVER_CONNECTION);
+    /* TODO: socket_extends() ? */
+    memcpy(&iconnection->options, handle_info == NULL ? &iserver->options : &handle_info->options, sizeof(iconnection->options));
+    cat_socket_internal_on_open(iconnection, cat_socket_type_to_af(handle_info == NULL ? iserver->type : handle_info->type));
+}
+
+static cat_always_inline cat_bool_t cat_socket_internal_accept_check_type(cat_socket_internal_t *iserver, cat_socket_internal_t *iconnection)
+{
+    cat_socket_type_t server_type = cat_socket_type_simplify(iserver->type);
+    cat_socket_type_t connection_type = iconnection->type;
+
+    if (unlikely((server_type & connection_type) != server_type)) {
+        cat_update_last_error(CAT_EINVAL, "Socket accept connection type mismatch, expect %s but got %s",
+            cat_socket_type_get_name(server_type), cat_socket_type_get_name(connection_type));
+        return cat_false;
+    }
+
+    return cat_true;
+}
+
 static cat_bool_t cat_socket_internal_accept(
     cat_socket_internal_t *iserver, cat_socket_internal_t *iconnection,
     cat_socket_inheritance_info_t *handle_info, cat_timeout_t timeout
 ) {
     int error;
 
-    if (handle_info == NULL) {
-        cat_socket_type_t server_type = cat_socket_type_simplify(iserver->type);
-        cat_socket_type_t connection_type = iconnection->type;
-        if (unlikely((server_type & connection_type) != server_type)) {
-            cat_update_last_error(CAT_EINVAL, "Socket accept connection type mismatch, expect %s but got %s",
-                cat_socket_type_get_name(server_type), cat_socket_type_get_name(connection_type));
-            return cat_false;
-        }
+    if (handle_info == NULL && unlikely(!cat_socket_internal_accept_check_type(iserver, iconnection))) {
+        return cat_false;
     }
 
     while (1) {
         cat_bool_t ret;
         error = uv_accept(&iserver->u.stream, &iconnection->u.stream);
         if (error == 0) {
-            /* init client properties */
-            iconnection->flags |= (CAT_SOCKET_INTERNAL_FLAG_ESTABLISHED | CAT_SOCKET_INTERNAL_FLAG_SERVER_CONNECTION);
-            /* TODO: socket_extends() ? */
-            memcpy(&iconnection->options, handle_info == NULL ? &iserver->options : &handle_info->options, sizeof(iconnection->options));
-            cat_socket_internal_on_open(iconnection, cat_socket_type_to_af(handle_info == NULL ? iserver->type : handle_info->type));
+            cat_socket_internal_on_accepted(iserver, iconnection, handle_info);
             return cat_true;
         }
         if (unlikely(error != CAT_EAGAIN)) {
@@ -1648,6 +1755,75 @@ CAT_API cat_bool_t cat_socket_accept_ex(cat_socket_t *server, cat_socket_t *conn
     return ret;
 }
 
+static cat_always_inline cat_bool_t cat_socket_try_accept_impl(cat_socket_t *server, cat_socket_t *connection)
+{
+    CAT_SOCKET_INTERNAL_GETTER_WITH_IO(server, iserver, CAT_SOCKET_IO_FLAG_ACCEPT, return cat_false);
+    CAT_SOCKET_INTERNAL_SERVER_ONLY(iserver, return cat_false);
+    int error;
+
+    if (unlikely(iserver->type & CAT_SOCKET_TYPE_FLAG_IPC)) {
+        cat_update_last_error(CAT_EMISUSE, "Socket try_accept can not act on an IPC socket");
+        return cat_false;
+    }
+    CAT_SOCKET_INTERNAL_GETTER_SILENT(connection, iconnection, {
+        cat_update_last_error(CAT_EINVAL, "Socket accept can not act on an unavailable socket");
+        return cat_false;
+    });
+    if (unlikely(cat_socket_is_open(connection))) {
+        cat_update_last_error(CAT_EMISUSE, "Socket accept can only act on a lazy socket");
+        return cat_false;
+    }
+    if (unlikely(!cat_socket_internal_accept_check_type(iserver, iconnection))) {
+        return cat_false;
+    }
+
+    /* take the connection which libuv has accepted in the last poll first */
+    error = uv_accept(&iserver->u.stream, &iconnection->u.stream);
+#ifdef CAT_OS_UNIX_LIKE
+    /* libuv accepts only one connection per poll,
+     * drain the rest of the kernel backlog directly instead of waiting for the next round */
+    while (error == CAT_EAGAIN) {
+        int fd = uv__accept(uv__stream_fd(&iserver->u.stream));
+        if (unlikely(fd < 0)) {
+            error = fd;
+            if (error == CAT_ECONNABORTED) {
+                error = CAT_EAGAIN;
+                continue;
+            }
+            break;
+        }
+        error = uv__stream_open(&iconnection->u.stream, fd, UV_HANDLE_READABLE | UV_HANDLE_WRITABLE);
+        if (unlikely(error != 0)) {
+            uv__close(fd);
+            break;
+        }
+        iconnection->u.handle.flags |= UV_HANDLE_BOUND;
+    }
+#endif
+    if (unlikely(error != 0)) {
+        if (error == CAT_EAGAIN) {
+            cat_update_last_error(CAT_EAGAIN, "Socket has no pending connection");
+        } else {
+            cat_update_last_error_with_reason(error, "Socket accept failed");
+        }
+        return cat_false;
+    }
+    cat_socket_internal_on_accepted(iserver, iconnection, NULL);
+
+    return cat_true;
+}
+
+CAT_API cat_bool_t cat_socket_try_accept(cat_socket_t *server, cat_socket_t *connection)
+{
+    cat_bool_t ret = cat_socket_try_accept_impl(server, connection);
+
+    CAT_LOG_DEBUG(SOCKET, "try_accept(" CAT_SOCKET_ID_FMT ") = " CAT_SOCKET_ID_FMT CAT_LOG_STRERRNO_FMT,
+        server->id, ret ? connection->id : CAT_SOCKET_INVALID_ID, CAT_LOG_STRERRNO_C(ret, cat_get_last_error_code()));
+    CAT_LOG_DEBUG_SOCKET_ESTABLISHED(connection, accepted, ret);
+
+    return ret;
+}
+
 static cat_always_inline void cat_socket_internal_on_connect_done(cat_socket_internal_t *socket_i, cat_sa_family_t af)
 {
     /* connect done successfully, we can do something here before transfer data */
@@ -2583,6 +2759,46 @@ static cat_always_inline cat_bool_t cat_socket_internal_support_inline_read(cons
            !(socket_i->u.handle.type == UV_NAMED_PIPE && socket_i->u.pipe.ipc);
 }
 
+#ifdef CAT_OS_UNIX_LIKE
+static cat_always_inline cat_bool_t cat_socket_internal_should_inline_read(cat_socket_internal_t *socket_i)
+{
+    switch (cat_socket_internal_get_inline_read_mode(socket_i)) {
+        case CAT_SOCKET_INLINE_READ_MODE_NEVER:
+            return cat_false;
+        case CAT_SOCKET_INLINE_READ_MODE_ADAPTIVE:
+            if (socket_i->inline_read.skips > 0) {
+                socket_i->inline_read.skips--;
+                return cat_false;
+            }
+            return cat_true;
+        default:
+            return cat_true;
+    }
+}
+
+static cat_always_inline void cat_socket_internal_on_inline_read_hit(cat_socket_internal_t *socket_i)
+{
+    socket_i->inline_read.stats.hits++;
+    socket_i->inline_read.misses = 0;
+    socket_i->inline_read.backoff = 0;
+}
+
+static cat_always_inline void cat_socket_internal_on_inline_read_miss(cat_socket_internal_t *socket_i)
+{
+    socket_i->inline_read.stats.misses++;
+    /* a miss right after a skip window starts the next (longer) one immediately */
+    if (++socket_i->inline_read.misses < CAT_SOCKET_INLINE_READ_MISS_THRESHOLD &&
+        socket_i->inline_read.backoff == 0) {
+        return;
+    }
+    socket_i->inline_read.misses = 0;
+    socket_i->inline_read.skips = (uint16_t) (1 << socket_i->inline_read.backoff);
+    if (socket_i->inline_read.backoff < CAT_SOCKET_INLINE_READ_MAX_BACKOFF) {
+        socket_i->inline_read.backoff++;
+    }
+}
+#endif
+
 static ssize_t cat_socket_internal_read_raw(
     cat_socket_internal_t *socket_i,
     char *buffer, size_t size,
@@ -2615,11 +2831,14 @@ static ssize_t cat_socket_internal_read_raw(
 #ifdef CAT_OS_UNIX_LIKE /* Do not inline read on WIN, proactor way is faster */
     /* Notice: when IO is low/slow, this is de-optimization,
      * because recv usually returns EAGAIN error,
-     * and there is an additional system call overhead */
+     * and there is an additional system call overhead,
+     * so it is skipped for a while if it keeps missing (see inline read mode) */
     if (likely(cat_socket_internal_support_inline_read(socket_i))) {
         cat_socket_fd_t fd = cat_socket_internal_get_fd_fast(socket_i);
         if (unlikely(fd == CAT_SOCKET_INVALID_FD)) {
             CAT_ASSERT(is_dgram && "only dgram fd creation is lazy");
+        } else if (!is_udg && !cat_socket_internal_should_inline_read(socket_i)) {
+            socket_i->inline_read.stats.skips++;
         } else while (1) {
             while (1) {
                 if (socket_i->flags & CAT_SOCKET_INTERNAL_FLAG_NOT_SOCK) {
@@ -2631,6 +2850,9 @@ static ssize_t cat_socket_internal_read_raw(
                 }
                 if (error < 0) {
                     if (likely(cat_sys_errno == EAGAIN)) {
+                        if (nread == 0 && !is_udg) {
+                            cat_socket_internal_on_inline_read_miss(socket_i);
+                        }
                         break;
                     }
                     if (unlikely(cat_sys_errno == EINTR)) {
@@ -2643,6 +2865,9 @@ static ssize_t cat_socket_internal_read_raw(
                     error = cat_translate_sys_error(cat_sys_errno);
                     goto _error;
                 }
+                if (!is_udg) {
+                    cat_socket_internal_on_inline_read_hit(socket_i);
+                }
                 if (once) {
                     return error;
                 }
@@ -2964,6 +3189,42 @@ static CAT_BUFFER_STR_FREE char *cat_socket_write_vector_str(const cat_socket_wr
     return cat_buffer_export_str(&buffer);
 }
 
+static cat_always_inline cat_socket_write_request_t *cat_socket_internal_acquire_write_request(cat_socket_internal_t *socket_i, cat_bool_t is_udp)
+{
+    cat_socket_write_request_t *request = socket_i->cache.write_requests;
+    size_t size;
+
+    if (likely(request != NULL)) {
+        socket_i->cache.write_requests = request->next;
+        socket_i->cache.write_request_count--;
+        return request;
+    }
+    if (!is_udp) {
+        size = cat_offsize_of(cat_socket_write_request_t, u.stream);
+    } else {
+        size = cat_offsize_of(cat_socket_write_request_t, u.udp);
+    }
+    request = (cat_socket_write_request_t *) cat_malloc(size);
+#if CAT_ALLOC_HANDLE_ERRORS
+    if (unlikely(request == NULL)) {
+        cat_update_last_error_of_syscall("Malloc for write request failed");
+    }
+#endif
+
+    return request;
+}
+
+static cat_always_inline void cat_socket_internal_release_write_request(cat_socket_internal_t *socket_i, cat_socket_write_request_t *request)
+{
+    if (socket_i->cache.write_request_count < CAT_SOCKET_WRITE_REQUEST_CACHE_SIZE) {
+        request->next = socket_i->cache.write_requests;
+        socket_i->cache.write_requests = request;
+        socket_i->cache.write_request_count++;
+    } else {
+        cat_free(request);
+    }
+}
+
 /* IOCP/io_uring may not support wait writable */
 static cat_always_inline void cat_socket_internal_write_callback(cat_socket_internal_t *socket_i, cat_socket_write_request_t *request, int status)
 {
@@ -2976,9 +3237,7 @@ static cat_always_inline void cat_socket_internal_write_callback(cat_socket_inte
         cat_coroutine_schedule(coroutine, SOCKET, "Write");
     }
 
-    if (request != socket_i->cache.write_request) {
-        cat_free(request);
-    }
+    cat_socket_internal_release_write_request(socket_i, request);
 }
 
 static void cat_socket_write_callback(uv_write_t *request, int status)
@@ -3076,125 +3335,394 @@ static cat_never_inline cat_bool_t cat_socket_internal_udg_write(
 }
 #endif
 
-static cat_bool_t cat_socket_internal_write_raw(
-    cat_socket_internal_t *socket_i,
-    const cat_socket_write_vector_t *vector, unsigned int vector_count,
-    const cat_sockaddr_t *address, cat_socklen_t address_length,
-    cat_socket_t *send_handle,
-    cat_timeout_t timeout
-)
-{
-    CAT_SOCKET_CHECK_INPUT_ADDRESS(address, address_length, return cat_false);
-    cat_bool_t is_udp = ((socket_i->type & CAT_SOCKET_TYPE_UDP) == CAT_SOCKET_TYPE_UDP);
-    cat_bool_t is_dgram = (socket_i->type & CAT_SOCKET_TYPE_FLAG_DGRAM);
-    cat_bool_t ret = cat_false;
-    cat_socket_write_request_t *request;
-    size_t context_size;
-    ssize_t error;
+/* direct write: data is written on the fd by ourselves instead of libuv (e.g. sendfile(2) or MSG_ZEROCOPY),
+ * other writes must wait for it to avoid interleaving */
 
-#ifdef CAT_OS_UNIX_LIKE
-    /* libuv does not support dynamic address length */
-    CAT_ASSERT(
-        (!is_udp || address == NULL || address->sa_family != AF_UNIX || address_length >= sizeof(struct sockaddr_un)) &&
-        "Socket does not support variable size UNIX address on UDP"
-    );
-    if (is_dgram && !is_udp) {
-        ret = cat_socket_internal_udg_write(socket_i, vector, vector_count, address, address_length, timeout);
-        goto _out;
-    }
-#endif
+static cat_never_inline cat_bool_t cat_socket_internal_wait_direct_write(cat_socket_internal_t *socket_i, cat_timeout_t timeout)
+{
+    cat_queue_t *queue = &socket_i->context.io.write.coroutines;
+    cat_bool_t ret;
 
-    if (!(socket_i->io_flags & CAT_SOCKET_IO_FLAG_WRITE)) {
-        request = socket_i->cache.write_request;
-    } else {
-        request = NULL;
-    }
-    if (unlikely(request == NULL)) {
-        /* why we do not try write: on high-traffic scenarios, is_try_write will instead lead to performance */
-        if (!is_udp) {
-            context_size = cat_offsize_of(cat_socket_write_request_t, u.stream);
-        } else {
-            context_size = cat_offsize_of(cat_socket_write_request_t, u.udp);
-        }
-        request = (cat_socket_write_request_t *) cat_malloc(context_size);
-#if CAT_ALLOC_HANDLE_ERRORS
-        if (unlikely(request == NULL)) {
-            cat_update_last_error_of_syscall("Malloc for write request failed");
-            goto _out;
-        }
-#endif
-        if (!(socket_i->io_flags & CAT_SOCKET_IO_FLAG_WRITE)) {
-            socket_i->cache.write_request = request;
-        }
-    }
-    if (!is_dgram) {
-        error = uv_write2(
-            &request->u.stream, &socket_i->u.stream,
-            (const uv_buf_t *) vector, vector_count,
-            send_handle == NULL ? NULL : &send_handle->internal->u.stream,
-            cat_socket_write_callback
-        );
-    } else {
-        error = uv_udp_send(
-            &request->u.udp, &socket_i->u.udp,
-            (const uv_buf_t *) vector, vector_count, address,
-            cat_socket_udp_send_callback
-        );
-    }
-    if (likely(error == 0)) {
-        request->error = CAT_ECANCELED;
-        request->u.coroutine = CAT_COROUTINE_G(current);
+    do {
         socket_i->io_flags |= CAT_SOCKET_IO_FLAG_WRITE;
-        cat_queue_push_back(&socket_i->context.io.write.coroutines, &CAT_COROUTINE_G(current)->waiter.node);
-        ret = cat_time_wait(timeout);
+        cat_queue_push_back(queue, &CAT_COROUTINE_G(current)->waiter.node);
+        CAT_TIME_WAIT_START() {
+            ret = cat_time_wait(timeout);
+        } CAT_TIME_WAIT_END(timeout);
         cat_queue_remove(&CAT_COROUTINE_G(current)->waiter.node);
-        request->u.coroutine = NULL;
-        error = request->error;
-        if (cat_queue_empty(&socket_i->context.io.write.coroutines)) {
+        if (cat_queue_empty(queue)) {
             socket_i->io_flags ^= CAT_SOCKET_IO_FLAG_WRITE;
         }
-        /* handle error */
-        if (unlikely(!ret || request->error == CAT_ECANCELED)) {
-            /* write request is in progress, it can not be cancelled gracefully,
-             * so we must cancel it by socket_close(), it's unrecoverable.
-             * TODO: should we wait for close done here?
-             * Release buffers before write operation is totally over is dangerous on Windows */
-            cat_socket_internal_unrecoverable_io_error(socket_i);
-        }
         if (unlikely(!ret)) {
-            cat_update_last_error_with_previous("Socket write wait failed");
-            goto _out;
+            cat_update_last_error_with_previous("Socket write wait for direct write failed");
+            return cat_false;
         }
-    }
-    ret = error == 0;
-    if (unlikely(!ret)) {
-        if (error == CAT_ECANCELED) {
+        if (unlikely(socket_i->u.socket == NULL)) {
             cat_update_last_error(CAT_ECANCELED, "Socket write has been canceled");
-        } else {
-            cat_update_last_error_with_reason((cat_errno_t) error, "Socket write failed");
+            return cat_false;
         }
-    }
+    } while (socket_i->flags & CAT_SOCKET_INTERNAL_FLAG_DIRECT_WRITE);
 
-    _out:
-    return ret;
+    return cat_true;
 }
 
-#ifdef CAT_OS_UNIX_LIKE
-static cat_never_inline ssize_t cat_socket_internal_udg_try_write(
+#ifdef CAT_OS_LINUX
+static cat_bool_t cat_socket_internal_write_raw(
     cat_socket_internal_t *socket_i,
     const cat_socket_write_vector_t *vector, unsigned int vector_count,
-    const cat_sockaddr_t *address, cat_socklen_t address_length
-)
-{
-    cat_socket_fd_t fd;
-    struct msghdr msg;
-    ssize_t nwrite;
+    const cat_sockaddr_t *address, cat_socklen_t address_length,
+    cat_socket_t *send_handle,
+    cat_timeout_t timeout
+);
 
-    if (!!(socket_i->io_flags & CAT_SOCKET_IO_FLAG_WRITE)) {
-        return CAT_EAGAIN;
+static cat_bool_t cat_socket_internal_direct_write_start(cat_socket_internal_t *socket_i, cat_timeout_t *timeout)
+{
+    if (socket_i->flags & CAT_SOCKET_INTERNAL_FLAG_DIRECT_WRITE) {
+        cat_bool_t wait_ret;
+        CAT_TIME_WAIT_START() {
+            wait_ret = cat_socket_internal_wait_direct_write(socket_i, *timeout);
+        } CAT_TIME_WAIT_END(*timeout);
+        if (unlikely(!wait_ret)) {
+            return cat_false;
+        }
     }
-
-    fd = cat_socket_internal_get_fd_fast(socket_i);
+    /* data of previous writes must go first, an empty write request will be done after them */
+    while ((socket_i->io_flags & CAT_SOCKET_IO_FLAG_WRITE) || uv_stream_get_write_queue_size(&socket_i->u.stream) != 0) {
+        cat_socket_write_vector_t vector = cat_socket_write_vector_init("", 0);
+        cat_bool_t write_ret;
+        CAT_TIME_WAIT_START() {
+            write_ret = cat_socket_internal_write_raw(socket_i, &vector, 1, NULL, 0, NULL, *timeout);
+        } CAT_TIME_WAIT_END(*timeout);
+        if (unlikely(!write_ret)) {
+            return cat_false;
+        }
+        if (unlikely(socket_i->u.socket == NULL)) {
+            cat_update_last_error(CAT_ECANCELED, "Socket has been closed during writing");
+            return cat_false;
+        }
+    }
+
+    socket_i->flags |= CAT_SOCKET_INTERNAL_FLAG_DIRECT_WRITE;
+    socket_i->io_flags |= CAT_SOCKET_IO_FLAG_WRITE;
+    cat_queue_push_back(&socket_i->context.io.write.coroutines, &CAT_COROUTINE_G(current)->waiter.node);
+
+    return cat_true;
+}
+
+static void cat_socket_internal_direct_write_end(cat_socket_internal_t *socket_i, cat_os_fd_t writefd)
+{
+    cat_queue_t *queue = &socket_i->context.io.write.coroutines;
+
+    if (writefd != CAT_OS_INVALID_FD) {
+        (void) uv__close(writefd);
+    }
+    socket_i->flags ^= CAT_SOCKET_INTERNAL_FLAG_DIRECT_WRITE;
+    cat_queue_remove(&CAT_COROUTINE_G(current)->waiter.node);
+    if (cat_queue_empty(queue)) {
+        socket_i->io_flags ^= CAT_SOCKET_IO_FLAG_WRITE;
+    } else if (socket_i->u.socket != NULL) {
+        /* resume coroutines which are waiting for us,
+         * each of them may re-queue itself at the back
+         * (if socket has been closed, they will be canceled by close()) */
+        cat_coroutine_t *last = cat_queue_back_data(queue, cat_coroutine_t, waiter.node);
+        cat_coroutine_t *waiter;
+        do {
+            waiter = cat_queue_front_data(queue, cat_coroutine_t, waiter.node);
+            cat_coroutine_schedule(waiter, SOCKET, "Direct write done");
+        } while (waiter != last);
+    }
+    if (socket_i->u.socket != NULL) {
+        /* auto flush of cork buffer was suspended by us */
+        cat_socket_internal_cork_schedule_flush(socket_i);
+    }
+}
+
+/* stream fd is managed by libuv, so we poll on the dup one */
+static cat_bool_t cat_socket_internal_direct_write_poll(
+    cat_socket_internal_t *socket_i, cat_os_fd_t *writefd,
+    cat_pollfd_events_t events, const char *name,
+    cat_timeout_t *timeout
+)
+{
+    cat_ret_t poll_ret;
+
+    if (*writefd == CAT_OS_INVALID_FD) {
+        *writefd = dup(cat_socket_internal_get_fd_fast(socket_i));
+        if (unlikely(*writefd == CAT_OS_INVALID_FD)) {
+            cat_update_last_error_of_syscall("Socket %s dup failed", name);
+            return cat_false;
+        }
+    }
+    CAT_TIME_WAIT_START() {
+        poll_ret = cat_poll_one(*writefd, events, NULL, *timeout);
+    } CAT_TIME_WAIT_END(*timeout);
+    if (likely(poll_ret == CAT_RET_OK && socket_i->u.socket != NULL)) {
+        return cat_true;
+    } else if (poll_ret == CAT_RET_OK || socket_i->u.socket == NULL) {
+        cat_update_last_error(CAT_ECANCELED, "Socket has been closed during %s", name);
+    } else if (poll_ret == CAT_RET_NONE) {
+        cat_update_last_error(CAT_ETIMEDOUT, "Socket %s poll timedout", name);
+    } else {
+        cat_update_last_error_with_previous("Socket %s poll failed", name);
+    }
+
+    return cat_false;
+}
+#endif
+
+#ifdef CAT_SOCKET_ZEROCOPY
+#include <linux/errqueue.h>
+
+/* receive completion notifications from the error queue (non-blocking) */
+static void cat_socket_internal_zerocopy_reap(cat_socket_internal_t *socket_i, cat_socket_fd_t fd)
+{
+    while (socket_i->zerocopy.pending > 0) {
+        char control[CMSG_SPACE(sizeof(struct sock_extended_err)) + CMSG_SPACE(sizeof(struct sockaddr_in6))];
+        struct msghdr msg;
+        struct cmsghdr *cmsg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        if (recvmsg(fd, &msg, MSG_ERRQUEUE) < 0) {
+            /* EAGAIN: no more notifications */
+            break;
+        }
+        for (cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            const struct sock_extended_err *serr;
+            uint32_t count;
+            if (!(cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) &&
+                !(cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)) {
+                continue;
+            }
+            serr = (const struct sock_extended_err *) CMSG_DATA(cmsg);
+            if (serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY || serr->ee_errno != 0) {
+                continue;
+            }
+            /* notifications cover the range [ee_info, ee_data] of send calls */
+            count = serr->ee_data - serr->ee_info + 1;
+            socket_i->zerocopy.pending -= CAT_MIN(count, socket_i->zerocopy.pending);
+            if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+                CAT_LOG_DEBUG(SOCKET, "Socket zerocopy fell back to copying for sends [%u, %u]", serr->ee_info, serr->ee_data);
+            }
+        }
+    }
+}
+
+static cat_never_inline cat_bool_t cat_socket_internal_zerocopy_write(
+    cat_socket_internal_t *socket_i,
+    const cat_socket_write_vector_t *vector, unsigned int vector_count,
+    cat_timeout_t timeout
+)
+{
+    cat_socket_fd_t fd = cat_socket_internal_get_fd_fast(socket_i);
+    cat_os_fd_t writefd = CAT_OS_INVALID_FD;
+    struct iovec *iov, *iov_end;
+    int flags = MSG_ZEROCOPY;
+    cat_bool_t ret = cat_false;
+
+    iov = (struct iovec *) cat_malloc(sizeof(*iov) * vector_count);
+#if CAT_ALLOC_HANDLE_ERRORS
+    if (unlikely(iov == NULL)) {
+        cat_update_last_error_of_syscall("Malloc for zerocopy vector failed");
+        return cat_false;
+    }
+#endif
+    memcpy(iov, vector, sizeof(*iov) * vector_count);
+    iov_end = iov + vector_count;
+
+    if (unlikely(!cat_socket_internal_direct_write_start(socket_i, &timeout))) {
+        cat_free(iov);
+        return cat_false;
+    }
+
+    while (1) {
+        struct msghdr msg;
+        ssize_t n;
+        struct iovec *iov_current = iov;
+        while (iov_current < iov_end && iov_current->iov_len == 0) {
+            iov_current++;
+        }
+        if (iov_current == iov_end) {
+            break;
+        }
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov_current;
+        msg.msg_iovlen = iov_end - iov_current;
+        do {
+            n = sendmsg(fd, &msg, flags);
+        } while (n < 0 && CAT_SOCKET_RETRY_ON_WRITE_ERROR(cat_sys_errno));
+        if (likely(n >= 0)) {
+            if (flags & MSG_ZEROCOPY) {
+                socket_i->zerocopy.pending++;
+            }
+            while (n > 0) {
+                size_t consumed = CAT_MIN((size_t) n, iov_current->iov_len);
+                iov_current->iov_base = (char *) iov_current->iov_base + consumed;
+                iov_current->iov_len -= consumed;
+                n -= consumed;
+                iov_current++;
+            }
+            continue;
+        }
+        if (cat_sys_errno == ENOBUFS && (flags & MSG_ZEROCOPY)) {
+            /* exceeded optmem limit for notifications, copy the rest */
+            flags = 0;
+            continue;
+        }
+        if (CAT_SOCKET_IS_TRANSIENT_WRITE_ERROR(cat_sys_errno)) {
+            if (unlikely(!cat_socket_internal_direct_write_poll(socket_i, &writefd, POLLOUT, "zerocopy write", &timeout))) {
+                goto _out;
+            }
+            /* it also wakes up on notifications */
+            cat_socket_internal_zerocopy_reap(socket_i, fd);
+            continue;
+        }
+        cat_update_last_error_of_syscall("Socket zerocopy write failed");
+        goto _out;
+    }
+
+    /* data can not be released until the kernel has done with it */
+    while (1) {
+        cat_socket_internal_zerocopy_reap(socket_i, fd);
+        if (socket_i->zerocopy.pending == 0) {
+            break;
+        }
+        /* notifications are reported as POLLERR */
+        if (unlikely(!cat_socket_internal_direct_write_poll(socket_i, &writefd, POLLPRI, "zerocopy completion", &timeout))) {
+            goto _out;
+        }
+    }
+    ret = cat_true;
+
+    _out:
+    cat_free(iov);
+    cat_socket_internal_direct_write_end(socket_i, writefd);
+    if (unlikely(!ret && socket_i->zerocopy.pending > 0 && socket_i->u.socket != NULL)) {
+        /* kernel may still be reading the data after we return, it's unrecoverable */
+        cat_socket_internal_unrecoverable_io_error(socket_i);
+    }
+    return ret;
+}
+#endif
+
+static cat_bool_t cat_socket_internal_write_raw(
+    cat_socket_internal_t *socket_i,
+    const cat_socket_write_vector_t *vector, unsigned int vector_count,
+    const cat_sockaddr_t *address, cat_socklen_t address_length,
+    cat_socket_t *send_handle,
+    cat_timeout_t timeout
+)
+{
+    CAT_SOCKET_CHECK_INPUT_ADDRESS(address, address_length, return cat_false);
+    cat_bool_t is_udp = ((socket_i->type & CAT_SOCKET_TYPE_UDP) == CAT_SOCKET_TYPE_UDP);
+    cat_bool_t is_dgram = (socket_i->type & CAT_SOCKET_TYPE_FLAG_DGRAM);
+    cat_bool_t ret = cat_false;
+    cat_socket_write_request_t *request;
+    ssize_t error;
+
+#ifdef CAT_OS_UNIX_LIKE
+    /* libuv does not support dynamic address length */
+    CAT_ASSERT(
+        (!is_udp || address == NULL || address->sa_family != AF_UNIX || address_length >= sizeof(struct sockaddr_un)) &&
+        "Socket does not support variable size UNIX address on UDP"
+    );
+    if (is_dgram && !is_udp) {
+        ret = cat_socket_internal_udg_write(socket_i, vector, vector_count, address, address_length, timeout);
+        goto _out;
+    }
+#endif
+
+    if (unlikely(socket_i->flags & CAT_SOCKET_INTERNAL_FLAG_DIRECT_WRITE)) {
+        if (unlikely(!cat_socket_internal_wait_direct_write(socket_i, timeout))) {
+            goto _out;
+        }
+    }
+#ifdef CAT_SOCKET_ZEROCOPY
+    if (unlikely(socket_i->zerocopy.threshold != 0) && !is_dgram && send_handle == NULL &&
+        cat_socket_write_vector_length(vector, vector_count) >= socket_i->zerocopy.threshold) {
+        ret = cat_socket_internal_zerocopy_write(socket_i, vector, vector_count, timeout);
+        goto _out;
+    }
+#endif
+
+    /* why we do not try write: on high-traffic scenarios, is_try_write will instead lead to performance */
+    request = cat_socket_internal_acquire_write_request(socket_i, is_udp);
+#if CAT_ALLOC_HANDLE_ERRORS
+    if (unlikely(request == NULL)) {
+        goto _out;
+    }
+#endif
+    if (!is_dgram) {
+        error = uv_write2(
+            &request->u.stream, &socket_i->u.stream,
+            (const uv_buf_t *) vector, vector_count,
+            send_handle == NULL ? NULL : &send_handle->internal->u.stream,
+            cat_socket_write_callback
+        );
+    } else {
+        error = uv_udp_send(
+            &request->u.udp, &socket_i->u.udp,
+            (const uv_buf_t *) vector, vector_count, address,
+            cat_socket_udp_send_callback
+        );
+    }
+    if (likely(error == 0)) {
+        request->error = CAT_ECANCELED;
+        request->u.coroutine = CAT_COROUTINE_G(current);
+        socket_i->io_flags |= CAT_SOCKET_IO_FLAG_WRITE;
+        cat_queue_push_back(&socket_i->context.io.write.coroutines, &CAT_COROUTINE_G(current)->waiter.node);
+        ret = cat_time_wait(timeout);
+        cat_queue_remove(&CAT_COROUTINE_G(current)->waiter.node);
+        request->u.coroutine = NULL;
+        error = request->error;
+        if (cat_queue_empty(&socket_i->context.io.write.coroutines)) {
+            socket_i->io_flags ^= CAT_SOCKET_IO_FLAG_WRITE;
+        }
+        /* handle error */
+        if (unlikely(!ret || request->error == CAT_ECANCELED)) {
+            /* write request is in progress, it can not be cancelled gracefully,
+             * so we must cancel it by socket_close(), it's unrecoverable.
+             * TODO: should we wait for close done here?
+             * Release buffers before write operation is totally over is dangerous on Windows */
+            cat_socket_internal_unrecoverable_io_error(socket_i);
+        }
+        if (unlikely(!ret)) {
+            cat_update_last_error_with_previous("Socket write wait failed");
+            goto _out;
+        }
+    } else {
+        /* request was not queued, so callback will never be called */
+        cat_socket_internal_release_write_request(socket_i, request);
+    }
+    ret = error == 0;
+    if (unlikely(!ret)) {
+        if (error == CAT_ECANCELED) {
+            cat_update_last_error(CAT_ECANCELED, "Socket write has been canceled");
+        } else {
+            cat_update_last_error_with_reason((cat_errno_t) error, "Socket write failed");
+        }
+    }
+
+    _out:
+    return ret;
+}
+
+#ifdef CAT_OS_UNIX_LIKE
+static cat_never_inline ssize_t cat_socket_internal_udg_try_write(
+    cat_socket_internal_t *socket_i,
+    const cat_socket_write_vector_t *vector, unsigned int vector_count,
+    const cat_sockaddr_t *address, cat_socklen_t address_length
+)
+{
+    cat_socket_fd_t fd;
+    struct msghdr msg;
+    ssize_t nwrite;
+
+    if (!!(socket_i->io_flags & CAT_SOCKET_IO_FLAG_WRITE)) {
+        return CAT_EAGAIN;
+    }
+
+    fd = cat_socket_internal_get_fd_fast(socket_i);
     msg.msg_name = (struct sockaddr *) address;
     msg.msg_namelen = address_length;
     msg.msg_iov = (struct iovec *) vector;
@@ -3234,6 +3762,9 @@ static ssize_t cat_socket_internal_try_write_raw(
     }
 #endif
     if (!is_dgram) {
+        if (unlikely(socket_i->flags & CAT_SOCKET_INTERNAL_FLAG_DIRECT_WRITE)) {
+            return CAT_EAGAIN;
+        }
         return uv_try_write(
             &socket_i->u.stream,
             (const uv_buf_t *) vector, vector_count
@@ -3432,56 +3963,257 @@ static cat_always_inline ssize_t cat_socket_internal_try_write(
     return cat_socket_internal_try_write_raw(socket_i, vector, vector_count, address, address_length);
 }
 
-#define CAT_SOCKET_INTERNAL_IO_ESTABLISHED_CHECK_FOR_STREAM_SILENT(_socket_i, _failure) do { \
-    if (!(_socket_i->type & CAT_SOCKET_TYPE_FLAG_DGRAM)) { \
-        CAT_SOCKET_INTERNAL_ESTABLISHED_ONLY_SILENT(_socket_i, _failure); \
-    } \
-} while (0)
+/* cork */
 
-#define CAT_SOCKET_INTERNAL_IO_ESTABLISHED_CHECK_FOR_STREAM(_socket_i, _failure) do { \
-    if (!(_socket_i->type & CAT_SOCKET_TYPE_FLAG_DGRAM)) { \
-        CAT_SOCKET_INTERNAL_ESTABLISHED_ONLY(_socket_i, _failure); \
+typedef struct cat_socket_cork_write_request_s {
+    uv_write_t request;
+    cat_socket_internal_t *socket_i;
+    cat_buffer_t buffer;
+} cat_socket_cork_write_request_t;
+
+#define CAT_SOCKET_INTERNAL_CORK_ERROR_CHECK(_socket_i, _failure) do { \
+    if (unlikely(_socket_i->cork.error != 0)) { \
+        cat_update_last_error_with_reason(_socket_i->cork.error, "Socket cork flush failed"); \
+        _failure; \
     } \
 } while (0)
 
-#define CAT_SOCKET_IO_CHECK_RAW(_socket, _socket_i, _io_flag, _failure) \
-    CAT_SOCKET_INTERNAL_GETTER_WITH_IO(_socket, _socket_i, _io_flag, _failure); \
-    CAT_SOCKET_INTERNAL_IO_ESTABLISHED_CHECK_FOR_STREAM(_socket_i, _failure) \
-
-#define CAT_SOCKET_IO_CHECK(_socket, _socket_i, _io_flag, _failure) \
-        CAT_SOCKET_IO_CHECK_RAW(_socket, _socket_i, _io_flag, _failure); \
-        do { \
-            if (unlikely((_socket_i->type & CAT_SOCKET_TYPE_IPCC) == CAT_SOCKET_TYPE_IPCC)) { \
-                cat_update_last_error(CAT_EMISUSE, "Socket IPC channel can not transfer user data"); \
-                _failure; \
-            } \
-        } while (0)
-
-#define CAT_SOCKET_TRY_IO_CHECK(_socket, _socket_i, _io_flag, _failure) \
-        CAT_SOCKET_INTERNAL_GETTER_WITH_IO_SILENT(_socket, _socket_i, _io_flag, _failure); \
-        CAT_SOCKET_INTERNAL_IO_ESTABLISHED_CHECK_FOR_STREAM_SILENT(_socket_i, _failure) \
-
-static cat_always_inline ssize_t cat_socket_read_impl(cat_socket_t *socket, char *buffer, size_t size, cat_sockaddr_t *address, cat_socklen_t *address_length, cat_timeout_t timeout, cat_bool_t once)
+static void cat_socket_internal_cork_write_callback(uv_write_t *request, int status)
 {
-    CAT_SOCKET_IO_CHECK(socket, socket_i, CAT_SOCKET_IO_FLAG_READ, return -1);
-    return cat_socket_internal_read(socket_i, buffer, size, address, address_length, timeout, once);
-}
+    cat_socket_cork_write_request_t *cork_request = cat_container_of(request, cat_socket_cork_write_request_t, request);
+    cat_socket_internal_t *socket_i = cork_request->socket_i;
 
-static cat_always_inline ssize_t cat_socket_try_recv_impl(cat_socket_t *socket, char *buffer, size_t size, cat_sockaddr_t *address, cat_socklen_t *address_length)
-{
-    CAT_SOCKET_TRY_IO_CHECK(socket, socket_i, CAT_SOCKET_IO_FLAG_READ, return error);
-    return cat_socket_internal_try_recv(socket_i, buffer, size, address, address_length);
+    /* nobody can see the error if socket has been closed (write was canceled) */
+    if (unlikely(status != 0) && socket_i->u.socket != NULL) {
+        CAT_LOG_DEBUG(SOCKET, "Socket cork flush failed, %s", cat_strerror(status));
+        /* the rest of stream is broken, keep the first error */
+        if (socket_i->cork.error == 0) {
+            socket_i->cork.error = status;
+        }
+    }
+    cat_buffer_close(&cork_request->buffer);
+    cat_free(cork_request);
 }
 
-static cat_always_inline cat_bool_t cat_socket_write_impl(cat_socket_t *socket, const cat_socket_write_vector_t *vector, unsigned int vector_count, const cat_sockaddr_t *address, cat_socklen_t address_length, cat_timeout_t timeout)
+/* flush buffer without blocking, the request takes over the buffer,
+ * unwritten data is left to libuv (it tries to write immediately if write queue is empty) */
+static void cat_socket_internal_cork_flush_async(cat_socket_internal_t *socket_i)
 {
-    CAT_SOCKET_IO_CHECK(socket, socket_i, CAT_SOCKET_IO_FLAG_NONE, return cat_false);
-    return cat_socket_internal_write(socket_i, vector, vector_count, address, address_length, timeout);
-}
+    cat_socket_cork_write_request_t *request;
+    uv_buf_t buf;
+    int error;
 
-static cat_always_inline ssize_t cat_socket_try_write_impl(cat_socket_t *socket, const cat_socket_write_vector_t *vector, unsigned int vector_count, const cat_sockaddr_t *address, cat_socklen_t address_length)
-{
+    request = (cat_socket_cork_write_request_t *) cat_malloc(sizeof(*request));
+#if CAT_ALLOC_HANDLE_ERRORS
+    if (unlikely(request == NULL)) {
+        return;
+    }
+#endif
+    request->socket_i = socket_i;
+    request->buffer = socket_i->cork.buffer;
+    cat_buffer_init(&socket_i->cork.buffer);
+#ifdef CAT_SSL
+    if (socket_i->ssl != NULL) {
+        cat_io_vector_t vector;
+        cat_io_vector_t ssl_vector[8];
+        unsigned int ssl_vector_count = CAT_ARRAY_SIZE(ssl_vector), n;
+        cat_buffer_t encrypted;
+        cat_bool_t ret;
+
+        vector.base = request->buffer.value;
+        vector.length = (cat_io_vector_length_t) request->buffer.length;
+        cat_buffer_init(&encrypted);
+        CAT_PROTECT_LAST_ERROR_START() {
+            ret = cat_ssl_encrypt(socket_i->ssl, &vector, 1, ssl_vector, &ssl_vector_count);
+            if (likely(ret)) {
+                /* encrypted vectors may refer to the internal buffer of ssl, we must copy them */
+                ret = cat_buffer_prepare(&encrypted, cat_io_vector_length(ssl_vector, ssl_vector_count));
+                for (n = 0; ret && n < ssl_vector_count; n++) {
+                    ret = cat_buffer_append(&encrypted, ssl_vector[n].base, ssl_vector[n].length);
+                }
+                cat_ssl_encrypted_vector_free(socket_i->ssl, ssl_vector, ssl_vector_count);
+            }
+        } CAT_PROTECT_LAST_ERROR_END();
+        cat_buffer_close(&request->buffer);
+        request->buffer = encrypted;
+        if (unlikely(!ret)) {
+            cat_socket_internal_cork_write_callback(&request->request, CAT_ESSL);
+            return;
+        }
+    }
+#endif
+    buf = uv_buf_init(request->buffer.value, (cat_io_vector_length_t) request->buffer.length);
+    error = uv_write(&request->request, &socket_i->u.stream, &buf, 1, cat_socket_internal_cork_write_callback);
+    if (unlikely(error != 0)) {
+        cat_socket_internal_cork_write_callback(&request->request, error);
+    }
+}
+
+static void cat_socket_cork_flush_callback(cat_data_t *data)
+{
+    cat_queue_t *queue = &CAT_SOCKET_G(cork.queue);
+    cat_socket_internal_t *socket_i;
+    (void) data;
+
+    CAT_SOCKET_G(cork.scheduled) = cat_false;
+    while ((socket_i = cat_queue_front_data(queue, cat_socket_internal_t, cork.node))) {
+        cat_queue_remove(&socket_i->cork.node);
+        cat_queue_init(&socket_i->cork.node);
+        /* direct write (sendfile, zerocopy) must not be interleaved,
+         * buffer will be re-scheduled when it is done */
+        if (unlikely(socket_i->flags & CAT_SOCKET_INTERNAL_FLAG_DIRECT_WRITE)) {
+            continue;
+        }
+        if (socket_i->cork.buffer.length != 0) {
+            cat_socket_internal_cork_flush_async(socket_i);
+        }
+    }
+}
+
+static void cat_socket_internal_cork_schedule_flush(cat_socket_internal_t *socket_i)
+{
+    if (!socket_i->cork.auto_flush || socket_i->cork.buffer.length == 0 ||
+        !cat_queue_empty(&socket_i->cork.node)) {
+        return;
+    }
+    if (!CAT_SOCKET_G(cork.scheduled)) {
+        if (unlikely(!cat_event_defer(cat_socket_cork_flush_callback, NULL))) {
+            return;
+        }
+        CAT_SOCKET_G(cork.scheduled) = cat_true;
+    }
+    cat_queue_push_back(&CAT_SOCKET_G(cork.queue), &socket_i->cork.node);
+}
+
+static cat_always_inline void cat_socket_internal_cork_unschedule_flush(cat_socket_internal_t *socket_i)
+{
+    if (!cat_queue_empty(&socket_i->cork.node)) {
+        cat_queue_remove(&socket_i->cork.node);
+        cat_queue_init(&socket_i->cork.node);
+    }
+}
+
+static cat_bool_t cat_socket_internal_cork_flush(cat_socket_internal_t *socket_i, cat_timeout_t timeout)
+{
+    cat_buffer_t buffer = socket_i->cork.buffer;
+    cat_socket_write_vector_t vector;
+    cat_bool_t ret;
+
+    if (buffer.length == 0) {
+        return cat_true;
+    }
+    /* other coroutines may append data to cork buffer during writing */
+    cat_buffer_init(&socket_i->cork.buffer);
+    cat_socket_internal_cork_unschedule_flush(socket_i);
+    vector = cat_socket_write_vector_init(buffer.value, buffer.length);
+    ret = cat_socket_internal_write(socket_i, &vector, 1, NULL, 0, timeout);
+    cat_buffer_close(&buffer);
+
+    return ret;
+}
+
+static cat_bool_t cat_socket_internal_cork_append(cat_socket_internal_t *socket_i, const cat_socket_write_vector_t *vector, unsigned int vector_count, size_t length)
+{
+    cat_buffer_t *buffer = &socket_i->cork.buffer;
+    unsigned int n;
+
+    if (unlikely(!cat_buffer_prepare(buffer, length))) {
+        cat_update_last_error_with_previous("Socket cork buffer alloc failed");
+        return cat_false;
+    }
+    for (n = 0; n < vector_count; n++) {
+        memcpy(buffer->value + buffer->length, vector[n].base, vector[n].length);
+        buffer->length += vector[n].length;
+    }
+
+    return cat_true;
+}
+
+static cat_bool_t cat_socket_internal_cork_write(cat_socket_internal_t *socket_i, const cat_socket_write_vector_t *vector, unsigned int vector_count, cat_timeout_t timeout)
+{
+    size_t length = cat_socket_write_vector_length(vector, vector_count);
+
+    /* nothing to coalesce with, write it directly */
+    if (socket_i->cork.buffer.length == 0 && length >= socket_i->cork.threshold) {
+        return cat_socket_internal_write(socket_i, vector, vector_count, NULL, 0, timeout);
+    }
+    if (unlikely(!cat_socket_internal_cork_append(socket_i, vector, vector_count, length))) {
+        return cat_false;
+    }
+    if (socket_i->cork.buffer.length >= socket_i->cork.threshold) {
+        return cat_socket_internal_cork_flush(socket_i, timeout);
+    }
+    cat_socket_internal_cork_schedule_flush(socket_i);
+
+    return cat_true;
+}
+
+#define CAT_SOCKET_INTERNAL_IO_ESTABLISHED_CHECK_FOR_STREAM_SILENT(_socket_i, _failure) do { \
+    if (!(_socket_i->type & CAT_SOCKET_TYPE_FLAG_DGRAM)) { \
+        CAT_SOCKET_INTERNAL_ESTABLISHED_ONLY_SILENT(_socket_i, _failure); \
+    } \
+} while (0)
+
+#define CAT_SOCKET_INTERNAL_IO_ESTABLISHED_CHECK_FOR_STREAM(_socket_i, _failure) do { \
+    if (!(_socket_i->type & CAT_SOCKET_TYPE_FLAG_DGRAM)) { \
+        CAT_SOCKET_INTERNAL_ESTABLISHED_ONLY(_socket_i, _failure); \
+    } \
+} while (0)
+
+#define CAT_SOCKET_IO_CHECK_RAW(_socket, _socket_i, _io_flag, _failure) \
+    CAT_SOCKET_INTERNAL_GETTER_WITH_IO(_socket, _socket_i, _io_flag, _failure); \
+    CAT_SOCKET_INTERNAL_IO_ESTABLISHED_CHECK_FOR_STREAM(_socket_i, _failure) \
+
+#define CAT_SOCKET_IO_CHECK(_socket, _socket_i, _io_flag, _failure) \
+        CAT_SOCKET_IO_CHECK_RAW(_socket, _socket_i, _io_flag, _failure); \
+        do { \
+            if (unlikely((_socket_i->type & CAT_SOCKET_TYPE_IPCC) == CAT_SOCKET_TYPE_IPCC)) { \
+                cat_update_last_error(CAT_EMISUSE, "Socket IPC channel can not transfer user data"); \
+                _failure; \
+            } \
+        } while (0)
+
+#define CAT_SOCKET_TRY_IO_CHECK(_socket, _socket_i, _io_flag, _failure) \
+        CAT_SOCKET_INTERNAL_GETTER_WITH_IO_SILENT(_socket, _socket_i, _io_flag, _failure); \
+        CAT_SOCKET_INTERNAL_IO_ESTABLISHED_CHECK_FOR_STREAM_SILENT(_socket_i, _failure) \
+
+static cat_always_inline ssize_t cat_socket_read_impl(cat_socket_t *socket, char *buffer, size_t size, cat_sockaddr_t *address, cat_socklen_t *address_length, cat_timeout_t timeout, cat_bool_t once)
+{
+    CAT_SOCKET_IO_CHECK(socket, socket_i, CAT_SOCKET_IO_FLAG_READ, return -1);
+    return cat_socket_internal_read(socket_i, buffer, size, address, address_length, timeout, once);
+}
+
+static cat_always_inline ssize_t cat_socket_try_recv_impl(cat_socket_t *socket, char *buffer, size_t size, cat_sockaddr_t *address, cat_socklen_t *address_length)
+{
+    CAT_SOCKET_TRY_IO_CHECK(socket, socket_i, CAT_SOCKET_IO_FLAG_READ, return error);
+    return cat_socket_internal_try_recv(socket_i, buffer, size, address, address_length);
+}
+
+static cat_always_inline cat_bool_t cat_socket_write_impl(cat_socket_t *socket, const cat_socket_write_vector_t *vector, unsigned int vector_count, const cat_sockaddr_t *address, cat_socklen_t address_length, cat_timeout_t timeout)
+{
+    CAT_SOCKET_IO_CHECK(socket, socket_i, CAT_SOCKET_IO_FLAG_NONE, return cat_false);
+    CAT_SOCKET_INTERNAL_CORK_ERROR_CHECK(socket_i, return cat_false);
+    if (unlikely(socket_i->cork.threshold != 0)) {
+        return cat_socket_internal_cork_write(socket_i, vector, vector_count, timeout);
+    }
+    return cat_socket_internal_write(socket_i, vector, vector_count, address, address_length, timeout);
+}
+
+static cat_always_inline ssize_t cat_socket_try_write_impl(cat_socket_t *socket, const cat_socket_write_vector_t *vector, unsigned int vector_count, const cat_sockaddr_t *address, cat_socklen_t address_length)
+{
     CAT_SOCKET_TRY_IO_CHECK(socket, socket_i, CAT_SOCKET_IO_FLAG_WRITE, return error == CAT_ELOCKED ? CAT_EAGAIN : error);
+    if (unlikely(socket_i->cork.error != 0)) {
+        return socket_i->cork.error;
+    }
+    if (unlikely(socket_i->cork.buffer.length != 0)) {
+        /* data must be written after the corked one */
+        size_t length = cat_socket_write_vector_length(vector, vector_count);
+        if (unlikely(!cat_socket_internal_cork_append(socket_i, vector, vector_count, length))) {
+            return cat_get_last_error_code();
+        }
+        cat_socket_internal_cork_schedule_flush(socket_i);
+        return (ssize_t) length;
+    }
     return cat_socket_internal_try_write(socket_i, vector, vector_count, address, address_length);
 }
 
@@ -4080,154 +4812,731 @@ static ssize_t cat_socket_peekfrom_impl(const cat_socket_t *socket, char *buffer
     return cat_socket_internal_peekfrom(socket_i, buffer, size, address, address_length, timeout);
 }
 
-static ssize_t cat_socket_peek_from_impl(const cat_socket_t *socket, char *buffer, size_t size, char *name, size_t *name_length, int *port, cat_timeout_t timeout)
+static ssize_t cat_socket_peek_from_impl(const cat_socket_t *socket, char *buffer, size_t size, char *name, size_t *name_length, int *port, cat_timeout_t timeout)
+{
+    CAT_SOCKET_INTERNAL_GETTER(socket, socket_i, return cat_false);
+    CAT_SOCKET_READ_ADDRESS_CONTEXT(address, name, name_length, port);
+    ssize_t nread;
+
+    nread = cat_socket_internal_peekfrom(socket_i, buffer, size, address, address_length, timeout);
+
+    CAT_SOCKET_READ_ADDRESS_TO_NAME(address, name, name_length, port);
+
+    return nread;
+}
+
+CAT_API ssize_t cat_socket_peek(const cat_socket_t *socket, char *buffer, size_t size)
+{
+    return cat_socket_peek_ex(socket, buffer, size, 0);
+}
+
+CAT_API ssize_t cat_socket_peek_ex(const cat_socket_t *socket, char *buffer, size_t size, cat_timeout_t timeout)
+{
+    CAT_LOG_DEBUG_VA(SOCKET, if (timeout != 0) {
+        CAT_LOG_DEBUG_D(SOCKET, "peek(" CAT_SOCKET_ID_FMT ", %p, %zu, " CAT_TIMEOUT_FMT ") = " CAT_LOG_UNFINISHED_STR,
+            socket->id, buffer, size, timeout);
+    });
+
+    ssize_t n = cat_socket_peekfrom_impl(socket, buffer, size, NULL, NULL, timeout);
+
+    CAT_LOG_DEBUG_VA(SOCKET, {
+        char *s;
+        CAT_LOG_DEBUG_D(SOCKET, "peek(" CAT_SOCKET_ID_FMT ", %s, %zu, " CAT_TIMEOUT_FMT ") = " CAT_LOG_SSIZE_RET_FMT,
+            socket->id, cat_log_str_quote(buffer, n < 0 ? 0 : n, &s), size, timeout, CAT_LOG_SSIZE_RET_C(n));
+        cat_free(s);
+    });
+
+    return n;
+}
+
+CAT_API ssize_t cat_socket_peekfrom(const cat_socket_t *socket, char *buffer, size_t size, cat_sockaddr_t *address, cat_socklen_t *address_length)
+{
+    return cat_socket_peekfrom_ex(socket, buffer, size, address, address_length, 0);
+}
+
+CAT_API ssize_t cat_socket_peekfrom_ex(const cat_socket_t *socket, char *buffer, size_t size, cat_sockaddr_t *address, cat_socklen_t *address_length, cat_timeout_t timeout)
+{
+    CAT_LOG_DEBUG_VA(SOCKET, if (timeout != 0) {
+        CAT_LOG_DEBUG_D(SOCKET, "peekfrom(" CAT_SOCKET_ID_FMT ", %p, %zu, %p, %d, " CAT_TIMEOUT_FMT ") = " CAT_LOG_UNFINISHED_STR,
+            socket->id, buffer, size, address, address_length != NULL ? *address_length: 0, timeout);
+    });
+
+    ssize_t n = cat_socket_peekfrom_impl(socket, buffer, size, address, address_length, timeout);
+
+    CAT_LOG_DEBUG_VA(SOCKET, {
+        char *s;
+        char name[CAT_SOCKADDR_MAX_PATH];
+        size_t name_length = sizeof(name);
+        int port;
+        if (cat_sockaddr_to_name_silent(address, address_length != NULL ? *address_length : 0, name, &name_length, &port) != 0) {
+            break;
+        }
+        CAT_LOG_DEBUG_D(SOCKET, "peekfrom(" CAT_SOCKET_ID_FMT ", %s, %zu, \"%.*s\", %d, " CAT_TIMEOUT_FMT ") = " CAT_LOG_SSIZE_RET_FMT,
+            socket->id, cat_log_str_quote(buffer, n < 0 ? 0 : n, &s), size, (int) name_length, name, port, timeout, CAT_LOG_SSIZE_RET_C(n));
+        cat_free(s);
+    });
+
+    return n;
+}
+
+CAT_API ssize_t cat_socket_peek_from(const cat_socket_t *socket, char *buffer, size_t size, char *name, size_t *name_length, int *port)
+{
+    return cat_socket_peek_from_ex(socket, buffer, size, name, name_length, port, 0);
+}
+
+CAT_API ssize_t cat_socket_peek_from_ex(const cat_socket_t *socket, char *buffer, size_t size, char *name, size_t *name_length, int *port, cat_timeout_t timeout)
+{
+    CAT_LOG_DEBUG_VA(SOCKET, if (timeout != 0) {
+        CAT_LOG_DEBUG_D(SOCKET, "peek_from(" CAT_SOCKET_ID_FMT ", %p, %zu, %p, %zu, " CAT_TIMEOUT_FMT ") = " CAT_LOG_UNFINISHED_STR,
+            socket->id, buffer, size, name, name_length != NULL ? *name_length: 0, timeout);
+    });
+
+    ssize_t n = cat_socket_peek_from_impl(socket, buffer, size, name, name_length, port, timeout);
+
+    CAT_LOG_DEBUG_VA(SOCKET, {
+        char *s;
+        CAT_LOG_DEBUG_D(SOCKET, "peek_from(" CAT_SOCKET_ID_FMT ", %s, %zu, \"%.*s\", %d, " CAT_TIMEOUT_FMT ") = " CAT_LOG_SSIZE_RET_FMT,
+            socket->id, cat_log_str_quote(buffer, n < 0 ? 0 : n, &s), size, (int) (name_length != NULL ? *name_length : 0), name, port != NULL ? *port : 0, timeout, CAT_LOG_SSIZE_RET_C(n));
+        cat_free(s);
+    });
+
+    return n;
+}
+
+#define CAT_SOCKET_IPCC_CHECK(_socket, _socket_i, _io_flags, _failure) \
+    CAT_SOCKET_IO_CHECK_RAW(_socket, _socket_i, _io_flags, _failure); \
+    if (unlikely(!((_socket_i->type & CAT_SOCKET_TYPE_IPCC) == CAT_SOCKET_TYPE_IPCC))) { \
+        cat_update_last_error(CAT_EINVAL, "Socket must be named pipe with IPC enabled"); \
+        _failure; \
+    }
+
+#ifndef CAT_OS_WIN
+#define CAT_SOCKET_IPCC_SUPPORTS "TCP, PIPE, UDP and UDG"
+#else
+#define CAT_SOCKET_IPCC_SUPPORTS "TCP"
+#endif
+
+// TODO: support send extra message
+static cat_bool_t cat_socket_send_handle_impl(cat_socket_t *socket, cat_socket_t *handle, cat_timeout_t timeout)
+{
+    CAT_SOCKET_IPCC_CHECK(socket, socket_i, CAT_SOCKET_IO_FLAG_NONE, return cat_false);
+    cat_socket_internal_t *ihandle;
+
+    if (unlikely(!cat_socket_is_available(handle))) {
+        cat_update_last_error(CAT_EINVAL, "Socket can not send an unavailble handle");
+        return cat_false;
+    }
+    ihandle = handle->internal;
+    if (unlikely(!cat_socket_internal_can_be_transfer_by_ipc(ihandle))) {
+        cat_update_last_error(CAT_EINVAL, "Socket can only send " CAT_SOCKET_IPCC_SUPPORTS " handle");
+        return cat_false;
+    }
+
+    cat_socket_inheritance_info_t handle_info = {
+        ihandle->type,
+        ihandle->options
+    };
+    cat_socket_write_vector_t vector = cat_socket_write_vector_init((char *) &handle_info, (cat_socket_vector_length_t) sizeof(handle_info));
+    if (!cat_socket_internal_write_raw(socket_i, &vector, 1, NULL, 0, handle, timeout)) {
+        cat_socket_internal_unrecoverable_io_error(socket_i);
+        return cat_false;
+    }
+
+    return cat_true;
+}
+
+CAT_API cat_bool_t cat_socket_send_handle(cat_socket_t *socket, cat_socket_t *handle)
+{
+    return cat_socket_send_handle_ex(socket, handle, cat_socket_get_write_timeout_fast(socket));
+}
+
+CAT_API cat_bool_t cat_socket_send_handle_ex(cat_socket_t *socket, cat_socket_t *handle, cat_timeout_t timeout)
+{
+    CAT_LOG_DEBUG(SOCKET, "send_handle(" CAT_SOCKET_ID_FMT ", " CAT_SOCKET_ID_FMT ", " CAT_TIMEOUT_FMT ") = " CAT_LOG_UNFINISHED_STR,
+        socket->id, handle->id, timeout);
+
+    cat_bool_t ret = cat_socket_send_handle_impl(socket, handle, timeout);
+
+    CAT_LOG_DEBUG_VA(SOCKET, {
+        CAT_LOG_DEBUG_D(SOCKET, "send_handle(" CAT_SOCKET_ID_FMT ", " CAT_SOCKET_ID_FMT ", " CAT_TIMEOUT_FMT ") = " CAT_LOG_BOOL_RET_FMT,
+            socket->id, handle->id, timeout, CAT_LOG_BOOL_RET_C(ret));
+    });
+
+    return ret;
+}
+
+#ifndef CAT_SOCKET_SEND_FILE_BUFFER_SIZE
+#define CAT_SOCKET_SEND_FILE_BUFFER_SIZE (64 * 1024)
+#endif
+
+static cat_bool_t cat_socket_internal_send_file_buffered(
+    cat_socket_internal_t *socket_i,
+    cat_file_t fd, int64_t offset, size_t length, size_t *nsent,
+    cat_timeout_t timeout
+)
+{
+    size_t buffer_size = CAT_MIN(length - *nsent, CAT_SOCKET_SEND_FILE_BUFFER_SIZE);
+    cat_bool_t ret = cat_false;
+    char *buffer;
+
+    buffer = (char *) cat_malloc(buffer_size);
+#if CAT_ALLOC_HANDLE_ERRORS
+    if (unlikely(buffer == NULL)) {
+        cat_update_last_error_of_syscall("Malloc for send file buffer failed");
+        return cat_false;
+    }
+#endif
+    while (*nsent < length) {
+        cat_socket_write_vector_t vector;
+        cat_bool_t write_ret;
+        ssize_t nread;
+        nread = cat_fs_pread(fd, buffer, CAT_MIN(length - *nsent, buffer_size), (off_t) (offset + *nsent));
+        if (unlikely(nread <= 0)) {
+            if (nread == 0) {
+                cat_update_last_error(CAT_EINVAL, "Socket send file reached the end of file unexpectedly");
+            } else {
+                cat_update_last_error_with_previous("Socket send file read failed");
+            }
+            goto _out;
+        }
+        if (unlikely(socket_i->u.socket == NULL)) {
+            cat_update_last_error(CAT_ECANCELED, "Socket has been closed during sending file");
+            goto _out;
+        }
+        vector = cat_socket_write_vector_init(buffer, (cat_socket_vector_length_t) nread);
+        CAT_TIME_WAIT_START() {
+            write_ret = cat_socket_internal_write(socket_i, &vector, 1, NULL, 0, timeout);
+        } CAT_TIME_WAIT_END(timeout);
+        if (unlikely(!write_ret)) {
+            goto _out;
+        }
+        *nsent += nread;
+    }
+    ret = cat_true;
+
+    _out:
+    cat_free(buffer);
+    return ret;
+}
+
+#ifdef CAT_OS_LINUX
+#include <sys/sendfile.h>
+
+/* sendfile(2) transfers at most 0x7ffff000 bytes at once */
+#define CAT_SOCKET_SEND_FILE_MAX_CHUNK_SIZE 0x7ffff000
+
+/* it returns NONE if sendfile(2) does not support the file,
+ * then the rest part should be sent in buffered way */
+static cat_ret_t cat_socket_internal_send_file_zero_copy(
+    cat_socket_internal_t *socket_i,
+    cat_file_t fd, int64_t offset, size_t length, size_t *nsent,
+    cat_timeout_t timeout
+)
+{
+    cat_socket_fd_t sockfd = cat_socket_internal_get_fd_fast(socket_i);
+    cat_os_fd_t writefd = CAT_OS_INVALID_FD;
+    cat_ret_t ret = CAT_RET_ERROR;
+
+    if (unlikely(!cat_socket_internal_direct_write_start(socket_i, &timeout))) {
+        return CAT_RET_ERROR;
+    }
+
+    while (*nsent < length) {
+        off_t file_offset = (off_t) (offset + *nsent);
+        size_t chunk_size = CAT_MIN(length - *nsent, CAT_SOCKET_SEND_FILE_MAX_CHUNK_SIZE);
+        ssize_t n;
+        do {
+            n = sendfile(sockfd, fd, &file_offset, chunk_size);
+        } while (n < 0 && CAT_SOCKET_RETRY_ON_WRITE_ERROR(cat_sys_errno));
+        if (likely(n > 0)) {
+            *nsent += n;
+            continue;
+        }
+        if (n == 0) {
+            cat_update_last_error(CAT_EINVAL, "Socket send file reached the end of file unexpectedly");
+            break;
+        }
+        if (CAT_SOCKET_IS_TRANSIENT_WRITE_ERROR(cat_sys_errno)) {
+            if (likely(cat_socket_internal_direct_write_poll(socket_i, &writefd, POLLOUT, "send file", &timeout))) {
+                continue;
+            }
+            break;
+        }
+        if (cat_sys_errno == EINVAL || cat_sys_errno == ENOSYS || cat_sys_errno == EOPNOTSUPP) {
+            /* the file does not support mmap-like operations */
+            ret = CAT_RET_NONE;
+            break;
+        }
+        cat_update_last_error_of_syscall("Socket send file failed");
+        break;
+    }
+    if (*nsent == length) {
+        ret = CAT_RET_OK;
+    }
+
+    cat_socket_internal_direct_write_end(socket_i, writefd);
+
+    return ret;
+}
+#endif
+
+static ssize_t cat_socket_send_file_impl(cat_socket_t *socket, cat_file_t fd, int64_t offset, size_t length, cat_timeout_t timeout)
+{
+    CAT_SOCKET_IO_CHECK(socket, socket_i, CAT_SOCKET_IO_FLAG_NONE, return -1);
+    size_t nsent = 0;
+
+    if (unlikely(socket_i->type & CAT_SOCKET_TYPE_FLAG_DGRAM)) {
+        cat_update_last_error(CAT_EMISUSE, "Socket send file only supports stream sockets");
+        return -1;
+    }
+    if (unlikely(offset < 0)) {
+        cat_update_last_error(CAT_EINVAL, "Socket send file offset can not be negative");
+        return -1;
+    }
+    CAT_SOCKET_INTERNAL_CORK_ERROR_CHECK(socket_i, return -1);
+    if (unlikely(socket_i->cork.buffer.length != 0)) {
+        cat_bool_t flush_ret;
+        CAT_TIME_WAIT_START() {
+            flush_ret = cat_socket_internal_cork_flush(socket_i, timeout);
+        } CAT_TIME_WAIT_END(timeout);
+        if (unlikely(!flush_ret)) {
+            return -1;
+        }
+    }
+    if (length == 0) {
+        cat_stat_t stat;
+        if (unlikely(cat_fs_fstat(fd, &stat) != 0)) {
+            cat_update_last_error_with_previous("Socket send file stat failed");
+            return -1;
+        }
+        if ((int64_t) stat.st_size <= offset) {
+            return 0;
+        }
+        length = (size_t) ((int64_t) stat.st_size - offset);
+    }
+
+#ifdef CAT_OS_LINUX
+    if (
+# ifdef CAT_SSL
+        socket_i->ssl == NULL &&
+# endif
+        (socket_i->type & CAT_SOCKET_TYPE_TTY) != CAT_SOCKET_TYPE_TTY &&
+        !(socket_i->flags & CAT_SOCKET_INTERNAL_FLAG_NOT_SOCK)
+    ) {
+        cat_ret_t ret = cat_socket_internal_send_file_zero_copy(socket_i, fd, offset, length, &nsent, timeout);
+        if (ret == CAT_RET_OK) {
+            return (ssize_t) nsent;
+        }
+        if (ret == CAT_RET_ERROR) {
+            goto _error;
+        }
+    }
+#endif
+    /* TLS sockets (and platforms without sendfile(2)) read the file chunk by chunk,
+     * chunks are encrypted in write() if necessary */
+    if (likely(cat_socket_internal_send_file_buffered(socket_i, fd, offset, length, &nsent, timeout))) {
+        return (ssize_t) nsent;
+    }
+
+    _error:
+    /* sent bytes can not be taken back, report them to the caller */
+    return nsent > 0 ? (ssize_t) nsent : -1;
+}
+
+CAT_API ssize_t cat_socket_send_file(cat_socket_t *socket, cat_file_t fd, int64_t offset, size_t length)
+{
+    return cat_socket_send_file_ex(socket, fd, offset, length, cat_socket_get_write_timeout_fast(socket));
+}
+
+CAT_API ssize_t cat_socket_send_file_ex(cat_socket_t *socket, cat_file_t fd, int64_t offset, size_t length, cat_timeout_t timeout)
+{
+    CAT_LOG_DEBUG(SOCKET, "send_file(" CAT_SOCKET_ID_FMT ", %d, %" PRId64 ", %zu, " CAT_TIMEOUT_FMT ") = " CAT_LOG_UNFINISHED_STR,
+        socket->id, fd, offset, length, timeout);
+
+    ssize_t ret = cat_socket_send_file_impl(socket, fd, offset, length, timeout);
+
+    CAT_LOG_DEBUG_VA(SOCKET, {
+        CAT_LOG_DEBUG_D(SOCKET, "send_file(" CAT_SOCKET_ID_FMT ", %d, %" PRId64 ", %zu, " CAT_TIMEOUT_FMT ") = " CAT_LOG_SSIZE_RET_FMT,
+            socket->id, fd, offset, length, timeout, CAT_LOG_SSIZE_RET_C(ret));
+    });
+
+    return ret;
+}
+
+CAT_API cat_bool_t cat_socket_cork(cat_socket_t *socket, size_t threshold, cat_bool_t auto_flush)
+{
+    CAT_SOCKET_INTERNAL_GETTER(socket, socket_i, return cat_false);
+
+    if (unlikely((socket_i->type & CAT_SOCKET_TYPE_FLAG_DGRAM) ||
+        (socket_i->type & CAT_SOCKET_TYPE_IPCC) == CAT_SOCKET_TYPE_IPCC)) {
+        cat_update_last_error(CAT_EMISUSE, "Socket cork only supports stream sockets");
+        return cat_false;
+    }
+    if (threshold == 0) {
+        threshold = CAT_SOCKET_CORK_DEFAULT_THRESHOLD;
+    }
+    socket_i->cork.threshold = threshold;
+    socket_i->cork.auto_flush = auto_flush;
+    if (auto_flush) {
+        cat_socket_internal_cork_schedule_flush(socket_i);
+    } else {
+        cat_socket_internal_cork_unschedule_flush(socket_i);
+    }
+
+    CAT_LOG_DEBUG(SOCKET, "cork(" CAT_SOCKET_ID_FMT ", %zu, %s)",
+        socket->id, threshold, cat_bool_str(auto_flush));
+
+    return cat_true;
+}
+
+CAT_API cat_bool_t cat_socket_uncork(cat_socket_t *socket)
+{
+    return cat_socket_uncork_ex(socket, cat_socket_get_write_timeout_fast(socket));
+}
+
+static cat_always_inline cat_bool_t cat_socket_uncork_impl(cat_socket_t *socket, cat_timeout_t timeout)
+{
+    CAT_SOCKET_INTERNAL_GETTER(socket, socket_i, return cat_false);
+
+    socket_i->cork.threshold = 0;
+    socket_i->cork.auto_flush = cat_false;
+    CAT_SOCKET_INTERNAL_CORK_ERROR_CHECK(socket_i, return cat_false);
+    if (socket_i->cork.buffer.length == 0) {
+        cat_socket_internal_cork_unschedule_flush(socket_i);
+        return cat_true;
+    }
+    CAT_SOCKET_INTERNAL_ESTABLISHED_ONLY(socket_i, return cat_false);
+
+    return cat_socket_internal_cork_flush(socket_i, timeout);
+}
+
+CAT_API cat_bool_t cat_socket_uncork_ex(cat_socket_t *socket, cat_timeout_t timeout)
+{
+    CAT_LOG_DEBUG(SOCKET, "uncork(" CAT_SOCKET_ID_FMT ", " CAT_TIMEOUT_FMT ") = " CAT_LOG_UNFINISHED_STR,
+        socket->id, timeout);
+
+    cat_bool_t ret = cat_socket_uncork_impl(socket, timeout);
+
+    CAT_LOG_DEBUG_VA(SOCKET, {
+        CAT_LOG_DEBUG_D(SOCKET, "uncork(" CAT_SOCKET_ID_FMT ", " CAT_TIMEOUT_FMT ") = " CAT_LOG_BOOL_RET_FMT,
+            socket->id, timeout, CAT_LOG_BOOL_RET_C(ret));
+    });
+
+    return ret;
+}
+
+CAT_API cat_bool_t cat_socket_is_corked(const cat_socket_t *socket)
 {
-    CAT_SOCKET_INTERNAL_GETTER(socket, socket_i, return cat_false);
-    CAT_SOCKET_READ_ADDRESS_CONTEXT(address, name, name_length, port);
-    ssize_t nread;
-
-    nread = cat_socket_internal_peekfrom(socket_i, buffer, size, address, address_length, timeout);
-
-    CAT_SOCKET_READ_ADDRESS_TO_NAME(address, name, name_length, port);
+    CAT_SOCKET_INTERNAL_GETTER_SILENT(socket, socket_i, return cat_false);
 
-    return nread;
+    return socket_i->cork.threshold != 0;
 }
 
-CAT_API ssize_t cat_socket_peek(const cat_socket_t *socket, char *buffer, size_t size)
+#ifdef CAT_OS_LINUX
+#ifndef CAT_SOCKET_MMSG_BATCH_SIZE
+#define CAT_SOCKET_MMSG_BATCH_SIZE 64
+#endif
+
+/* UDP fd may be watched by libuv (e.g. there are pending sends), so we poll on the dup one */
+static int cat_socket_internal_udp_wait_readable(cat_socket_internal_t *socket_i, cat_socket_fd_t fd, cat_timeout_t timeout)
 {
-    return cat_socket_peek_ex(socket, buffer, size, 0);
+    cat_socket_fd_t readfd;
+    cat_ret_t ret;
+
+    readfd = dup(fd);
+    if (unlikely(readfd == CAT_OS_INVALID_FD)) {
+        return cat_translate_sys_error(cat_sys_errno);
+    }
+    socket_i->context.io.read.coroutine = CAT_COROUTINE_G(current);
+    socket_i->io_flags |= CAT_SOCKET_IO_FLAG_READ;
+    ret = cat_poll_one(readfd, POLLIN, NULL, timeout);
+    socket_i->io_flags ^= CAT_SOCKET_IO_FLAG_READ;
+    socket_i->context.io.read.coroutine = NULL;
+    (void) uv__close(readfd);
+    if (ret == CAT_RET_OK) {
+        return socket_i->u.socket != NULL ? 0 : CAT_ECANCELED;
+    } else if (ret == CAT_RET_NONE) {
+        return CAT_ETIMEDOUT;
+    } else {
+        return CAT_EPREV;
+    }
 }
 
-CAT_API ssize_t cat_socket_peek_ex(const cat_socket_t *socket, char *buffer, size_t size, cat_timeout_t timeout)
+static ssize_t cat_socket_internal_recv_many_mmsg(
+    cat_socket_internal_t *socket_i, cat_socket_fd_t fd,
+    cat_socket_datagram_t *datagrams, size_t count,
+    cat_timeout_t timeout
+)
 {
-    CAT_LOG_DEBUG_VA(SOCKET, if (timeout != 0) {
-        CAT_LOG_DEBUG_D(SOCKET, "peek(" CAT_SOCKET_ID_FMT ", %p, %zu, " CAT_TIMEOUT_FMT ") = " CAT_LOG_UNFINISHED_STR,
-            socket->id, buffer, size, timeout);
-    });
+    cat_bool_t is_udg = (socket_i->type & CAT_SOCKET_TYPE_UDG) == CAT_SOCKET_TYPE_UDG;
+    struct mmsghdr msgs[CAT_SOCKET_MMSG_BATCH_SIZE];
+    struct iovec iovs[CAT_SOCKET_MMSG_BATCH_SIZE];
+    size_t nrecv = 0;
+    int error;
 
-    ssize_t n = cat_socket_peekfrom_impl(socket, buffer, size, NULL, NULL, timeout);
+    while (nrecv < count) {
+        unsigned int batch = (unsigned int) CAT_MIN(count - nrecv, CAT_SOCKET_MMSG_BATCH_SIZE), i;
+        int n;
+        for (i = 0; i < batch; i++) {
+            cat_socket_datagram_t *datagram = &datagrams[nrecv + i];
+            iovs[i].iov_base = datagram->buffer;
+            iovs[i].iov_len = datagram->size;
+            memset(&msgs[i].msg_hdr, 0, sizeof(msgs[i].msg_hdr));
+            msgs[i].msg_hdr.msg_name = &datagram->address.address;
+            msgs[i].msg_hdr.msg_namelen = sizeof(datagram->address.address);
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        n = recvmmsg(fd, msgs, batch, MSG_DONTWAIT, NULL);
+        if (likely(n > 0)) {
+            for (i = 0; i < (unsigned int) n; i++) {
+                cat_socket_datagram_t *datagram = &datagrams[nrecv + i];
+                datagram->length = msgs[i].msg_len;
+                datagram->address.length = msgs[i].msg_hdr.msg_namelen;
+            }
+            nrecv += n;
+            if ((unsigned int) n < batch) {
+                /* no more pending datagrams */
+                break;
+            }
+            continue;
+        }
+        if (unlikely(n == 0)) {
+            break;
+        }
+        if (unlikely(cat_sys_errno == EINTR)) {
+            continue;
+        }
+        if (unlikely(cat_sys_errno != EAGAIN)) {
+            error = cat_translate_sys_error(cat_sys_errno);
+            goto _error;
+        }
+        if (nrecv > 0) {
+            break;
+        }
+        if (is_udg) {
+            error = cat_socket_internal_udg_wait_readable(socket_i, fd, timeout);
+        } else {
+            error = cat_socket_internal_udp_wait_readable(socket_i, fd, timeout);
+        }
+        if (unlikely(error != 0)) {
+            goto _error;
+        }
+    }
 
-    CAT_LOG_DEBUG_VA(SOCKET, {
-        char *s;
-        CAT_LOG_DEBUG_D(SOCKET, "peek(" CAT_SOCKET_ID_FMT ", %s, %zu, " CAT_TIMEOUT_FMT ") = " CAT_LOG_SSIZE_RET_FMT,
-            socket->id, cat_log_str_quote(buffer, n < 0 ? 0 : n, &s), size, timeout, CAT_LOG_SSIZE_RET_C(n));
-        cat_free(s);
-    });
+    return (ssize_t) nrecv;
 
-    return n;
+    _error:
+    if (error == CAT_EPREV) {
+        cat_update_last_error_with_previous("Socket recv many wait failed");
+    } else if (error == CAT_ETIMEDOUT) {
+        cat_update_last_error(CAT_ETIMEDOUT, "Socket recv many timedout");
+    } else if (error == CAT_ECANCELED) {
+        cat_update_last_error(CAT_ECANCELED, "Socket recv many has been canceled");
+    } else {
+        cat_update_last_error_with_reason((cat_errno_t) error, "Socket recv many failed");
+    }
+    return nrecv > 0 ? (ssize_t) nrecv : -1;
 }
 
-CAT_API ssize_t cat_socket_peekfrom(const cat_socket_t *socket, char *buffer, size_t size, cat_sockaddr_t *address, cat_socklen_t *address_length)
+static ssize_t cat_socket_internal_send_many_mmsg(
+    cat_socket_internal_t *socket_i, cat_socket_fd_t fd,
+    const cat_socket_datagram_t *datagrams, size_t count,
+    cat_timeout_t timeout
+)
 {
-    return cat_socket_peekfrom_ex(socket, buffer, size, address, address_length, 0);
+    cat_queue_t *queue = &socket_i->context.io.write.coroutines;
+    struct mmsghdr msgs[CAT_SOCKET_MMSG_BATCH_SIZE];
+    struct iovec iovs[CAT_SOCKET_MMSG_BATCH_SIZE];
+    size_t nsent = 0;
+
+    while (nsent < count) {
+        unsigned int batch = (unsigned int) CAT_MIN(count - nsent, CAT_SOCKET_MMSG_BATCH_SIZE), i;
+        cat_socket_fd_t writefd;
+        cat_ret_t poll_ret;
+        int n;
+        for (i = 0; i < batch; i++) {
+            const cat_socket_datagram_t *datagram = &datagrams[nsent + i];
+            iovs[i].iov_base = datagram->buffer;
+            iovs[i].iov_len = datagram->length;
+            memset(&msgs[i].msg_hdr, 0, sizeof(msgs[i].msg_hdr));
+            if (datagram->address.length != 0) {
+                msgs[i].msg_hdr.msg_name = (void *) &datagram->address.address;
+                msgs[i].msg_hdr.msg_namelen = datagram->address.length;
+            }
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        do {
+            n = sendmmsg(fd, msgs, batch, 0);
+        } while (n < 0 && CAT_SOCKET_RETRY_ON_WRITE_ERROR(cat_sys_errno));
+        if (likely(n > 0)) {
+            nsent += n;
+            continue;
+        }
+        if (unlikely(n == 0 || !CAT_SOCKET_IS_TRANSIENT_WRITE_ERROR(cat_sys_errno))) {
+            cat_update_last_error_of_syscall("Socket send many failed");
+            break;
+        }
+        /* wait for writable, also for cancellation by close() */
+        writefd = dup(fd);
+        if (unlikely(writefd == CAT_OS_INVALID_FD)) {
+            cat_update_last_error_of_syscall("Socket send many dup failed");
+            break;
+        }
+        socket_i->io_flags |= CAT_SOCKET_IO_FLAG_WRITE;
+        cat_queue_push_back(queue, &CAT_COROUTINE_G(current)->waiter.node);
+        CAT_TIME_WAIT_START() {
+            poll_ret = cat_poll_one(writefd, POLLOUT, NULL, timeout);
+        } CAT_TIME_WAIT_END(timeout);
+        cat_queue_remove(&CAT_COROUTINE_G(current)->waiter.node);
+        if (cat_queue_empty(queue)) {
+            socket_i->io_flags ^= CAT_SOCKET_IO_FLAG_WRITE;
+        }
+        (void) uv__close(writefd);
+        if (likely(poll_ret == CAT_RET_OK && socket_i->u.socket != NULL)) {
+            continue;
+        } else if (poll_ret == CAT_RET_OK || socket_i->u.socket == NULL) {
+            cat_update_last_error(CAT_ECANCELED, "Socket send many has been canceled");
+        } else if (poll_ret == CAT_RET_NONE) {
+            cat_update_last_error(CAT_ETIMEDOUT, "Socket send many poll writable timedout");
+        } else {
+            cat_update_last_error_with_previous("Socket send many poll writable failed");
+        }
+        break;
+    }
+
+    return nsent > 0 ? (ssize_t) nsent : -1;
 }
+#endif
 
-CAT_API ssize_t cat_socket_peekfrom_ex(const cat_socket_t *socket, char *buffer, size_t size, cat_sockaddr_t *address, cat_socklen_t *address_length, cat_timeout_t timeout)
+static ssize_t cat_socket_recv_many_impl(cat_socket_t *socket, cat_socket_datagram_t *datagrams, size_t count, cat_timeout_t timeout)
 {
-    CAT_LOG_DEBUG_VA(SOCKET, if (timeout != 0) {
-        CAT_LOG_DEBUG_D(SOCKET, "peekfrom(" CAT_SOCKET_ID_FMT ", %p, %zu, %p, %d, " CAT_TIMEOUT_FMT ") = " CAT_LOG_UNFINISHED_STR,
-            socket->id, buffer, size, address, address_length != NULL ? *address_length: 0, timeout);
-    });
-
-    ssize_t n = cat_socket_peekfrom_impl(socket, buffer, size, address, address_length, timeout);
+    CAT_SOCKET_IO_CHECK(socket, socket_i, CAT_SOCKET_IO_FLAG_READ, return -1);
+    cat_socket_fd_t fd;
+    ssize_t n;
+    size_t i;
 
-    CAT_LOG_DEBUG_VA(SOCKET, {
-        char *s;
-        char name[CAT_SOCKADDR_MAX_PATH];
-        size_t name_length = sizeof(name);
-        int port;
-        if (cat_sockaddr_to_name_silent(address, address_length != NULL ? *address_length : 0, name, &name_length, &port) != 0) {
+    if (unlikely(!(socket_i->type & CAT_SOCKET_TYPE_FLAG_DGRAM))) {
+        cat_update_last_error(CAT_EMISUSE, "Socket recv many only supports datagram sockets");
+        return -1;
+    }
+    if (unlikely(count == 0)) {
+        return 0;
+    }
+    fd = cat_socket_internal_get_fd_fast(socket_i);
+#ifdef CAT_OS_LINUX
+    if (likely(fd != CAT_SOCKET_INVALID_FD)) {
+        return cat_socket_internal_recv_many_mmsg(socket_i, fd, datagrams, count, timeout);
+    }
+#endif
+    /* wait for the first one, then receive the rest without blocking */
+    datagrams[0].address.length = sizeof(datagrams[0].address.address);
+    n = cat_socket_internal_read(
+        socket_i, datagrams[0].buffer, datagrams[0].size,
+        &datagrams[0].address.address.common, &datagrams[0].address.length,
+        timeout, cat_true
+    );
+    if (unlikely(n < 0)) {
+        return -1;
+    }
+    datagrams[0].length = (size_t) n;
+    for (i = 1; i < count; i++) {
+        datagrams[i].address.length = sizeof(datagrams[i].address.address);
+        n = cat_socket_internal_try_recv(
+            socket_i, datagrams[i].buffer, datagrams[i].size,
+            &datagrams[i].address.address.common, &datagrams[i].address.length
+        );
+        if (n < 0) {
             break;
         }
-        CAT_LOG_DEBUG_D(SOCKET, "peekfrom(" CAT_SOCKET_ID_FMT ", %s, %zu, \"%.*s\", %d, " CAT_TIMEOUT_FMT ") = " CAT_LOG_SSIZE_RET_FMT,
-            socket->id, cat_log_str_quote(buffer, n < 0 ? 0 : n, &s), size, (int) name_length, name, port, timeout, CAT_LOG_SSIZE_RET_C(n));
-        cat_free(s);
-    });
+        datagrams[i].length = (size_t) n;
+    }
 
-    return n;
+    return (ssize_t) i;
 }
 
-CAT_API ssize_t cat_socket_peek_from(const cat_socket_t *socket, char *buffer, size_t size, char *name, size_t *name_length, int *port)
+CAT_API ssize_t cat_socket_recv_many(cat_socket_t *socket, cat_socket_datagram_t *datagrams, size_t count)
 {
-    return cat_socket_peek_from_ex(socket, buffer, size, name, name_length, port, 0);
+    return cat_socket_recv_many_ex(socket, datagrams, count, cat_socket_get_read_timeout_fast(socket));
 }
 
-CAT_API ssize_t cat_socket_peek_from_ex(const cat_socket_t *socket, char *buffer, size_t size, char *name, size_t *name_length, int *port, cat_timeout_t timeout)
+CAT_API ssize_t cat_socket_recv_many_ex(cat_socket_t *socket, cat_socket_datagram_t *datagrams, size_t count, cat_timeout_t timeout)
 {
-    CAT_LOG_DEBUG_VA(SOCKET, if (timeout != 0) {
-        CAT_LOG_DEBUG_D(SOCKET, "peek_from(" CAT_SOCKET_ID_FMT ", %p, %zu, %p, %zu, " CAT_TIMEOUT_FMT ") = " CAT_LOG_UNFINISHED_STR,
-            socket->id, buffer, size, name, name_length != NULL ? *name_length: 0, timeout);
-    });
+    CAT_LOG_DEBUG(SOCKET, "recv_many(" CAT_SOCKET_ID_FMT ", %p, %zu, " CAT_TIMEOUT_FMT ") = " CAT_LOG_UNFINISHED_STR,
+        socket->id, datagrams, count, timeout);
 
-    ssize_t n = cat_socket_peek_from_impl(socket, buffer, size, name, name_length, port, timeout);
+    ssize_t ret = cat_socket_recv_many_impl(socket, datagrams, count, timeout);
 
     CAT_LOG_DEBUG_VA(SOCKET, {
-        char *s;
-        CAT_LOG_DEBUG_D(SOCKET, "peek_from(" CAT_SOCKET_ID_FMT ", %s, %zu, \"%.*s\", %d, " CAT_TIMEOUT_FMT ") = " CAT_LOG_SSIZE_RET_FMT,
-            socket->id, cat_log_str_quote(buffer, n < 0 ? 0 : n, &s), size, (int) (name_length != NULL ? *name_length : 0), name, port != NULL ? *port : 0, timeout, CAT_LOG_SSIZE_RET_C(n));
-        cat_free(s);
+        CAT_LOG_DEBUG_D(SOCKET, "recv_many(" CAT_SOCKET_ID_FMT ", %p, %zu, " CAT_TIMEOUT_FMT ") = " CAT_LOG_SSIZE_RET_FMT,
+            socket->id, datagrams, count, timeout, CAT_LOG_SSIZE_RET_C(ret));
     });
 
-    return n;
+    return ret;
 }
 
-#define CAT_SOCKET_IPCC_CHECK(_socket, _socket_i, _io_flags, _failure) \
-    CAT_SOCKET_IO_CHECK_RAW(_socket, _socket_i, _io_flags, _failure); \
-    if (unlikely(!((_socket_i->type & CAT_SOCKET_TYPE_IPCC) == CAT_SOCKET_TYPE_IPCC))) { \
-        cat_update_last_error(CAT_EINVAL, "Socket must be named pipe with IPC enabled"); \
-        _failure; \
-    }
-
-#ifndef CAT_OS_WIN
-#define CAT_SOCKET_IPCC_SUPPORTS "TCP, PIPE, UDP and UDG"
-#else
-#define CAT_SOCKET_IPCC_SUPPORTS "TCP"
-#endif
-
-// TODO: support send extra message
-static cat_bool_t cat_socket_send_handle_impl(cat_socket_t *socket, cat_socket_t *handle, cat_timeout_t timeout)
+static ssize_t cat_socket_send_many_impl(cat_socket_t *socket, const cat_socket_datagram_t *datagrams, size_t count, cat_timeout_t timeout)
 {
-    CAT_SOCKET_IPCC_CHECK(socket, socket_i, CAT_SOCKET_IO_FLAG_NONE, return cat_false);
-    cat_socket_internal_t *ihandle;
+    CAT_SOCKET_IO_CHECK(socket, socket_i, CAT_SOCKET_IO_FLAG_NONE, return -1);
+    cat_socket_fd_t fd;
+    size_t i = 0;
 
-    if (unlikely(!cat_socket_is_available(handle))) {
-        cat_update_last_error(CAT_EINVAL, "Socket can not send an unavailble handle");
-        return cat_false;
-    }
-    ihandle = handle->internal;
-    if (unlikely(!cat_socket_internal_can_be_transfer_by_ipc(ihandle))) {
-        cat_update_last_error(CAT_EINVAL, "Socket can only send " CAT_SOCKET_IPCC_SUPPORTS " handle");
-        return cat_false;
+    if (unlikely(!(socket_i->type & CAT_SOCKET_TYPE_FLAG_DGRAM))) {
+        cat_update_last_error(CAT_EMISUSE, "Socket send many only supports datagram sockets");
+        return -1;
     }
-
-    cat_socket_inheritance_info_t handle_info = {
-        ihandle->type,
-        ihandle->options
-    };
-    cat_socket_write_vector_t vector = cat_socket_write_vector_init((char *) &handle_info, (cat_socket_vector_length_t) sizeof(handle_info));
-    if (!cat_socket_internal_write_raw(socket_i, &vector, 1, NULL, 0, handle, timeout)) {
-        cat_socket_internal_unrecoverable_io_error(socket_i);
-        return cat_false;
+    for (; i < count; i++) {
+        const cat_socket_datagram_t *datagram = &datagrams[i];
+        cat_socket_write_vector_t vector;
+        cat_bool_t ret;
+        fd = cat_socket_internal_get_fd_fast(socket_i);
+#ifdef CAT_OS_LINUX
+        /* fd of UDP socket is created lazily, the first send will create it */
+        if (likely(fd != CAT_SOCKET_INVALID_FD)) {
+            ssize_t n = cat_socket_internal_send_many_mmsg(socket_i, fd, datagrams + i, count - i, timeout);
+            if (unlikely(n < 0)) {
+                break;
+            }
+            i += n;
+            break;
+        }
+#endif
+        vector = cat_socket_write_vector_init(datagram->buffer, (cat_socket_vector_length_t) datagram->length);
+        CAT_TIME_WAIT_START() {
+            ret = cat_socket_internal_write(
+                socket_i, &vector, 1,
+                datagram->address.length != 0 ? &datagram->address.address.common : NULL,
+                datagram->address.length, timeout
+            );
+        } CAT_TIME_WAIT_END(timeout);
+        if (unlikely(!ret)) {
+            break;
+        }
+        if (unlikely(socket_i->u.socket == NULL)) {
+            cat_update_last_error(CAT_ECANCELED, "Socket has been closed during sending");
+            break;
+        }
     }
 
-    return cat_true;
+    return i > 0 ? (ssize_t) i : -1;
 }
 
-CAT_API cat_bool_t cat_socket_send_handle(cat_socket_t *socket, cat_socket_t *handle)
+CAT_API ssize_t cat_socket_send_many(cat_socket_t *socket, const cat_socket_datagram_t *datagrams, size_t count)
 {
-    return cat_socket_send_handle_ex(socket, handle, cat_socket_get_write_timeout_fast(socket));
+    return cat_socket_send_many_ex(socket, datagrams, count, cat_socket_get_write_timeout_fast(socket));
 }
 
-CAT_API cat_bool_t cat_socket_send_handle_ex(cat_socket_t *socket, cat_socket_t *handle, cat_timeout_t timeout)
+CAT_API ssize_t cat_socket_send_many_ex(cat_socket_t *socket, const cat_socket_datagram_t *datagrams, size_t count, cat_timeout_t timeout)
 {
-    CAT_LOG_DEBUG(SOCKET, "send_handle(" CAT_SOCKET_ID_FMT ", " CAT_SOCKET_ID_FMT ", " CAT_TIMEOUT_FMT ") = " CAT_LOG_UNFINISHED_STR,
-        socket->id, handle->id, timeout);
+    CAT_LOG_DEBUG(SOCKET, "send_many(" CAT_SOCKET_ID_FMT ", %p, %zu, " CAT_TIMEOUT_FMT ") = " CAT_LOG_UNFINISHED_STR,
+        socket->id, datagrams, count, timeout);
 
-    cat_bool_t ret = cat_socket_send_handle_impl(socket, handle, timeout);
+    ssize_t ret = count == 0 ? 0 : cat_socket_send_many_impl(socket, datagrams, count, timeout);
 
     CAT_LOG_DEBUG_VA(SOCKET, {
-        CAT_LOG_DEBUG_D(SOCKET, "send_handle(" CAT_SOCKET_ID_FMT ", " CAT_SOCKET_ID_FMT ", " CAT_TIMEOUT_FMT ") = " CAT_LOG_BOOL_RET_FMT,
-            socket->id, handle->id, timeout, CAT_LOG_BOOL_RET_C(ret));
+        CAT_LOG_DEBUG_D(SOCKET, "send_many(" CAT_SOCKET_ID_FMT ", %p, %zu, " CAT_TIMEOUT_FMT ") = " CAT_LOG_SSIZE_RET_FMT,
+            socket->id, datagrams, count, timeout, CAT_LOG_SSIZE_RET_C(ret));
     });
 
     return ret;
@@ -4340,8 +5649,10 @@ static void cat_socket_close_callback(uv_handle_t *handle)
     }
 #endif
 
-    if (socket_i->cache.write_request != NULL) {
-        cat_free(socket_i->cache.write_request);
+    while (socket_i->cache.write_requests != NULL) {
+        cat_socket_write_request_t *request = socket_i->cache.write_requests;
+        socket_i->cache.write_requests = request->next;
+        cat_free(request);
     }
     if (socket_i->cache.ipcc_handle_info != NULL) {
         cat_free(socket_i->cache.ipcc_handle_info);
@@ -4379,6 +5690,10 @@ static void cat_socket_internal_close_impl(cat_socket_internal_t *socket_i, cat_
         uv_ref(&socket_i->u.handle);
     }
 
+    /* corked data which has not been flushed is discarded */
+    cat_socket_internal_cork_unschedule_flush(socket_i);
+    cat_buffer_close(&socket_i->cork.buffer);
+
 #ifdef CAT_SSL
     if (socket_i->ssl != NULL &&
         cat_ssl_get_shutdown(socket_i->ssl) != (CAT_SSL_SENT_SHUTDOWN | CAT_SSL_RECEIVED_SHUTDOWN)) {
@@ -4447,7 +5762,25 @@ static cat_always_inline cat_bool_t cat_socket_close_impl(cat_socket_t *socket)
             ret = cat_false;
         }
     } else {
-        cat_socket_internal_close_impl(socket_i, cat_false);
+        if (unlikely(socket_i->cork.error != 0)) {
+            /* report it if corked data has been lost */
+            cat_update_last_error_with_reason(socket_i->cork.error, "Socket cork flush failed");
+            ret = cat_false;
+        } else if (unlikely(socket_i->cork.buffer.length != 0) && cat_socket_internal_is_established(socket_i)) {
+            /* corked data must be sent before closing */
+            if (likely(!cat_coroutine_switch_denied())) {
+                ret = cat_socket_internal_cork_flush(socket_i, cat_socket_get_write_timeout_fast(socket));
+            } else {
+                /* we can not wait here, write as much as possible */
+                cat_socket_internal_cork_flush_async(socket_i);
+            }
+            /* it may be closed during flushing */
+            socket_i = socket->internal;
+            socket->flags &= ~CAT_SOCKET_FLAG_UNRECOVERABLE_ERROR;
+        }
+        if (socket_i != NULL) {
+            cat_socket_internal_close_impl(socket_i, cat_false);
+        }
     }
 
     if (socket->flags & CAT_SOCKET_FLAG_ALLOCATED) {
@@ -4925,6 +6258,82 @@ CAT_API cat_bool_t cat_socket_set_tcp_accept_balance(cat_socket_t *socket, cat_b
     return cat_true;
 }
 
+CAT_API size_t cat_socket_get_tcp_zerocopy_threshold(const cat_socket_t *socket)
+{
+#ifdef CAT_SOCKET_ZEROCOPY
+    CAT_SOCKET_INTERNAL_GETTER_SILENT(socket, socket_i, return 0);
+
+    return socket_i->zerocopy.threshold;
+#else
+    (void) socket;
+    return 0;
+#endif
+}
+
+CAT_API cat_bool_t cat_socket_set_tcp_zerocopy_threshold(cat_socket_t *socket, size_t threshold)
+{
+    CAT_SOCKET_INTERNAL_GETTER(socket, socket_i, return cat_false);
+    CAT_SOCKET_INTERNAL_TCP_ONLY(socket_i, return cat_false);
+#ifdef CAT_SOCKET_ZEROCOPY
+    cat_socket_fd_t fd;
+    int enable = threshold != 0;
+
+    if (!!socket_i->zerocopy.threshold == !!threshold) {
+        socket_i->zerocopy.threshold = threshold;
+        return cat_true;
+    }
+    fd = cat_socket_internal_get_fd_fast(socket_i);
+    if (unlikely(fd == CAT_SOCKET_INVALID_FD)) {
+        cat_update_last_error(CAT_EBADF, "Socket is not initialized, TCP zerocopy can not be enabled");
+        return cat_false;
+    }
+    if (enable && unlikely(setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable)) != 0)) {
+        cat_update_last_error_of_syscall("Socket enable TCP zerocopy failed");
+        return cat_false;
+    }
+    /* SO_ZEROCOPY can not be disabled once it was enabled, but it only takes effect with MSG_ZEROCOPY */
+    socket_i->zerocopy.threshold = threshold;
+
+    return cat_true;
+#else
+    (void) threshold;
+    cat_update_last_error(CAT_ENOTSUP, "Socket TCP zerocopy is not supported on this platform");
+    return cat_false;
+#endif
+}
+
+CAT_API cat_socket_inline_read_mode_t cat_socket_get_inline_read_mode(const cat_socket_t *socket)
+{
+    CAT_SOCKET_INTERNAL_GETTER_SILENT(socket, socket_i, return CAT_SOCKET_INLINE_READ_MODE_DEFAULT);
+
+    return socket_i->options.inline_read_mode;
+}
+
+CAT_API cat_bool_t cat_socket_set_inline_read_mode(cat_socket_t *socket, cat_socket_inline_read_mode_t mode)
+{
+    CAT_SOCKET_INTERNAL_GETTER(socket, socket_i, return cat_false);
+
+    if (unlikely(mode < CAT_SOCKET_INLINE_READ_MODE_DEFAULT || mode > CAT_SOCKET_INLINE_READ_MODE_NEVER)) {
+        cat_update_last_error(CAT_EINVAL, "Socket inline read mode %d is invalid", (int) mode);
+        return cat_false;
+    }
+    socket_i->options.inline_read_mode = mode;
+    socket_i->inline_read.misses = 0;
+    socket_i->inline_read.backoff = 0;
+    socket_i->inline_read.skips = 0;
+
+    return cat_true;
+}
+
+CAT_API cat_bool_t cat_socket_get_inline_read_stats(const cat_socket_t *socket, cat_socket_inline_read_stats_t *stats)
+{
+    CAT_SOCKET_INTERNAL_GETTER(socket, socket_i, return cat_false);
+
+    *stats = socket_i->inline_read.stats;
+
+    return cat_true;
+}
+
 CAT_API cat_bool_t cat_socket_get_udp_broadcast(const cat_socket_t *socket)
 {
     CAT_SOCKET_INTERNAL_GETTER_SILENT(socket, socket_i, return cat_false);
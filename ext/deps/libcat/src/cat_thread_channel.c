@@ -0,0 +1,628 @@
+/*
+  +--------------------------------------------------------------------------+
+  | libcat                                                                   |
+  +--------------------------------------------------------------------------+
+  | Licensed under the Apache License, Version 2.0 (the "License");          |
+  | you may not use this file except in compliance with the License.         |
+  | You may obtain a copy of the License at                                  |
+  | http://www.apache.org/licenses/LICENSE-2.0                               |
+  | Unless required by applicable law or agreed to in writing, software      |
+  | distributed under the License is distributed on an "AS IS" BASIS,        |
+  | WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. |
+  | See the License for the specific language governing permissions and      |
+  | limitations under the License. See accompanying LICENSE file.            |
+  +--------------------------------------------------------------------------+
+  | Author: Twosee <twosee@php.net>                                          |
+  +--------------------------------------------------------------------------+
+ */
+
+#include "cat_thread_channel.h"
+#include "cat_async.h"
+#include "cat_coroutine.h"
+#include "cat_time.h"
+
+/* waiter lives on the stack of the waiting coroutine,
+ * it can only be accessed with the channel mutex held */
+typedef struct cat_thread_channel_waiter_s {
+    cat_queue_node_t node;
+    cat_async_t *async;
+    cat_bool_t notified;
+} cat_thread_channel_waiter_t;
+
+/* consumer which is waiting in the consumer thread of a single consumer channel */
+typedef struct cat_thread_channel_local_waiter_s {
+    cat_queue_node_t node;
+    cat_coroutine_t *coroutine;
+    cat_bool_t notified;
+} cat_thread_channel_local_waiter_t;
+
+/* one-shot async armed by the consumer thread when it has nothing to pop,
+ * it is rung by the first producer who sees it, so wakeups are coalesced */
+struct cat_thread_channel_doorbell_s {
+    cat_async_t async;
+    cat_thread_channel_t *channel;
+};
+
+static cat_always_inline cat_bool_t cat_thread_channel_is_lockfree(const cat_thread_channel_t *channel)
+{
+    return channel->flags & CAT_THREAD_CHANNEL_FLAG_SINGLE_CONSUMER;
+}
+
+static cat_always_inline cat_bool_t cat_thread_channel_is_closed(cat_thread_channel_t *channel)
+{
+    return cat_atomic_bool_load(&channel->closed);
+}
+
+static cat_always_inline char *cat_thread_channel_storage_slot(const cat_thread_channel_t *channel, uint64_t position)
+{
+    return channel->storage + (size_t) (position % channel->capacity) * channel->data_size;
+}
+
+static cat_always_inline cat_timeout_t cat_thread_channel_get_timeout_left(cat_timeout_t timeout, cat_msec_t start)
+{
+    cat_msec_t elapsed;
+
+    if (timeout <= 0) {
+        return timeout;
+    }
+    elapsed = cat_time_msec() - start;
+
+    return elapsed >= (cat_msec_t) timeout ? 0 : (cat_timeout_t) (timeout - elapsed);
+}
+
+static void cat_thread_channel_notify(cat_queue_t *queue)
+{
+    cat_thread_channel_waiter_t *waiter = cat_queue_front_data(queue, cat_thread_channel_waiter_t, node);
+
+    if (waiter != NULL) {
+        cat_queue_remove(&waiter->node);
+        waiter->notified = cat_true;
+        (void) cat_async_notify(waiter->async);
+    }
+}
+
+static void cat_thread_channel_notify_all(cat_queue_t *queue)
+{
+    while (!cat_queue_empty(queue)) {
+        cat_thread_channel_notify(queue);
+    }
+}
+
+/* it must be called with mutex held, and it returns with mutex held */
+static cat_bool_t cat_thread_channel_wait(cat_thread_channel_t *channel, cat_queue_t *queue, cat_timeout_t timeout)
+{
+    cat_thread_channel_waiter_t waiter;
+    cat_bool_t ret;
+
+    waiter.async = cat_async_create(NULL);
+    if (unlikely(waiter.async == NULL)) {
+        return cat_false;
+    }
+    waiter.notified = cat_false;
+    cat_queue_push_back(queue, &waiter.node);
+
+    uv_mutex_unlock(&channel->mutex);
+    ret = cat_async_wait_and_close(waiter.async, NULL, timeout);
+    uv_mutex_lock(&channel->mutex);
+
+    if (!waiter.notified) {
+        /* nobody can reach it anymore, notify it by ourselves so that it can be closed */
+        CAT_ASSERT(!ret);
+        cat_queue_remove(&waiter.node);
+        (void) cat_async_notify(waiter.async);
+    } else if (unlikely(!ret)) {
+        /* we were notified but we are leaving (timedout or canceled), pass it on */
+        cat_thread_channel_notify(queue);
+    }
+
+    return ret;
+}
+
+/* lock-free ring (single consumer) */
+
+static cat_bool_t cat_thread_channel_lockfree_try_push(cat_thread_channel_t *channel, const cat_data_t *data)
+{
+    uint64_t tail = cat_atomic_uint64_load(&channel->u.lockfree.tail);
+    cat_atomic_uint64_t *sequence;
+
+    while (1) {
+        uint64_t current;
+        sequence = &channel->u.lockfree.sequences[tail % channel->capacity];
+        current = cat_atomic_uint64_load(sequence);
+        if (current == tail * 2) {
+            /* slot is free, try to claim it (tail will be updated if we lost) */
+            if (cat_atomic_uint64_compare_exchange_weak(&channel->u.lockfree.tail, &tail, tail + 1)) {
+                break;
+            }
+        } else if ((int64_t) (current - tail * 2) < 0) {
+            /* slot has not been popped yet, it is full */
+            return cat_false;
+        } else {
+            /* other producer has claimed it */
+            tail = cat_atomic_uint64_load(&channel->u.lockfree.tail);
+        }
+    }
+    memcpy(cat_thread_channel_storage_slot(channel, tail), data, channel->data_size);
+    /* publish it */
+    cat_atomic_uint64_store(sequence, tail * 2 + 1);
+
+    return cat_true;
+}
+
+static cat_always_inline cat_bool_t cat_thread_channel_lockfree_is_readable(cat_thread_channel_t *channel)
+{
+    uint64_t head = cat_atomic_uint64_load(&channel->u.lockfree.head);
+
+    return cat_atomic_uint64_load(&channel->u.lockfree.sequences[head % channel->capacity]) == head * 2 + 1;
+}
+
+/* consumer thread only */
+static cat_bool_t cat_thread_channel_lockfree_try_pop(cat_thread_channel_t *channel, cat_data_t *data)
+{
+    uint64_t head = cat_atomic_uint64_load(&channel->u.lockfree.head);
+    cat_atomic_uint64_t *sequence = &channel->u.lockfree.sequences[head % channel->capacity];
+    char *slot;
+
+    /* empty, or the producer has not finished writing yet (it will ring the doorbell later) */
+    if (cat_atomic_uint64_load(sequence) != head * 2 + 1) {
+        return cat_false;
+    }
+    slot = cat_thread_channel_storage_slot(channel, head);
+    if (data != NULL) {
+        memcpy(data, slot, channel->data_size);
+    } else if (channel->dtor != NULL) {
+        channel->dtor(slot);
+    }
+    /* release the slot to producers of the next lap */
+    cat_atomic_uint64_store(sequence, (head + channel->capacity) * 2);
+    cat_atomic_uint64_store(&channel->u.lockfree.head, head + 1);
+
+    return cat_true;
+}
+
+/* it can be called in any thread */
+static void cat_thread_channel_lockfree_ring(cat_thread_channel_t *channel)
+{
+    cat_thread_channel_doorbell_t *doorbell;
+
+    if (cat_atomic_ptr_load(&channel->u.lockfree.doorbell) == NULL) {
+        return;
+    }
+    doorbell = (cat_thread_channel_doorbell_t *) cat_atomic_ptr_exchange(&channel->u.lockfree.doorbell, NULL);
+    if (doorbell != NULL) {
+        (void) cat_async_notify(&doorbell->async);
+    }
+}
+
+static void cat_thread_channel_lockfree_wake_consumer(cat_thread_channel_t *channel)
+{
+    cat_thread_channel_local_waiter_t *waiter = cat_queue_front_data(&channel->u.lockfree.consumers, cat_thread_channel_local_waiter_t, node);
+
+    if (waiter != NULL) {
+        cat_queue_remove(&waiter->node);
+        waiter->notified = cat_true;
+        cat_coroutine_schedule(waiter->coroutine, CHANNEL, "Thread channel consumer");
+    }
+}
+
+static void cat_thread_channel_lockfree_doorbell_cleanup(cat_async_t *async)
+{
+    cat_thread_channel_doorbell_t *doorbell = cat_container_of(async, cat_thread_channel_doorbell_t, async);
+    cat_thread_channel_t *channel = doorbell->channel;
+
+    if (channel->u.lockfree.armed == doorbell) {
+        channel->u.lockfree.armed = NULL;
+    }
+    cat_free(doorbell);
+    cat_thread_channel_lockfree_wake_consumer(channel);
+    cat_thread_channel_release(channel);
+}
+
+static cat_bool_t cat_thread_channel_lockfree_arm(cat_thread_channel_t *channel)
+{
+    cat_thread_channel_doorbell_t *doorbell;
+
+    if (channel->u.lockfree.armed != NULL) {
+        /* it is armed or it has been rung, both will wake us up */
+        return cat_true;
+    }
+    doorbell = (cat_thread_channel_doorbell_t *) cat_malloc(sizeof(*doorbell));
+#if CAT_ALLOC_HANDLE_ERRORS
+    if (unlikely(doorbell == NULL)) {
+        cat_update_last_error_of_syscall("Malloc for thread channel doorbell failed");
+        return cat_false;
+    }
+#endif
+    if (unlikely(cat_async_create(&doorbell->async) == NULL)) {
+        cat_free(doorbell);
+        return cat_false;
+    }
+    doorbell->channel = cat_thread_channel_add_ref(channel);
+    /* it will be closed after it was rung */
+    (void) cat_async_cleanup(&doorbell->async, cat_thread_channel_lockfree_doorbell_cleanup);
+    channel->u.lockfree.armed = doorbell;
+    cat_atomic_ptr_store(&channel->u.lockfree.doorbell, doorbell);
+
+    return cat_true;
+}
+
+static void cat_thread_channel_lockfree_disarm(cat_thread_channel_t *channel)
+{
+    cat_thread_channel_doorbell_t *doorbell = channel->u.lockfree.armed;
+
+    if (doorbell == NULL) {
+        return;
+    }
+    channel->u.lockfree.armed = NULL;
+    /* if producer has taken it, it will be rung by the producer,
+     * otherwise we ring it by ourselves so that it can be closed */
+    if (cat_atomic_ptr_compare_exchange_strong(&channel->u.lockfree.doorbell, (cat_ptr_t *) &doorbell, NULL)) {
+        (void) cat_async_notify(&doorbell->async);
+    }
+}
+
+static void cat_thread_channel_lockfree_after_pop(cat_thread_channel_t *channel)
+{
+    /* there is space now, let waiting producer know */
+    if (unlikely(cat_atomic_uint32_load(&channel->u.lockfree.producer_waiters) != 0)) {
+        uv_mutex_lock(&channel->mutex);
+        cat_thread_channel_notify(&channel->producers);
+        uv_mutex_unlock(&channel->mutex);
+    }
+    /* there may be more data, pass it on to the other waiting consumer */
+    if (!cat_queue_empty(&channel->u.lockfree.consumers) && cat_thread_channel_lockfree_is_readable(channel)) {
+        cat_thread_channel_lockfree_wake_consumer(channel);
+    }
+}
+
+static cat_bool_t cat_thread_channel_lockfree_push(cat_thread_channel_t *channel, const cat_data_t *data, cat_timeout_t timeout)
+{
+    cat_msec_t start = timeout > 0 ? cat_time_msec() : 0;
+    cat_bool_t ret;
+
+    while (1) {
+        if (unlikely(cat_thread_channel_is_closed(channel))) {
+            cat_update_last_error(CAT_ECLOSED, "Channel has been closed");
+            return cat_false;
+        }
+        if (likely(cat_thread_channel_lockfree_try_push(channel, data))) {
+            break;
+        }
+        /* it is full, wait for the consumer (slow path) */
+        uv_mutex_lock(&channel->mutex);
+        (void) cat_atomic_uint32_fetch_add(&channel->u.lockfree.producer_waiters, 1);
+        /* consumer may have popped before it saw us */
+        if (cat_thread_channel_lockfree_try_push(channel, data)) {
+            (void) cat_atomic_uint32_fetch_sub(&channel->u.lockfree.producer_waiters, 1);
+            uv_mutex_unlock(&channel->mutex);
+            break;
+        }
+        if (unlikely(cat_thread_channel_is_closed(channel))) {
+            ret = cat_false;
+            cat_update_last_error(CAT_ECLOSED, "Channel has been closed");
+        } else {
+            ret = cat_thread_channel_wait(channel, &channel->producers, cat_thread_channel_get_timeout_left(timeout, start));
+            if (unlikely(!ret)) {
+                cat_update_last_error_with_previous("Channel wait consumer failed");
+            }
+        }
+        (void) cat_atomic_uint32_fetch_sub(&channel->u.lockfree.producer_waiters, 1);
+        uv_mutex_unlock(&channel->mutex);
+        if (unlikely(!ret)) {
+            return cat_false;
+        }
+    }
+    cat_thread_channel_lockfree_ring(channel);
+
+    return cat_true;
+}
+
+static cat_bool_t cat_thread_channel_lockfree_pop(cat_thread_channel_t *channel, cat_data_t *data, cat_timeout_t timeout)
+{
+    cat_msec_t start = timeout > 0 ? cat_time_msec() : 0;
+    uv_thread_t current_thread = uv_thread_self();
+    cat_thread_channel_local_waiter_t waiter;
+    cat_bool_t ret = cat_true;
+
+    if (unlikely(!uv_thread_equal(&channel->u.lockfree.consumer, &current_thread))) {
+        cat_update_last_error(CAT_EMISUSE, "Channel can only be popped in the thread which created it");
+        return cat_false;
+    }
+
+    while (1) {
+        if (cat_thread_channel_lockfree_try_pop(channel, data)) {
+            break;
+        }
+        if (unlikely(cat_thread_channel_is_closed(channel))) {
+            cat_update_last_error(CAT_ECLOSED, "Channel has been closed");
+            ret = cat_false;
+            break;
+        }
+        if (unlikely(!cat_thread_channel_lockfree_arm(channel))) {
+            cat_update_last_error_with_previous("Channel wait producer failed");
+            ret = cat_false;
+            break;
+        }
+        /* producer may have pushed before it saw the doorbell */
+        if (cat_thread_channel_lockfree_try_pop(channel, data)) {
+            break;
+        }
+        if (unlikely(cat_thread_channel_is_closed(channel))) {
+            cat_update_last_error(CAT_ECLOSED, "Channel has been closed");
+            ret = cat_false;
+            break;
+        }
+        waiter.coroutine = CAT_COROUTINE_G(current);
+        waiter.notified = cat_false;
+        cat_queue_push_back(&channel->u.lockfree.consumers, &waiter.node);
+        ret = cat_time_wait(cat_thread_channel_get_timeout_left(timeout, start));
+        if (!waiter.notified) {
+            cat_queue_remove(&waiter.node);
+            if (ret) {
+                cat_update_last_error(CAT_ECANCELED, "Channel wait producer has been canceled");
+                ret = cat_false;
+            } else {
+                cat_update_last_error_with_previous("Channel wait producer failed");
+            }
+            break;
+        }
+        CAT_ASSERT(ret);
+    }
+
+    if (ret) {
+        cat_thread_channel_lockfree_after_pop(channel);
+    } else if (cat_thread_channel_is_closed(channel)) {
+        /* let the other consumers know it */
+        cat_thread_channel_lockfree_wake_consumer(channel);
+    }
+    if (cat_queue_empty(&channel->u.lockfree.consumers)) {
+        /* do not keep the event loop alive if nobody is waiting */
+        cat_thread_channel_lockfree_disarm(channel);
+    }
+
+    return ret;
+}
+
+/* mutex protected ring (multiple consumers) */
+
+static cat_bool_t cat_thread_channel_locked_push(cat_thread_channel_t *channel, const cat_data_t *data, cat_timeout_t timeout)
+{
+    cat_msec_t start = timeout > 0 ? cat_time_msec() : 0;
+
+    uv_mutex_lock(&channel->mutex);
+    while (1) {
+        if (unlikely(cat_thread_channel_is_closed(channel))) {
+            uv_mutex_unlock(&channel->mutex);
+            cat_update_last_error(CAT_ECLOSED, "Channel has been closed");
+            return cat_false;
+        }
+        if (channel->u.locked.length < channel->capacity) {
+            memcpy(cat_thread_channel_storage_slot(channel, channel->u.locked.head + channel->u.locked.length), data, channel->data_size);
+            channel->u.locked.length++;
+            cat_thread_channel_notify(&channel->u.locked.consumers);
+            break;
+        }
+        if (unlikely(!cat_thread_channel_wait(channel, &channel->producers, cat_thread_channel_get_timeout_left(timeout, start)))) {
+            uv_mutex_unlock(&channel->mutex);
+            cat_update_last_error_with_previous("Channel wait consumer failed");
+            return cat_false;
+        }
+    }
+    uv_mutex_unlock(&channel->mutex);
+
+    return cat_true;
+}
+
+static cat_bool_t cat_thread_channel_locked_pop(cat_thread_channel_t *channel, cat_data_t *data, cat_timeout_t timeout)
+{
+    cat_msec_t start = timeout > 0 ? cat_time_msec() : 0;
+
+    uv_mutex_lock(&channel->mutex);
+    while (1) {
+        if (channel->u.locked.length > 0) {
+            char *slot = cat_thread_channel_storage_slot(channel, channel->u.locked.head);
+            if (data != NULL) {
+                memcpy(data, slot, channel->data_size);
+            } else if (channel->dtor != NULL) {
+                channel->dtor(slot);
+            }
+            channel->u.locked.head = (channel->u.locked.head + 1) % channel->capacity;
+            channel->u.locked.length--;
+            cat_thread_channel_notify(&channel->producers);
+            break;
+        }
+        if (unlikely(cat_thread_channel_is_closed(channel))) {
+            uv_mutex_unlock(&channel->mutex);
+            cat_update_last_error(CAT_ECLOSED, "Channel has been closed");
+            return cat_false;
+        }
+        if (unlikely(!cat_thread_channel_wait(channel, &channel->u.locked.consumers, cat_thread_channel_get_timeout_left(timeout, start)))) {
+            uv_mutex_unlock(&channel->mutex);
+            cat_update_last_error_with_previous("Channel wait producer failed");
+            return cat_false;
+        }
+    }
+    uv_mutex_unlock(&channel->mutex);
+
+    return cat_true;
+}
+
+CAT_API cat_thread_channel_t *cat_thread_channel_create(cat_channel_size_t capacity, cat_channel_data_size_t data_size, cat_channel_data_dtor_t dtor)
+{
+    return cat_thread_channel_create_ex(capacity, data_size, dtor, CAT_THREAD_CHANNEL_FLAG_NONE);
+}
+
+CAT_API cat_thread_channel_t *cat_thread_channel_create_ex(cat_channel_size_t capacity, cat_channel_data_size_t data_size, cat_channel_data_dtor_t dtor, cat_thread_channel_flags_t flags)
+{
+    cat_thread_channel_t *channel;
+    int error;
+
+    if (unlikely(capacity == 0)) {
+        cat_update_last_error(CAT_EINVAL, "Thread channel capacity can not be 0");
+        return NULL;
+    }
+    channel = (cat_thread_channel_t *) cat_malloc(sizeof(*channel));
+#if CAT_ALLOC_HANDLE_ERRORS
+    if (unlikely(channel == NULL)) {
+        cat_update_last_error_of_syscall("Malloc for thread channel failed");
+        return NULL;
+    }
+#endif
+    channel->storage = (char *) cat_malloc((size_t) capacity * data_size);
+#if CAT_ALLOC_HANDLE_ERRORS
+    if (unlikely(channel->storage == NULL)) {
+        cat_update_last_error_of_syscall("Malloc for thread channel storage failed");
+        cat_free(channel);
+        return NULL;
+    }
+#endif
+    error = uv_mutex_init(&channel->mutex);
+    if (unlikely(error != 0)) {
+        cat_update_last_error_with_reason(error, "Thread channel mutex init failed");
+        cat_free(channel->storage);
+        cat_free(channel);
+        return NULL;
+    }
+    cat_atomic_uint32_init(&channel->refcount, 1);
+    cat_atomic_bool_init(&channel->closed, cat_false);
+    channel->flags = flags;
+    channel->data_size = data_size;
+    channel->dtor = dtor;
+    channel->capacity = capacity;
+    cat_queue_init(&channel->producers);
+    if (cat_thread_channel_is_lockfree(channel)) {
+        cat_channel_size_t n;
+        channel->u.lockfree.sequences = (cat_atomic_uint64_t *) cat_malloc(sizeof(*channel->u.lockfree.sequences) * capacity);
+#if CAT_ALLOC_HANDLE_ERRORS
+        if (unlikely(channel->u.lockfree.sequences == NULL)) {
+            cat_update_last_error_of_syscall("Malloc for thread channel sequences failed");
+            uv_mutex_destroy(&channel->mutex);
+            cat_free(channel->storage);
+            cat_free(channel);
+            return NULL;
+        }
+#endif
+        for (n = 0; n < capacity; n++) {
+            cat_atomic_uint64_init(&channel->u.lockfree.sequences[n], (uint64_t) n * 2);
+        }
+        cat_atomic_uint64_init(&channel->u.lockfree.tail, 0);
+        cat_atomic_uint64_init(&channel->u.lockfree.head, 0);
+        cat_atomic_uint32_init(&channel->u.lockfree.producer_waiters, 0);
+        cat_atomic_ptr_init(&channel->u.lockfree.doorbell, NULL);
+        channel->u.lockfree.consumer = uv_thread_self();
+        channel->u.lockfree.armed = NULL;
+        cat_queue_init(&channel->u.lockfree.consumers);
+    } else {
+        channel->u.locked.length = 0;
+        channel->u.locked.head = 0;
+        cat_queue_init(&channel->u.locked.consumers);
+    }
+
+    return channel;
+}
+
+CAT_API cat_thread_channel_t *cat_thread_channel_add_ref(cat_thread_channel_t *channel)
+{
+    (void) cat_atomic_uint32_fetch_add(&channel->refcount, 1);
+
+    return channel;
+}
+
+CAT_API void cat_thread_channel_release(cat_thread_channel_t *channel)
+{
+    if (cat_atomic_uint32_fetch_sub(&channel->refcount, 1) != 1) {
+        return;
+    }
+    /* we are the last one, no one is waiting */
+    CAT_ASSERT(cat_queue_empty(&channel->producers));
+    if (cat_thread_channel_is_lockfree(channel)) {
+        uint64_t head = cat_atomic_uint64_load(&channel->u.lockfree.head);
+        uint64_t tail = cat_atomic_uint64_load(&channel->u.lockfree.tail);
+        CAT_ASSERT(cat_queue_empty(&channel->u.lockfree.consumers));
+        CAT_ASSERT(channel->u.lockfree.armed == NULL);
+        if (channel->dtor != NULL) {
+            for (; head != tail; head++) {
+                channel->dtor(cat_thread_channel_storage_slot(channel, head));
+            }
+        }
+        cat_free(channel->u.lockfree.sequences);
+    } else {
+        CAT_ASSERT(cat_queue_empty(&channel->u.locked.consumers));
+        if (channel->dtor != NULL) {
+            for (; channel->u.locked.length > 0; channel->u.locked.length--) {
+                channel->dtor(cat_thread_channel_storage_slot(channel, channel->u.locked.head++));
+            }
+        }
+    }
+    uv_mutex_destroy(&channel->mutex);
+    cat_free(channel->storage);
+    cat_free(channel);
+}
+
+CAT_API cat_bool_t cat_thread_channel_push(cat_thread_channel_t *channel, const cat_data_t *data, cat_timeout_t timeout)
+{
+    if (cat_thread_channel_is_lockfree(channel)) {
+        return cat_thread_channel_lockfree_push(channel, data, timeout);
+    }
+    return cat_thread_channel_locked_push(channel, data, timeout);
+}
+
+CAT_API cat_bool_t cat_thread_channel_pop(cat_thread_channel_t *channel, cat_data_t *data, cat_timeout_t timeout)
+{
+    if (cat_thread_channel_is_lockfree(channel)) {
+        return cat_thread_channel_lockfree_pop(channel, data, timeout);
+    }
+    return cat_thread_channel_locked_pop(channel, data, timeout);
+}
+
+CAT_API cat_bool_t cat_thread_channel_close(cat_thread_channel_t *channel)
+{
+    if (unlikely(cat_atomic_bool_exchange(&channel->closed, cat_true))) {
+        cat_update_last_error(CAT_ECLOSED, "Channel has been closed");
+        return cat_false;
+    }
+    uv_mutex_lock(&channel->mutex);
+    cat_thread_channel_notify_all(&channel->producers);
+    if (!cat_thread_channel_is_lockfree(channel)) {
+        cat_thread_channel_notify_all(&channel->u.locked.consumers);
+    }
+    uv_mutex_unlock(&channel->mutex);
+    if (cat_thread_channel_is_lockfree(channel)) {
+        /* consumers will pass it on to each other */
+        cat_thread_channel_lockfree_ring(channel);
+    }
+
+    return cat_true;
+}
+
+CAT_API cat_channel_size_t cat_thread_channel_get_capacity(const cat_thread_channel_t *channel)
+{
+    return channel->capacity;
+}
+
+CAT_API cat_channel_size_t cat_thread_channel_get_length(cat_thread_channel_t *channel)
+{
+    cat_channel_size_t length;
+
+    if (cat_thread_channel_is_lockfree(channel)) {
+        uint64_t head = cat_atomic_uint64_load(&channel->u.lockfree.head);
+        uint64_t tail = cat_atomic_uint64_load(&channel->u.lockfree.tail);
+        /* it is a snapshot, claimed slots are counted in */
+        return tail > head ? (cat_channel_size_t) CAT_MIN(tail - head, channel->capacity) : 0;
+    }
+    uv_mutex_lock(&channel->mutex);
+    length = channel->u.locked.length;
+    uv_mutex_unlock(&channel->mutex);
+
+    return length;
+}
+
+CAT_API cat_thread_channel_flags_t cat_thread_channel_get_flags(const cat_thread_channel_t *channel)
+{
+    return channel->flags;
+}
+
+CAT_API cat_bool_t cat_thread_channel_is_available(cat_thread_channel_t *channel)
+{
+    return !cat_thread_channel_is_closed(channel);
+}
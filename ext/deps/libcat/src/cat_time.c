@@ -27,6 +27,7 @@
 #include "../deps/libuv/src/win/internal.h"
 #include <windows.h>
 #endif
+#include "../deps/libuv/src/heap-inl.h"
 
 CAT_API cat_nsec_t cat_time_nsec(void)
 {
@@ -104,42 +105,129 @@ CAT_API char *cat_time_format_msec(cat_msec_t msec)
 #undef SECOND
 }
 
-typedef union {
+/* timer */
+
+/* Timed waiters live on the stacks of their coroutines and are linked into
+ * a min-heap, only one uv timer is armed for the nearest one,
+ * so there is no allocation or handle close for each wait */
+
+typedef struct cat_timer_s {
+    struct heap_node node;
+    cat_msec_t timeout;
+    uint64_t id;
     cat_coroutine_t *coroutine;
-    uv_handle_t handle;
-    uv_timer_t timer;
 } cat_timer_t;
 
-static void cat_timer_callback(uv_timer_t* handle)
+CAT_STATIC_ASSERT(sizeof(CAT_EVENT_G(timer_heap)) == sizeof(struct heap));
+
+#define cat_timer_heap() ((struct heap *) &CAT_EVENT_G(timer_heap))
+
+static int cat_timer_less_than(const struct heap_node *ha, const struct heap_node *hb)
 {
-    cat_timer_t *timer = (cat_timer_t *) handle;
-    cat_coroutine_t *coroutine = timer->coroutine;
+    const cat_timer_t *a = cat_container_of(ha, cat_timer_t, node);
+    const cat_timer_t *b = cat_container_of(hb, cat_timer_t, node);
 
-    timer->coroutine = NULL;
-    cat_coroutine_schedule(coroutine, TIME, "Timer");
+    if (a->timeout < b->timeout) {
+        return 1;
+    }
+    if (b->timeout < a->timeout) {
+        return 0;
+    }
+    /* compare id when both have the same timeout,
+     * it makes the timers which were started first run first */
+    return a->id < b->id;
 }
 
-static void cat_timer_close_callback(uv_handle_t *handle)
+static void cat_timer_callback(uv_timer_t *handle);
+
+static void cat_timer_arm(void)
 {
-    cat_timer_t *timer = cat_container_of(handle, cat_timer_t, handle);
-    cat_free(timer);
+    struct heap_node *node = heap_min(cat_timer_heap());
+    cat_timer_t *timer;
+    cat_msec_t now;
+
+    if (node == NULL) {
+        (void) uv_timer_stop(&CAT_EVENT_G(timer));
+        return;
+    }
+    timer = cat_container_of(node, cat_timer_t, node);
+    now = CAT_EVENT_G(loop).time;
+    (void) uv_timer_start(&CAT_EVENT_G(timer), cat_timer_callback, timer->timeout > now ? timer->timeout - now : 0, 0);
 }
 
-static cat_timer_t *cat_timer_wait(cat_msec_t msec)
+static void cat_timer_callback(uv_timer_t *handle)
 {
-    cat_timer_t *timer;
-    cat_bool_t ret;
+    struct heap *heap = cat_timer_heap();
+    /* timers started in callbacks must be run in the next round */
+    uint64_t last_id = CAT_EVENT_G(timer_last_id);
+    struct heap_node *node;
+
+    while ((node = heap_min(heap)) != NULL) {
+        cat_timer_t *timer = cat_container_of(node, cat_timer_t, node);
+        cat_coroutine_t *coroutine;
+        if (timer->timeout > handle->loop->time || timer->id >= last_id) {
+            break;
+        }
+        heap_remove(heap, node, cat_timer_less_than);
+        coroutine = timer->coroutine;
+        timer->coroutine = NULL;
+        cat_coroutine_schedule(coroutine, TIME, "Timer");
+    }
 
-    timer = (cat_timer_t *) cat_malloc(sizeof(*timer));;
-#if CAT_ALLOC_HANDLE_ERRORS
-    if (unlikely(timer == NULL)) {
-        cat_update_last_error_of_syscall("Malloc for timer failed");
-        return NULL;
+    cat_timer_arm();
+}
+
+static void cat_timer_start(cat_timer_t *timer, cat_msec_t msec)
+{
+    struct heap *heap = cat_timer_heap();
+    cat_msec_t timeout = CAT_EVENT_G(loop).time + msec;
+
+    if (unlikely(timeout < msec)) {
+        /* overflow */
+        timeout = (cat_msec_t) -1;
     }
-#endif
+    timer->timeout = timeout;
+    timer->id = CAT_EVENT_G(timer_last_id)++;
+    timer->coroutine = CAT_COROUTINE_G(current);
+    heap_insert(heap, &timer->node, cat_timer_less_than);
+    if (heap_min(heap) == &timer->node) {
+        cat_timer_arm();
+    }
+}
 
-    (void) uv_timer_init(&CAT_EVENT_G(loop), &timer->timer);
-    (void) uv_timer_start(&timer->timer, cat_timer_callback, msec, 0);
+static void cat_timer_stop(cat_timer_t *timer)
+{
+    struct heap *heap = cat_timer_heap();
+
+    if (timer->coroutine == NULL) {
+        /* it has been removed by callback */
+        return;
+    }
+    heap_remove(heap, &timer->node, cat_timer_less_than);
+    if (heap_min(heap) == NULL) {
+        /* do not keep the loop alive,
+         * otherwise, it is harmless to let the timer wake up earlier than expected */
+        (void) uv_timer_stop(&CAT_EVENT_G(timer));
+    }
+}
+
+CAT_API void cat_time_runtime_init(void)
+{
+    (void) uv_timer_init(&CAT_EVENT_G(loop), &CAT_EVENT_G(timer));
+    heap_init(cat_timer_heap());
+    CAT_EVENT_G(timer_last_id) = 0;
+}
+
+CAT_API void cat_time_runtime_shutdown(void)
+{
+    uv_close((uv_handle_t *) &CAT_EVENT_G(timer), NULL);
+}
+
+static cat_bool_t cat_timer_wait(cat_timer_t *timer, cat_msec_t msec)
+{
+    cat_bool_t ret;
+
+    cat_timer_start(timer, msec);
 
     CAT_LOG_DEBUG_VA(TIME, {
         char *s = cat_time_format_msec(msec);
@@ -147,18 +235,16 @@ static cat_timer_t *cat_timer_wait(cat_msec_t msec)
         cat_free(s);
     });
 
-    timer->coroutine = CAT_COROUTINE_G(current);
-
     ret = cat_coroutine_yield(NULL, NULL);
 
-    uv_close(&timer->handle, cat_timer_close_callback);
+    cat_timer_stop(timer);
 
     if (unlikely(!ret)) {
         cat_update_last_error_with_previous("Time sleep failed");
-        return NULL;
+        return cat_false;
     }
 
-    return timer;
+    return cat_true;
 }
 
 CAT_API cat_bool_t cat_time_wait(cat_timeout_t timeout)
@@ -166,14 +252,12 @@ CAT_API cat_bool_t cat_time_wait(cat_timeout_t timeout)
     if (timeout < 0) {
         return cat_coroutine_yield(NULL, NULL);
     } else {
-        cat_timer_t *timer;
-
-        timer = cat_timer_wait(timeout);
+        cat_timer_t timer;
 
-        if (unlikely(timer == NULL)) {
+        if (unlikely(!cat_timer_wait(&timer, timeout))) {
             return cat_false;
         }
-        if (unlikely(timer->coroutine == NULL)) {
+        if (unlikely(timer.coroutine == NULL)) {
             cat_update_last_error(CAT_ETIMEDOUT, "Timed out for " CAT_TIMEOUT_FMT " ms", timeout);
             return cat_false;
         }
@@ -187,14 +271,12 @@ CAT_API cat_ret_t cat_time_delay(cat_timeout_t timeout)
     if (timeout < 0) {
         cat_coroutine_yield(NULL, NULL);
     } else {
-        cat_timer_t *timer;
-
-        timer = cat_timer_wait(timeout);
+        cat_timer_t timer;
 
-        if (unlikely(timer == NULL)) {
+        if (unlikely(!cat_timer_wait(&timer, timeout))) {
             return CAT_RET_ERROR;
         }
-        if (timer->coroutine == NULL) {
+        if (timer.coroutine == NULL) {
             return CAT_RET_OK;
         }
     }
@@ -209,22 +291,20 @@ CAT_API unsigned int cat_time_sleep(unsigned int seconds)
 
 CAT_API cat_msec_t cat_time_msleep(cat_msec_t msec)
 {
-    cat_timer_t *timer;
-
-    timer = cat_timer_wait(msec);
+    cat_timer_t timer;
 
-    if (unlikely(timer == NULL)) {
+    if (unlikely(!cat_timer_wait(&timer, msec))) {
         return msec;
     }
 
-    if (unlikely(timer->coroutine != NULL)) {
+    if (unlikely(timer.coroutine != NULL)) {
         cat_update_last_error(CAT_ECANCELED, "Time waiter has been canceled");
-        if (unlikely(timer->timer.timeout <= CAT_EVENT_G(loop).time)) {
+        if (unlikely(timer.timeout <= CAT_EVENT_G(loop).time)) {
             /* blocking IO lead it to be negative or 0
              * we can not know the real reserve time */
             return msec;
         }
-        return timer->timer.timeout - CAT_EVENT_G(loop).time;
+        return timer.timeout - CAT_EVENT_G(loop).time;
     }
 
     return 0;
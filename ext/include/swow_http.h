@@ -25,6 +25,7 @@ extern "C" {
 #include "swow.h"
 
 #include "cat_http.h"
+#include "cat_fs.h"
 
 extern SWOW_API zend_class_entry *swow_http_http_ce;
 
@@ -34,15 +35,61 @@ extern SWOW_API zend_class_entry *swow_http_parser_ce;
 extern SWOW_API zend_object_handlers swow_http_parser_handlers;
 extern SWOW_API zend_class_entry *swow_http_parser_exception_ce;
 
+extern SWOW_API zend_class_entry *swow_http_response_template_ce;
+extern SWOW_API zend_object_handlers swow_http_response_template_handlers;
+
+CAT_GLOBALS_STRUCT_BEGIN(swow_http) {
+    /* the Date header value is formatted at most once per second */
+    time_t date_time;
+    char date[sizeof("Sun, 06 Nov 1994 08:49:37 GMT")];
+} CAT_GLOBALS_STRUCT_END(swow_http);
+
+extern SWOW_API CAT_GLOBALS_DECLARE(swow_http);
+
+#define SWOW_HTTP_G(x) CAT_GLOBALS_GET(swow_http, x)
+
+typedef struct swow_http_parser_upload_s {
+    cat_bool_t uploading;
+    cat_file_t fd;
+    zend_string *tmp_name;
+    int error;
+    size_t size;
+    size_t total_size;
+    zend_long max_file_size;
+    zend_long max_total_size;
+} swow_http_parser_upload_t;
+
 typedef struct swow_http_parser_s {
     cat_http_parser_t parser;
     size_t data_offset;
+    swow_http_parser_upload_t upload;
     zend_object std;
 } swow_http_parser_t;
 
+typedef struct swow_http_response_template_s {
+    /* status line and static headers */
+    zend_string *head;
+    zend_long status_code;
+    zend_bool with_date;
+    /* 1xx, 204 and 304 responses must not have Content-Length generated */
+    zend_bool with_content_length;
+    zend_object std;
+} swow_http_response_template_t;
+
 /* loader */
 
 zend_result swow_http_module_init(INIT_FUNC_ARGS);
+zend_result swow_http_module_shutdown(INIT_FUNC_ARGS);
+
+/* pack */
+
+/* status line and headers, without the empty line which ends the head */
+SWOW_API size_t swow_http_get_response_head_length(
+    zend_long status_code, const char *reason_phrase, size_t reason_phrase_length,
+    HashTable *headers, const char *protocol_version, size_t protocol_version_length);
+SWOW_API char *swow_http_pack_response_head(
+    char *p, zend_long status_code, const char *reason_phrase, size_t reason_phrase_length,
+    HashTable *headers, const char *protocol_version, size_t protocol_version_length);
 
 /* helper*/
 
@@ -56,6 +103,11 @@ static zend_always_inline swow_http_parser_t *swow_http_parser_get_from_object(z
     return cat_container_of(object, swow_http_parser_t, std);
 }
 
+static zend_always_inline swow_http_response_template_t *swow_http_response_template_get_from_object(zend_object *object)
+{
+    return cat_container_of(object, swow_http_response_template_t, std);
+}
+
 #ifdef __cplusplus
 }
 #endif
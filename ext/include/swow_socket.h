@@ -31,8 +31,20 @@ extern SWOW_API zend_object_handlers swow_socket_handlers;
 
 extern SWOW_API zend_class_entry *swow_socket_exception_ce;
 
+typedef struct swow_socket_accept_stats_s {
+    uint64_t batches;
+    uint64_t connections;
+    uint32_t last_batch_size;
+    uint32_t max_batch_size;
+} swow_socket_accept_stats_t;
+
 typedef struct swow_socket_s {
     cat_socket_t socket;
+    /* backlog depth observed by acceptMany() */
+    swow_socket_accept_stats_t accept_stats;
+    /* receiving area reused by recvMany() (it is NULL while it is in use) */
+    char *recv_many_area;
+    size_t recv_many_area_size;
     zend_object std;
 } swow_socket_t;
 
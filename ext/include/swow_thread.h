@@ -0,0 +1,86 @@
+/*
+  +--------------------------------------------------------------------------+
+  | Swow                                                                     |
+  +--------------------------------------------------------------------------+
+  | Licensed under the Apache License, Version 2.0 (the "License");          |
+  | you may not use this file except in compliance with the License.         |
+  | You may obtain a copy of the License at                                  |
+  | http://www.apache.org/licenses/LICENSE-2.0                               |
+  | Unless required by applicable law or agreed to in writing, software      |
+  | distributed under the License is distributed on an "AS IS" BASIS,        |
+  | WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. |
+  | See the License for the specific language governing permissions and      |
+  | limitations under the License. See accompanying LICENSE file.            |
+  +--------------------------------------------------------------------------+
+  | Author: Twosee <twosee@php.net>                                          |
+  +--------------------------------------------------------------------------+
+ */
+
+#ifndef SWOW_THREAD_H
+#define SWOW_THREAD_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "swow.h"
+
+#include "cat_async.h"
+#include "cat_atomic.h"
+#include "cat_thread_channel.h"
+
+/* threads are only available on ZTS builds,
+ * each thread runs its own request with its own event loop */
+
+extern SWOW_API zend_class_entry *swow_thread_ce;
+extern SWOW_API zend_object_handlers swow_thread_handlers;
+extern SWOW_API zend_class_entry *swow_thread_exception_ce;
+
+extern SWOW_API zend_class_entry *swow_thread_channel_ce;
+extern SWOW_API zend_object_handlers swow_thread_channel_handlers;
+
+typedef struct swow_thread_context_s {
+    /* held by the object and by the async handle (until the thread exited) */
+    uint32_t refcount;
+    uint32_t id;
+    uv_thread_t tid;
+    cat_async_t async;
+    cat_coroutine_t *joiner;
+    cat_bool_t done;
+    /* written by parent before the thread starts */
+    zend_string *payload;
+    /* written by child before it notifies the async */
+    zend_string *result;
+    int exit_status;
+} swow_thread_context_t;
+
+typedef struct swow_thread_s {
+    swow_thread_context_t *context;
+    zend_object std;
+} swow_thread_t;
+
+typedef struct swow_thread_channel_s {
+    cat_thread_channel_t *channel;
+    zend_object std;
+} swow_thread_channel_t;
+
+/* loader */
+
+zend_result swow_thread_module_init(INIT_FUNC_ARGS);
+zend_result swow_thread_module_shutdown(INIT_FUNC_ARGS);
+
+/* helper*/
+
+static zend_always_inline swow_thread_t *swow_thread_get_from_object(zend_object *object)
+{
+    return cat_container_of(object, swow_thread_t, std);
+}
+
+static zend_always_inline swow_thread_channel_t *swow_thread_channel_get_from_object(zend_object *object)
+{
+    return cat_container_of(object, swow_thread_channel_t, std);
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* SWOW_THREAD_H */
@@ -169,6 +169,102 @@ static PHP_METHOD(Swow_Channel, pop)
     }
 }
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Channel_pushMany, 0, 1, IS_STATIC, 0)
+    ZEND_ARG_TYPE_INFO(0, items, IS_ARRAY, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, timeout, IS_LONG, 0, "-1")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Channel, pushMany)
+{
+    SWOW_CHANNEL_GETTER_CONSTRUCTED(s_channel, channel);
+    HashTable *items;
+    zend_long timeout = -1;
+    zval *z_items, *z_item;
+    uint32_t count, n;
+
+    ZEND_PARSE_PARAMETERS_START(1, 2)
+        Z_PARAM_ARRAY_HT(items)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(timeout)
+    ZEND_PARSE_PARAMETERS_END();
+
+    count = zend_hash_num_elements(items);
+    if (UNEXPECTED(count == 0)) {
+        RETURN_THIS();
+    }
+
+    /* copy items to a contiguous buffer, the pushed ones are owned by channel */
+    z_items = (zval *) safe_emalloc(count, sizeof(zval), 0);
+    n = 0;
+    ZEND_HASH_FOREACH_VAL(items, z_item) {
+        ZVAL_COPY_DEREF(&z_items[n], z_item);
+        n++;
+    } ZEND_HASH_FOREACH_END();
+
+    n = (uint32_t) cat_channel_push_batch(channel, z_items, count, timeout);
+
+    if (UNEXPECTED(n != count)) {
+        uint32_t i;
+        for (i = n; i < count; i++) {
+            zval_ptr_dtor(&z_items[i]);
+        }
+        efree(z_items);
+        swow_throw_exception_with_last(swow_channel_exception_ce);
+        RETURN_THROWS();
+    }
+    efree(z_items);
+
+    RETURN_THIS();
+}
+
+#define SWOW_CHANNEL_POP_MANY_CHUNK_SIZE 256
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Channel_popMany, 0, 1, IS_ARRAY, 0)
+    ZEND_ARG_TYPE_INFO(0, max, IS_LONG, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, timeout, IS_LONG, 0, "-1")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Channel, popMany)
+{
+    SWOW_CHANNEL_GETTER_CONSTRUCTED(s_channel, channel);
+    zval z_items[SWOW_CHANNEL_POP_MANY_CHUNK_SIZE];
+    zend_long max;
+    zend_long timeout = -1;
+    size_t n, i;
+
+    ZEND_PARSE_PARAMETERS_START(1, 2)
+        Z_PARAM_LONG(max)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(timeout)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(max <= 0)) {
+        zend_argument_value_error(1, "must be greater than 0");
+        RETURN_THROWS();
+    }
+
+    /* only the first chunk may wait, the rest takes what is ready */
+    n = cat_channel_pop_batch(channel, z_items, MIN(max, SWOW_CHANNEL_POP_MANY_CHUNK_SIZE), timeout);
+    if (UNEXPECTED(n == 0)) {
+        swow_throw_exception_with_last(swow_channel_exception_ce);
+        RETURN_THROWS();
+    }
+    array_init_size(return_value, (uint32_t) n);
+    while (1) {
+        for (i = 0; i < n; i++) {
+            add_next_index_zval(return_value, &z_items[i]);
+        }
+        max -= n;
+        if (max == 0 || !cat_channel_is_readable(channel)) {
+            break;
+        }
+        n = cat_channel_pop_batch(channel, z_items, MIN(max, SWOW_CHANNEL_POP_MANY_CHUNK_SIZE), 0);
+        if (n == 0) {
+            break;
+        }
+    }
+}
+
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Channel_close, 0, 0, IS_VOID, 0)
 ZEND_END_ARG_INFO()
 
@@ -317,6 +413,8 @@ static const zend_function_entry swow_channel_methods[] = {
     PHP_ME(Swow_Channel, __construct,  arginfo_class_Swow_Channel___construct,  ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Channel, push,         arginfo_class_Swow_Channel_push,         ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Channel, pop,          arginfo_class_Swow_Channel_pop,          ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Channel, pushMany,     arginfo_class_Swow_Channel_pushMany,     ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Channel, popMany,      arginfo_class_Swow_Channel_popMany,      ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Channel, close,        arginfo_class_Swow_Channel_close,        ZEND_ACC_PUBLIC)
     /* status */
     PHP_ME(Swow_Channel, getCapacity,  arginfo_class_Swow_Channel_getCapacity,  ZEND_ACC_PUBLIC)
@@ -333,6 +431,11 @@ static const zend_function_entry swow_channel_methods[] = {
     PHP_FE_END
 };
 
+static void swow_channel_gc_walker(cat_data_t *data, cat_data_t *arg)
+{
+    zend_get_gc_buffer_add_zval((zend_get_gc_buffer *) arg, (zval *) data);
+}
+
 static HashTable *swow_channel_get_gc(zend_object *object, zval **gc_data, int *gc_count)
 {
     SWOW_CHANNEL_GETTER_INTERNAL(object, s_channel, channel);
@@ -345,9 +448,7 @@ static HashTable *swow_channel_get_gc(zend_object *object, zval **gc_data, int *
 
     zend_get_gc_buffer *zgc_buffer = zend_get_gc_buffer_create();
 
-    CAT_QUEUE_FOREACH_DATA_START(&channel->u.buffered.storage, cat_channel_bucket_t, node, bucket) {
-        zend_get_gc_buffer_add_zval(zgc_buffer, (zval *) bucket->data);
-    } CAT_QUEUE_FOREACH_DATA_END();
+    cat_channel_walk_storage(channel, swow_channel_gc_walker, zgc_buffer);
 
     zend_get_gc_buffer_use(zgc_buffer, gc_data, gc_count);
 
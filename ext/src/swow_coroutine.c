@@ -1688,6 +1688,93 @@ static PHP_METHOD(Swow_Coroutine, getGlobalSwitches)
     RETURN_LONG(CAT_COROUTINE_G(switches));
 }
 
+#define arginfo_class_Swow_Coroutine_getStackUsage arginfo_class_Swow_Coroutine_getId
+
+static PHP_METHOD(Swow_Coroutine, getStackUsage)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG(cat_coroutine_get_stack_usage(&getThisCoroutine()->coroutine));
+}
+
+#define arginfo_class_Swow_Coroutine_getPeakStackUsage arginfo_class_Swow_Coroutine_getId
+
+static PHP_METHOD(Swow_Coroutine, getPeakStackUsage)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG(cat_coroutine_get_peak_stack_usage(&getThisCoroutine()->coroutine));
+}
+
+#define arginfo_class_Swow_Coroutine_getGlobalPeakStackUsage arginfo_class_Swow_Coroutine_getId
+
+static PHP_METHOD(Swow_Coroutine, getGlobalPeakStackUsage)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG(cat_coroutine_get_global_peak_stack_usage());
+}
+
+#define arginfo_class_Swow_Coroutine_trimStack arginfo_class_Swow_Coroutine_getId
+
+static PHP_METHOD(Swow_Coroutine, trimStack)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG(cat_coroutine_trim_stack(&getThisCoroutine()->coroutine));
+}
+
+#define arginfo_class_Swow_Coroutine_getStackPoolSize arginfo_class_Swow_Coroutine_getId
+
+static PHP_METHOD(Swow_Coroutine, getStackPoolSize)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG(cat_coroutine_get_stack_pool_size());
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Coroutine_setStackPoolSize, 0, 1, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO(0, size, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Coroutine, setStackPoolSize)
+{
+    zend_long size;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_LONG(size)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(size < 0)) {
+        zend_argument_value_error(1, "can not be negative");
+        RETURN_THROWS();
+    }
+    if (UNEXPECTED((zend_ulong) size > UINT32_MAX)) {
+        size = UINT32_MAX;
+    }
+
+    (void) cat_coroutine_set_stack_pool_size((cat_coroutine_count_t) size);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Coroutine_getStackPoolInfo, 0, 0, IS_ARRAY, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Coroutine, getStackPoolInfo)
+{
+    cat_coroutine_stack_pool_info_t info;
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    cat_coroutine_get_stack_pool_info(&info);
+
+    array_init(return_value);
+    add_assoc_bool(return_value, "available", info.available);
+    add_assoc_long(return_value, "size", info.size);
+    add_assoc_long(return_value, "count", info.count);
+    add_assoc_long(return_value, "hits", info.hits);
+    add_assoc_long(return_value, "misses", info.misses);
+}
+
 #define arginfo_class_Swow_Coroutine_getElapsed arginfo_class_Swow_Coroutine_getId
 
 static PHP_METHOD(Swow_Coroutine, getElapsed)
@@ -2184,6 +2271,13 @@ static const zend_function_entry swow_coroutine_methods[] = {
     PHP_ME(Swow_Coroutine, getStateName,            arginfo_class_Swow_Coroutine_getStateName,            ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Coroutine, getSwitches,             arginfo_class_Swow_Coroutine_getSwitches,             ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Coroutine, getGlobalSwitches,       arginfo_class_Swow_Coroutine_getGlobalSwitches,       ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Coroutine, getStackUsage,           arginfo_class_Swow_Coroutine_getStackUsage,           ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Coroutine, getPeakStackUsage,       arginfo_class_Swow_Coroutine_getPeakStackUsage,       ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Coroutine, getGlobalPeakStackUsage, arginfo_class_Swow_Coroutine_getGlobalPeakStackUsage, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Coroutine, trimStack,               arginfo_class_Swow_Coroutine_trimStack,               ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Coroutine, getStackPoolSize,        arginfo_class_Swow_Coroutine_getStackPoolSize,        ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Coroutine, setStackPoolSize,        arginfo_class_Swow_Coroutine_setStackPoolSize,        ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Coroutine, getStackPoolInfo,        arginfo_class_Swow_Coroutine_getStackPoolInfo,        ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Swow_Coroutine, getElapsed,              arginfo_class_Swow_Coroutine_getElapsed,              ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Coroutine, getElapsedAsString,      arginfo_class_Swow_Coroutine_getElapsedAsString,      ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Coroutine, getExitStatus,           arginfo_class_Swow_Coroutine_getExitStatus,           ZEND_ACC_PUBLIC)
@@ -21,6 +21,8 @@
 #include "swow_defer.h"
 #include "swow_coroutine.h"
 
+SWOW_API zend_class_entry *swow_event_ce;
+
 static cat_bool_t swow_event_scheduler_run(void)
 {
     swow_coroutine_t *s_coroutine;
@@ -80,12 +82,53 @@ static PHP_FUNCTION(swow_pcntl_fork)
     }
 }
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Event_getRound, 0, 0, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Event, getRound)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG(cat_event_get_round());
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Event_getDeferInfo, 0, 0, IS_ARRAY, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Event, getDeferInfo)
+{
+    cat_event_defer_info_t info;
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    cat_event_get_defer_info(&info);
+
+    array_init(return_value);
+    add_assoc_long(return_value, "pending", info.pending);
+    add_assoc_long(return_value, "capacity", info.capacity);
+    add_assoc_long(return_value, "last_round", info.last_round);
+    add_assoc_long(return_value, "peak_round", info.peak_round);
+    add_assoc_long(return_value, "total", info.total);
+}
+
+static const zend_function_entry swow_event_methods[] = {
+    PHP_ME(Swow_Event, getRound,     arginfo_class_Swow_Event_getRound,     ZEND_ACC_STATIC | ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Event, getDeferInfo, arginfo_class_Swow_Event_getDeferInfo, ZEND_ACC_STATIC | ZEND_ACC_PUBLIC)
+    PHP_FE_END
+};
+
 zend_result swow_event_module_init(INIT_FUNC_ARGS)
 {
     if (!cat_event_module_init()) {
         return FAILURE;
     }
 
+    swow_event_ce = swow_register_internal_class(
+        "Swow\\Event", NULL, swow_event_methods,
+        NULL, NULL, cat_false, cat_false,
+        swow_create_object_deny, NULL, 0
+    );
+
     return SUCCESS;
 }
 
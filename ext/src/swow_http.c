@@ -22,6 +22,10 @@
 
 #include "swow_errno.h" /* for errno register */
 
+#include "swow_known_strings.h"
+
+#include "rfc1867.h" /* for UPLOAD_ERROR_* */
+
 SWOW_API zend_class_entry *swow_http_http_ce;
 
 SWOW_API zend_class_entry *swow_http_status_ce;
@@ -30,6 +34,11 @@ SWOW_API zend_class_entry *swow_http_parser_ce;
 SWOW_API zend_object_handlers swow_http_parser_handlers;
 SWOW_API zend_class_entry *swow_http_parser_exception_ce;
 
+SWOW_API zend_class_entry *swow_http_response_template_ce;
+SWOW_API zend_object_handlers swow_http_response_template_handlers;
+
+SWOW_API CAT_GLOBALS_DECLARE(swow_http);
+
 /* Status */
 
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Http_Status_getReasonPhraseOf, 0, 1, IS_STRING, 0)
@@ -60,10 +69,90 @@ static zend_object *swow_http_parser_create_object(zend_class_entry *ce)
 
     cat_http_parser_init(&s_parser->parser);
     s_parser->data_offset = 0;
+    s_parser->upload.uploading = cat_false;
+    s_parser->upload.fd = -1;
+    s_parser->upload.tmp_name = NULL;
+    s_parser->upload.error = UPLOAD_ERROR_OK;
+    s_parser->upload.size = 0;
+    s_parser->upload.total_size = 0;
+    s_parser->upload.max_file_size = -1;
+    s_parser->upload.max_total_size = -1;
 
     return &s_parser->std;
 }
 
+static void swow_http_parser_upload_close(swow_http_parser_upload_t *upload, cat_bool_t discard)
+{
+    if (upload->fd >= 0) {
+        (void) cat_fs_close(upload->fd);
+        upload->fd = -1;
+    }
+    if (upload->tmp_name != NULL) {
+        if (discard && ZSTR_LEN(upload->tmp_name) > 0) {
+            (void) cat_fs_unlink(ZSTR_VAL(upload->tmp_name));
+        }
+        zend_string_release(upload->tmp_name);
+        upload->tmp_name = NULL;
+    }
+}
+
+static void swow_http_parser_upload_fail(swow_http_parser_upload_t *upload, int error)
+{
+    /* the same as what PHP does, the temp file is removed if anything goes wrong */
+    swow_http_parser_upload_close(upload, cat_true);
+    upload->tmp_name = ZSTR_EMPTY_ALLOC();
+    upload->error = error;
+    upload->size = 0;
+}
+
+static void swow_http_parser_upload_reset(swow_http_parser_upload_t *upload)
+{
+    swow_http_parser_upload_close(upload, cat_true);
+    upload->uploading = cat_false;
+    upload->error = UPLOAD_ERROR_OK;
+    upload->size = 0;
+    upload->total_size = 0;
+}
+
+static cat_bool_t swow_http_parser_upload_write(swow_http_parser_upload_t *upload, const char *data, size_t length)
+{
+    upload->total_size += length;
+    if (UNEXPECTED(upload->max_total_size >= 0 && upload->total_size > (size_t) upload->max_total_size)) {
+        swow_http_parser_upload_reset(upload);
+        swow_throw_exception(swow_http_parser_exception_ce, CAT_HTTP_STATUS_REQUEST_ENTITY_TOO_LARGE, "Uploaded files exceed the maximum size");
+        return cat_false;
+    }
+    if (upload->error != UPLOAD_ERROR_OK) {
+        /* the rest of data is just discarded */
+        return cat_true;
+    }
+    if (UNEXPECTED(upload->max_file_size >= 0 && upload->size + length > (size_t) upload->max_file_size)) {
+        swow_http_parser_upload_fail(upload, UPLOAD_ERROR_A);
+        return cat_true;
+    }
+    while (length > 0) {
+        ssize_t n = cat_fs_write(upload->fd, data, length);
+        if (UNEXPECTED(n <= 0)) {
+            swow_http_parser_upload_fail(upload, UPLOAD_ERROR_F);
+            return cat_true;
+        }
+        upload->size += n;
+        data += n;
+        length -= n;
+    }
+
+    return cat_true;
+}
+
+static void swow_http_parser_free_object(zend_object *object)
+{
+    swow_http_parser_t *s_parser = swow_http_parser_get_from_object(object);
+
+    swow_http_parser_upload_reset(&s_parser->upload);
+
+    zend_object_std_dtor(&s_parser->std);
+}
+
 #define getThisParser() (swow_http_parser_get_from_object(Z_OBJ_P(ZEND_THIS)))
 
 #define SWOW_HTTP_PARSER_GETTER(_sparser, _parser) \
@@ -180,11 +269,454 @@ static PHP_METHOD(Swow_Http_Parser, execute)
         RETURN_THROWS();
     }
 
+    /* body data of the uploaded file is written to disk directly, it never goes back to PHP */
+    if (s_parser->upload.uploading && parser->event == CAT_HTTP_PARSER_EVENT_MULTIPART_BODY) {
+        size_t parsed_length = parser->parsed_length;
+        do {
+            if (UNEXPECTED(!swow_http_parser_upload_write(&s_parser->upload, parser->data, parser->data_length))) {
+                RETURN_THROWS();
+            }
+            ret = cat_http_parser_execute(parser, ptr + parsed_length, length - parsed_length);
+            if (UNEXPECTED(!ret)) {
+                swow_throw_exception_with_last(swow_http_parser_exception_ce);
+                RETURN_THROWS();
+            }
+            parsed_length += parser->parsed_length;
+        } while (parser->event == CAT_HTTP_PARSER_EVENT_MULTIPART_BODY);
+        parser->parsed_length = parsed_length;
+    }
+
     s_parser->data_offset = parser->data - ZSTR_VAL(string);
 
     RETURN_LONG(parser->parsed_length);
 }
 
+#define SWOW_HTTP_PARSER_MESSAGE_EVENTS ( \
+    CAT_HTTP_PARSER_EVENT_URL | \
+    CAT_HTTP_PARSER_EVENT_STATUS | \
+    CAT_HTTP_PARSER_EVENT_HEADER_FIELD | \
+    CAT_HTTP_PARSER_EVENT_HEADER_VALUE | \
+    CAT_HTTP_PARSER_EVENT_HEADERS_COMPLETE | \
+    CAT_HTTP_PARSER_EVENT_BODY | \
+    CAT_HTTP_PARSER_EVENT_MESSAGE_COMPLETE \
+)
+
+#define SWOW_HTTP_KNOWN_STRING_MAP(XX) \
+    XX(method,           "method") \
+    XX(uri,              "uri") \
+    XX(status_code,      "statusCode") \
+    XX(reason_phrase,    "reasonPhrase") \
+    XX(protocol_version, "protocolVersion") \
+    XX(headers,          "headers") \
+    XX(header_names,     "headerNames") \
+    XX(content_length,   "contentLength") \
+    XX(keep_alive,       "shouldKeepAlive") \
+    XX(is_chunked,       "isChunked") \
+    XX(is_multipart,     "isMultipart") \
+    XX(is_upgrade,       "isUpgrade") \
+    XX(body_offset,      "bodyOffset") \
+    XX(body_length,      "bodyLength") \
+    XX(parsed_length,    "parsedLength") \
+    XX(completed,        "completed") \
+    XX(tmp_name,         "tmpName") \
+    XX(error,            "error") \
+    XX(size,             "size") \
+    XX(version_1_0,      "1.0") \
+    XX(version_1_1,      "1.1") \
+    XX(version_2,        "2") \
+
+SWOW_HTTP_KNOWN_STRING_MAP(SWOW_KNOWN_STRING_STORAGE_GEN)
+
+/* header names which are found in most of messages, they are matched case-insensitively */
+#define SWOW_HTTP_KNOWN_HEADER_MAP(XX) \
+    XX("Host") \
+    XX("Connection") \
+    XX("Keep-Alive") \
+    XX("Accept") \
+    XX("Accept-Charset") \
+    XX("Accept-Encoding") \
+    XX("Accept-Language") \
+    XX("Accept-Ranges") \
+    XX("Authorization") \
+    XX("Cache-Control") \
+    XX("Content-Disposition") \
+    XX("Content-Encoding") \
+    XX("Content-Length") \
+    XX("Content-Type") \
+    XX("Cookie") \
+    XX("Date") \
+    XX("ETag") \
+    XX("Expect") \
+    XX("If-Modified-Since") \
+    XX("If-None-Match") \
+    XX("Last-Modified") \
+    XX("Location") \
+    XX("Origin") \
+    XX("Pragma") \
+    XX("Range") \
+    XX("Referer") \
+    XX("Sec-WebSocket-Accept") \
+    XX("Sec-WebSocket-Extensions") \
+    XX("Sec-WebSocket-Key") \
+    XX("Sec-WebSocket-Protocol") \
+    XX("Sec-WebSocket-Version") \
+    XX("Server") \
+    XX("Set-Cookie") \
+    XX("Transfer-Encoding") \
+    XX("Upgrade") \
+    XX("User-Agent") \
+    XX("Vary") \
+    XX("X-Forwarded-For") \
+    XX("X-Forwarded-Host") \
+    XX("X-Forwarded-Proto") \
+    XX("X-Real-IP") \
+    XX("X-Requested-With") \
+
+/* header values which are short and common, they are matched exactly */
+#define SWOW_HTTP_KNOWN_HEADER_VALUE_MAP(XX) \
+    XX("close") \
+    XX("keep-alive") \
+    XX("Keep-Alive") \
+    XX("Upgrade") \
+    XX("websocket") \
+    XX("chunked") \
+    XX("gzip") \
+    XX("gzip, deflate") \
+    XX("gzip, deflate, br") \
+    XX("no-cache") \
+    XX("*/*") \
+    XX("0") \
+    XX("13") \
+    XX("application/json") \
+    XX("application/x-www-form-urlencoded") \
+    XX("text/html") \
+    XX("text/plain") \
+    XX("XMLHttpRequest") \
+
+typedef struct swow_http_known_header_s {
+    zend_string *name;
+    zend_string *lc_name;
+} swow_http_known_header_t;
+
+#define SWOW_HTTP_KNOWN_COUNT_GEN(string) + 1
+
+static swow_http_known_header_t swow_http_known_headers[0 SWOW_HTTP_KNOWN_HEADER_MAP(SWOW_HTTP_KNOWN_COUNT_GEN)];
+static zend_string *swow_http_known_header_values[0 SWOW_HTTP_KNOWN_HEADER_VALUE_MAP(SWOW_HTTP_KNOWN_COUNT_GEN)];
+static zend_string *swow_http_method_names[CAT_HTTP_METHOD_UNKNOWN + 1];
+
+static void swow_http_known_strings_init(void)
+{
+    static const char *header_names[] = {
+#define SWOW_HTTP_KNOWN_STRING_ARRAY_GEN(string) string,
+        SWOW_HTTP_KNOWN_HEADER_MAP(SWOW_HTTP_KNOWN_STRING_ARRAY_GEN)
+    };
+    static const char *header_values[] = {
+        SWOW_HTTP_KNOWN_HEADER_VALUE_MAP(SWOW_HTTP_KNOWN_STRING_ARRAY_GEN)
+#undef SWOW_HTTP_KNOWN_STRING_ARRAY_GEN
+    };
+    size_t n;
+
+    SWOW_HTTP_KNOWN_STRING_MAP(SWOW_KNOWN_STRING_INIT_STRL_GEN);
+    for (n = 0; n < CAT_ARRAY_SIZE(swow_http_known_headers); n++) {
+        zend_string *name = zend_string_init(header_names[n], strlen(header_names[n]), true);
+        swow_http_known_headers[n].lc_name = zend_new_interned_string(zend_string_tolower_ex(name, true));
+        swow_http_known_headers[n].name = zend_new_interned_string(name);
+    }
+    for (n = 0; n < CAT_ARRAY_SIZE(swow_http_known_header_values); n++) {
+        swow_http_known_header_values[n] = zend_new_interned_string(zend_string_init(header_values[n], strlen(header_values[n]), true));
+    }
+    for (n = 0; n < CAT_ARRAY_SIZE(swow_http_method_names); n++) {
+        const char *method = cat_http_method_get_name((cat_http_method_t) n);
+        swow_http_method_names[n] = zend_new_interned_string(zend_string_init(method, strlen(method), true));
+    }
+}
+
+static zend_always_inline zend_string *swow_http_get_method_name(const cat_http_parser_t *parser)
+{
+    cat_http_method_t method = cat_http_parser_get_method(parser);
+
+    if (UNEXPECTED(method > CAT_HTTP_METHOD_UNKNOWN)) {
+        method = CAT_HTTP_METHOD_UNKNOWN;
+    }
+
+    return swow_http_method_names[method];
+}
+
+static zend_always_inline zend_string *swow_http_get_protocol_version(const cat_http_parser_t *parser)
+{
+    const char *version = cat_http_parser_get_protocol_version(parser);
+
+    if (strcmp(version, "1.1") == 0) {
+        return SWOW_KNOWN_STRING(version_1_1);
+    }
+    if (strcmp(version, "1.0") == 0) {
+        return SWOW_KNOWN_STRING(version_1_0);
+    }
+    if (strcmp(version, "2") == 0) {
+        return SWOW_KNOWN_STRING(version_2);
+    }
+
+    return zend_string_init(version, strlen(version), false);
+}
+
+static zend_always_inline const swow_http_known_header_t *swow_http_find_known_header(const char *name, size_t name_length)
+{
+    size_t n;
+
+    for (n = 0; n < CAT_ARRAY_SIZE(swow_http_known_headers); n++) {
+        const swow_http_known_header_t *header = &swow_http_known_headers[n];
+        if (ZSTR_LEN(header->name) == name_length &&
+            zend_binary_strncasecmp(ZSTR_VAL(header->lc_name), name_length, name, name_length, name_length) == 0) {
+            return header;
+        }
+    }
+
+    return NULL;
+}
+
+static zend_always_inline zend_string *swow_http_get_header_value(const char *value, size_t value_length)
+{
+    size_t n;
+
+    for (n = 0; n < CAT_ARRAY_SIZE(swow_http_known_header_values); n++) {
+        zend_string *known_value = swow_http_known_header_values[n];
+        if (ZSTR_LEN(known_value) == value_length && memcmp(ZSTR_VAL(known_value), value, value_length) == 0) {
+            return known_value;
+        }
+    }
+
+    return zend_string_init(value, value_length, false);
+}
+
+static void swow_http_parser_add_header(zval *z_headers, zval *z_header_names, const char *name, size_t name_length, const char *value, size_t value_length)
+{
+    const swow_http_known_header_t *known_header = swow_http_find_known_header(name, name_length);
+    zend_string *header_name, *lc_header_name;
+    zval *z_values, z_tmp;
+
+    if (known_header != NULL) {
+        /* names of known headers are never numeric, and they are interned, so we need neither symtable nor copies */
+        if (memcmp(ZSTR_VAL(known_header->name), name, name_length) == 0) {
+            header_name = known_header->name;
+        } else if (memcmp(ZSTR_VAL(known_header->lc_name), name, name_length) == 0) {
+            header_name = known_header->lc_name;
+        } else {
+            header_name = zend_string_init(name, name_length, false);
+        }
+        lc_header_name = known_header->lc_name;
+        z_values = zend_hash_find(Z_ARRVAL_P(z_headers), header_name);
+        if (z_values == NULL) {
+            array_init(&z_tmp);
+            z_values = zend_hash_add_new(Z_ARRVAL_P(z_headers), header_name, &z_tmp);
+        }
+    } else {
+        header_name = zend_string_init(name, name_length, false);
+        lc_header_name = zend_string_tolower(header_name);
+        z_values = zend_symtable_find(Z_ARRVAL_P(z_headers), header_name);
+        if (z_values == NULL) {
+            array_init(&z_tmp);
+            z_values = zend_symtable_update(Z_ARRVAL_P(z_headers), header_name, &z_tmp);
+        }
+    }
+    ZVAL_STR(&z_tmp, swow_http_get_header_value(value, value_length));
+    zend_hash_next_index_insert_new(Z_ARRVAL_P(z_values), &z_tmp);
+
+    ZVAL_STR(&z_tmp, header_name);
+    zend_symtable_update(Z_ARRVAL_P(z_header_names), lc_header_name, &z_tmp);
+    zend_string_release(lc_header_name);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Http_Parser_parseMessage, 0, 1, IS_ARRAY, 1)
+    ZEND_ARG_OBJ_TYPE_MASK(0, data, Stringable, MAY_BE_STRING, NULL)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, start, IS_LONG, 0, "0")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, maxHeaderLength, IS_LONG, 0, "-1")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, maxContentLength, IS_LONG, 0, "-1")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Http_Parser, parseMessage)
+{
+    SWOW_HTTP_PARSER_GETTER(s_parser, parser);
+    zend_string *string;
+    zend_long start = 0;
+    zend_long length = -1;
+    zend_long max_header_length = -1;
+    zend_long max_content_length = -1;
+    cat_http_parser_events_t events;
+    const char *ptr, *p, *end;
+    /* spans of the buffer */
+    const char *line = NULL, *header_name = NULL, *header_value = NULL, *body = NULL;
+    size_t line_length = 0, header_name_length = 0, header_value_length = 0, body_length = 0;
+    size_t header_length = 0;
+    uint64_t content_length = 0;
+    cat_bool_t headers_completed = cat_false;
+    cat_bool_t completed = cat_false;
+    cat_bool_t has_header = cat_false;
+    cat_http_status_code_t status = 0;
+    zval z_headers, z_header_names, z_tmp;
+
+    ZEND_PARSE_PARAMETERS_START(1, 4)
+        SWOW_PARAM_STRINGABLE_EXPECT_BUFFER_FOR_READING(string)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(start)
+        Z_PARAM_LONG(max_header_length)
+        Z_PARAM_LONG(max_content_length)
+    ZEND_PARSE_PARAMETERS_END();
+
+    /* check args and initialize */
+    ptr = swow_string_get_readable_space(string, start, &length, 1);
+
+    if (UNEXPECTED(ptr == NULL)) {
+        RETURN_THROWS();
+    }
+
+    /* message is always parsed from the beginning,
+     * so the caller can simply call it again after more data was received */
+    cat_http_parser_reset(parser);
+    swow_http_parser_upload_reset(&s_parser->upload);
+    events = cat_http_parser_get_events(parser);
+    cat_http_parser_set_events(parser, events | SWOW_HTTP_PARSER_MESSAGE_EVENTS);
+    array_init(&z_headers);
+    array_init(&z_header_names);
+
+    p = ptr;
+    end = ptr + length;
+    while (1) {
+        if (UNEXPECTED(!cat_http_parser_execute(parser, p, end - p))) {
+            swow_throw_exception_with_last(swow_http_parser_exception_ce);
+            goto _error;
+        }
+        p += parser->parsed_length;
+        if (!headers_completed) {
+            header_length += parser->parsed_length;
+            if (max_header_length >= 0 && header_length > (size_t) max_header_length) {
+                status = !has_header ?
+                    CAT_HTTP_STATUS_REQUEST_URI_TOO_LARGE :
+                    CAT_HTTP_STATUS_REQUEST_HEADER_FIELDS_TOO_LARGE;
+                goto _limit_error;
+            }
+        }
+        switch (parser->event) {
+            case CAT_HTTP_PARSER_EVENT_NONE:
+                if (headers_completed) {
+                    /* we have checked that all data of body is in the buffer */
+                    swow_throw_exception(swow_http_parser_exception_ce, CAT_EPROTO, "Unexpected end of body data");
+                    goto _error;
+                }
+                /* wait for more data */
+                cat_http_parser_set_events(parser, events);
+                zval_ptr_dtor(&z_headers);
+                zval_ptr_dtor(&z_header_names);
+                RETURN_NULL();
+            /* spans are contiguous in the buffer, so we can simply extend them */
+            case CAT_HTTP_PARSER_EVENT_URL:
+            case CAT_HTTP_PARSER_EVENT_STATUS:
+                if (line == NULL) {
+                    line = parser->data;
+                }
+                line_length = (parser->data + parser->data_length) - line;
+                break;
+            case CAT_HTTP_PARSER_EVENT_HEADER_FIELD:
+                if (parser->previous_event != CAT_HTTP_PARSER_EVENT_HEADER_FIELD) {
+                    if (header_name != NULL) {
+                        swow_http_parser_add_header(&z_headers, &z_header_names, header_name, header_name_length, header_value != NULL ? header_value : "", header_value_length);
+                        header_value = NULL;
+                        header_value_length = 0;
+                    }
+                    header_name = parser->data;
+                    has_header = cat_true;
+                }
+                header_name_length = (parser->data + parser->data_length) - header_name;
+                break;
+            case CAT_HTTP_PARSER_EVENT_HEADER_VALUE:
+                if (header_value == NULL) {
+                    header_value = parser->data;
+                }
+                header_value_length = (parser->data + parser->data_length) - header_value;
+                break;
+            case CAT_HTTP_PARSER_EVENT_HEADERS_COMPLETE:
+                if (header_name != NULL) {
+                    swow_http_parser_add_header(&z_headers, &z_header_names, header_name, header_name_length, header_value != NULL ? header_value : "", header_value_length);
+                }
+                headers_completed = cat_true;
+                if (!cat_http_parser_is_chunked(parser)) {
+                    content_length = cat_http_parser_get_content_length(parser);
+                    if (max_content_length >= 0 && content_length > (uint64_t) max_content_length) {
+                        status = CAT_HTTP_STATUS_REQUEST_ENTITY_TOO_LARGE;
+                        goto _limit_error;
+                    }
+                }
+                /* body will be parsed by the caller via execute() if it is not all in the buffer */
+                if (cat_http_parser_is_chunked(parser) ||
+                    cat_http_parser_is_multipart(parser) ||
+                    llhttp_message_needs_eof(&parser->llhttp) ||
+                    (uint64_t) (end - p) < content_length) {
+                    goto _return;
+                }
+                break;
+            case CAT_HTTP_PARSER_EVENT_BODY:
+                if (body == NULL) {
+                    body = parser->data;
+                }
+                body_length = (parser->data + parser->data_length) - body;
+                break;
+            case CAT_HTTP_PARSER_EVENT_MESSAGE_COMPLETE:
+                completed = cat_true;
+                goto _return;
+            default:
+                break;
+        }
+    }
+
+    _return:
+    cat_http_parser_set_events(parser, events);
+    s_parser->data_offset = parser->data - ZSTR_VAL(string);
+    array_init_size(return_value, 16);
+#define SWOW_HTTP_PARSER_MESSAGE_ADD(name, zv) zend_hash_add_new(Z_ARRVAL_P(return_value), SWOW_KNOWN_STRING(name), zv)
+    if (parser->llhttp.type == HTTP_REQUEST) {
+        ZVAL_INTERNED_STR(&z_tmp, swow_http_get_method_name(parser));
+        SWOW_HTTP_PARSER_MESSAGE_ADD(method, &z_tmp);
+        ZVAL_STRINGL_FAST(&z_tmp, line != NULL ? line : "", line_length);
+        SWOW_HTTP_PARSER_MESSAGE_ADD(uri, &z_tmp);
+    } else {
+        ZVAL_LONG(&z_tmp, cat_http_parser_get_status_code(parser));
+        SWOW_HTTP_PARSER_MESSAGE_ADD(status_code, &z_tmp);
+        ZVAL_STRINGL_FAST(&z_tmp, line != NULL ? line : "", line_length);
+        SWOW_HTTP_PARSER_MESSAGE_ADD(reason_phrase, &z_tmp);
+    }
+    ZVAL_STR(&z_tmp, swow_http_get_protocol_version(parser));
+    SWOW_HTTP_PARSER_MESSAGE_ADD(protocol_version, &z_tmp);
+    SWOW_HTTP_PARSER_MESSAGE_ADD(headers, &z_headers);
+    SWOW_HTTP_PARSER_MESSAGE_ADD(header_names, &z_header_names);
+    ZVAL_LONG(&z_tmp, (zend_long) content_length);
+    SWOW_HTTP_PARSER_MESSAGE_ADD(content_length, &z_tmp);
+    ZVAL_BOOL(&z_tmp, parser->keep_alive);
+    SWOW_HTTP_PARSER_MESSAGE_ADD(keep_alive, &z_tmp);
+    ZVAL_BOOL(&z_tmp, cat_http_parser_is_chunked(parser));
+    SWOW_HTTP_PARSER_MESSAGE_ADD(is_chunked, &z_tmp);
+    ZVAL_BOOL(&z_tmp, cat_http_parser_is_multipart(parser));
+    SWOW_HTTP_PARSER_MESSAGE_ADD(is_multipart, &z_tmp);
+    ZVAL_BOOL(&z_tmp, cat_http_parser_is_upgrade(parser));
+    SWOW_HTTP_PARSER_MESSAGE_ADD(is_upgrade, &z_tmp);
+    ZVAL_LONG(&z_tmp, (body != NULL ? body : p) - ZSTR_VAL(string));
+    SWOW_HTTP_PARSER_MESSAGE_ADD(body_offset, &z_tmp);
+    ZVAL_LONG(&z_tmp, body_length);
+    SWOW_HTTP_PARSER_MESSAGE_ADD(body_length, &z_tmp);
+    ZVAL_LONG(&z_tmp, p - ptr);
+    SWOW_HTTP_PARSER_MESSAGE_ADD(parsed_length, &z_tmp);
+    ZVAL_BOOL(&z_tmp, completed);
+    SWOW_HTTP_PARSER_MESSAGE_ADD(completed, &z_tmp);
+#undef SWOW_HTTP_PARSER_MESSAGE_ADD
+    return;
+
+    _limit_error:
+    swow_throw_exception(swow_http_parser_exception_ce, status, "%s", cat_http_status_get_reason(status));
+    _error:
+    cat_http_parser_set_events(parser, events);
+    zval_ptr_dtor(&z_headers);
+    zval_ptr_dtor(&z_header_names);
+    RETURN_THROWS();
+}
+
 #define arginfo_class_Swow_Http_Parser_getEvent arginfo_class_Swow_Http_Parser_getType
 
 static PHP_METHOD(Swow_Http_Parser, getEvent)
@@ -294,7 +826,7 @@ static PHP_METHOD(Swow_Http_Parser, getMethod)
 
     ZEND_PARSE_PARAMETERS_NONE();
 
-    RETURN_STRING(cat_http_parser_get_method_name(parser));
+    RETURN_INTERNED_STR(swow_http_get_method_name(parser));
 }
 
 #define arginfo_class_Swow_Http_Parser_getMajorVersion arginfo_class_Swow_Http_Parser_getType
@@ -327,7 +859,7 @@ static PHP_METHOD(Swow_Http_Parser, getProtocolVersion)
 
     ZEND_PARSE_PARAMETERS_NONE();
 
-    RETURN_STRING(cat_http_parser_get_protocol_version(parser));
+    RETURN_STR(swow_http_get_protocol_version(parser));
 }
 
 #define arginfo_class_Swow_Http_Parser_getStatusCode arginfo_class_Swow_Http_Parser_getType
@@ -437,10 +969,133 @@ static PHP_METHOD(Swow_Http_Parser, reset)
 
     cat_http_parser_reset(parser);
     s_parser->data_offset = 0;
+    swow_http_parser_upload_reset(&s_parser->upload);
+
+    RETURN_THIS();
+}
+
+#define arginfo_class_Swow_Http_Parser_getMaxUploadedFileSize arginfo_class_Swow_Http_Parser_getType
+
+static PHP_METHOD(Swow_Http_Parser, getMaxUploadedFileSize)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG(getThisParser()->upload.max_file_size);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Http_Parser_setMaxUploadedFileSize, 0, 1, IS_STATIC, 0)
+    ZEND_ARG_TYPE_INFO(0, size, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Http_Parser, setMaxUploadedFileSize)
+{
+    zend_long size;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_LONG(size)
+    ZEND_PARSE_PARAMETERS_END();
+
+    getThisParser()->upload.max_file_size = size;
 
     RETURN_THIS();
 }
 
+#define arginfo_class_Swow_Http_Parser_getMaxUploadedFilesSize arginfo_class_Swow_Http_Parser_getType
+
+static PHP_METHOD(Swow_Http_Parser, getMaxUploadedFilesSize)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG(getThisParser()->upload.max_total_size);
+}
+
+#define arginfo_class_Swow_Http_Parser_setMaxUploadedFilesSize arginfo_class_Swow_Http_Parser_setMaxUploadedFileSize
+
+static PHP_METHOD(Swow_Http_Parser, setMaxUploadedFilesSize)
+{
+    zend_long size;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_LONG(size)
+    ZEND_PARSE_PARAMETERS_END();
+
+    getThisParser()->upload.max_total_size = size;
+
+    RETURN_THIS();
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Http_Parser_startUploadedFile, 0, 1, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO(0, directory, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, prefix, IS_STRING, 0, "\'swow_uploaded_file_\'")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Http_Parser, startUploadedFile)
+{
+    swow_http_parser_upload_t *upload = &getThisParser()->upload;
+    zend_string *directory;
+    zend_string *prefix = NULL;
+    zend_string *tmp_name;
+    size_t directory_length;
+
+    ZEND_PARSE_PARAMETERS_START(1, 2)
+        Z_PARAM_STR(directory)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_STR(prefix)
+    ZEND_PARSE_PARAMETERS_END();
+
+    /* the previous one was not finished, it is broken */
+    swow_http_parser_upload_close(upload, cat_true);
+    upload->uploading = cat_true;
+    upload->error = UPLOAD_ERROR_OK;
+    upload->size = 0;
+
+    directory_length = ZSTR_LEN(directory);
+    while (directory_length > 1 && IS_SLASH(ZSTR_VAL(directory)[directory_length - 1])) {
+        directory_length--;
+    }
+    tmp_name = zend_strpprintf(0, "%.*s%c%sXXXXXX",
+        (int) directory_length, ZSTR_VAL(directory), DEFAULT_SLASH,
+        prefix != NULL ? ZSTR_VAL(prefix) : "swow_uploaded_file_");
+    upload->fd = cat_fs_mkstemp_ex(ZSTR_VAL(tmp_name));
+    if (UNEXPECTED(upload->fd < 0)) {
+        zend_string_release(tmp_name);
+        swow_http_parser_upload_fail(upload, UPLOAD_ERROR_E);
+        RETURN_EMPTY_STRING();
+    }
+    upload->tmp_name = tmp_name;
+
+    RETURN_STR_COPY(tmp_name);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Http_Parser_finishUploadedFile, 0, 0, IS_ARRAY, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Http_Parser, finishUploadedFile)
+{
+    swow_http_parser_upload_t *upload = &getThisParser()->upload;
+    zval z_tmp;
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    if (UNEXPECTED(!upload->uploading)) {
+        swow_throw_exception(swow_http_parser_exception_ce, CAT_EMISUSE, "No uploaded file has been started");
+        RETURN_THROWS();
+    }
+
+    array_init_size(return_value, 3);
+    ZVAL_STR_COPY(&z_tmp, upload->tmp_name);
+    zend_hash_add_new(Z_ARRVAL_P(return_value), SWOW_KNOWN_STRING(tmp_name), &z_tmp);
+    ZVAL_LONG(&z_tmp, upload->error);
+    zend_hash_add_new(Z_ARRVAL_P(return_value), SWOW_KNOWN_STRING(error), &z_tmp);
+    ZVAL_LONG(&z_tmp, upload->size);
+    zend_hash_add_new(Z_ARRVAL_P(return_value), SWOW_KNOWN_STRING(size), &z_tmp);
+
+    swow_http_parser_upload_close(upload, cat_false);
+    upload->uploading = cat_false;
+    upload->error = UPLOAD_ERROR_OK;
+    upload->size = 0;
+}
+
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Http_Parser_getEventNameFor, 0, 1, IS_STRING, 0)
     ZEND_ARG_TYPE_INFO(0, event, IS_LONG, 0)
 ZEND_END_ARG_INFO()
@@ -458,35 +1113,42 @@ static PHP_METHOD(Swow_Http_Parser, getEventNameFor)
 }
 
 static const zend_function_entry swow_http_parser_methods[] = {
-    PHP_ME(Swow_Http_Parser, getType,               arginfo_class_Swow_Http_Parser_getType,               ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_Http_Parser, setType,               arginfo_class_Swow_Http_Parser_setType,               ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_Http_Parser, getEvents,             arginfo_class_Swow_Http_Parser_getEvents,             ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_Http_Parser, setEvents,             arginfo_class_Swow_Http_Parser_setEvents,             ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_Http_Parser, execute,               arginfo_class_Swow_Http_Parser_execute,               ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_Http_Parser, getEvent,              arginfo_class_Swow_Http_Parser_getEvent,              ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_Http_Parser, getEventName,          arginfo_class_Swow_Http_Parser_getEventName,          ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_Http_Parser, getPreviousEvent,      arginfo_class_Swow_Http_Parser_getPreviousEvent,      ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_Http_Parser, getPreviousEventName,  arginfo_class_Swow_Http_Parser_getPreviousEventName,  ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_Http_Parser, getDataOffset,         arginfo_class_Swow_Http_Parser_getDataOffset,         ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_Http_Parser, getDataLength,         arginfo_class_Swow_Http_Parser_getDataLength,         ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_Http_Parser, getParsedLength,       arginfo_class_Swow_Http_Parser_getParsedLength,       ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_Http_Parser, isCompleted,           arginfo_class_Swow_Http_Parser_isCompleted,           ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_Http_Parser, shouldKeepAlive,       arginfo_class_Swow_Http_Parser_shouldKeepAlive,       ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_Http_Parser, getMethod,             arginfo_class_Swow_Http_Parser_getMethod,             ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_Http_Parser, getMajorVersion,       arginfo_class_Swow_Http_Parser_getMajorVersion,       ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_Http_Parser, getMinorVersion,       arginfo_class_Swow_Http_Parser_getMinorVersion,       ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_Http_Parser, getProtocolVersion,    arginfo_class_Swow_Http_Parser_getProtocolVersion,    ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_Http_Parser, getStatusCode,         arginfo_class_Swow_Http_Parser_getStatusCode,         ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_Http_Parser, getReasonPhrase,       arginfo_class_Swow_Http_Parser_getReasonPhrase,       ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_Http_Parser, getContentLength,      arginfo_class_Swow_Http_Parser_getContentLength,      ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_Http_Parser, getCurrentChunkLength, arginfo_class_Swow_Http_Parser_getCurrentChunkLength, ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_Http_Parser, isChunked,             arginfo_class_Swow_Http_Parser_isChunked,             ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_Http_Parser, isMultipart,           arginfo_class_Swow_Http_Parser_isMultipart,           ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_Http_Parser, isUpgrade,             arginfo_class_Swow_Http_Parser_isUpgrade,             ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_Http_Parser, finish,                arginfo_class_Swow_Http_Parser_finish,                ZEND_ACC_PUBLIC)
-    PHP_ME(Swow_Http_Parser, reset,                 arginfo_class_Swow_Http_Parser_reset,                 ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, getType,                 arginfo_class_Swow_Http_Parser_getType,                 ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, setType,                 arginfo_class_Swow_Http_Parser_setType,                 ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, getEvents,               arginfo_class_Swow_Http_Parser_getEvents,               ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, setEvents,               arginfo_class_Swow_Http_Parser_setEvents,               ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, execute,                 arginfo_class_Swow_Http_Parser_execute,                 ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, parseMessage,            arginfo_class_Swow_Http_Parser_parseMessage,            ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, getEvent,                arginfo_class_Swow_Http_Parser_getEvent,                ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, getEventName,            arginfo_class_Swow_Http_Parser_getEventName,            ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, getPreviousEvent,        arginfo_class_Swow_Http_Parser_getPreviousEvent,        ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, getPreviousEventName,    arginfo_class_Swow_Http_Parser_getPreviousEventName,    ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, getDataOffset,           arginfo_class_Swow_Http_Parser_getDataOffset,           ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, getDataLength,           arginfo_class_Swow_Http_Parser_getDataLength,           ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, getParsedLength,         arginfo_class_Swow_Http_Parser_getParsedLength,         ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, isCompleted,             arginfo_class_Swow_Http_Parser_isCompleted,             ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, shouldKeepAlive,         arginfo_class_Swow_Http_Parser_shouldKeepAlive,         ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, getMethod,               arginfo_class_Swow_Http_Parser_getMethod,               ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, getMajorVersion,         arginfo_class_Swow_Http_Parser_getMajorVersion,         ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, getMinorVersion,         arginfo_class_Swow_Http_Parser_getMinorVersion,         ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, getProtocolVersion,      arginfo_class_Swow_Http_Parser_getProtocolVersion,      ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, getStatusCode,           arginfo_class_Swow_Http_Parser_getStatusCode,           ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, getReasonPhrase,         arginfo_class_Swow_Http_Parser_getReasonPhrase,         ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, getContentLength,        arginfo_class_Swow_Http_Parser_getContentLength,        ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, getCurrentChunkLength,   arginfo_class_Swow_Http_Parser_getCurrentChunkLength,   ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, isChunked,               arginfo_class_Swow_Http_Parser_isChunked,               ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, isMultipart,             arginfo_class_Swow_Http_Parser_isMultipart,             ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, isUpgrade,               arginfo_class_Swow_Http_Parser_isUpgrade,               ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, finish,                  arginfo_class_Swow_Http_Parser_finish,                  ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, reset,                   arginfo_class_Swow_Http_Parser_reset,                   ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, getMaxUploadedFileSize,  arginfo_class_Swow_Http_Parser_getMaxUploadedFileSize,  ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, setMaxUploadedFileSize,  arginfo_class_Swow_Http_Parser_setMaxUploadedFileSize,  ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, getMaxUploadedFilesSize, arginfo_class_Swow_Http_Parser_getMaxUploadedFilesSize, ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, setMaxUploadedFilesSize, arginfo_class_Swow_Http_Parser_setMaxUploadedFilesSize, ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, startUploadedFile,       arginfo_class_Swow_Http_Parser_startUploadedFile,       ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_Parser, finishUploadedFile,      arginfo_class_Swow_Http_Parser_finishUploadedFile,      ZEND_ACC_PUBLIC)
     /* static */
-    PHP_ME(Swow_Http_Parser, getEventNameFor,       arginfo_class_Swow_Http_Parser_getEventNameFor,       ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Http_Parser, getEventNameFor,         arginfo_class_Swow_Http_Parser_getEventNameFor,         ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_FE_END
 };
 
@@ -502,7 +1164,7 @@ static zend_always_inline size_t swow_http_get_header_length(zend_string *header
     return size;
 }
 
-static zend_always_inline size_t swow_http_get_message_length(HashTable *headers, zend_string *body)
+static zend_always_inline size_t swow_http_get_headers_length(HashTable *headers)
 {
     zend_string *header_name;
     zval *z_header_value;
@@ -521,6 +1183,13 @@ static zend_always_inline size_t swow_http_get_message_length(HashTable *headers
         }
     } ZEND_HASH_FOREACH_END();
 
+    return size;
+}
+
+static zend_always_inline size_t swow_http_get_message_length(HashTable *headers, zend_string *body)
+{
+    size_t size = swow_http_get_headers_length(headers);
+
     size += CAT_STRLEN("\r\n");
 
     size += ZSTR_LEN(body);
@@ -563,10 +1232,8 @@ static zend_always_inline char *swow_http_pack_headers(char *p, HashTable *heade
     return p;
 }
 
-static zend_always_inline char *swow_http_pack_message(char *p, HashTable *headers, zend_string *body)
+static zend_always_inline char *swow_http_pack_body(char *p, zend_string *body)
 {
-    p = swow_http_pack_headers(p, headers);
-
     p = cat_strnappend(p, CAT_STRL("\r\n"));
 
     if (ZSTR_LEN(body) > 0) {
@@ -578,6 +1245,52 @@ static zend_always_inline char *swow_http_pack_message(char *p, HashTable *heade
     return p;
 }
 
+static zend_always_inline char *swow_http_pack_message(char *p, HashTable *headers, zend_string *body)
+{
+    p = swow_http_pack_headers(p, headers);
+
+    return swow_http_pack_body(p, body);
+}
+
+#define SWOW_HTTP_STATUS_LINE_PREPARE() \
+    char status_code_buffer[MAX_LENGTH_OF_LONG + 1]; \
+    char *status_code_string_eof = status_code_buffer + sizeof(status_code_buffer) - 1; \
+    char *status_code_string = zend_print_long_to_buf(status_code_string_eof, status_code); \
+    size_t status_code_length = status_code_string_eof - status_code_string; \
+    if (reason_phrase_length == 0) { \
+        reason_phrase = cat_http_status_get_reason(status_code); \
+        reason_phrase_length = strlen(reason_phrase); \
+    }
+
+SWOW_API size_t swow_http_get_response_head_length(
+    zend_long status_code, const char *reason_phrase, size_t reason_phrase_length,
+    HashTable *headers, const char *protocol_version, size_t protocol_version_length)
+{
+    SWOW_HTTP_STATUS_LINE_PREPARE();
+
+    return CAT_STRLEN("HTTP/") + protocol_version_length + CAT_STRLEN(" ") +
+           status_code_length + CAT_STRLEN(" ") +
+           reason_phrase_length + CAT_STRLEN("\r\n") +
+           swow_http_get_headers_length(headers);
+}
+
+SWOW_API char *swow_http_pack_response_head(
+    char *p, zend_long status_code, const char *reason_phrase, size_t reason_phrase_length,
+    HashTable *headers, const char *protocol_version, size_t protocol_version_length)
+{
+    SWOW_HTTP_STATUS_LINE_PREPARE();
+
+    p = cat_strnappend(p, CAT_STRL("HTTP/"));
+    p = cat_strnappend(p, protocol_version, protocol_version_length);
+    p = cat_strnappend(p, CAT_STRL(" "));
+    p = cat_strnappend(p, status_code_string, status_code_length);
+    p = cat_strnappend(p, CAT_STRL(" "));
+    p = cat_strnappend(p, reason_phrase, reason_phrase_length);
+    p = cat_strnappend(p, CAT_STRL("\r\n"));
+
+    return swow_http_pack_headers(p, headers);
+}
+
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Http_Http_packRequest, 0, 2, IS_STRING, 0)
     ZEND_ARG_TYPE_INFO(0, method, IS_STRING, 0)
     ZEND_ARG_OBJ_TYPE_MASK(0, uri, Stringable, MAY_BE_STRING, NULL)
@@ -644,9 +1357,6 @@ static PHP_METHOD(Swow_Http_Http, packResponse)
     zend_string *response;
     /* arguments */
     zend_long status_code;
-    char status_code_buffer[MAX_LENGTH_OF_LONG + 1];
-    char *status_code_string, *status_code_string_eof;
-    size_t status_code_length;
     char *reason_phrase = NULL;
     size_t reason_phrase_length = 0;
     HashTable *headers = (HashTable *) &zend_empty_array;
@@ -667,32 +1377,15 @@ static PHP_METHOD(Swow_Http_Http, packResponse)
         Z_PARAM_STRING(protocol_version, protocol_version_length)
     ZEND_PARSE_PARAMETERS_END();
 
-    status_code_string_eof = status_code_buffer + sizeof(status_code_buffer) - 1;
-    status_code_string = zend_print_long_to_buf(status_code_string_eof, status_code);
-    status_code_length = status_code_string_eof - status_code_string;
-    if (reason_phrase_length == 0) {
-        reason_phrase = (char *) cat_http_status_get_reason(status_code);
-        reason_phrase_length = strlen(reason_phrase);
-    }
+    size = swow_http_get_response_head_length(status_code, reason_phrase, reason_phrase_length, headers, protocol_version, protocol_version_length);
 
-    size = CAT_STRLEN("HTTP/") + protocol_version_length + CAT_STRLEN(" ") +
-           status_code_length + CAT_STRLEN(" ") +
-           reason_phrase_length + CAT_STRLEN("\r\n");
-
-    size += swow_http_get_message_length(headers, body);
+    size += CAT_STRLEN("\r\n") + ZSTR_LEN(body);
 
     response = zend_string_alloc(size, 0);
 
-    p = ZSTR_VAL(response);
-    p = cat_strnappend(p, CAT_STRL("HTTP/"));
-    p = cat_strnappend(p, protocol_version, protocol_version_length);
-    p = cat_strnappend(p, CAT_STRL(" "));
-    p = cat_strnappend(p, status_code_string, status_code_length);
-    p = cat_strnappend(p, CAT_STRL(" "));
-    p = cat_strnappend(p, reason_phrase, reason_phrase_length);
-    p = cat_strnappend(p, CAT_STRL("\r\n"));
+    p = swow_http_pack_response_head(ZSTR_VAL(response), status_code, reason_phrase, reason_phrase_length, headers, protocol_version, protocol_version_length);
 
-    (void) swow_http_pack_message(p, headers, body);
+    (void) swow_http_pack_body(p, body);
 
     RETURN_STR(response);
 }
@@ -703,12 +1396,305 @@ static const zend_function_entry swow_http_http_methods[] = {
     PHP_FE_END
 };
 
+/* ResponseTemplate */
+
+static const char *swow_http_get_date(void)
+{
+    static const char week_days[][4] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+    static const char months[][4] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+    time_t now = time(NULL);
+
+    if (now != SWOW_HTTP_G(date_time)) {
+        struct tm tm;
+        php_gmtime_r(&now, &tm);
+        snprintf(SWOW_HTTP_G(date), sizeof(SWOW_HTTP_G(date)), "%s, %02d %s %04d %02d:%02d:%02d GMT",
+            week_days[tm.tm_wday], tm.tm_mday, months[tm.tm_mon], tm.tm_year + 1900,
+            tm.tm_hour, tm.tm_min, tm.tm_sec);
+        SWOW_HTTP_G(date_time) = now;
+    }
+
+    return SWOW_HTTP_G(date);
+}
+
+static zend_object *swow_http_response_template_create_object(zend_class_entry *ce)
+{
+    swow_http_response_template_t *s_template = swow_object_alloc(swow_http_response_template_t, ce, swow_http_response_template_handlers);
+
+    s_template->head = NULL;
+    s_template->status_code = 0;
+    s_template->with_date = false;
+    s_template->with_content_length = false;
+
+    return &s_template->std;
+}
+
+static void swow_http_response_template_free_object(zend_object *object)
+{
+    swow_http_response_template_t *s_template = swow_http_response_template_get_from_object(object);
+
+    if (s_template->head != NULL) {
+        zend_string_release(s_template->head);
+    }
+
+    zend_object_std_dtor(&s_template->std);
+}
+
+#define getThisResponseTemplate() (swow_http_response_template_get_from_object(Z_OBJ_P(ZEND_THIS)))
+
+static zend_bool swow_http_headers_has(HashTable *headers, const char *name, size_t name_length)
+{
+    zend_string *header_name;
+
+    ZEND_HASH_FOREACH_STR_KEY(headers, header_name) {
+        if (header_name != NULL &&
+            zend_binary_strcasecmp(ZSTR_VAL(header_name), ZSTR_LEN(header_name), name, name_length) == 0) {
+            return true;
+        }
+    } ZEND_HASH_FOREACH_END();
+
+    return false;
+}
+
+#define SWOW_HTTP_RESPONSE_TEMPLATE_GETTER(_s_template) \
+    swow_http_response_template_t *_s_template = getThisResponseTemplate(); \
+    if (UNEXPECTED(_s_template->head == NULL)) { \
+        zend_throw_error(NULL, "%s must construct first", ZSTR_VAL(Z_OBJCE_P(ZEND_THIS)->name)); \
+        RETURN_THROWS(); \
+    }
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_class_Swow_Http_ResponseTemplate___construct, 0, 0, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, statusCode, IS_LONG, 0, "Swow\\Http\\Status::OK")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, reasonPhrase, IS_STRING, 0, "\'\'")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, headers, IS_ARRAY, 0, "[]")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, protocolVersion, IS_STRING, 0, "Swow\\Http\\Http::DEFAULT_PROTOCOL_VERSION")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, withDate, _IS_BOOL, 0, "true")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Http_ResponseTemplate, __construct)
+{
+    swow_http_response_template_t *s_template = getThisResponseTemplate();
+    zend_string *head;
+    /* arguments */
+    zend_long status_code = CAT_HTTP_STATUS_OK;
+    char *reason_phrase = NULL;
+    size_t reason_phrase_length = 0;
+    HashTable *headers = (HashTable *) &zend_empty_array;
+    char *protocol_version = (char *) "1.1";
+    size_t protocol_version_length = CAT_STRLEN("1.1");
+    zend_bool with_date = true;
+    /* pack */
+    char *p;
+
+    ZEND_PARSE_PARAMETERS_START(0, 5)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(status_code)
+        Z_PARAM_STRING(reason_phrase, reason_phrase_length)
+        Z_PARAM_ARRAY_HT(headers)
+        Z_PARAM_STRING(protocol_version, protocol_version_length)
+        Z_PARAM_BOOL(with_date)
+    ZEND_PARSE_PARAMETERS_END();
+
+    /* they are generated for every response */
+    if (UNEXPECTED(swow_http_headers_has(headers, CAT_STRL("Content-Length")))) {
+        zend_argument_value_error(3, "can not contain Content-Length");
+        RETURN_THROWS();
+    }
+    if (with_date && UNEXPECTED(swow_http_headers_has(headers, CAT_STRL("Date")))) {
+        zend_argument_value_error(3, "can not contain Date when withDate is true");
+        RETURN_THROWS();
+    }
+
+    head = zend_string_alloc(swow_http_get_response_head_length(
+        status_code, reason_phrase, reason_phrase_length, headers, protocol_version, protocol_version_length), 0);
+
+    p = swow_http_pack_response_head(
+        ZSTR_VAL(head), status_code, reason_phrase, reason_phrase_length, headers, protocol_version, protocol_version_length);
+    *p = '\0';
+
+    if (s_template->head != NULL) {
+        zend_string_release(s_template->head);
+    }
+    s_template->head = head;
+    s_template->status_code = status_code;
+    s_template->with_date = with_date;
+    s_template->with_content_length = !(
+        status_code < CAT_HTTP_STATUS_OK ||
+        status_code == CAT_HTTP_STATUS_NO_CONTENT ||
+        status_code == CAT_HTTP_STATUS_NOT_MODIFIED
+    );
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Http_ResponseTemplate_getStatusCode, 0, 0, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Http_ResponseTemplate, getStatusCode)
+{
+    SWOW_HTTP_RESPONSE_TEMPLATE_GETTER(s_template);
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG(s_template->status_code);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Http_ResponseTemplate_getHead, 0, 0, IS_STRING, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Http_ResponseTemplate, getHead)
+{
+    SWOW_HTTP_RESPONSE_TEMPLATE_GETTER(s_template);
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_STR_COPY(s_template->head);
+}
+
+static zend_always_inline size_t swow_http_response_template_get_length(
+    const swow_http_response_template_t *s_template, size_t content_length_length, HashTable *headers, zend_string *body)
+{
+    size_t size = ZSTR_LEN(s_template->head);
+
+    if (s_template->with_date) {
+        size += CAT_STRLEN("Date: ") + CAT_STRLEN("Sun, 06 Nov 1994 08:49:37 GMT") + CAT_STRLEN("\r\n");
+    }
+    if (s_template->with_content_length) {
+        size += CAT_STRLEN("Content-Length: ") + content_length_length + CAT_STRLEN("\r\n");
+    }
+    size += swow_http_get_message_length(headers, body);
+
+    return size;
+}
+
+static zend_always_inline char *swow_http_response_template_pack(
+    char *p, const swow_http_response_template_t *s_template,
+    const char *content_length, size_t content_length_length, HashTable *headers, zend_string *body)
+{
+    p = cat_strnappend(p, ZSTR_VAL(s_template->head), ZSTR_LEN(s_template->head));
+    if (s_template->with_date) {
+        p = cat_strnappend(p, CAT_STRL("Date: "));
+        p = cat_strnappend(p, swow_http_get_date(), CAT_STRLEN("Sun, 06 Nov 1994 08:49:37 GMT"));
+        p = cat_strnappend(p, CAT_STRL("\r\n"));
+    }
+    if (s_template->with_content_length) {
+        p = cat_strnappend(p, CAT_STRL("Content-Length: "));
+        p = cat_strnappend(p, content_length, content_length_length);
+        p = cat_strnappend(p, CAT_STRL("\r\n"));
+    }
+
+    return swow_http_pack_message(p, headers, body);
+}
+
+/* Content-Length and Date can be given by user only if template does not generate them (e.g. 304) */
+#define SWOW_HTTP_RESPONSE_TEMPLATE_CHECK_HEADERS(s_template, headers, arg_num) do { \
+    if (s_template->with_content_length && UNEXPECTED(swow_http_headers_has(headers, CAT_STRL("Content-Length")))) { \
+        zend_argument_value_error(arg_num, "can not contain Content-Length"); \
+        RETURN_THROWS(); \
+    } \
+    if (s_template->with_date && UNEXPECTED(swow_http_headers_has(headers, CAT_STRL("Date")))) { \
+        zend_argument_value_error(arg_num, "can not contain Date"); \
+        RETURN_THROWS(); \
+    } \
+} while (0)
+
+#define SWOW_HTTP_RESPONSE_TEMPLATE_CONTENT_LENGTH(body) \
+    char content_length_buffer[MAX_LENGTH_OF_LONG + 1]; \
+    char *content_length_eof = content_length_buffer + sizeof(content_length_buffer) - 1; \
+    char *content_length = zend_print_ulong_to_buf(content_length_eof, ZSTR_LEN(body)); \
+    size_t content_length_length = content_length_eof - content_length
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Http_ResponseTemplate_pack, 0, 0, IS_STRING, 0)
+    ZEND_ARG_OBJ_TYPE_MASK(0, body, Stringable, MAY_BE_STRING, "\'\'")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, headers, IS_ARRAY, 0, "[]")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Http_ResponseTemplate, pack)
+{
+    SWOW_HTTP_RESPONSE_TEMPLATE_GETTER(s_template);
+    zend_string *response;
+    /* arguments */
+    zend_string *body = zend_empty_string;
+    HashTable *headers = (HashTable *) &zend_empty_array;
+
+    ZEND_PARSE_PARAMETERS_START(0, 2)
+        Z_PARAM_OPTIONAL
+        SWOW_PARAM_STRINGABLE_EXPECT_BUFFER_FOR_READING(body)
+        Z_PARAM_ARRAY_HT(headers)
+    ZEND_PARSE_PARAMETERS_END();
+
+    SWOW_HTTP_RESPONSE_TEMPLATE_CHECK_HEADERS(s_template, headers, 2);
+    SWOW_HTTP_RESPONSE_TEMPLATE_CONTENT_LENGTH(body);
+
+    response = zend_string_alloc(swow_http_response_template_get_length(s_template, content_length_length, headers, body), 0);
+
+    (void) swow_http_response_template_pack(ZSTR_VAL(response), s_template, content_length, content_length_length, headers, body);
+
+    RETURN_STR(response);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Http_ResponseTemplate_packTo, 0, 1, IS_LONG, 0)
+    ZEND_ARG_OBJ_INFO(0, buffer, Swow\\Buffer, 0)
+    ZEND_ARG_OBJ_TYPE_MASK(0, body, Stringable, MAY_BE_STRING, "\'\'")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, headers, IS_ARRAY, 0, "[]")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Http_ResponseTemplate, packTo)
+{
+    SWOW_HTTP_RESPONSE_TEMPLATE_GETTER(s_template);
+    swow_buffer_t *s_buffer;
+    cat_buffer_t *buffer;
+    size_t size;
+    /* arguments */
+    zend_object *buffer_object;
+    zend_string *body = zend_empty_string;
+    HashTable *headers = (HashTable *) &zend_empty_array;
+
+    ZEND_PARSE_PARAMETERS_START(1, 3)
+        Z_PARAM_OBJ_OF_CLASS(buffer_object, swow_buffer_ce)
+        Z_PARAM_OPTIONAL
+        SWOW_PARAM_STRINGABLE_EXPECT_BUFFER_FOR_READING(body)
+        Z_PARAM_ARRAY_HT(headers)
+    ZEND_PARSE_PARAMETERS_END();
+
+    SWOW_HTTP_RESPONSE_TEMPLATE_CHECK_HEADERS(s_template, headers, 3);
+
+    s_buffer = swow_buffer_get_from_object(buffer_object);
+    buffer = &s_buffer->buffer;
+    SWOW_BUFFER_CHECK_LOCK(s_buffer);
+
+    SWOW_HTTP_RESPONSE_TEMPLATE_CONTENT_LENGTH(body);
+
+    size = swow_http_response_template_get_length(s_template, content_length_length, headers, body);
+
+    /* the response is appended to the buffer, so the buffer can be reused for many responses */
+    swow_buffer_cow(s_buffer);
+    if (UNEXPECTED(!cat_buffer_prepare(buffer, size))) {
+        swow_throw_exception_with_last(swow_buffer_exception_ce);
+        RETURN_THROWS();
+    }
+    (void) swow_http_response_template_pack(buffer->value + buffer->length, s_template, content_length, content_length_length, headers, body);
+    swow_buffer_update(s_buffer, buffer->length + size);
+
+    RETURN_LONG(size);
+}
+
+static const zend_function_entry swow_http_response_template_methods[] = {
+    PHP_ME(Swow_Http_ResponseTemplate, __construct,   arginfo_class_Swow_Http_ResponseTemplate___construct,   ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_ResponseTemplate, getStatusCode, arginfo_class_Swow_Http_ResponseTemplate_getStatusCode, ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_ResponseTemplate, getHead,       arginfo_class_Swow_Http_ResponseTemplate_getHead,       ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_ResponseTemplate, pack,          arginfo_class_Swow_Http_ResponseTemplate_pack,          ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Http_ResponseTemplate, packTo,        arginfo_class_Swow_Http_ResponseTemplate_packTo,        ZEND_ACC_PUBLIC)
+    PHP_FE_END
+};
+
 zend_result swow_http_module_init(INIT_FUNC_ARGS)
 {
     if (!cat_http_module_init()) {
         return FAILURE;
     }
 
+    CAT_GLOBALS_REGISTER(swow_http);
+
+    swow_http_known_strings_init();
+
     /* Http */
     swow_http_http_ce = swow_register_internal_class(
         "Swow\\Http\\Http", NULL, swow_http_http_methods,
@@ -732,7 +1718,7 @@ zend_result swow_http_module_init(INIT_FUNC_ARGS)
         "Swow\\Http\\Parser", NULL, swow_http_parser_methods,
         &swow_http_parser_handlers, NULL,
         cat_false, cat_false,
-        swow_http_parser_create_object, NULL,
+        swow_http_parser_create_object, swow_http_parser_free_object,
         XtOffsetOf(swow_http_parser_t, std)
     );
     zend_declare_class_constant_long(swow_http_parser_ce, ZEND_STRL("TYPE_BOTH"), CAT_HTTP_PARSER_TYPE_BOTH);
@@ -757,5 +1743,21 @@ zend_result swow_http_module_init(INIT_FUNC_ARGS)
     CAT_HTTP_PARSER_ERRNO_MAP(SWOW_HTTP_PARSER_ERRNO_GEN)
 #undef SWOW_HTTP_PARSER_ERRNO_GEN
 
+    /* ResponseTemplate */
+    swow_http_response_template_ce = swow_register_internal_class(
+        "Swow\\Http\\ResponseTemplate", NULL, swow_http_response_template_methods,
+        &swow_http_response_template_handlers, NULL,
+        cat_false, cat_false,
+        swow_http_response_template_create_object, swow_http_response_template_free_object,
+        XtOffsetOf(swow_http_response_template_t, std)
+    );
+
+    return SUCCESS;
+}
+
+zend_result swow_http_module_shutdown(INIT_FUNC_ARGS)
+{
+    CAT_GLOBALS_UNREGISTER(swow_http);
+
     return SUCCESS;
 }
@@ -34,6 +34,7 @@
 #include "swow_signal.h"
 #include "swow_watchdog.h"
 #include "swow_closure.h"
+#include "swow_thread.h"
 #include "swow_ipaddress.h"
 #include "swow_http.h"
 #include "swow_websocket.h"
@@ -161,6 +162,7 @@ PHP_MINIT_FUNCTION(swow)
         swow_signal_module_init,
         swow_watchdog_module_init,
         swow_closure_module_init,
+        swow_thread_module_init,
         swow_ipaddress_init,
         swow_http_module_init,
         swow_websocket_module_init,
@@ -216,6 +218,8 @@ PHP_MSHUTDOWN_FUNCTION(swow)
 #ifdef CAT_OS_WAIT
         swow_proc_open_module_shutdown,
 #endif
+        swow_http_module_shutdown,
+        swow_thread_module_shutdown,
         swow_closure_module_shutdown,
         swow_watchdog_module_shutdown,
         swow_stream_module_shutdown,
@@ -507,12 +511,32 @@ static PHP_METHOD(Swow_Extension, isBuiltWith)
         ret = 1;
     }
 #endif
+#ifdef CAT_IO_URING
+    else if (zend_string_equals_literal_ci(lib, "io_uring")) {
+        ret = 1;
+    }
+#endif
 
     RETURN_BOOL(ret);
 }
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Extension_isIoUringAvailable, 0, 0, _IS_BOOL, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Extension, isIoUringAvailable)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+#ifdef CAT_IO_URING
+    RETURN_BOOL(cat_io_uring_is_available());
+#else
+    RETURN_FALSE;
+#endif
+}
+
 static const zend_function_entry swow_extension_methods[] = {
-    PHP_ME(Swow_Extension, isBuiltWith, arginfo_class_Swow_Extension_isBuiltWith, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Extension, isBuiltWith,        arginfo_class_Swow_Extension_isBuiltWith,        ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Extension, isIoUringAvailable, arginfo_class_Swow_Extension_isIoUringAvailable, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_FE_END
 };
 
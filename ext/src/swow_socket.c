@@ -18,6 +18,7 @@
 
 #include "swow_socket.h"
 #include "swow_buffer.h"
+#include "swow_http.h"
 
 SWOW_API zend_class_entry *swow_socket_ce;
 SWOW_API zend_object_handlers swow_socket_handlers;
@@ -30,11 +31,19 @@ SWOW_API zend_class_entry *swow_socket_exception_ce;
 
 #define SWOW_SOCKET_GETTER(_s_socket, _socket) SWOW_SOCKET_GETTER_INTERNAL(Z_OBJ_P(ZEND_THIS), _s_socket, _socket)
 
+/* areas of recvMany() larger than it are not kept by the socket */
+#ifndef SWOW_SOCKET_RECV_MANY_AREA_MAX_SIZE
+#define SWOW_SOCKET_RECV_MANY_AREA_MAX_SIZE (1024 * 1024)
+#endif
+
 static zend_object *swow_socket_create_object(zend_class_entry *ce)
 {
     swow_socket_t *s_socket = swow_object_alloc(swow_socket_t, ce, swow_socket_handlers);
 
     cat_socket_init(&s_socket->socket);
+    memset(&s_socket->accept_stats, 0, sizeof(s_socket->accept_stats));
+    s_socket->recv_many_area = NULL;
+    s_socket->recv_many_area_size = 0;
 
     return &s_socket->std;
 }
@@ -63,6 +72,10 @@ static void swow_socket_free_object(zend_object *object)
         cat_socket_close(socket);
     }
 
+    if (s_socket->recv_many_area != NULL) {
+        efree(s_socket->recv_many_area);
+    }
+
     zend_object_std_dtor(&s_socket->std);
 }
 
@@ -450,6 +463,98 @@ static PHP_METHOD(Swow_Socket, acceptTo)
     RETURN_THIS();
 }
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_acceptMany, 0, 1, IS_ARRAY, 0)
+    ZEND_ARG_TYPE_INFO(0, max, IS_LONG, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, timeout, IS_LONG, 1, "null")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, acceptMany)
+{
+    SWOW_SOCKET_GETTER(s_server, server);
+    cat_socket_type_t server_type = cat_socket_get_simple_type(server);
+    zend_long max;
+    zend_long timeout;
+    zend_bool timeout_is_null = 1;
+    swow_socket_t *s_connection;
+    cat_socket_t *connection;
+    zend_long n;
+    cat_bool_t ret;
+
+    ZEND_PARSE_PARAMETERS_START(1, 2)
+        Z_PARAM_LONG(max)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG_OR_NULL(timeout, timeout_is_null)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(max <= 0)) {
+        zend_argument_value_error(1, "must be greater than 0");
+        RETURN_THROWS();
+    }
+    if (timeout_is_null) {
+        timeout = cat_socket_get_accept_timeout(server);
+    }
+
+    for (n = 0; n < max; n++) {
+        s_connection = swow_socket_get_from_object(
+            swow_socket_create_object(Z_OBJCE_P(ZEND_THIS))
+        );
+        connection = &s_connection->socket;
+        if (likely(server_type != CAT_SOCKET_TYPE_ANY)) {
+            ret = cat_socket_create(connection, server_type) != NULL;
+            if (UNEXPECTED(!ret)) {
+                zend_object_release(&s_connection->std);
+                break;
+            }
+        }
+        /* wait for the first one only, then take what is already pending in the backlog */
+        if (n == 0) {
+            ret = cat_socket_accept_ex(server, connection, timeout);
+        } else {
+            ret = cat_socket_try_accept(server, connection);
+        }
+        if (!ret) {
+            if (server_type != CAT_SOCKET_TYPE_ANY) {
+                cat_socket_close(connection);
+            }
+            zend_object_release(&s_connection->std);
+            break;
+        }
+        if (n == 0) {
+            array_init(return_value);
+        }
+        add_next_index_object(return_value, &s_connection->std);
+    }
+
+    if (UNEXPECTED(n == 0)) {
+        swow_throw_exception_with_last(swow_socket_exception_ce);
+        RETURN_THROWS();
+    }
+    /* errors after the first connection (usually EAGAIN) just end the batch,
+     * they will be reported by the next call if they are persistent */
+    s_server->accept_stats.batches++;
+    s_server->accept_stats.connections += n;
+    s_server->accept_stats.last_batch_size = (uint32_t) n;
+    if ((uint32_t) n > s_server->accept_stats.max_batch_size) {
+        s_server->accept_stats.max_batch_size = (uint32_t) n;
+    }
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_getAcceptStats, 0, 0, IS_ARRAY, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, getAcceptStats)
+{
+    swow_socket_t *s_socket = swow_socket_get_from_object(Z_OBJ_P(ZEND_THIS));
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    array_init(return_value);
+    add_assoc_long(return_value, "batches", (zend_long) s_socket->accept_stats.batches);
+    add_assoc_long(return_value, "connections", (zend_long) s_socket->accept_stats.connections);
+    add_assoc_long(return_value, "last_batch_size", (zend_long) s_socket->accept_stats.last_batch_size);
+    add_assoc_long(return_value, "max_batch_size", (zend_long) s_socket->accept_stats.max_batch_size);
+}
+
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_connect, 0, 1, IS_STATIC, 0)
     ZEND_ARG_TYPE_INFO(0, name, IS_STRING, 0)
     ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, port, IS_LONG, 0, "0")
@@ -1246,6 +1351,439 @@ static PHP_METHOD(Swow_Socket, sendHandle)
     RETURN_THIS();
 }
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_sendFile, 0, 1, IS_LONG, 0)
+    ZEND_ARG_TYPE_INFO(0, file, IS_MIXED, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, offset, IS_LONG, 0, "0")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, length, IS_LONG, 0, "-1")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, timeout, IS_LONG, 1, "null")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, sendFile)
+{
+    SWOW_SOCKET_GETTER(s_socket, socket);
+    zval *z_file;
+    zend_long offset = 0;
+    zend_long length = -1;
+    zend_long timeout;
+    zend_bool timeout_is_null = 1;
+    cat_file_t fd = -1;
+    cat_bool_t need_close = cat_false;
+    ssize_t ret;
+
+    ZEND_PARSE_PARAMETERS_START(1, 4)
+        Z_PARAM_ZVAL(z_file)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(offset)
+        Z_PARAM_LONG(length)
+        Z_PARAM_LONG_OR_NULL(timeout, timeout_is_null)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(offset < 0)) {
+        zend_argument_value_error(2, "can not be negative");
+        RETURN_THROWS();
+    }
+    if (UNEXPECTED(length < -1)) {
+        zend_argument_value_error(3, "can not be less than -1");
+        RETURN_THROWS();
+    }
+    if (Z_TYPE_P(z_file) == IS_STRING) {
+        const char *path = Z_STRVAL_P(z_file);
+        if (UNEXPECTED(zend_str_has_nul_byte(Z_STR_P(z_file)))) {
+            zend_argument_value_error(1, "must not contain any null bytes");
+            RETURN_THROWS();
+        }
+        if (UNEXPECTED(php_check_open_basedir_ex(path, 0) != 0)) {
+            swow_throw_exception(swow_socket_exception_ce, CAT_EACCES, "open_basedir restriction in effect, File(%s) is not within the allowed path(s)", path);
+            RETURN_THROWS();
+        }
+        fd = cat_fs_open(path, O_RDONLY);
+        if (UNEXPECTED(fd < 0)) {
+            swow_throw_exception_with_last_as_reason(swow_socket_exception_ce, "Failed to open file \"%s\"", path);
+            RETURN_THROWS();
+        }
+        need_close = cat_true;
+    } else if (Z_TYPE_P(z_file) == IS_RESOURCE) {
+        php_stream *stream;
+        int stream_fd;
+        php_stream_from_zval(stream, z_file);
+        if (UNEXPECTED(php_stream_cast(stream, PHP_STREAM_AS_FD | PHP_STREAM_CAST_INTERNAL, (void *) &stream_fd, REPORT_ERRORS) != SUCCESS || stream_fd < 0)) {
+            zend_argument_value_error(1, "must be a stream which can be cast to a file descriptor");
+            RETURN_THROWS();
+        }
+        fd = (cat_file_t) stream_fd;
+    } else {
+        zend_argument_type_error(1, "must be of type string or resource, %s given", zend_zval_type_name(z_file));
+        RETURN_THROWS();
+    }
+    if (timeout_is_null) {
+        timeout = cat_socket_get_write_timeout(socket);
+    }
+
+    if (length == -1) {
+        cat_stat_t stat;
+        if (UNEXPECTED(cat_fs_fstat(fd, &stat) != 0)) {
+            swow_throw_exception_with_last(swow_socket_exception_ce);
+            goto _out;
+        }
+        length = (zend_long) stat.st_size > offset ? (zend_long) stat.st_size - offset : 0;
+    }
+
+    if (length == 0) {
+        ret = 0;
+    } else {
+        ret = cat_socket_send_file_ex(socket, fd, offset, (size_t) length, timeout);
+    }
+
+    /* also for socket exception getReturnValue */
+    RETVAL_LONG(ret > 0 ? ret : 0);
+
+    if (UNEXPECTED(ret != length)) {
+        swow_throw_call_exception_with_last(swow_socket_exception_ce);
+    }
+
+    _out:
+
+    if (need_close) {
+        (void) cat_fs_close(fd);
+    }
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_sendResponse, 0, 1, IS_STATIC, 0)
+    ZEND_ARG_TYPE_INFO(0, statusCode, IS_LONG, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, headers, IS_ARRAY, 0, "[]")
+    ZEND_ARG_OBJ_TYPE_MASK(0, body, Stringable, MAY_BE_STRING, "\'\'")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, reasonPhrase, IS_STRING, 0, "\'\'")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, protocolVersion, IS_STRING, 0, "Swow\\Http\\Http::DEFAULT_PROTOCOL_VERSION")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, timeout, IS_LONG, 1, "null")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, sendResponse)
+{
+    SWOW_SOCKET_GETTER(s_socket, socket);
+    zend_long status_code;
+    HashTable *headers = (HashTable *) &zend_empty_array;
+    zend_string *body = zend_empty_string;
+    char *reason_phrase = NULL;
+    size_t reason_phrase_length = 0;
+    char *protocol_version = (char *) "1.1";
+    size_t protocol_version_length = CAT_STRLEN("1.1");
+    zend_long timeout;
+    zend_bool timeout_is_null = 1;
+    char head_on_stack[1024], *head, *p;
+    size_t head_length;
+    cat_socket_write_vector_t vector[2];
+    cat_bool_t ret;
+
+    ZEND_PARSE_PARAMETERS_START(1, 6)
+        Z_PARAM_LONG(status_code)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_ARRAY_HT(headers)
+        SWOW_PARAM_STRINGABLE_EXPECT_BUFFER_FOR_READING(body)
+        Z_PARAM_STRING(reason_phrase, reason_phrase_length)
+        Z_PARAM_STRING(protocol_version, protocol_version_length)
+        Z_PARAM_LONG_OR_NULL(timeout, timeout_is_null)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (timeout_is_null) {
+        timeout = cat_socket_get_write_timeout(socket);
+    }
+
+    /* only the head is packed, the body is written as the second vector, so it is never copied */
+    head_length = swow_http_get_response_head_length(
+        status_code, reason_phrase, reason_phrase_length, headers, protocol_version, protocol_version_length) + CAT_STRLEN("\r\n");
+    head = head_length <= sizeof(head_on_stack) ? head_on_stack : emalloc(head_length);
+    p = swow_http_pack_response_head(
+        head, status_code, reason_phrase, reason_phrase_length, headers, protocol_version, protocol_version_length);
+    memcpy(p, "\r\n", CAT_STRLEN("\r\n"));
+    vector[0].base = head;
+    vector[0].length = head_length;
+    vector[1].base = ZSTR_VAL(body);
+    vector[1].length = ZSTR_LEN(body);
+
+    /* body may be the string of a buffer, make sure that it is immutable (COW) during writing */
+    zend_string_addref(body);
+    ret = cat_socket_write_ex(socket, vector, ZSTR_LEN(body) > 0 ? 2 : 1, timeout);
+    zend_string_release(body);
+    if (head != head_on_stack) {
+        efree(head);
+    }
+
+    if (UNEXPECTED(!ret)) {
+        swow_throw_call_exception_with_last(swow_socket_exception_ce);
+        RETURN_THROWS();
+    }
+
+    RETURN_THIS();
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_recvMany, 0, 0, IS_ARRAY, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, count, IS_LONG, 0, "64")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, size, IS_LONG, 0, "Swow\\Buffer::COMMON_SIZE")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, timeout, IS_LONG, 1, "null")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, recvMany)
+{
+    SWOW_SOCKET_GETTER(s_socket, socket);
+    zend_long count = 64;
+    zend_long size = CAT_BUFFER_COMMON_SIZE;
+    zend_long timeout;
+    zend_bool timeout_is_null = 1;
+    cat_socket_datagram_t *datagrams;
+    char *area;
+    size_t area_size, required_size;
+    ssize_t n, i;
+
+    ZEND_PARSE_PARAMETERS_START(0, 3)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(count)
+        Z_PARAM_LONG(size)
+        Z_PARAM_LONG_OR_NULL(timeout, timeout_is_null)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(count <= 0 || count > UINT16_MAX)) {
+        zend_argument_value_error(1, "must be greater than 0 and less than or equal to %u", UINT16_MAX);
+        RETURN_THROWS();
+    }
+    if (UNEXPECTED(size <= 0)) {
+        zend_argument_value_error(2, "must be greater than 0");
+        RETURN_THROWS();
+    }
+    if (timeout_is_null) {
+        timeout = cat_socket_get_read_timeout(socket);
+    }
+
+    /* datagrams are received into the area of the socket, strings are allocated with their exact length later,
+     * the area is taken during receiving, other coroutines which call us at the same time use their own one */
+    area_size = required_size = zend_safe_address_guarded((size_t) count, (size_t) size, 0);
+    area = s_socket->recv_many_area;
+    if (area == NULL || s_socket->recv_many_area_size < area_size) {
+        if (area != NULL) {
+            efree(area);
+        }
+        area = (char *) emalloc(area_size);
+    } else {
+        area_size = s_socket->recv_many_area_size;
+    }
+    s_socket->recv_many_area = NULL;
+    s_socket->recv_many_area_size = 0;
+    datagrams = (cat_socket_datagram_t *) emalloc(sizeof(*datagrams) * count);
+    for (i = 0; i < count; i++) {
+        datagrams[i].buffer = area + i * size;
+        datagrams[i].size = size;
+    }
+
+    n = cat_socket_recv_many_ex(socket, datagrams, count, timeout);
+
+    /* also for socket exception getReturnValue */
+    array_init_size(return_value, n > 0 ? (uint32_t) n : 0);
+    for (i = 0; i < n; i++) {
+        zval z_datagram, z_tmp;
+        char address[CAT_SOCKADDR_MAX_PATH];
+        size_t address_length = sizeof(address);
+        int port;
+        array_init_size(&z_datagram, 3);
+        ZVAL_STRINGL_FAST(&z_tmp, datagrams[i].buffer, datagrams[i].length);
+        zend_hash_next_index_insert_new(Z_ARRVAL(z_datagram), &z_tmp);
+        if (cat_sockaddr_to_name_silent(
+            &datagrams[i].address.address.common, datagrams[i].address.length,
+            address, &address_length, &port) != 0 || address_length == 0) {
+            ZVAL_EMPTY_STRING(&z_tmp);
+            port = 0;
+        } else {
+            ZVAL_STRINGL(&z_tmp, address, address_length);
+        }
+        zend_hash_next_index_insert_new(Z_ARRVAL(z_datagram), &z_tmp);
+        ZVAL_LONG(&z_tmp, port);
+        zend_hash_next_index_insert_new(Z_ARRVAL(z_datagram), &z_tmp);
+        zend_hash_next_index_insert_new(Z_ARRVAL_P(return_value), &z_datagram);
+    }
+    efree(datagrams);
+    /* do not hold the memory of an unusually large call for the socket's life */
+    if (s_socket->recv_many_area != NULL || required_size > SWOW_SOCKET_RECV_MANY_AREA_MAX_SIZE) {
+        efree(area);
+    } else {
+        if (area_size / 2 > required_size) {
+            area = (char *) erealloc(area, required_size);
+            area_size = required_size;
+        }
+        s_socket->recv_many_area = area;
+        s_socket->recv_many_area_size = area_size;
+    }
+
+    if (UNEXPECTED(n < 0)) {
+        swow_throw_call_exception_with_last(swow_socket_exception_ce);
+        RETURN_THROWS();
+    }
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_sendMany, 0, 1, IS_LONG, 0)
+    ZEND_ARG_TYPE_INFO(0, datagrams, IS_ARRAY, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, timeout, IS_LONG, 1, "null")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, sendMany)
+{
+    SWOW_SOCKET_GETTER(s_socket, socket);
+    HashTable *datagrams_array;
+    zend_long timeout;
+    zend_bool timeout_is_null = 1;
+    cat_socket_datagram_t *datagrams;
+    zend_string **strings;
+    uint32_t count, n = 0;
+    cat_sa_family_t family;
+    zval *z_datagram;
+    ssize_t ret;
+
+    ZEND_PARSE_PARAMETERS_START(1, 2)
+        Z_PARAM_ARRAY_HT(datagrams_array)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG_OR_NULL(timeout, timeout_is_null)
+    ZEND_PARSE_PARAMETERS_END();
+
+    count = zend_hash_num_elements(datagrams_array);
+    if (count == 0) {
+        RETURN_LONG(0);
+    }
+    if (timeout_is_null) {
+        timeout = cat_socket_get_write_timeout(socket);
+    }
+    family = (cat_socket_get_type(socket) & CAT_SOCKET_TYPE_FLAG_LOCAL) ? AF_LOCAL : AF_UNSPEC;
+
+    datagrams = (cat_socket_datagram_t *) emalloc(sizeof(*datagrams) * count);
+    strings = (zend_string **) emalloc(sizeof(*strings) * count);
+    /* [[data, address, port], ...] or [data, ...] (for connected sockets) */
+    ZEND_HASH_FOREACH_VAL(datagrams_array, z_datagram) {
+        cat_socket_datagram_t *datagram = &datagrams[n];
+        zval *z_data, *z_address = NULL, *z_port = NULL;
+        zend_string *data;
+        ZVAL_DEREF(z_datagram);
+        z_data = z_datagram;
+        if (Z_TYPE_P(z_datagram) == IS_ARRAY) {
+            z_data = zend_hash_index_find(Z_ARRVAL_P(z_datagram), 0);
+            z_address = zend_hash_index_find(Z_ARRVAL_P(z_datagram), 1);
+            z_port = zend_hash_index_find(Z_ARRVAL_P(z_datagram), 2);
+            if (UNEXPECTED(z_data == NULL)) {
+                zend_argument_value_error(1, "must be a list of data or [data, address, port]");
+                goto _error;
+            }
+        }
+        data = zval_try_get_string(z_data);
+        if (UNEXPECTED(data == NULL)) {
+            goto _error;
+        }
+        strings[n] = data;
+        datagram->buffer = ZSTR_VAL(data);
+        datagram->length = ZSTR_LEN(data);
+        datagram->address.length = 0;
+        n++;
+        if (z_address != NULL && Z_TYPE_P(z_address) != IS_NULL) {
+            zend_string *address = zval_try_get_string(z_address);
+            zend_long port = z_port != NULL ? zval_get_long(z_port) : 0;
+            cat_bool_t success;
+            if (UNEXPECTED(address == NULL)) {
+                goto _error;
+            }
+            datagram->address.length = sizeof(datagram->address.address);
+            datagram->address.address.common.sa_family = family;
+            success = ZSTR_LEN(address) == 0 || cat_sockaddr_getbyname(
+                &datagram->address.address.common, &datagram->address.length,
+                ZSTR_VAL(address), ZSTR_LEN(address), (int) port
+            );
+            if (ZSTR_LEN(address) == 0) {
+                datagram->address.length = 0;
+            }
+            zend_string_release(address);
+            if (UNEXPECTED(!success)) {
+                swow_throw_exception_with_last(swow_socket_exception_ce);
+                goto _error;
+            }
+        }
+    } ZEND_HASH_FOREACH_END();
+
+    ret = cat_socket_send_many_ex(socket, datagrams, count, timeout);
+
+    /* also for socket exception getReturnValue */
+    RETVAL_LONG(ret > 0 ? ret : 0);
+
+    if (UNEXPECTED(ret != (ssize_t) count)) {
+        swow_throw_call_exception_with_last(swow_socket_exception_ce);
+    }
+
+    if (0) {
+        _error:
+        ZEND_ASSERT_HAS_EXCEPTION();
+    }
+    while (n--) {
+        zend_string_release(strings[n]);
+    }
+    efree(strings);
+    efree(datagrams);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_cork, 0, 0, IS_STATIC, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, threshold, IS_LONG, 0, "0")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, autoFlush, _IS_BOOL, 0, "true")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, cork)
+{
+    SWOW_SOCKET_GETTER(s_socket, socket);
+    zend_long threshold = 0;
+    zend_bool auto_flush = 1;
+    cat_bool_t ret;
+
+    ZEND_PARSE_PARAMETERS_START(0, 2)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(threshold)
+        Z_PARAM_BOOL(auto_flush)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(threshold < 0)) {
+        zend_argument_value_error(1, "can not be negative");
+        RETURN_THROWS();
+    }
+
+    ret = cat_socket_cork(socket, (size_t) threshold, auto_flush);
+
+    if (UNEXPECTED(!ret)) {
+        swow_throw_exception_with_last(swow_socket_exception_ce);
+        RETURN_THROWS();
+    }
+
+    RETURN_THIS();
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_uncork, 0, 0, IS_STATIC, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, timeout, IS_LONG, 1, "null")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, uncork)
+{
+    SWOW_SOCKET_GETTER(s_socket, socket);
+    zend_long timeout;
+    zend_bool timeout_is_null = 1;
+    cat_bool_t ret;
+
+    ZEND_PARSE_PARAMETERS_START(0, 1)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG_OR_NULL(timeout, timeout_is_null)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (timeout_is_null) {
+        timeout = cat_socket_get_write_timeout(socket);
+    }
+
+    ret = cat_socket_uncork_ex(socket, timeout);
+
+    if (UNEXPECTED(!ret)) {
+        swow_throw_exception_with_last(swow_socket_exception_ce);
+        RETURN_THROWS();
+    }
+
+    RETURN_THIS();
+}
+
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_close, 0, 0, _IS_BOOL, 0)
 ZEND_END_ARG_INFO()
 
@@ -1297,6 +1835,10 @@ SWOW_SOCKET_IS_XXX_API_GEN(ServerConnection, server_connection)
 
 SWOW_SOCKET_IS_XXX_API_GEN(Client, client)
 
+#define arginfo_class_Swow_Socket_isCorked arginfo_class_Swow_Socket_close
+
+SWOW_SOCKET_IS_XXX_API_GEN(Corked, corked)
+
 #define arginfo_class_Swow_Socket_getConnectionError arginfo_class_Swow_Socket_getId
 
 static PHP_METHOD(Swow_Socket, getConnectionError)
@@ -1383,6 +1925,49 @@ static PHP_METHOD(Swow_Socket, getSendBufferSize)
     RETURN_LONG(cat_socket_get_send_buffer_size(socket));
 }
 
+#define arginfo_class_Swow_Socket_getTcpZeroCopyThreshold arginfo_class_Swow_Socket_getId
+
+static PHP_METHOD(Swow_Socket, getTcpZeroCopyThreshold)
+{
+    SWOW_SOCKET_GETTER(s_socket, socket);
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG((zend_long) cat_socket_get_tcp_zerocopy_threshold(socket));
+}
+
+#define arginfo_class_Swow_Socket_getInlineReadMode arginfo_class_Swow_Socket_getId
+
+static PHP_METHOD(Swow_Socket, getInlineReadMode)
+{
+    SWOW_SOCKET_GETTER(s_socket, socket);
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG(cat_socket_get_inline_read_mode(socket));
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_getInlineReadStats, 0, 0, IS_ARRAY, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, getInlineReadStats)
+{
+    SWOW_SOCKET_GETTER(s_socket, socket);
+    cat_socket_inline_read_stats_t stats;
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    if (UNEXPECTED(!cat_socket_get_inline_read_stats(socket, &stats))) {
+        swow_throw_exception_with_last(swow_socket_exception_ce);
+        RETURN_THROWS();
+    }
+
+    array_init_size(return_value, 3);
+    add_assoc_long(return_value, "hits", (zend_long) stats.hits);
+    add_assoc_long(return_value, "misses", (zend_long) stats.misses);
+    add_assoc_long(return_value, "skips", (zend_long) stats.skips);
+}
+
 /* setter */
 
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_setRecvBufferSize, 0, 1, IS_STATIC, 0)
@@ -1512,6 +2097,317 @@ static PHP_METHOD(Swow_Socket, setTcpAcceptBalance)
     RETURN_THIS();
 }
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_setTcpZeroCopyThreshold, 0, 1, IS_STATIC, 0)
+    ZEND_ARG_TYPE_INFO(0, threshold, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, setTcpZeroCopyThreshold)
+{
+    SWOW_SOCKET_GETTER(s_socket, socket);
+    zend_long threshold;
+    cat_bool_t ret;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_LONG(threshold)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(threshold < 0)) {
+        zend_argument_value_error(1, "can not be negative");
+        RETURN_THROWS();
+    }
+
+    ret = cat_socket_set_tcp_zerocopy_threshold(socket, (size_t) threshold);
+
+    if (UNEXPECTED(!ret)) {
+        swow_throw_exception_with_last(swow_socket_exception_ce);
+        RETURN_THROWS();
+    }
+
+    RETURN_THIS();
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_setInlineReadMode, 0, 1, IS_STATIC, 0)
+    ZEND_ARG_TYPE_INFO(0, mode, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, setInlineReadMode)
+{
+    SWOW_SOCKET_GETTER(s_socket, socket);
+    zend_long mode;
+    cat_bool_t ret;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_LONG(mode)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(mode < CAT_SOCKET_INLINE_READ_MODE_DEFAULT || mode > CAT_SOCKET_INLINE_READ_MODE_NEVER)) {
+        zend_argument_value_error(1, "must be one of Socket::INLINE_READ_MODE_* constants");
+        RETURN_THROWS();
+    }
+
+    ret = cat_socket_set_inline_read_mode(socket, (cat_socket_inline_read_mode_t) mode);
+
+    if (UNEXPECTED(!ret)) {
+        swow_throw_exception_with_last(swow_socket_exception_ce);
+        RETURN_THROWS();
+    }
+
+    RETURN_THIS();
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_getGlobalInlineReadMode, 0, 1, IS_LONG, 0)
+    ZEND_ARG_TYPE_INFO(0, type, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, getGlobalInlineReadMode)
+{
+    zend_long type;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_LONG(type)
+    ZEND_PARSE_PARAMETERS_END();
+
+    RETURN_LONG(cat_socket_get_global_inline_read_mode((cat_socket_type_t) type));
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_setGlobalInlineReadMode, 0, 1, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO(0, mode, IS_LONG, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, type, IS_LONG, 0, "Swow\\Socket::TYPE_ANY")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, setGlobalInlineReadMode)
+{
+    zend_long mode;
+    zend_long type = CAT_SOCKET_TYPE_ANY;
+    cat_bool_t ret;
+
+    ZEND_PARSE_PARAMETERS_START(1, 2)
+        Z_PARAM_LONG(mode)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(type)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(mode < CAT_SOCKET_INLINE_READ_MODE_DEFAULT || mode > CAT_SOCKET_INLINE_READ_MODE_NEVER)) {
+        zend_argument_value_error(1, "must be one of Socket::INLINE_READ_MODE_* constants");
+        RETURN_THROWS();
+    }
+
+    ret = cat_socket_set_global_inline_read_mode((cat_socket_type_t) type, (cat_socket_inline_read_mode_t) mode);
+
+    if (UNEXPECTED(!ret)) {
+        swow_throw_exception_with_last(swow_socket_exception_ce);
+        RETURN_THROWS();
+    }
+}
+
+#define arginfo_class_Swow_Socket_getGlobalDnsCacheCapacity arginfo_class_Swow_Socket_getGlobalTimeout
+
+static PHP_METHOD(Swow_Socket, getGlobalDnsCacheCapacity)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG((zend_long) cat_dns_cache_get_capacity());
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_setGlobalDnsCacheCapacity, 0, 1, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO(0, capacity, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, setGlobalDnsCacheCapacity)
+{
+    zend_long capacity;
+    cat_bool_t ret;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_LONG(capacity)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(capacity < 0)) {
+        zend_argument_value_error(1, "can not be negative");
+        RETURN_THROWS();
+    }
+
+    ret = cat_dns_cache_set_capacity((size_t) capacity);
+
+    if (UNEXPECTED(!ret)) {
+        swow_throw_exception_with_last(swow_socket_exception_ce);
+        RETURN_THROWS();
+    }
+}
+
+#define SWOW_SOCKET_DNS_CACHE_TTL_API_GEN(Name, name) \
+static PHP_METHOD(Swow_Socket, getGlobalDnsCache##Name) \
+{ \
+    ZEND_PARSE_PARAMETERS_NONE(); \
+    \
+    RETURN_LONG((zend_long) cat_dns_cache_get_##name()); \
+} \
+\
+static PHP_METHOD(Swow_Socket, setGlobalDnsCache##Name) \
+{ \
+    zend_long ttl; \
+    \
+    ZEND_PARSE_PARAMETERS_START(1, 1) \
+        Z_PARAM_LONG(ttl) \
+    ZEND_PARSE_PARAMETERS_END(); \
+    \
+    if (UNEXPECTED(ttl < 0)) { \
+        zend_argument_value_error(1, "can not be negative"); \
+        RETURN_THROWS(); \
+    } \
+    \
+    cat_dns_cache_set_##name((cat_msec_t) ttl); \
+}
+
+#define arginfo_class_Swow_Socket_getGlobalDnsCacheTtl arginfo_class_Swow_Socket_getGlobalTimeout
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_setGlobalDnsCacheTtl, 0, 1, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO(0, ttl, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+#define arginfo_class_Swow_Socket_getGlobalDnsCacheNegativeTtl arginfo_class_Swow_Socket_getGlobalTimeout
+
+#define arginfo_class_Swow_Socket_setGlobalDnsCacheNegativeTtl arginfo_class_Swow_Socket_setGlobalDnsCacheTtl
+
+SWOW_SOCKET_DNS_CACHE_TTL_API_GEN(Ttl, ttl)
+SWOW_SOCKET_DNS_CACHE_TTL_API_GEN(NegativeTtl, negative_ttl)
+
+#undef SWOW_SOCKET_DNS_CACHE_TTL_API_GEN
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_getGlobalDnsCacheStats, 0, 0, IS_ARRAY, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, getGlobalDnsCacheStats)
+{
+    cat_dns_cache_stats_t stats;
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    cat_dns_cache_get_stats(&stats);
+
+    array_init(return_value);
+    add_assoc_long(return_value, "hits", (zend_long) stats.hits);
+    add_assoc_long(return_value, "misses", (zend_long) stats.misses);
+    add_assoc_long(return_value, "coalesced", (zend_long) stats.coalesced);
+    add_assoc_long(return_value, "count", (zend_long) stats.count);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_flushGlobalDnsCache, 0, 0, IS_VOID, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, flushGlobalDnsCache)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    cat_dns_cache_flush();
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_isGlobalDnsResolverEnabled, 0, 0, _IS_BOOL, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, isGlobalDnsResolverEnabled)
+{
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_BOOL(cat_dns_resolver_is_enabled());
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_setGlobalDnsResolverEnabled, 0, 1, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO(0, enabled, _IS_BOOL, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, setGlobalDnsResolverEnabled)
+{
+    zend_bool enabled;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_BOOL(enabled)
+    ZEND_PARSE_PARAMETERS_END();
+
+    cat_dns_resolver_set_enabled(enabled);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_getGlobalDnsServers, 0, 0, IS_STRING, 1)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, getGlobalDnsServers)
+{
+    const char *servers;
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    servers = cat_dns_resolver_get_servers();
+
+    if (servers == NULL) {
+        RETURN_NULL();
+    }
+    RETURN_STRING(servers);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_setGlobalDnsServers, 0, 1, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO(0, servers, IS_STRING, 1)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, setGlobalDnsServers)
+{
+    zend_string *servers;
+    cat_bool_t ret;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_STR_OR_NULL(servers)
+    ZEND_PARSE_PARAMETERS_END();
+
+    ret = cat_dns_resolver_set_servers(servers != NULL ? ZSTR_VAL(servers) : NULL);
+
+    if (UNEXPECTED(!ret)) {
+        swow_throw_exception_with_last(swow_socket_exception_ce);
+        RETURN_THROWS();
+    }
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket_resolveSrv, 0, 1, IS_ARRAY, 0)
+    ZEND_ARG_TYPE_INFO(0, name, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, timeout, IS_LONG, 1, "null")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Socket, resolveSrv)
+{
+    zend_string *name;
+    zend_long timeout;
+    zend_bool timeout_is_null = 1;
+    cat_dns_srv_t *records, *record;
+
+    ZEND_PARSE_PARAMETERS_START(1, 2)
+        Z_PARAM_STR(name)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG_OR_NULL(timeout, timeout_is_null)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (timeout_is_null) {
+        timeout = cat_socket_get_global_dns_timeout();
+    }
+
+    records = cat_dns_query_srv_ex(ZSTR_VAL(name), timeout);
+
+    if (UNEXPECTED(records == NULL)) {
+        swow_throw_exception_with_last(swow_socket_exception_ce);
+        RETURN_THROWS();
+    }
+
+    array_init(return_value);
+    for (record = records; record != NULL; record = record->next) {
+        zval z_record;
+        array_init(&z_record);
+        add_assoc_string(&z_record, "target", record->target);
+        add_assoc_long(&z_record, "port", record->port);
+        add_assoc_long(&z_record, "priority", record->priority);
+        add_assoc_long(&z_record, "weight", record->weight);
+        add_assoc_long(&z_record, "ttl", (zend_long) record->ttl);
+        add_next_index_zval(return_value, &z_record);
+    }
+    cat_dns_free_srv(records);
+}
+
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Socket___debugInfo, 0, 0, IS_ARRAY, 0)
 ZEND_END_ARG_INFO()
 
@@ -1593,6 +2489,8 @@ static const zend_function_entry swow_socket_methods[] = {
     PHP_ME(Swow_Socket, listen,                    arginfo_class_Swow_Socket_listen,              ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, accept,                    arginfo_class_Swow_Socket_accept,              ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, acceptTo,                  arginfo_class_Swow_Socket_acceptTo,            ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Socket, acceptMany,                arginfo_class_Swow_Socket_acceptMany,          ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Socket, getAcceptStats,            arginfo_class_Swow_Socket_getAcceptStats,      ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, connect,                   arginfo_class_Swow_Socket_connect,             ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, enableCrypto,              arginfo_class_Swow_Socket_enableCrypto,        ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, getSockAddress,            arginfo_class_Swow_Socket_getAddress,          ZEND_ACC_PUBLIC)
@@ -1618,6 +2516,12 @@ static const zend_function_entry swow_socket_methods[] = {
     PHP_ME(Swow_Socket, send,                      arginfo_class_Swow_Socket_send,                ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, sendTo,                    arginfo_class_Swow_Socket_sendTo,              ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, sendHandle,                arginfo_class_Swow_Socket_sendHandle,          ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Socket, sendFile,                  arginfo_class_Swow_Socket_sendFile,            ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Socket, sendResponse,              arginfo_class_Swow_Socket_sendResponse,        ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Socket, recvMany,                  arginfo_class_Swow_Socket_recvMany,            ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Socket, sendMany,                  arginfo_class_Swow_Socket_sendMany,            ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Socket, cork,                      arginfo_class_Swow_Socket_cork,                ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Socket, uncork,                    arginfo_class_Swow_Socket_uncork,              ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, close,                     arginfo_class_Swow_Socket_close,               ZEND_ACC_PUBLIC)
     /* status */
     PHP_ME(Swow_Socket, isAvailable,               arginfo_class_Swow_Socket_isAvailable,         ZEND_ACC_PUBLIC)
@@ -1626,6 +2530,7 @@ static const zend_function_entry swow_socket_methods[] = {
     PHP_ME(Swow_Socket, isServer,                  arginfo_class_Swow_Socket_isServer,            ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, isServerConnection,        arginfo_class_Swow_Socket_isServerConnection,  ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, isClient,                  arginfo_class_Swow_Socket_isClient,            ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Socket, isCorked,                  arginfo_class_Swow_Socket_isCorked,            ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, getConnectionError,        arginfo_class_Swow_Socket_getConnectionError,  ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, checkLiveness,             arginfo_class_Swow_Socket_checkLiveness,       ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, getIoState,                arginfo_class_Swow_Socket_getIoState,          ZEND_ACC_PUBLIC)
@@ -1633,12 +2538,17 @@ static const zend_function_entry swow_socket_methods[] = {
     PHP_ME(Swow_Socket, getIoStateNaming,          arginfo_class_Swow_Socket_getIoStateNaming,    ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, getRecvBufferSize,         arginfo_class_Swow_Socket_getRecvBufferSize,   ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, getSendBufferSize,         arginfo_class_Swow_Socket_getSendBufferSize,   ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Socket, getTcpZeroCopyThreshold,   arginfo_class_Swow_Socket_getTcpZeroCopyThreshold, ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Socket, getInlineReadMode,         arginfo_class_Swow_Socket_getInlineReadMode,   ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Socket, getInlineReadStats,        arginfo_class_Swow_Socket_getInlineReadStats,  ZEND_ACC_PUBLIC)
     /* setter */
     PHP_ME(Swow_Socket, setRecvBufferSize,         arginfo_class_Swow_Socket_setRecvBufferSize,   ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, setSendBufferSize,         arginfo_class_Swow_Socket_setSendBufferSize,   ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, setTcpNodelay,             arginfo_class_Swow_Socket_setTcpNodelay,       ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, setTcpKeepAlive,           arginfo_class_Swow_Socket_setTcpKeepAlive,     ZEND_ACC_PUBLIC)
     PHP_ME(Swow_Socket, setTcpAcceptBalance,       arginfo_class_Swow_Socket_setTcpAcceptBalance, ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Socket, setTcpZeroCopyThreshold,   arginfo_class_Swow_Socket_setTcpZeroCopyThreshold, ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Socket, setInlineReadMode,         arginfo_class_Swow_Socket_setInlineReadMode,   ZEND_ACC_PUBLIC)
     /* magic */
     PHP_ME(Swow_Socket, __debugInfo,               arginfo_class_Swow_Socket___debugInfo,         ZEND_ACC_PUBLIC)
     /* globals */
@@ -1657,6 +2567,21 @@ static const zend_function_entry swow_socket_methods[] = {
     PHP_ME(Swow_Socket, setGlobalHandshakeTimeout, arginfo_class_Swow_Socket_setGlobalTimeout,    ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Swow_Socket, setGlobalReadTimeout,      arginfo_class_Swow_Socket_setGlobalTimeout,    ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_ME(Swow_Socket, setGlobalWriteTimeout,     arginfo_class_Swow_Socket_setGlobalTimeout,    ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, getGlobalInlineReadMode,   arginfo_class_Swow_Socket_getGlobalInlineReadMode, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, setGlobalInlineReadMode,   arginfo_class_Swow_Socket_setGlobalInlineReadMode, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, getGlobalDnsCacheCapacity, arginfo_class_Swow_Socket_getGlobalDnsCacheCapacity, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, setGlobalDnsCacheCapacity, arginfo_class_Swow_Socket_setGlobalDnsCacheCapacity, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, getGlobalDnsCacheTtl,      arginfo_class_Swow_Socket_getGlobalDnsCacheTtl, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, setGlobalDnsCacheTtl,      arginfo_class_Swow_Socket_setGlobalDnsCacheTtl, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, getGlobalDnsCacheNegativeTtl, arginfo_class_Swow_Socket_getGlobalDnsCacheNegativeTtl, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, setGlobalDnsCacheNegativeTtl, arginfo_class_Swow_Socket_setGlobalDnsCacheNegativeTtl, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, getGlobalDnsCacheStats,    arginfo_class_Swow_Socket_getGlobalDnsCacheStats, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, flushGlobalDnsCache,       arginfo_class_Swow_Socket_flushGlobalDnsCache, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, isGlobalDnsResolverEnabled, arginfo_class_Swow_Socket_isGlobalDnsResolverEnabled, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, setGlobalDnsResolverEnabled, arginfo_class_Swow_Socket_setGlobalDnsResolverEnabled, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, getGlobalDnsServers,       arginfo_class_Swow_Socket_getGlobalDnsServers, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, setGlobalDnsServers,       arginfo_class_Swow_Socket_setGlobalDnsServers, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+    PHP_ME(Swow_Socket, resolveSrv,                arginfo_class_Swow_Socket_resolveSrv,          ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
     PHP_FE_END
 };
 
@@ -1693,6 +2618,10 @@ zend_result swow_socket_module_init(INIT_FUNC_ARGS)
     zend_declare_class_constant_long(swow_socket_ce, ZEND_STRL("BIND_FLAG_" #name), (value));
     CAT_SOCKET_BIND_FLAG_MAP(SWOW_SOCKET_BIND_FLAG_GEN)
 #undef SWOW_SOCKET_BIND_FLAG_GEN
+#define SWOW_SOCKET_INLINE_READ_MODE_GEN(name, value) \
+    zend_declare_class_constant_long(swow_socket_ce, ZEND_STRL("INLINE_READ_MODE_" #name), (value));
+    CAT_SOCKET_INLINE_READ_MODE_MAP(SWOW_SOCKET_INLINE_READ_MODE_GEN)
+#undef SWOW_SOCKET_INLINE_READ_MODE_GEN
 
     swow_socket_exception_ce = swow_register_internal_class(
         "Swow\\SocketException", swow_call_exception_ce, NULL, NULL, NULL, cat_true, cat_true, NULL, NULL, 0
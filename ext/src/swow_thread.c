@@ -17,18 +17,666 @@
  */
 
 #include "swow_thread.h"
+#include "swow_channel.h"
 
-SWOW_API zend_class_entry *swow_thread_wait_reference_ce;
-SWOW_API zend_object_handlers swow_thread_wait_reference_handlers;
-
+SWOW_API zend_class_entry *swow_thread_ce;
+SWOW_API zend_object_handlers swow_thread_handlers;
 SWOW_API zend_class_entry *swow_thread_exception_ce;
 
-SWOW_API CAT_GLOBALS_DECLARE(swow_thread)
+SWOW_API zend_class_entry *swow_thread_channel_ce;
+SWOW_API zend_object_handlers swow_thread_channel_handlers;
+
+#ifdef ZTS
+
+#include "cat_time.h"
+
+#include "SAPI.h"
+#include "php_main.h"
+
+static cat_atomic_uint32_t swow_thread_last_id;
+
+/* serialized data are shared between threads, so they must be persistent */
+
+static SWOW_MAY_THROW zend_string *swow_thread_serialize(zval *z_data)
+{
+    php_serialize_data_t var_hash;
+    smart_str buffer = { 0 };
+    zend_string *data = NULL;
+
+    PHP_VAR_SERIALIZE_INIT(var_hash);
+    php_var_serialize(&buffer, z_data, &var_hash);
+    PHP_VAR_SERIALIZE_DESTROY(var_hash);
+
+    if (EXPECTED(!EG(exception) && buffer.s != NULL)) {
+        data = zend_string_init(ZSTR_VAL(buffer.s), ZSTR_LEN(buffer.s), 1);
+    }
+    smart_str_free(&buffer);
+
+    return data;
+}
+
+static SWOW_MAY_THROW bool swow_thread_unserialize(zval *z_data, const zend_string *data)
+{
+    php_unserialize_data_t var_hash;
+    const unsigned char *p = (const unsigned char *) ZSTR_VAL(data);
+    zval *z_tmp;
+    bool ret;
+
+    PHP_VAR_UNSERIALIZE_INIT(var_hash);
+    z_tmp = var_tmp_var(&var_hash);
+    ret = php_var_unserialize(z_tmp, &p, p + ZSTR_LEN(data), &var_hash);
+    if (EXPECTED(ret)) {
+        ZVAL_COPY(z_data, z_tmp);
+    } else if (!EG(exception)) {
+        zend_throw_error(NULL, "Unserialization of thread data failed at offset " ZEND_LONG_FMT " of %zu bytes",
+            (zend_long) ((char *) p - ZSTR_VAL(data)), ZSTR_LEN(data));
+    }
+    PHP_VAR_UNSERIALIZE_DESTROY(var_hash);
+
+    return ret;
+}
+
+/* thread context */
+
+static void swow_thread_context_release(swow_thread_context_t *context)
+{
+    if (--context->refcount != 0) {
+        return;
+    }
+    if (context->payload != NULL) {
+        zend_string_release_ex(context->payload, 1);
+    }
+    if (context->result != NULL) {
+        zend_string_release_ex(context->result, 1);
+    }
+    efree(context);
+}
+
+static void swow_thread_async_cleanup(cat_async_t *async)
+{
+    swow_thread_context_t *context = cat_container_of(async, swow_thread_context_t, async);
+
+    /* the thread notified us as the last thing it did, so it is exiting */
+    (void) uv_thread_join(&context->tid);
+    context->done = cat_true;
+    if (context->joiner != NULL) {
+        cat_coroutine_schedule(context->joiner, THREAD, "Thread join");
+    }
+    swow_thread_context_release(context);
+}
+
+static void swow_thread_async_release(cat_async_t *async)
+{
+    swow_thread_context_release(cat_container_of(async, swow_thread_context_t, async));
+}
+
+/* it runs in the new thread (request) */
+static void swow_thread_execute(swow_thread_context_t *context)
+{
+    zend_fcall_info fci;
+    zval z_payload, *z_closure, *z_arguments, z_retval;
+
+    if (UNEXPECTED(!swow_thread_unserialize(&z_payload, context->payload))) {
+        goto _error;
+    }
+    z_closure = zend_hash_index_find(Z_ARRVAL(z_payload), 0);
+    z_arguments = zend_hash_index_find(Z_ARRVAL(z_payload), 1);
+    ZEND_ASSERT(z_closure != NULL && Z_TYPE_P(z_closure) == IS_OBJECT);
+    ZEND_ASSERT(z_arguments != NULL && Z_TYPE_P(z_arguments) == IS_ARRAY);
+
+    fci.size = sizeof(fci);
+    ZVAL_COPY_VALUE(&fci.function_name, z_closure);
+    fci.object = NULL;
+    fci.retval = &z_retval;
+    fci.params = NULL;
+    fci.param_count = 0;
+    fci.named_params = NULL;
+    (void) zend_fcall_info_args(&fci, z_arguments);
+    (void) zend_call_function(&fci, NULL);
+    zend_fcall_info_args_clear(&fci, 1);
+    zval_ptr_dtor(&z_payload);
+    if (UNEXPECTED(EG(exception))) {
+        goto _error;
+    }
+
+    context->result = swow_thread_serialize(&z_retval);
+    zval_ptr_dtor(&z_retval);
+    if (EXPECTED(context->result != NULL)) {
+        return;
+    }
+
+    _error:
+    if (EG(exception)) {
+        /* same as uncaught exceptions in main script, it bails out */
+        zend_exception_error(EG(exception), E_ERROR);
+    }
+}
+
+static void swow_thread_routine(void *arg)
+{
+    swow_thread_context_t *context = (swow_thread_context_t *) arg;
+
+    (void) ts_resource(0);
+#ifdef COMPILE_DL_SWOW
+    ZEND_TSRMLS_CACHE_UPDATE();
+#endif
+
+    PG(expose_php) = 0;
+    PG(auto_globals_jit) = 1;
+    if (UNEXPECTED(php_request_startup() != SUCCESS)) {
+        context->exit_status = 255;
+    } else {
+        PG(during_request_startup) = 0;
+        SG(sapi_started) = 0;
+        SG(headers_sent) = 1;
+        SG(request_info).no_headers = 1;
+        zend_first_try {
+            swow_thread_execute(context);
+        } zend_end_try();
+        context->exit_status = EG(exit_status);
+        php_request_shutdown(NULL);
+    }
+    ts_free_thread();
+
+    /* it must be the last one, context may be released by the parent at any time after it */
+    (void) cat_async_notify(&context->async);
+}
+
+/* thread object */
+
+static zend_object *swow_thread_create_object(zend_class_entry *ce)
+{
+    swow_thread_t *s_thread = swow_object_alloc(swow_thread_t, ce, swow_thread_handlers);
+
+    s_thread->context = NULL;
+
+    return &s_thread->std;
+}
+
+static void swow_thread_free_object(zend_object *object)
+{
+    swow_thread_t *s_thread = swow_thread_get_from_object(object);
+
+    /* thread keeps running if it was not joined,
+     * event loop will not exit until it is done */
+    if (s_thread->context != NULL) {
+        swow_thread_context_release(s_thread->context);
+    }
+
+    zend_object_std_dtor(&s_thread->std);
+}
+
+#define SWOW_THREAD_GETTER_CONSTRUCTED(context) \
+    swow_thread_context_t *context = swow_thread_get_from_object(Z_OBJ_P(ZEND_THIS))->context; \
+    if (UNEXPECTED(context == NULL)) { \
+        zend_throw_error(NULL, "%s must construct first", ZEND_THIS_NAME); \
+        RETURN_THROWS(); \
+    }
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_class_Swow_Thread___construct, 0, 0, 1)
+    ZEND_ARG_OBJ_INFO(0, closure, Closure, 0)
+    ZEND_ARG_VARIADIC_TYPE_INFO(0, args, IS_MIXED, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Thread, __construct)
+{
+    swow_thread_t *s_thread = swow_thread_get_from_object(Z_OBJ_P(ZEND_THIS));
+    swow_thread_context_t *context;
+    zval *z_closure, *z_args = NULL, z_payload, z_arguments;
+    uint32_t argc = 0, i;
+    zend_string *payload;
+    int error;
+
+    if (UNEXPECTED(s_thread->context != NULL)) {
+        zend_throw_error(NULL, "%s can be constructed only once", ZEND_THIS_NAME);
+        RETURN_THROWS();
+    }
+
+    ZEND_PARSE_PARAMETERS_START(1, -1)
+        Z_PARAM_OBJECT_OF_CLASS(z_closure, zend_ce_closure)
+        Z_PARAM_VARIADIC('*', z_args, argc)
+    ZEND_PARSE_PARAMETERS_END();
+
+    /* closure and arguments are passed to the thread by serialization */
+    array_init_size(&z_arguments, argc);
+    for (i = 0; i < argc; i++) {
+        Z_TRY_ADDREF(z_args[i]);
+        add_next_index_zval(&z_arguments, &z_args[i]);
+    }
+    array_init_size(&z_payload, 2);
+    Z_ADDREF_P(z_closure);
+    add_next_index_zval(&z_payload, z_closure);
+    add_next_index_zval(&z_payload, &z_arguments);
+    payload = swow_thread_serialize(&z_payload);
+    zval_ptr_dtor(&z_payload);
+    if (UNEXPECTED(payload == NULL)) {
+        RETURN_THROWS();
+    }
+
+    context = (swow_thread_context_t *) emalloc(sizeof(*context));
+    context->refcount = 1;
+    context->id = cat_atomic_uint32_fetch_add(&swow_thread_last_id, 1) + 1;
+    context->joiner = NULL;
+    context->done = cat_false;
+    context->payload = payload;
+    context->result = NULL;
+    context->exit_status = 0;
+    if (UNEXPECTED(cat_async_create(&context->async) == NULL)) {
+        swow_thread_context_release(context);
+        swow_throw_exception_with_last(swow_thread_exception_ce);
+        RETURN_THROWS();
+    }
+    /* async handle holds a ref until it is closed */
+    context->refcount++;
+    error = uv_thread_create(&context->tid, swow_thread_routine, context);
+    if (UNEXPECTED(error != 0)) {
+        cat_update_last_error_with_reason(error, "Thread create failed");
+        (void) cat_async_close(&context->async, swow_thread_async_release);
+        swow_thread_context_release(context);
+        swow_throw_exception_with_last(swow_thread_exception_ce);
+        RETURN_THROWS();
+    }
+    /* it will be closed after the thread notified us */
+    (void) cat_async_cleanup(&context->async, swow_thread_async_cleanup);
+
+    s_thread->context = context;
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Thread_getId, 0, 0, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Thread, getId)
+{
+    SWOW_THREAD_GETTER_CONSTRUCTED(context);
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG(context->id);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Thread_isRunning, 0, 0, _IS_BOOL, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Thread, isRunning)
+{
+    SWOW_THREAD_GETTER_CONSTRUCTED(context);
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_BOOL(!context->done);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Thread_join, 0, 0, IS_MIXED, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Thread, join)
+{
+    SWOW_THREAD_GETTER_CONSTRUCTED(context);
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    if (!context->done) {
+        cat_bool_t ret;
+        if (UNEXPECTED(context->joiner != NULL)) {
+            zend_throw_error(NULL, "Thread is being joined by another coroutine");
+            RETURN_THROWS();
+        }
+        context->joiner = CAT_COROUTINE_G(current);
+        ret = cat_time_wait(-1);
+        context->joiner = NULL;
+        if (UNEXPECTED(!ret)) {
+            swow_throw_exception_with_last(swow_thread_exception_ce);
+            RETURN_THROWS();
+        }
+        if (UNEXPECTED(!context->done)) {
+            cat_update_last_error(CAT_ECANCELED, "Thread join has been canceled");
+            swow_throw_exception_with_last(swow_thread_exception_ce);
+            RETURN_THROWS();
+        }
+    }
+    if (UNEXPECTED(context->result == NULL)) {
+        zend_throw_exception_ex(swow_thread_exception_ce, context->exit_status,
+            "Thread exited abnormally with status %d", context->exit_status);
+        RETURN_THROWS();
+    }
+    if (UNEXPECTED(!swow_thread_unserialize(return_value, context->result))) {
+        RETURN_THROWS();
+    }
+}
+
+static const zend_function_entry swow_thread_methods[] = {
+    PHP_ME(Swow_Thread, __construct, arginfo_class_Swow_Thread___construct, ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Thread, getId,       arginfo_class_Swow_Thread_getId,       ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Thread, isRunning,   arginfo_class_Swow_Thread_isRunning,   ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Thread, join,        arginfo_class_Swow_Thread_join,        ZEND_ACC_PUBLIC)
+    PHP_FE_END
+};
+
+/* thread channel */
+
+/* serialized channels are kept here until they are unserialized,
+ * it is shared between threads, so it is protected by a mutex */
+static uv_mutex_t swow_thread_channel_registry_mutex;
+static HashTable swow_thread_channel_registry;
+static zend_ulong swow_thread_channel_registry_last_ticket;
+
+static void swow_thread_channel_data_dtor(const cat_data_t *data)
+{
+    zend_string_release_ex(*(zend_string **) data, 1);
+}
+
+static zend_object *swow_thread_channel_create_object(zend_class_entry *ce)
+{
+    swow_thread_channel_t *s_channel = swow_object_alloc(swow_thread_channel_t, ce, swow_thread_channel_handlers);
 
-CAT_GLOBALS_CTOR_DECLARE_SZ(swow_thread)
+    s_channel->channel = NULL;
+
+    return &s_channel->std;
+}
+
+static void swow_thread_channel_free_object(zend_object *object)
+{
+    swow_thread_channel_t *s_channel = swow_thread_channel_get_from_object(object);
+
+    if (s_channel->channel != NULL) {
+        cat_thread_channel_release(s_channel->channel);
+    }
+
+    zend_object_std_dtor(&s_channel->std);
+}
+
+#define SWOW_THREAD_CHANNEL_GETTER_CONSTRUCTED(channel) \
+    cat_thread_channel_t *channel = swow_thread_channel_get_from_object(Z_OBJ_P(ZEND_THIS))->channel; \
+    if (UNEXPECTED(channel == NULL)) { \
+        zend_throw_error(NULL, "%s must construct first", ZEND_THIS_NAME); \
+        RETURN_THROWS(); \
+    }
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_class_Swow_Thread_Channel___construct, 0, 0, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, capacity, IS_LONG, 0, "1")
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, flags, IS_LONG, 0, "Swow\\Thread\\Channel::FLAG_NONE")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Thread_Channel, __construct)
+{
+    swow_thread_channel_t *s_channel = swow_thread_channel_get_from_object(Z_OBJ_P(ZEND_THIS));
+    zend_long capacity = 1;
+    zend_long flags = CAT_THREAD_CHANNEL_FLAG_NONE;
+
+    if (UNEXPECTED(s_channel->channel != NULL)) {
+        zend_throw_error(NULL, "%s can be constructed only once", ZEND_THIS_NAME);
+        RETURN_THROWS();
+    }
+
+    ZEND_PARSE_PARAMETERS_START(0, 2)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(capacity)
+        Z_PARAM_LONG(flags)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(capacity <= 0)) {
+        zend_argument_value_error(1, "must be greater than 0");
+        RETURN_THROWS();
+    }
+    if (UNEXPECTED((zend_ulong) capacity > CAT_CHANNEL_SIZE_MAX)) {
+        zend_argument_value_error(1, "must be less than or equal to %u", CAT_CHANNEL_SIZE_MAX);
+        RETURN_THROWS();
+    }
+    if (UNEXPECTED((flags & ~CAT_THREAD_CHANNEL_FLAG_SINGLE_CONSUMER) != 0)) {
+        zend_argument_value_error(2, "is unknown");
+        RETURN_THROWS();
+    }
+
+    s_channel->channel = cat_thread_channel_create_ex(capacity, sizeof(zend_string *), swow_thread_channel_data_dtor, (cat_thread_channel_flags_t) flags);
+
+    if (UNEXPECTED(s_channel->channel == NULL)) {
+        swow_throw_exception_with_last(swow_channel_exception_ce);
+        RETURN_THROWS();
+    }
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Thread_Channel_push, 0, 1, IS_STATIC, 0)
+    ZEND_ARG_TYPE_INFO(0, value, IS_MIXED, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, timeout, IS_LONG, 0, "-1")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Thread_Channel, push)
+{
+    SWOW_THREAD_CHANNEL_GETTER_CONSTRUCTED(channel);
+    zval *z_data;
+    zend_long timeout = -1;
+    zend_string *data;
+    cat_bool_t ret;
+
+    ZEND_PARSE_PARAMETERS_START(1, 2)
+        Z_PARAM_ZVAL(z_data)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(timeout)
+    ZEND_PARSE_PARAMETERS_END();
+
+    data = swow_thread_serialize(z_data);
+    if (UNEXPECTED(data == NULL)) {
+        RETURN_THROWS();
+    }
+
+    ret = cat_thread_channel_push(channel, &data, timeout);
+
+    if (UNEXPECTED(!ret)) {
+        zend_string_release_ex(data, 1);
+        swow_throw_exception_with_last(swow_channel_exception_ce);
+        RETURN_THROWS();
+    }
+
+    RETURN_THIS();
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Thread_Channel_pop, 0, 0, IS_MIXED, 0)
+    ZEND_ARG_TYPE_INFO_WITH_DEFAULT_VALUE(0, timeout, IS_LONG, 0, "-1")
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Thread_Channel, pop)
+{
+    SWOW_THREAD_CHANNEL_GETTER_CONSTRUCTED(channel);
+    zend_long timeout = -1;
+    zend_string *data;
+    cat_bool_t ret;
+
+    ZEND_PARSE_PARAMETERS_START(0, 1)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(timeout)
+    ZEND_PARSE_PARAMETERS_END();
+
+    ret = cat_thread_channel_pop(channel, &data, timeout);
+
+    if (UNEXPECTED(!ret)) {
+        swow_throw_exception_with_last(swow_channel_exception_ce);
+        RETURN_THROWS();
+    }
+
+    ret = swow_thread_unserialize(return_value, data);
+    zend_string_release_ex(data, 1);
+    if (UNEXPECTED(!ret)) {
+        RETURN_THROWS();
+    }
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Thread_Channel_close, 0, 0, IS_STATIC, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Thread_Channel, close)
+{
+    SWOW_THREAD_CHANNEL_GETTER_CONSTRUCTED(channel);
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    if (UNEXPECTED(!cat_thread_channel_close(channel))) {
+        swow_throw_exception_with_last(swow_channel_exception_ce);
+        RETURN_THROWS();
+    }
+
+    RETURN_THIS();
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Thread_Channel_getCapacity, 0, 0, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Thread_Channel, getCapacity)
+{
+    SWOW_THREAD_CHANNEL_GETTER_CONSTRUCTED(channel);
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG(cat_thread_channel_get_capacity(channel));
+}
+
+#define arginfo_class_Swow_Thread_Channel_getLength arginfo_class_Swow_Thread_Channel_getCapacity
+
+static PHP_METHOD(Swow_Thread_Channel, getLength)
+{
+    SWOW_THREAD_CHANNEL_GETTER_CONSTRUCTED(channel);
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_LONG(cat_thread_channel_get_length(channel));
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Thread_Channel_isAvailable, 0, 0, _IS_BOOL, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Thread_Channel, isAvailable)
+{
+    SWOW_THREAD_CHANNEL_GETTER_CONSTRUCTED(channel);
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    RETURN_BOOL(cat_thread_channel_is_available(channel));
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Thread_Channel___serialize, 0, 0, IS_ARRAY, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Thread_Channel, __serialize)
+{
+    SWOW_THREAD_CHANNEL_GETTER_CONSTRUCTED(channel);
+    zend_ulong ticket;
+
+    ZEND_PARSE_PARAMETERS_NONE();
+
+    /* the ref is owned by the registry until the ticket is consumed */
+    uv_mutex_lock(&swow_thread_channel_registry_mutex);
+    ticket = ++swow_thread_channel_registry_last_ticket;
+    zend_hash_index_add_new_ptr(&swow_thread_channel_registry, ticket, cat_thread_channel_add_ref(channel));
+    uv_mutex_unlock(&swow_thread_channel_registry_mutex);
+
+    array_init_size(return_value, 1);
+    add_next_index_long(return_value, (zend_long) ticket);
+}
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_class_Swow_Thread_Channel___unserialize, 0, 1, IS_VOID, 0)
+    ZEND_ARG_TYPE_INFO(0, data, IS_ARRAY, 0)
+ZEND_END_ARG_INFO()
+
+static PHP_METHOD(Swow_Thread_Channel, __unserialize)
+{
+    swow_thread_channel_t *s_channel = swow_thread_channel_get_from_object(Z_OBJ_P(ZEND_THIS));
+    HashTable *data;
+    zval *z_ticket;
+    cat_thread_channel_t *channel = NULL;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_ARRAY_HT(data)
+    ZEND_PARSE_PARAMETERS_END();
+
+    if (UNEXPECTED(s_channel->channel != NULL)) {
+        zend_throw_error(NULL, "%s can be constructed only once", ZEND_THIS_NAME);
+        RETURN_THROWS();
+    }
+    z_ticket = zend_hash_index_find(data, 0);
+    if (UNEXPECTED(z_ticket == NULL || Z_TYPE_P(z_ticket) != IS_LONG)) {
+        zend_throw_error(NULL, "Invalid serialization data for %s object", ZEND_THIS_NAME);
+        RETURN_THROWS();
+    }
+
+    uv_mutex_lock(&swow_thread_channel_registry_mutex);
+    channel = (cat_thread_channel_t *) zend_hash_index_find_ptr(&swow_thread_channel_registry, Z_LVAL_P(z_ticket));
+    if (channel != NULL) {
+        zend_hash_index_del(&swow_thread_channel_registry, Z_LVAL_P(z_ticket));
+    }
+    uv_mutex_unlock(&swow_thread_channel_registry_mutex);
+
+    if (UNEXPECTED(channel == NULL)) {
+        zend_throw_error(NULL, "%s can be unserialized only once", ZEND_THIS_NAME);
+        RETURN_THROWS();
+    }
+
+    s_channel->channel = channel;
+}
+
+static const zend_function_entry swow_thread_channel_methods[] = {
+    PHP_ME(Swow_Thread_Channel, __construct,   arginfo_class_Swow_Thread_Channel___construct,   ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Thread_Channel, push,          arginfo_class_Swow_Thread_Channel_push,          ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Thread_Channel, pop,           arginfo_class_Swow_Thread_Channel_pop,           ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Thread_Channel, close,         arginfo_class_Swow_Thread_Channel_close,         ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Thread_Channel, getCapacity,   arginfo_class_Swow_Thread_Channel_getCapacity,   ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Thread_Channel, getLength,     arginfo_class_Swow_Thread_Channel_getLength,     ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Thread_Channel, isAvailable,   arginfo_class_Swow_Thread_Channel_isAvailable,   ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Thread_Channel, __serialize,   arginfo_class_Swow_Thread_Channel___serialize,   ZEND_ACC_PUBLIC)
+    PHP_ME(Swow_Thread_Channel, __unserialize, arginfo_class_Swow_Thread_Channel___unserialize, ZEND_ACC_PUBLIC)
+    PHP_FE_END
+};
+#endif /* ZTS */
 
 zend_result swow_thread_module_init(INIT_FUNC_ARGS)
 {
-    
+#ifdef ZTS
+    cat_atomic_uint32_init(&swow_thread_last_id, 0);
+
+    swow_thread_ce = swow_register_internal_class(
+        "Swow\\Thread", NULL, swow_thread_methods,
+        &swow_thread_handlers, NULL,
+        cat_false, cat_false,
+        swow_thread_create_object,
+        swow_thread_free_object,
+        XtOffsetOf(swow_thread_t, std)
+    );
+
+    swow_thread_exception_ce = swow_register_internal_class(
+        "Swow\\ThreadException", swow_exception_ce, NULL, NULL, NULL, cat_true, cat_true, NULL, NULL, 0
+    );
+
+    if (uv_mutex_init(&swow_thread_channel_registry_mutex) != 0) {
+        return FAILURE;
+    }
+    zend_hash_init(&swow_thread_channel_registry, 0, NULL, NULL, 1);
+    swow_thread_channel_registry_last_ticket = 0;
+
+    swow_thread_channel_ce = swow_register_internal_class(
+        "Swow\\Thread\\Channel", NULL, swow_thread_channel_methods,
+        &swow_thread_channel_handlers, NULL,
+        cat_false, cat_true,
+        swow_thread_channel_create_object,
+        swow_thread_channel_free_object,
+        XtOffsetOf(swow_thread_channel_t, std)
+    );
+    zend_declare_class_constant_long(swow_thread_channel_ce, ZEND_STRL("FLAG_NONE"), CAT_THREAD_CHANNEL_FLAG_NONE);
+    zend_declare_class_constant_long(swow_thread_channel_ce, ZEND_STRL("FLAG_SINGLE_CONSUMER"), CAT_THREAD_CHANNEL_FLAG_SINGLE_CONSUMER);
+#endif
+
+    return SUCCESS;
+}
+
+zend_result swow_thread_module_shutdown(INIT_FUNC_ARGS)
+{
+#ifdef ZTS
+    cat_thread_channel_t *channel;
+
+    /* release channels which were serialized but never unserialized */
+    ZEND_HASH_FOREACH_PTR(&swow_thread_channel_registry, channel) {
+        cat_thread_channel_release(channel);
+    } ZEND_HASH_FOREACH_END();
+    zend_hash_destroy(&swow_thread_channel_registry);
+    uv_mutex_destroy(&swow_thread_channel_registry_mutex);
+#endif
+
     return SUCCESS;
 }
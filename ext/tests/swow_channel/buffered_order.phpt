@@ -0,0 +1,32 @@
+--TEST--
+swow_channel: buffered channel keeps order when storage wraps and grows
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Channel;
+
+foreach ([1, 3, 8, 100] as $c) {
+    $channel = new Channel($c);
+    $in = $out = 0;
+    for ($round = 0; $round < TEST_MAX_REQUESTS; $round++) {
+        for ($n = ($round * 7) % 13 + 1; $n-- && !$channel->isFull();) {
+            $channel->push([$in++]);
+        }
+        for ($n = ($round * 5) % 11; $n-- && !$channel->isEmpty();) {
+            Assert::same($channel->pop(), [$out++]);
+        }
+        Assert::same($channel->getLength(), $in - $out);
+    }
+    /* buffered data is released with the channel */
+    $channel = null;
+}
+echo "Done\n";
+
+?>
+--EXPECT--
+Done
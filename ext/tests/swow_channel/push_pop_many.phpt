@@ -0,0 +1,65 @@
+--TEST--
+swow_channel: pushMany and popMany
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Channel;
+use Swow\ChannelException;
+use Swow\Coroutine;
+use Swow\Errno;
+
+foreach ([0, 1, 7, 100] as $c) {
+    $channel = new Channel($c);
+    Coroutine::run(static function () use ($channel): void {
+        for ($n = 0; $n < TEST_MAX_LOOPS; $n += 10) {
+            $channel->pushMany(range($n, $n + 9));
+        }
+        $channel->push(false);
+    });
+    $expected = 0;
+    while (true) {
+        $items = $channel->popMany(8);
+        Assert::greaterThan(count($items), 0);
+        Assert::lessThanEq(count($items), 8);
+        foreach ($items as $item) {
+            if ($item === false) {
+                break 2;
+            }
+            Assert::same($item, $expected++);
+        }
+    }
+    Assert::greaterThanEq($expected, TEST_MAX_LOOPS);
+}
+
+$channel = new Channel(2);
+try {
+    $channel->pushMany([1, 2, 3], 1);
+    echo 'Never here' . PHP_EOL;
+} catch (ChannelException $exception) {
+    Assert::same($exception->getCode(), Errno::ETIMEDOUT);
+}
+Assert::same($channel->popMany(100), [1, 2]);
+try {
+    $channel->popMany(1, 1);
+    echo 'Never here' . PHP_EOL;
+} catch (ChannelException $exception) {
+    Assert::same($exception->getCode(), Errno::ETIMEDOUT);
+}
+try {
+    $channel->popMany(0);
+    echo 'Never here' . PHP_EOL;
+} catch (ValueError $exception) {
+    echo $exception->getMessage() . PHP_EOL;
+}
+
+echo "Done\n";
+
+?>
+--EXPECT--
+Swow\Channel::popMany(): Argument #1 ($max) must be greater than 0
+Done
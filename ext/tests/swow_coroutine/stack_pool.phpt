@@ -0,0 +1,64 @@
+--TEST--
+swow_coroutine: stack pool
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Coroutine;
+
+$original = Coroutine::getStackPoolSize();
+Assert::greaterThanEq($original, 0);
+/* pool is compiled out in ASan or thread context builds, stacks are never cached there */
+$available = Coroutine::getStackPoolInfo()['available'];
+
+Coroutine::setStackPoolSize(8);
+Assert::same(Coroutine::getStackPoolSize(), 8);
+
+for ($n = 0; $n < 32; $n++) {
+    Coroutine::run(static function (): void { });
+}
+$info = Coroutine::getStackPoolInfo();
+Assert::same($info['size'], 8);
+Assert::lessThanEq($info['count'], 8);
+if ($available) {
+    Assert::greaterThanEq($info['hits'] + $info['misses'], 32);
+}
+
+$coroutines = [];
+for ($n = 0; $n < 16; $n++) {
+    $coroutines[] = new Coroutine(static function (): void {
+        Coroutine::yield();
+    });
+}
+foreach ($coroutines as $coroutine) {
+    $coroutine->resume();
+}
+foreach ($coroutines as $coroutine) {
+    $coroutine->resume();
+}
+$coroutines = [];
+Assert::same(Coroutine::getStackPoolInfo()['count'], $available ? 8 : 0);
+
+Coroutine::setStackPoolSize(2);
+Assert::same(Coroutine::getStackPoolInfo()['count'], $available ? 2 : 0);
+
+Coroutine::setStackPoolSize(0);
+Assert::same(Coroutine::getStackPoolInfo()['count'], 0);
+
+try {
+    Coroutine::setStackPoolSize(-1);
+} catch (ValueError $exception) {
+    echo $exception->getMessage(), "\n";
+}
+
+Coroutine::setStackPoolSize($original);
+
+echo "Done\n";
+?>
+--EXPECT--
+Swow\Coroutine::setStackPoolSize(): Argument #1 ($size) can not be negative
+Done
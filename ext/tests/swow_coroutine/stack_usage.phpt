@@ -0,0 +1,29 @@
+--TEST--
+swow_coroutine: stack usage
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Coroutine;
+
+$coroutine = Coroutine::run(static function (): void {
+    Assert::greaterThan(Coroutine::getCurrent()->getStackUsage(), 0);
+    Coroutine::yield();
+});
+Assert::greaterThan($coroutine->getStackUsage(), 0);
+Assert::greaterThanEq($coroutine->getPeakStackUsage(), $coroutine->getStackUsage());
+Assert::greaterThanEq(Coroutine::getGlobalPeakStackUsage(), $coroutine->getPeakStackUsage());
+Assert::greaterThanEq($coroutine->trimStack(), 0);
+// running coroutine can not be trimmed
+Assert::same(Coroutine::getCurrent()->trimStack(), 0);
+$coroutine->resume();
+Assert::same($coroutine->trimStack(), 0);
+
+echo "Done\n";
+?>
+--EXPECT--
+Done
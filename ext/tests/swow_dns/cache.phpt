@@ -0,0 +1,63 @@
+--TEST--
+swow_dns: cache
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Coroutine;
+use Swow\Socket;
+use Swow\Sync\WaitReference;
+
+Socket::flushGlobalDnsCache();
+Socket::setGlobalDnsCacheCapacity(16);
+Socket::setGlobalDnsCacheTtl(60 * 1000);
+Assert::same(Socket::getGlobalDnsCacheCapacity(), 16);
+Assert::same(Socket::getGlobalDnsCacheTtl(), 60 * 1000);
+Socket::setGlobalDnsCacheNegativeTtl(0);
+Assert::same(Socket::getGlobalDnsCacheNegativeTtl(), 0);
+try {
+    Socket::setGlobalDnsCacheCapacity(-1);
+} catch (ValueError $exception) {
+    echo $exception->getMessage() . PHP_EOL;
+}
+
+$stats = Socket::getGlobalDnsCacheStats();
+Assert::same($stats['count'], 0);
+
+// concurrent lookups share one resolution
+$wr = new WaitReference();
+for ($n = 0; $n < 4; $n++) {
+    Coroutine::run(static function () use ($wr): void {
+        Assert::same(gethostbyname('localhost'), '127.0.0.1');
+    });
+}
+WaitReference::wait($wr);
+$newStats = Socket::getGlobalDnsCacheStats();
+Assert::same($newStats['misses'] - $stats['misses'], 1);
+Assert::same($newStats['coalesced'] - $stats['coalesced'], 3);
+Assert::same($newStats['count'], 1);
+
+// then it is cached
+Assert::same(gethostbyname('localhost'), '127.0.0.1');
+Assert::same(Socket::getGlobalDnsCacheStats()['hits'] - $newStats['hits'], 1);
+
+Socket::flushGlobalDnsCache();
+Assert::same(Socket::getGlobalDnsCacheStats()['count'], 0);
+
+// buckets do not depend on capacity
+Socket::setGlobalDnsCacheCapacity(PHP_INT_MAX);
+Assert::same(gethostbyname('localhost'), '127.0.0.1');
+Assert::same(Socket::getGlobalDnsCacheStats()['count'], 1);
+Socket::setGlobalDnsCacheCapacity(16);
+Socket::flushGlobalDnsCache();
+
+echo "Done\n";
+
+?>
+--EXPECT--
+Swow\Socket::setGlobalDnsCacheCapacity(): Argument #1 ($capacity) can not be negative
+Done
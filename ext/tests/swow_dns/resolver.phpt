@@ -0,0 +1,167 @@
+--TEST--
+swow_dns: native resolver
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Coroutine;
+use Swow\Socket;
+use Swow\SocketException;
+
+const TYPE_A = 1;
+const TYPE_SRV = 33;
+
+function encodeName(string $name): string
+{
+    $encoded = '';
+    foreach (explode('.', rtrim($name, '.')) as $label) {
+        $encoded .= chr(strlen($label)) . $label;
+    }
+
+    return $encoded . "\0";
+}
+
+function record(int $type, string $rdata): string
+{
+    return "\xc0\x0c" . pack('nnNn', $type, 1, 300, strlen($rdata)) . $rdata;
+}
+
+/** @return array{0: string, 1: bool} response and whether it is truncated */
+function respond(string $query, bool $tcp): array
+{
+    $offset = 12;
+    $labels = [];
+    while (($length = ord($query[$offset])) !== 0) {
+        $labels[] = substr($query, $offset + 1, $length);
+        $offset += $length + 1;
+    }
+    $name = implode('.', $labels);
+    $type = unpack('n', $query, $offset + 1)[1];
+    $question = substr($query, 12, $offset + 5 - 12);
+    $rcode = 0;
+    $answers = [];
+    switch ("{$name}/{$type}") {
+        case 'a.test/' . TYPE_A:
+            $answers[] = record(TYPE_A, inet_pton('10.0.0.1'));
+            break;
+        case 'big.test/' . TYPE_A:
+            if (!$tcp) {
+                return [substr($query, 0, 2) . pack('nnnnn', 0x8380, 1, 0, 0, 0) . $question, true];
+            }
+            for ($n = 1; $n <= 3; $n++) {
+                $answers[] = record(TYPE_A, inet_pton("10.0.1.{$n}"));
+            }
+            break;
+        case '_svc._tcp.test/' . TYPE_SRV:
+            $answers[] = record(TYPE_SRV, pack('nnn', 20, 5, 8080) . encodeName('s2.test'));
+            $answers[] = record(TYPE_SRV, pack('nnn', 10, 5, 80) . encodeName('s1.test'));
+            break;
+        case 'a.test/28':
+            break;
+        default:
+            $rcode = 3;
+    }
+
+    return [substr($query, 0, 2) . pack('nnnnn', 0x8180 | $rcode, 1, count($answers), 0, 0) . $question . implode('', $answers), false];
+}
+
+$udpServer = new Socket(Socket::TYPE_UDP4);
+$udpServer->bind('127.0.0.1');
+$port = $udpServer->getSockPort();
+$tcpServer = new Socket(Socket::TYPE_TCP4);
+$tcpServer->bind('127.0.0.1', $port)->listen();
+$queries = ['udp' => 0, 'tcp' => 0];
+
+$serveUdp = static function (Socket $udpServer) use (&$queries): void {
+    try {
+        while (true) {
+            $query = $udpServer->recvStringFrom(512, $address, $port);
+            $queries['udp']++;
+            [$response] = respond($query, false);
+            $udpServer->sendTo($response, address: $address, port: $port);
+        }
+    } catch (SocketException) {
+    }
+};
+Coroutine::run($serveUdp, $udpServer);
+Coroutine::run(static function () use ($tcpServer, &$queries): void {
+    try {
+        while (true) {
+            $connection = $tcpServer->accept();
+            $length = unpack('n', $connection->readString(2))[1];
+            $queries['tcp']++;
+            [$response] = respond($connection->readString($length), true);
+            $connection->send(pack('n', strlen($response)) . $response);
+            $connection->close();
+        }
+    } catch (SocketException) {
+    }
+});
+
+try {
+    Socket::setGlobalDnsServers('127.0.0.1:65536');
+} catch (SocketException $exception) {
+    echo "invalid servers\n";
+}
+Socket::setGlobalDnsServers("127.0.0.1:{$port}");
+Assert::same(Socket::getGlobalDnsServers(), "127.0.0.1:{$port}");
+Socket::setGlobalDnsResolverEnabled(true);
+Assert::true(Socket::isGlobalDnsResolverEnabled());
+Socket::flushGlobalDnsCache();
+
+Assert::same(gethostbyname('a.test'), '10.0.0.1');
+Assert::same(gethostbyname('nx.test'), 'nx.test');
+Assert::same(gethostbyname('localhost'), '127.0.0.1');
+
+// truncated responses are retried over TCP
+$queries = ['udp' => 0, 'tcp' => 0];
+Assert::startsWith(gethostbyname('big.test'), '10.0.1.');
+Assert::same($queries, ['udp' => 1, 'tcp' => 1]);
+
+Assert::same(Socket::resolveSrv('_svc._tcp.test'), [
+    ['target' => 's1.test', 'port' => 80, 'priority' => 10, 'weight' => 5, 'ttl' => 300],
+    ['target' => 's2.test', 'port' => 8080, 'priority' => 20, 'weight' => 5, 'ttl' => 300],
+]);
+try {
+    Socket::resolveSrv('nx.test');
+} catch (SocketException $exception) {
+    echo "nx srv\n";
+}
+
+// nameservers of different families
+try {
+    $udp6Server = new Socket(Socket::TYPE_UDP6);
+    $udp6Server->bind('::1');
+} catch (SocketException) {
+    $udp6Server = null;
+}
+if ($udp6Server !== null) {
+    Coroutine::run($serveUdp, $udp6Server);
+    $refusedPort = (new Socket(Socket::TYPE_UDP4))->bind('127.0.0.1')->getSockPort();
+    Socket::setGlobalDnsServers("127.0.0.1:{$refusedPort},[::1]:{$udp6Server->getSockPort()}");
+    Socket::flushGlobalDnsCache();
+    Assert::same(gethostbyname('a.test'), '10.0.0.1');
+    Socket::setGlobalDnsServers("[::1]:{$refusedPort},127.0.0.1:{$port}");
+    Socket::flushGlobalDnsCache();
+    Assert::same(gethostbyname('a.test'), '10.0.0.1');
+    $udp6Server->close();
+}
+
+Socket::setGlobalDnsResolverEnabled(false);
+Socket::setGlobalDnsServers(null);
+Assert::null(Socket::getGlobalDnsServers());
+Socket::flushGlobalDnsCache();
+$udpServer->close();
+$tcpServer->close();
+
+echo "Done\n";
+
+?>
+--EXPECT--
+invalid servers
+nx srv
+Done
@@ -0,0 +1,46 @@
+--TEST--
+swow_event: defer info
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Coroutine;
+use Swow\Event;
+
+$info = Event::getDeferInfo();
+Assert::same(array_keys($info), ['pending', 'capacity', 'last_round', 'peak_round', 'total']);
+Assert::greaterThanEq($info['peak_round'], $info['last_round']);
+
+$round = Event::getRound();
+usleep(1000);
+Assert::greaterThan(Event::getRound(), $round);
+
+/* select() defers its done and free callbacks */
+[$a, $b] = stream_socket_pair(STREAM_PF_UNIX, STREAM_SOCK_STREAM, STREAM_IPPROTO_IP);
+for ($n = 0; $n < TEST_MAX_REQUESTS; $n++) {
+    Coroutine::run(static function () use ($b): void {
+        usleep(1000);
+        fwrite($b, 'x');
+    });
+    $r = [$a];
+    $w = $e = null;
+    Assert::same(stream_select($r, $w, $e, 1), 1);
+    Assert::same(fread($a, 1), 'x');
+}
+usleep(1000);
+
+$newInfo = Event::getDeferInfo();
+Assert::same($newInfo['pending'], 0);
+Assert::greaterThanEq($newInfo['total'], $info['total'] + TEST_MAX_REQUESTS);
+Assert::greaterThanEq($newInfo['capacity'], $newInfo['peak_round']);
+Assert::greaterThanEq($newInfo['peak_round'], $newInfo['last_round']);
+
+echo "Done\n";
+
+?>
+--EXPECT--
+Done
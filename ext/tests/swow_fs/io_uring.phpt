@@ -0,0 +1,48 @@
+--TEST--
+swow_fs: file operations through io_uring
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+skip_linux_only();
+skip_if(!Swow\Extension::isBuiltWith('io_uring'), 'extension must be built with io_uring');
+/* IORING_OP_OPENAT and IORING_OP_STATX are supported since 5.6 */
+skip_if(version_compare(preg_replace('/^(\d+\.\d+).*/', '$1', php_uname('r')), '5.6', '<'), 'kernel does not support io_uring');
+?>
+--ENV--
+CAT_IO_URING=1
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Coroutine;
+use Swow\Sync\WaitReference;
+
+const TEST_COUNT = 16;
+
+/* make sure that operations below go through the ring rather than falling back to the threadpool */
+Assert::true(Swow\Extension::isIoUringAvailable());
+
+$wr = new WaitReference();
+for ($n = 0; $n < TEST_COUNT; $n++) {
+    Coroutine::run(static function () use ($n, $wr): void {
+        $filename = sys_get_temp_dir() . "/swow_io_uring_{$n}_" . getRandomBytes(8);
+        $data = getRandomBytes(8192 + $n);
+        Assert::same(file_put_contents($filename, $data), strlen($data));
+        Assert::same(filesize($filename), strlen($data));
+        $fp = fopen($filename, 'r+');
+        Assert::same(fstat($fp)['size'], strlen($data));
+        Assert::same(fread($fp, 4), substr($data, 0, 4));
+        Assert::same(fwrite($fp, 'swow'), 4);
+        Assert::true(fflush($fp));
+        Assert::true(fclose($fp));
+        Assert::same(file_get_contents($filename), substr($data, 0, 4) . 'swow' . substr($data, 8));
+        Assert::true(unlink($filename));
+        Assert::false(@file_get_contents($filename));
+    });
+}
+$wr::wait($wr);
+
+echo "Done\n";
+?>
+--EXPECT--
+Done
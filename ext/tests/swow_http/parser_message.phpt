@@ -0,0 +1,119 @@
+--TEST--
+swow_http: parse message at once
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Buffer;
+use Swow\Http\Parser;
+use Swow\Http\ParserException;
+use Swow\Http\Status;
+
+$payload = json_encode(['container' => 'mug', 'capacity' => 500]);
+$request = implode("\r\n", [
+    'POST /pot-0?additions[]=Cream HTTP/1.1',
+    'Host: alpine-linux.local',
+    'X-Test-Header: value1',
+    'x-test-header: value2',
+    'X-Test-Header: value3',
+    'X-Empty:',
+    'Content-Type: application/json',
+    'Content-Length: ' . strlen($payload),
+    '',
+    $payload,
+]);
+$pipelined = "GET / HTTP/1.0\r\n\r\n";
+
+$buffer = new Buffer(4096);
+$parser = (new Parser())->setType(Parser::TYPE_REQUEST)->setEvents(Parser::EVENTS_ALL);
+
+// incomplete head
+$buffer->append(substr($request, 0, 40));
+Assert::null($parser->parseMessage($buffer));
+
+// whole message is in the buffer
+$buffer->append(substr($request, 40) . $pipelined);
+$message = $parser->parseMessage($buffer);
+Assert::same($message['method'], 'POST');
+Assert::same($message['uri'], '/pot-0?additions[]=Cream');
+Assert::same($message['protocolVersion'], '1.1');
+Assert::same($message['headers']['X-Test-Header'], ['value1', 'value3']);
+Assert::same($message['headers']['x-test-header'], ['value2']);
+Assert::same($message['headers']['X-Empty'], ['']);
+Assert::same($message['headerNames']['x-test-header'], 'x-test-header');
+Assert::same($message['headerNames']['content-type'], 'Content-Type');
+Assert::same($message['contentLength'], strlen($payload));
+Assert::true($message['shouldKeepAlive']);
+Assert::false($message['isChunked']);
+Assert::true($message['completed']);
+Assert::same($buffer->read($message['bodyOffset'], $message['bodyLength']), $payload);
+Assert::same($message['parsedLength'], strlen($request));
+
+// pipelined message
+$message = $parser->parseMessage($buffer, strlen($request));
+Assert::same($message['method'], 'GET');
+Assert::same($message['headers'], []);
+Assert::false($message['shouldKeepAlive']);
+Assert::true($message['completed']);
+Assert::same($message['bodyLength'], 0);
+Assert::same(strlen($request) + $message['parsedLength'], $buffer->getLength());
+
+// body is not all received, the rest of it can be parsed by execute()
+$partial = substr($request, 0, -10);
+$message = $parser->parseMessage($partial);
+Assert::false($message['completed']);
+Assert::same($message['bodyLength'], 0);
+$parser->execute($partial, $message['parsedLength']);
+Assert::same($parser->getEvent(), Parser::EVENT_BODY);
+Assert::same($parser->getDataLength(), strlen($payload) - 10);
+
+// chunked body is left to execute()
+$chunked = "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nfoo\r\n0\r\n\r\n";
+$message = $parser->parseMessage($chunked);
+Assert::true($message['isChunked']);
+Assert::false($message['completed']);
+$parser->execute($chunked, $message['parsedLength']);
+Assert::same($parser->getEvent(), Parser::EVENT_CHUNK_HEADER);
+
+// known headers in any case
+$message = $parser->parseMessage("GET / HTTP/1.1\r\nhost: a\r\nCONNECTION: close\r\nConnection: Upgrade\r\n\r\n");
+Assert::same($message['headers'], ['host' => ['a'], 'CONNECTION' => ['close'], 'Connection' => ['Upgrade']]);
+Assert::same($message['headerNames'], ['host' => 'host', 'connection' => 'Connection']);
+Assert::false($message['shouldKeepAlive']);
+
+// response
+$parser->reset()->setType(Parser::TYPE_RESPONSE);
+$message = $parser->parseMessage("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n");
+Assert::same($message['statusCode'], 404);
+Assert::same($message['reasonPhrase'], 'Not Found');
+Assert::true($message['completed']);
+$parser->reset()->setType(Parser::TYPE_REQUEST);
+
+// limits
+foreach ([
+    [$request, 16, -1, Status::REQUEST_URI_TOO_LARGE],
+    [$request, 64, -1, Status::REQUEST_HEADER_FIELDS_TOO_LARGE],
+    [$request, -1, 8, Status::REQUEST_ENTITY_TOO_LARGE],
+] as [$data, $maxHeaderLength, $maxContentLength, $statusCode]) {
+    try {
+        $parser->parseMessage($data, 0, $maxHeaderLength, $maxContentLength);
+        echo "Never here\n";
+    } catch (ParserException $exception) {
+        Assert::same($exception->getCode(), $statusCode);
+    }
+}
+
+// bad message
+Assert::throws(static function () use ($parser): void {
+    $parser->parseMessage("BREW /pot-2 HTCPCP/1.0\r\n\r\n");
+}, ParserException::class, expectMessage: '/Invalid method encountered/');
+
+echo "Done\n";
+
+?>
+--EXPECT--
+Done
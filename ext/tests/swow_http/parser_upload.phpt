@@ -0,0 +1,98 @@
+--TEST--
+swow_http: write uploaded files to disk by parser
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Http\Parser;
+use Swow\Http\ParserException;
+use Swow\Http\Status;
+
+function uploadRequest(string ...$contents): string
+{
+    $body = '';
+    foreach ($contents as $n => $content) {
+        $body .= "--boundary\r\nContent-Disposition: form-data; name=\"file{$n}\"; filename=\"{$n}.txt\"\r\n\r\n{$content}\r\n";
+    }
+    $body .= "--boundary--\r\n";
+
+    return "POST /upload HTTP/1.1\r\nContent-Type: multipart/form-data; boundary=boundary\r\nContent-Length: " . strlen($body) . "\r\n\r\n" . $body;
+}
+
+/** @return array<array{'tmpName': string, 'error': int, 'size': int}> */
+function upload(Parser $parser, string $request, int $chunkSize = PHP_INT_MAX): array
+{
+    $files = [];
+    $parser->reset();
+    foreach (str_split($request, $chunkSize) as $chunk) {
+        $offset = 0;
+        while ($offset < strlen($chunk)) {
+            $offset += $parser->execute($chunk, $offset);
+            switch ($parser->getEvent()) {
+                case Parser::EVENT_MULTIPART_HEADERS_COMPLETE:
+                    $parser->startUploadedFile(sys_get_temp_dir());
+                    break;
+                case Parser::EVENT_MULTIPART_BODY:
+                    echo "Never here\n";
+                    break;
+                case Parser::EVENT_MULTIPART_DATA_END:
+                    $files[] = $parser->finishUploadedFile();
+                    break;
+            }
+        }
+    }
+    Assert::true($parser->isCompleted());
+
+    return $files;
+}
+
+$parser = (new Parser())->setType(Parser::TYPE_REQUEST)->setEvents(Parser::EVENTS_ALL);
+Assert::same($parser->getMaxUploadedFileSize(), -1);
+Assert::same($parser->getMaxUploadedFilesSize(), -1);
+
+$contents = [str_repeat('x', 8192), 'y', ''];
+foreach ([PHP_INT_MAX, 1000, 7] as $chunkSize) {
+    $files = upload($parser, uploadRequest(...$contents), $chunkSize);
+    Assert::count($files, 3);
+    foreach ($files as $n => $file) {
+        Assert::same($file['error'], UPLOAD_ERR_OK);
+        Assert::same($file['size'], strlen($contents[$n]));
+        Assert::same(file_get_contents($file['tmpName']), $contents[$n]);
+        unlink($file['tmpName']);
+    }
+}
+
+// per-file limit
+$parser->setMaxUploadedFileSize(4096);
+$files = upload($parser, uploadRequest(str_repeat('x', 8192), 'y'), 1000);
+Assert::same($files[0], ['tmpName' => '', 'error' => UPLOAD_ERR_INI_SIZE, 'size' => 0]);
+Assert::same($files[1]['error'], UPLOAD_ERR_OK);
+unlink($files[1]['tmpName']);
+
+// total limit
+$parser->setMaxUploadedFilesSize(8192);
+try {
+    upload($parser, uploadRequest(str_repeat('x', 10000)), 1000);
+    echo "Never here\n";
+} catch (ParserException $exception) {
+    Assert::same($exception->getCode(), Status::REQUEST_ENTITY_TOO_LARGE);
+}
+$parser->setMaxUploadedFileSize(-1)->setMaxUploadedFilesSize(-1);
+
+// unable to create temp file
+$parser->reset();
+Assert::same($parser->startUploadedFile('/path/to/nowhere'), '');
+Assert::same($parser->finishUploadedFile(), ['tmpName' => '', 'error' => UPLOAD_ERR_NO_TMP_DIR, 'size' => 0]);
+Assert::throws(static function () use ($parser): void {
+    $parser->finishUploadedFile();
+}, ParserException::class);
+
+echo "Done\n";
+
+?>
+--EXPECT--
+Done
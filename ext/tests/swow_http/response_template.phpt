@@ -0,0 +1,106 @@
+--TEST--
+swow_http: ResponseTemplate
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Buffer;
+use Swow\Http\Http;
+use Swow\Http\ResponseTemplate;
+use Swow\Http\Status;
+
+$headers = [
+    'Server' => 'alpine-linux.local',
+    'X-Test-Header' => ['value1', 'value2'],
+    'Content-Type' => 'application/json',
+];
+
+$template = new ResponseTemplate(Status::OK, headers: $headers, withDate: false);
+Assert::same($template->getStatusCode(), Status::OK);
+var_dump($template->getHead());
+var_dump($template->pack('hello world', ['Connection' => 'close']));
+Assert::same(
+    $template->pack('{}'),
+    Http::packResponse(Status::OK, headers: $headers + ['Content-Length' => 2], body: '{}')
+);
+
+// buffer can be reused
+$buffer = new Buffer(64);
+$length = $template->packTo($buffer, 'foo');
+$length += $template->packTo($buffer, 'bar', ['X-Id' => 2]);
+Assert::same($buffer->getLength(), $length);
+Assert::same($buffer->toString(), $template->pack('foo') . $template->pack('bar', ['X-Id' => 2]));
+$buffer->clear();
+$template->packTo($buffer);
+Assert::endsWith($buffer->toString(), "Content-Length: 0\r\n\r\n");
+
+// Date header
+$template = new ResponseTemplate(Status::NOT_FOUND, protocolVersion: '1.0');
+$response = $template->pack();
+Assert::true(preg_match('/^HTTP\/1.0 404 Not Found\r\nDate: (.+)\r\nContent-Length: 0\r\n\r\n$/', $response, $matches) === 1);
+Assert::lessThanEq(abs(strtotime($matches[1]) - time()), 1);
+Assert::same(gmdate('D, d M Y H:i:s', strtotime($matches[1])) . ' GMT', $matches[1]);
+
+// no Content-Length for 1xx, 204 and 304
+foreach ([Status::SWITCHING_PROTOCOLS, Status::NO_CONTENT, Status::NOT_MODIFIED] as $statusCode) {
+    $template = new ResponseTemplate($statusCode, withDate: false);
+    Assert::same($template->pack(), Http::packResponse($statusCode));
+    $buffer->clear();
+    $template->packTo($buffer);
+    Assert::same($buffer->toString(), Http::packResponse($statusCode));
+}
+Assert::same(
+    $template->pack(headers: ['Content-Length' => 42]),
+    Http::packResponse(Status::NOT_MODIFIED, headers: ['Content-Length' => 42])
+);
+
+// Content-Length is generated, it can not be given
+Assert::throws(static function (): void {
+    new ResponseTemplate(headers: ['content-length' => 0]);
+}, ValueError::class, expectMessage: '/Argument #3 \(\$headers\) can not contain Content-Length/');
+$template = new ResponseTemplate(withDate: false);
+Assert::throws(static function () use ($template): void {
+    $template->pack('foo', ['Content-Length' => 3]);
+}, ValueError::class, expectMessage: '/Argument #2 \(\$headers\) can not contain Content-Length/');
+Assert::throws(static function () use ($template, $buffer): void {
+    $template->packTo($buffer, 'foo', ['Content-Length' => 3]);
+}, ValueError::class, expectMessage: '/Argument #3 \(\$headers\) can not contain Content-Length/');
+
+// so is Date unless withDate is false
+Assert::throws(static function (): void {
+    new ResponseTemplate(headers: ['date' => 'Thu, 01 Jan 1970 00:00:00 GMT']);
+}, ValueError::class, expectMessage: '/Argument #3 \(\$headers\) can not contain Date/');
+Assert::throws(static function (): void {
+    $template = new ResponseTemplate();
+    $template->pack('foo', ['Date' => 'Thu, 01 Jan 1970 00:00:00 GMT']);
+}, ValueError::class, expectMessage: '/Argument #2 \(\$headers\) can not contain Date/');
+Assert::throws(static function () use ($buffer): void {
+    $template = new ResponseTemplate();
+    $template->packTo($buffer, 'foo', ['Date' => 'Thu, 01 Jan 1970 00:00:00 GMT']);
+}, ValueError::class, expectMessage: '/Argument #3 \(\$headers\) can not contain Date/');
+$template = new ResponseTemplate(headers: ['Date' => 'Thu, 01 Jan 1970 00:00:00 GMT'], withDate: false);
+Assert::same($template->pack(), "HTTP/1.1 200 OK\r\nDate: Thu, 01 Jan 1970 00:00:00 GMT\r\nContent-Length: 0\r\n\r\n");
+
+echo "Done\n";
+?>
+--EXPECT--
+string(123) "HTTP/1.1 200 OK
+Server: alpine-linux.local
+X-Test-Header: value1
+X-Test-Header: value2
+Content-Type: application/json
+"
+string(175) "HTTP/1.1 200 OK
+Server: alpine-linux.local
+X-Test-Header: value1
+X-Test-Header: value2
+Content-Type: application/json
+Content-Length: 11
+Connection: close
+
+hello world"
+Done
@@ -0,0 +1,69 @@
+--TEST--
+swow_socket: accept many
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+skip_if_max_open_files_less_than(256);
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Errno;
+use Swow\Socket;
+use Swow\SocketException;
+
+$server = (new Socket(Socket::TYPE_TCP))->bind('127.0.0.1')->listen(128);
+
+try {
+    $server->acceptMany(0);
+} catch (ValueError $exception) {
+    echo $exception->getMessage() . "\n";
+}
+try {
+    $server->acceptMany(8, 0);
+} catch (SocketException $exception) {
+    Assert::same($exception->getCode(), Errno::ETIMEDOUT);
+}
+
+$clients = [];
+for ($n = 0; $n < 32; $n++) {
+    $clients[] = (new Socket(Socket::TYPE_TCP))->connect($server->getSockAddress(), $server->getSockPort());
+}
+$connections = [];
+while (count($connections) < 32) {
+    $batch = $server->acceptMany(16);
+    Assert::greaterThan(count($batch), 0);
+    Assert::lessThanEq(count($batch), 16);
+    foreach ($batch as $connection) {
+        Assert::true($connection->isEstablished());
+        $connections[$connection->getPeerPort()] = $connection;
+    }
+}
+foreach ($clients as $client) {
+    $client->send('ping');
+    Assert::same($connections[$client->getSockPort()]->recvString(), 'ping');
+}
+
+$stats = $server->getAcceptStats();
+Assert::same($stats['connections'], 32);
+Assert::lessThan($stats['batches'], 32);
+Assert::same($stats['max_batch_size'], 16);
+var_dump(array_keys($stats));
+
+echo "Done\n";
+
+?>
+--EXPECT--
+Swow\Socket::acceptMany(): Argument #1 ($max) must be greater than 0
+array(4) {
+  [0]=>
+  string(7) "batches"
+  [1]=>
+  string(11) "connections"
+  [2]=>
+  string(15) "last_batch_size"
+  [3]=>
+  string(14) "max_batch_size"
+}
+Done
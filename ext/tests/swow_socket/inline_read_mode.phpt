@@ -0,0 +1,82 @@
+--TEST--
+swow_socket: inline read mode
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+skip_if_win();
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Coroutine;
+use Swow\Socket;
+use Swow\Sync\WaitReference;
+
+Assert::same(Socket::getGlobalInlineReadMode(Socket::TYPE_TCP), Socket::INLINE_READ_MODE_ADAPTIVE);
+Socket::setGlobalInlineReadMode(Socket::INLINE_READ_MODE_NEVER, Socket::TYPE_UDP);
+Assert::same(Socket::getGlobalInlineReadMode(Socket::TYPE_UDP4), Socket::INLINE_READ_MODE_NEVER);
+Assert::same(Socket::getGlobalInlineReadMode(Socket::TYPE_TCP), Socket::INLINE_READ_MODE_ADAPTIVE);
+Socket::setGlobalInlineReadMode(Socket::INLINE_READ_MODE_DEFAULT);
+Assert::same(Socket::getGlobalInlineReadMode(Socket::TYPE_UDP), Socket::INLINE_READ_MODE_ADAPTIVE);
+try {
+    Socket::setGlobalInlineReadMode(PHP_INT_MAX);
+    echo "Never here\n";
+} catch (ValueError) {
+    echo "Invalid mode\n";
+}
+try {
+    (new Socket(Socket::TYPE_TCP))->setInlineReadMode((1 << 32) + Socket::INLINE_READ_MODE_ALWAYS);
+    echo "Never here\n";
+} catch (ValueError) {
+    echo "Invalid mode\n";
+}
+
+// fixed, so that adaptive mode always misses enough times (4) to start skipping
+$count = 64;
+$modes = [
+    'always' => Socket::INLINE_READ_MODE_ALWAYS,
+    'adaptive' => Socket::INLINE_READ_MODE_ADAPTIVE,
+    'never' => Socket::INLINE_READ_MODE_NEVER,
+];
+foreach ($modes as $name => $mode) {
+    $server = (new Socket(Socket::TYPE_TCP))->bind('127.0.0.1')->listen();
+    $server->setInlineReadMode($mode);
+    $client = (new Socket(Socket::TYPE_TCP))->connect($server->getSockAddress(), $server->getSockPort());
+    $connection = $server->accept();
+    Assert::same($connection->getInlineReadMode(), $mode);
+
+    $wr = new WaitReference();
+    Coroutine::run(static function () use ($client, $count, $wr): void {
+        for ($i = 0; $i < $count; $i++) {
+            $client->send(pack('N', $i));
+            usleep(100);
+        }
+    });
+    for ($i = 0; $i < $count; $i++) {
+        Assert::same(unpack('N', $connection->readString(4))[1], $i);
+    }
+    WaitReference::wait($wr);
+
+    $stats = $connection->getInlineReadStats();
+    Assert::same($stats['hits'] + $stats['misses'] + $stats['skips'] >= $count, true);
+    match ($mode) {
+        Socket::INLINE_READ_MODE_ALWAYS => Assert::same($stats['skips'], 0),
+        Socket::INLINE_READ_MODE_ADAPTIVE => Assert::greaterThan($stats['skips'], 0),
+        Socket::INLINE_READ_MODE_NEVER => Assert::same($stats['hits'] + $stats['misses'], 0),
+    };
+    echo "{$name} verified\n";
+    $connection->close();
+    $client->close();
+    $server->close();
+}
+
+echo "Done\n";
+?>
+--EXPECT--
+Invalid mode
+Invalid mode
+always verified
+adaptive verified
+never verified
+Done
@@ -0,0 +1,71 @@
+--TEST--
+swow_socket: send file
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Coroutine;
+use Swow\Socket;
+use Swow\SocketException;
+use Swow\Sync\WaitReference;
+
+$file = sys_get_temp_dir() . '/swow_socket_send_file_' . getmypid();
+$content = getRandomBytes(4 * 1024 * 1024);
+file_put_contents($file, $content);
+
+$server = (new Socket(Socket::TYPE_TCP))->bind('127.0.0.1')->listen();
+$client = (new Socket(Socket::TYPE_TCP))->connect($server->getSockAddress(), $server->getSockPort());
+$connection = $server->accept();
+
+$expected = 'HEAD' . $content . substr($content, 1024, 4096) . 'TAIL' . substr($content, -16);
+$wr = new WaitReference();
+Coroutine::run(static function () use ($connection, $expected, $wr): void {
+    /* let the sender be blocked */
+    usleep(10 * 1000);
+    Assert::same($connection->readString(strlen($expected)), $expected);
+});
+
+$client->send('HEAD');
+Assert::same($client->sendFile($file), strlen($content));
+Assert::same($client->sendFile($file, 1024, 4096), 4096);
+$client->send('TAIL');
+$stream = fopen($file, 'rb');
+Assert::same($client->sendFile($stream, strlen($content) - 16), 16);
+Assert::same($client->sendFile($stream, strlen($content)), 0);
+Assert::same($client->sendFile($file, 0, 0), 0);
+WaitReference::wait($wr);
+
+try {
+    $client->sendFile($stream, strlen($content) - 16, 32);
+} catch (SocketException $exception) {
+    Assert::same($exception->getReturnValue(), 16);
+    $connection->readString(16);
+    echo 'Partial sent' . PHP_EOL;
+}
+fclose($stream);
+
+try {
+    $client->sendFile($file . '.not_exists');
+} catch (SocketException $exception) {
+    echo 'No such file' . PHP_EOL;
+}
+try {
+    $client->sendFile($file, -1);
+} catch (ValueError $exception) {
+    echo $exception->getMessage() . PHP_EOL;
+}
+
+unlink($file);
+
+echo "Done\n";
+
+?>
+--EXPECT--
+Partial sent
+No such file
+Swow\Socket::sendFile(): Argument #2 ($offset) can not be negative
+Done
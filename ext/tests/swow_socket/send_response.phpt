@@ -0,0 +1,48 @@
+--TEST--
+swow_socket: send http response
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Buffer;
+use Swow\Coroutine;
+use Swow\Http\Http;
+use Swow\Http\Status;
+use Swow\Socket;
+
+$server = (new Socket(Socket::TYPE_TCP))->bind('127.0.0.1')->listen();
+$client = (new Socket(Socket::TYPE_TCP))->connect($server->getSockAddress(), $server->getSockPort());
+$connection = $server->accept();
+
+$headers = ['Content-Type' => 'text/plain', 'X-Test-Header' => ['value1', 'value2']];
+
+// empty body
+$client->sendResponse(Status::NO_CONTENT);
+$expected = Http::packResponse(Status::NO_CONTENT);
+Assert::same($connection->readString(strlen($expected)), $expected);
+
+// string body
+$client->sendResponse(Status::OK, $headers + ['Content-Length' => 11], 'hello world', protocolVersion: '1.0');
+$expected = Http::packResponse(Status::OK, headers: $headers + ['Content-Length' => 11], body: 'hello world', protocolVersion: '1.0');
+Assert::same($connection->readString(strlen($expected)), $expected);
+
+// large buffer body and a head which does not fit on the stack
+$body = new Buffer(1024 * 1024);
+$body->append(str_repeat('x', $body->getSize()));
+$headers['X-Large-Header'] = str_repeat('y', 4096);
+$expected = Http::packResponse(Status::NOT_FOUND, 'Gone Fishing', $headers, $body);
+Coroutine::run(static function () use ($client, $headers, $body): void {
+    $client->sendResponse(Status::NOT_FOUND, $headers, $body, 'Gone Fishing');
+});
+Assert::same($connection->readString(strlen($expected)), $expected);
+Assert::same($body->getLength(), 1024 * 1024);
+
+echo "Done\n";
+
+?>
+--EXPECT--
+Done
@@ -0,0 +1,71 @@
+--TEST--
+swow_socket: TCP cork
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Socket;
+use Swow\SocketException;
+
+$server = (new Socket(Socket::TYPE_TCP))->bind('127.0.0.1')->listen();
+$client = (new Socket(Socket::TYPE_TCP))->connect($server->getSockAddress(), $server->getSockPort());
+$connection = $server->accept();
+
+try {
+    $client->cork(-1);
+} catch (ValueError $exception) {
+    echo $exception->getMessage() . PHP_EOL;
+}
+try {
+    (new Socket(Socket::TYPE_UDP))->cork();
+} catch (SocketException $exception) {
+    echo $exception->getMessage() . PHP_EOL;
+}
+
+/* auto flush when we yield */
+Assert::false($client->isCorked());
+$client->cork();
+Assert::true($client->isCorked());
+$client->send('Hello ');
+$client->write([['World'], ['!']]);
+Assert::same($connection->recvString(), 'Hello World!');
+
+/* flush when buffer reaches the threshold */
+$client->cork(8, false);
+$client->send('aaaa');
+usleep(1000);
+$client->send('bbbb');
+Assert::same($connection->recvString(), 'aaaabbbb');
+
+/* flush on uncork */
+$client->send('x');
+$client->uncork();
+Assert::false($client->isCorked());
+Assert::same($connection->recvString(), 'x');
+
+/* error of auto flush is reported by the following writes and close */
+$connection->close();
+usleep(1000);
+$client->send('x');
+usleep(1000);
+$client->cork();
+$client->send('y');
+/* flush fails in the next round of event loop, and its callback is called in the round after it */
+usleep(1000);
+usleep(1000);
+Assert::throws(static function () use ($client): void {
+    $client->send('z');
+}, SocketException::class, expectMessage: '/Socket cork flush failed/');
+Assert::false($client->close());
+
+echo "Done\n";
+
+?>
+--EXPECT--
+Swow\Socket::cork(): Argument #1 ($threshold) can not be negative
+Socket cork only supports stream sockets
+Done
@@ -0,0 +1,50 @@
+--TEST--
+swow_socket: corked data is flushed on close
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Coroutine;
+use Swow\Socket;
+
+$server = (new Socket(Socket::TYPE_TCP))->bind('127.0.0.1')->listen();
+
+/* small response which is still in the cork buffer */
+$client = (new Socket(Socket::TYPE_TCP))->connect($server->getSockAddress(), $server->getSockPort());
+$connection = $server->accept();
+$client->cork();
+$client->send("HTTP/1.1 200 OK\r\n");
+$client->send("Content-Length: 0\r\n\r\n");
+Assert::true($client->close());
+Assert::same($connection->readString(38), "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n");
+Assert::same($connection->recvString(), '');
+$connection->close();
+
+/* large one which can not be written at once */
+$client = (new Socket(Socket::TYPE_TCP))->connect($server->getSockAddress(), $server->getSockPort());
+$connection = $server->accept();
+$data = str_repeat('x', 4 * 1024 * 1024);
+$client->cork(strlen($data) * 2, false);
+$client->send($data);
+$received = '';
+$reader = Coroutine::run(static function () use ($connection, &$received): void {
+    while (($chunk = $connection->recvString()) !== '') {
+        $received .= $chunk;
+    }
+});
+Assert::true($client->close());
+while ($reader->isAvailable()) {
+    usleep(1000);
+}
+Assert::same(strlen($received), strlen($data));
+$connection->close();
+
+echo "Done\n";
+
+?>
+--EXPECT--
+Done
@@ -0,0 +1,59 @@
+--TEST--
+swow_socket: TCP zerocopy
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+skip_linux_only();
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Buffer;
+use Swow\Coroutine;
+use Swow\Socket;
+use Swow\SocketException;
+use Swow\Sync\WaitReference;
+
+$server = (new Socket(Socket::TYPE_TCP))->bind('127.0.0.1')->listen();
+$client = (new Socket(Socket::TYPE_TCP))->connect($server->getSockAddress(), $server->getSockPort());
+$connection = $server->accept();
+
+try {
+    $client->setTcpZeroCopyThreshold(-1);
+} catch (ValueError $exception) {
+    echo $exception->getMessage() . PHP_EOL;
+}
+try {
+    $client->setTcpZeroCopyThreshold(64 * 1024);
+} catch (SocketException) {
+    /* kernel does not support SO_ZEROCOPY, writes still work by copying */
+}
+
+$payload = getRandomBytes(8 * 1024 * 1024);
+$buffer = new Buffer(strlen($payload));
+$buffer->append($payload);
+
+$wr = new WaitReference();
+Coroutine::run(static function () use ($connection, $payload, $wr): void {
+    usleep(10 * 1000);
+    Assert::same($connection->readString(4), 'HEAD');
+    Assert::same($connection->readString(strlen($payload)), $payload);
+    Assert::same($connection->readString(strlen($payload)), $payload);
+    Assert::same($connection->readString(4), 'TAIL');
+});
+$client->send('HEAD');
+$client->send($buffer);
+$client->write([[$payload], ['TAIL']]);
+WaitReference::wait($wr);
+Assert::same($buffer->toString(), $payload);
+
+$client->setTcpZeroCopyThreshold(0);
+Assert::same($client->getTcpZeroCopyThreshold(), 0);
+
+echo "Done\n";
+
+?>
+--EXPECT--
+Swow\Socket::setTcpZeroCopyThreshold(): Argument #1 ($threshold) can not be negative
+Done
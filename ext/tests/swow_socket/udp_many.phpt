@@ -0,0 +1,85 @@
+--TEST--
+swow_socket: udp recvMany and sendMany
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Coroutine;
+use Swow\Errno;
+use Swow\Socket;
+use Swow\SocketException;
+use Swow\Sync\WaitReference;
+
+$server = (new Socket(Socket::TYPE_UDP))->bind('127.0.0.1');
+$client = (new Socket(Socket::TYPE_UDP))->bind('127.0.0.1');
+
+$wr = new WaitReference();
+Coroutine::run(static function () use ($server, $client, $wr): void {
+    $received = [];
+    while (count($received) < TEST_MAX_REQUESTS + 1) {
+        foreach ($server->recvMany(64, 8192, 1000) as [$data, $address, $port]) {
+            Assert::same($address, $client->getSockAddress());
+            Assert::same($port, $client->getSockPort());
+            $received[] = $data;
+        }
+    }
+    Assert::same($received, array_merge(array_map('strval', range(0, TEST_MAX_REQUESTS - 1)), ['connected']));
+    echo "Received\n";
+});
+
+$datagrams = [];
+for ($i = 0; $i < TEST_MAX_REQUESTS; $i++) {
+    $datagrams[] = [(string) $i, $server->getSockAddress(), $server->getSockPort()];
+}
+Assert::same($client->sendMany($datagrams), TEST_MAX_REQUESTS);
+$client->connect($server->getSockAddress(), $server->getSockPort());
+Assert::same($client->sendMany(['connected']), 1);
+Assert::same($client->sendMany([]), 0);
+WaitReference::wait($wr);
+
+try {
+    $server->recvMany(timeout: 10);
+    echo "Never here\n";
+} catch (SocketException $exception) {
+    Assert::same($exception->getCode(), Errno::ETIMEDOUT);
+    Assert::same($exception->getReturnValue(), []);
+    echo "Timedout\n";
+}
+
+try {
+    $client->sendMany([['data', 'not-an-ip', 1234]]);
+    echo "Never here\n";
+} catch (SocketException) {
+    echo "Invalid address\n";
+}
+
+try {
+    $server->recvMany(0);
+    echo "Never here\n";
+} catch (ValueError $error) {
+    echo $error->getMessage(), "\n";
+}
+
+$tcpServer = (new Socket(Socket::TYPE_TCP))->bind('127.0.0.1')->listen();
+$tcp = (new Socket(Socket::TYPE_TCP))->connect($tcpServer->getSockAddress(), $tcpServer->getSockPort());
+try {
+    $tcp->recvMany(timeout: 0);
+    echo "Never here\n";
+} catch (SocketException $exception) {
+    Assert::same($exception->getCode(), Errno::EMISUSE);
+    echo "Stream socket\n";
+}
+
+echo "Done\n";
+?>
+--EXPECT--
+Received
+Timedout
+Invalid address
+Swow\Socket::recvMany(): Argument #1 ($count) must be greater than 0 and less than or equal to 65535
+Stream socket
+Done
@@ -0,0 +1,76 @@
+--TEST--
+swow_thread: run closures in threads and communicate through thread channel
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+skip_if(!PHP_ZTS, 'ZTS is required');
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\Channel;
+use Swow\Coroutine;
+use Swow\Thread;
+use Swow\ThreadException;
+
+$thread = new Thread(static function (int $a, int $b): int {
+    return $a + $b;
+}, 1, 2);
+Assert::greaterThan($thread->getId(), 0);
+Assert::same($thread->join(), 3);
+Assert::false($thread->isRunning());
+
+$requests = new Thread\Channel(4);
+$responses = new Thread\Channel(4);
+$workers = [];
+for ($n = 0; $n < 2; $n++) {
+    $workers[] = new Thread(static function (Thread\Channel $requests, Thread\Channel $responses): int {
+        $handled = 0;
+        while (true) {
+            try {
+                $value = $requests->pop();
+            } catch (Swow\ChannelException) {
+                break;
+            }
+            $responses->push($value * 2);
+            $handled++;
+        }
+        return $handled;
+    }, $requests, $responses);
+}
+$sum = 0;
+$consumer = Coroutine::run(static function () use ($responses, &$sum): void {
+    for ($n = 0; $n < TEST_MAX_REQUESTS; $n++) {
+        $sum += $responses->pop();
+    }
+});
+for ($n = 0; $n < TEST_MAX_REQUESTS; $n++) {
+    $requests->push($n);
+}
+$requests->close();
+$handled = 0;
+foreach ($workers as $worker) {
+    $handled += $worker->join();
+}
+Assert::same($handled, TEST_MAX_REQUESTS);
+while ($consumer->isAvailable()) {
+    usleep(1000);
+}
+Assert::same($sum, TEST_MAX_REQUESTS * (TEST_MAX_REQUESTS - 1));
+
+$thread = new Thread(static function (): void {
+    throw new Exception('in thread');
+});
+try {
+    $thread->join();
+    echo "Never here\n";
+} catch (ThreadException $exception) {
+    Assert::same($exception->getCode(), 255);
+}
+
+echo "Done\n";
+?>
+--EXPECTF--
+%AFatal error: Uncaught Exception: in thread%A
+Done
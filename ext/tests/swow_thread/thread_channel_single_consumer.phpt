@@ -0,0 +1,66 @@
+--TEST--
+swow_thread: single consumer thread channel
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.php';
+skip_if(!PHP_ZTS, 'ZTS is required');
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swow\ChannelException;
+use Swow\Coroutine;
+use Swow\Sync\WaitGroup;
+use Swow\Thread;
+
+$channel = new Thread\Channel(8, Thread\Channel::FLAG_SINGLE_CONSUMER);
+
+$producers = [];
+for ($n = 0; $n < 4; $n++) {
+    $producers[] = new Thread(static function (Thread\Channel $channel, int $count): void {
+        for ($i = 0; $i < $count; $i++) {
+            $channel->push($i);
+        }
+    }, $channel, TEST_MAX_REQUESTS);
+}
+
+$sum = 0;
+$wg = new WaitGroup();
+for ($n = 0; $n < 2; $n++) {
+    $wg->add();
+    Coroutine::run(static function () use ($channel, &$sum, $wg): void {
+        try {
+            while (true) {
+                $sum += $channel->pop();
+            }
+        } catch (ChannelException) {
+        } finally {
+            $wg->done();
+        }
+    });
+}
+foreach ($producers as $producer) {
+    $producer->join();
+}
+$channel->close();
+$wg->wait();
+Assert::same($sum, 4 * TEST_MAX_REQUESTS * (TEST_MAX_REQUESTS - 1) / 2);
+
+/* only the thread which created it can pop */
+$channel = new Thread\Channel(1, Thread\Channel::FLAG_SINGLE_CONSUMER);
+$thread = new Thread(static function (Thread\Channel $channel): string {
+    try {
+        $channel->pop(0);
+    } catch (ChannelException $exception) {
+        return $exception->getMessage();
+    }
+    return 'Never here';
+}, $channel);
+var_dump($thread->join());
+
+echo "Done\n";
+?>
+--EXPECT--
+string(57) "Channel can only be popped in the thread which created it"
+Done
@@ -29,10 +29,8 @@ use ValueError;
 
 use function array_filter;
 use function array_map;
-use function count;
 use function explode;
 use function fopen;
-use function fwrite;
 use function implode;
 use function in_array;
 use function parse_str;
@@ -40,12 +38,8 @@ use function sprintf;
 use function strcasecmp;
 use function strtolower;
 use function sys_get_temp_dir;
-use function tempnam;
 use function trim;
 
-use const UPLOAD_ERR_CANT_WRITE;
-use const UPLOAD_ERR_OK;
-
 /**
  * http response / request receiver
  *
@@ -155,6 +149,9 @@ trait ReceiverTrait
         $messageEntity = $isServerRequest ? new ServerRequestEntity() : new ResponseEntity();
         $maxHeaderLength = $this->getMaxHeaderLength();
         $maxContentLength = $this->getMaxContentLength();
+        $parser
+            ->setMaxUploadedFileSize($this->getMaxUploadedFileSize())
+            ->setMaxUploadedFilesSize($this->getMaxUploadedFilesSize());
 
         /* Socket IO related values {{{ */
         $expectMoreData = $parsedOffset === $buffer->getLength();
@@ -166,7 +163,6 @@ trait ReceiverTrait
         /* }}} */
         /* HTTP related values {{{ */
         $uriOrReasonPhrase = '';
-        $headerName = '';
         $formDataName = '';
         $fileName = '';
         /** @var array<string, array<string>> */
@@ -175,7 +171,6 @@ trait ReceiverTrait
         $headerNames = [];
         $shouldKeepAlive = false;
         $contentLength = 0;
-        $headerLength = 0;
         $headersCompleted = false;
         $isChunked = false;
         $currentChunkLength = 0;
@@ -186,15 +181,69 @@ trait ReceiverTrait
         $multiPartHeadersCompleted = false;
         $multipartHeaderName = '';
         $multipartHeaders = [];
-        $tmpName = '';
-        $tmpFile = null;
-        $tmpFileSize = 0;
-        $fileError = UPLOAD_ERR_OK;
         $formData = [];
         $uploadedFiles = [];
         /* }}} */
         try {
+            /* the start-line and headers (and the body if all of it has been received) are parsed at once */
             while (true) {
+                if ($expectMoreData) {
+                    $this->recvData($buffer, $buffer->getLength());
+                    /** @noinspection PhpUnusedLocalVariableInspection (on the safe-side) */
+                    $expectMoreData = false;
+                }
+                try {
+                    $message = $parser->parseMessage($buffer, $parsedOffset, $maxHeaderLength, $maxContentLength);
+                } catch (ParserException $parserException) {
+                    $statusCode = $parserException->getCode();
+                    if (in_array($statusCode, [HttpStatus::REQUEST_URI_TOO_LARGE, HttpStatus::REQUEST_HEADER_FIELDS_TOO_LARGE, HttpStatus::REQUEST_ENTITY_TOO_LARGE], true)) {
+                        throw new ProtocolException($statusCode);
+                    }
+                    throw $parserException;
+                }
+                if ($message !== null) {
+                    break;
+                }
+                $buffer->truncateFrom($parsedOffset);
+                if ($buffer->isFull()) {
+                    throw new ParserException('Buffer is full and unable to continue parsing');
+                }
+                $parsedOffset = 0;
+                $expectMoreData = true;
+            }
+            $headersCompleted = true;
+            $uriOrReasonPhrase = $message['uri'] ?? $message['reasonPhrase'];
+            $headers = $message['headers'];
+            $headerNames = $message['headerNames'];
+            $shouldKeepAlive = $message['shouldKeepAlive'];
+            $contentLength = $message['contentLength'];
+            $isChunked = $message['isChunked'];
+            $isMultipart = $message['isMultipart'];
+            $parsedOffset += $message['parsedLength'];
+            if ($message['completed'] && $message['bodyLength'] > 0) {
+                $body = new Buffer($contentLength);
+                $body->append($buffer, $message['bodyOffset'], $message['bodyLength']);
+            }
+            if ($isMultipart && $this->preserveBodyData) {
+                $body = new Buffer($contentLength);
+                $unparsedLength = $buffer->getLength() - $parsedOffset;
+                if ($contentLength < $unparsedLength) {
+                    $body->append($buffer, $parsedOffset, $contentLength);
+                } else {
+                    $body->append($buffer, $parsedOffset, $unparsedLength);
+                    $neededLength = $contentLength - $unparsedLength;
+                    if ($neededLength > 0) {
+                        $this->read($body, $unparsedLength, $neededLength);
+                    }
+                }
+                // Notice: There may be some risks associated with doing so,
+                // but it's the easiest way...
+                $buffer = $body;
+                $parsedOffset = 0;
+            }
+            /* the rest of the message is parsed event by event */
+            $event = HttpParser::EVENT_HEADERS_COMPLETE;
+            while (!$message['completed']) {
                 if ($expectMoreData) {
                     $this->recvData($buffer, $buffer->getLength());
                     /** @noinspection PhpUnusedLocalVariableInspection (on the safe-side) */
@@ -209,16 +258,10 @@ trait ReceiverTrait
                     if ($event & HttpParser::EVENT_FLAG_DATA) {
                         $dataOffset = $parser->getDataOffset();
                         $dataLength = $parser->getDataLength();
-                        if (!$headersCompleted || ($isMultipart && !$multiPartHeadersCompleted)) {
+                        if ($isMultipart && !$multiPartHeadersCompleted) {
                             $data = $buffer->read($dataOffset, $dataLength);
                         }
                     }
-                    if (!$headersCompleted) {
-                        $headerLength += $parsedLength;
-                        if ($headerLength > $maxHeaderLength) {
-                            throw new ProtocolException(empty($headerName) ? HttpStatus::REQUEST_URI_TOO_LARGE : HttpStatus::REQUEST_HEADER_FIELDS_TOO_LARGE);
-                        }
-                    }
                     if ($event === HttpParser::EVENT_NONE) {
                         $buffer->truncateFrom($parsedOffset);
                         if ($buffer->isFull()) {
@@ -250,73 +293,7 @@ trait ReceiverTrait
                         }
                         break 2;
                     }
-                    if (!$headersCompleted) {
-                        switch ($event) {
-                            case HttpParser::EVENT_HEADER_FIELD:
-                                {
-                                    if ($event !== $previousEvent) {
-                                        $headerName = $data;
-                                    } else {
-                                        $headerName .= $data;
-                                    }
-                                    break;
-                                }
-                            case HttpParser::EVENT_HEADER_VALUE:
-                                {
-                                    if ($event !== $previousEvent) {
-                                        $headers[$headerName][] = $data;
-                                        $headerNames[strtolower($headerName)] = $headerName;
-                                    } else {
-                                        $headers[$headerName][count($headers[$headerName]) - 1] .= $data;
-                                    }
-                                    break;
-                                }
-                            case HttpParser::EVENT_URL:
-                            case HttpParser::EVENT_STATUS:
-                                {
-                                    if ($event !== $previousEvent) {
-                                        $uriOrReasonPhrase = $data;
-                                    } else {
-                                        $uriOrReasonPhrase .= $data;
-                                    }
-                                    break;
-                                }
-                            case HttpParser::EVENT_HEADERS_COMPLETE:
-                                {
-                                    $headersCompleted = true;
-                                    $shouldKeepAlive = $parser->shouldKeepAlive();
-                                    if ($parser->isChunked()) {
-                                        $isChunked = true;
-                                    } else {
-                                        $contentLength = $parser->getContentLength();
-                                        if ($contentLength > $maxContentLength) {
-                                            throw new ProtocolException(HttpStatus::REQUEST_ENTITY_TOO_LARGE);
-                                        }
-                                    }
-                                    if ($parser->isMultipart()) {
-                                        $isMultipart = true;
-                                        if ($this->preserveBodyData) {
-                                            $body = new Buffer($contentLength);
-                                            $unparsedLength = $buffer->getLength() - $parsedOffset;
-                                            if ($contentLength < $parsedLength) {
-                                                $body->append($buffer, $parsedOffset, $contentLength);
-                                            } else {
-                                                $body->append($buffer, $parsedOffset, $unparsedLength);
-                                                $neededLength = $contentLength - $unparsedLength;
-                                                if ($neededLength > 0) {
-                                                    $this->read($body, $unparsedLength, $neededLength);
-                                                }
-                                            }
-                                            // Notice: There may be some risks associated with doing so,
-                                            // but it's the easiest way...
-                                            $buffer = $body;
-                                            $parsedOffset = 0;
-                                        }
-                                    }
-                                    break;
-                                }
-                        }
-                    } elseif ($isMultipart) {
+                    if ($isMultipart) {
                         switch ($event) {
                             case HttpParser::EVENT_MULTIPART_HEADER_FIELD:
                                 {
@@ -361,8 +338,8 @@ trait ReceiverTrait
 
                                     if ($fileName) {
                                         // TODO: make dir and prefix configurable
-                                        $tmpName = tempnam(sys_get_temp_dir(), 'swow_uploaded_file_');
-                                        $tmpFile = fopen($tmpName, 'rwb+');
+                                        // body data of the file is written to disk by the parser, we won't see it
+                                        $parser->startUploadedFile(sys_get_temp_dir());
                                     } else {
                                         // TODO: not hard code here?
                                         $formDataValue = new Buffer(256);
@@ -371,24 +348,7 @@ trait ReceiverTrait
                                 }
                             case HttpParser::EVENT_MULTIPART_BODY:
                                 {
-                                    if (isset($formDataValue)) {
-                                        $formDataValue->append($buffer, $dataOffset, $dataLength);
-                                    } else {
-                                        if ($fileError !== UPLOAD_ERR_OK) {
-                                            break;
-                                        }
-                                        if ($dataOffset === 0) {
-                                            $nWrite = fwrite($tmpFile, $buffer->toString(), $dataLength);
-                                        } else {
-                                            // TODO: maybe we should have something like fwrite_ex() to gain more performance?
-                                            $nWrite = fwrite($tmpFile, $buffer->read($dataOffset, $dataLength));
-                                        }
-                                        if ($nWrite !== $dataLength) {
-                                            $fileError = UPLOAD_ERR_CANT_WRITE;
-                                        } else {
-                                            $tmpFileSize += $nWrite;
-                                        }
-                                    }
+                                    $formDataValue->append($buffer, $dataOffset, $dataLength);
                                     break;
                                 }
                             case HttpParser::EVENT_MULTIPART_DATA_END:
@@ -399,19 +359,16 @@ trait ReceiverTrait
                                         $formDataName = '';
                                         $formDataValue = null;
                                     } else {
+                                        $uploadedFileInfo = $parser->finishUploadedFile();
                                         $uploadedFile = new UploadedFileEntity();
                                         $uploadedFile->name = $fileName;
                                         $uploadedFile->type = $multipartHeaders['content-type'] ?? MimeType::TXT;
-                                        $uploadedFile->tmpName = $tmpName;
-                                        $uploadedFile->tmpFile = $tmpFile;
-                                        $uploadedFile->error = $fileError;
-                                        $uploadedFile->size = $tmpFileSize;
+                                        $uploadedFile->tmpName = $uploadedFileInfo['tmpName'];
+                                        // the temp file has been removed by the parser if the upload failed
+                                        $uploadedFile->tmpFile = fopen($uploadedFileInfo['tmpName'] ?: 'php://memory', 'r+b');
+                                        $uploadedFile->error = $uploadedFileInfo['error'];
+                                        $uploadedFile->size = $uploadedFileInfo['size'];
                                         $uploadedFiles[$formDataName] = $uploadedFile;
-                                        // reset for the next parts
-                                        $tmpName = '';
-                                        $tmpFile = null;
-                                        $tmpFileSize = 0;
-                                        $fileError = UPLOAD_ERR_OK;
                                     }
                                     // reset for the next parts
                                     $multiPartHeadersCompleted = false;
@@ -515,6 +472,10 @@ trait ReceiverTrait
         } catch (ParserException $parserException) {
             /* Note: Connection should be reset, it's an unrecoverable error. */
             $shouldKeepAlive = false;
+            if ($parserException->getCode() === HttpStatus::REQUEST_ENTITY_TOO_LARGE) {
+                /* uploaded files exceed the limit */
+                throw new ProtocolException(HttpStatus::REQUEST_ENTITY_TOO_LARGE, previous: $parserException);
+            }
             throw new ProtocolException(HttpStatus::BAD_REQUEST, 'Protocol Parsing Error', $parserException);
         } catch (SocketException $socketException) {
             $shouldKeepAlive = false;
@@ -19,6 +19,10 @@ trait LimitationTrait
 
     protected int $maxContentLength = 8 * 1024 * 1024;
 
+    protected int $maxUploadedFileSize = -1;
+
+    protected int $maxUploadedFilesSize = -1;
+
     public function getMaxHeaderLength(): int
     {
         return $this->maxHeaderLength;
@@ -44,4 +48,30 @@ trait LimitationTrait
 
         return $this;
     }
+
+    public function getMaxUploadedFileSize(): int
+    {
+        return $this->maxUploadedFileSize;
+    }
+
+    /** @return $this */
+    public function setMaxUploadedFileSize(int $maxUploadedFileSize): static
+    {
+        $this->maxUploadedFileSize = $maxUploadedFileSize;
+
+        return $this;
+    }
+
+    public function getMaxUploadedFilesSize(): int
+    {
+        return $this->maxUploadedFilesSize;
+    }
+
+    /** @return $this */
+    public function setMaxUploadedFilesSize(int $maxUploadedFilesSize): static
+    {
+        $this->maxUploadedFilesSize = $maxUploadedFilesSize;
+
+        return $this;
+    }
 }
@@ -18,7 +18,6 @@ use Psr\Http\Message\ResponseInterface;
 use Psr\Http\Message\ServerRequestInterface;
 use Stringable;
 use Swow\Errno;
-use Swow\Http\Http;
 use Swow\Http\Message\ServerRequestEntity;
 use Swow\Http\Parser as HttpParser;
 use Swow\Http\Protocol\ProtocolException;
@@ -105,6 +104,16 @@ class ServerConnection extends Socket implements ProtocolTypeInterface
         return $this->getServer()->getMaxContentLength();
     }
 
+    public function getMaxUploadedFileSize(): int
+    {
+        return $this->getServer()->getMaxUploadedFileSize();
+    }
+
+    public function getMaxUploadedFilesSize(): int
+    {
+        return $this->getServer()->getMaxUploadedFilesSize();
+    }
+
     public function recvServerRequestEntity(): ServerRequestEntity
     {
         return $this->recvMessageEntity();
@@ -166,13 +175,7 @@ class ServerConnection extends Socket implements ProtocolTypeInterface
                     }
                 }
                 $headers += $this->generateResponseHeaders($body, $close);
-                $this->write([
-                    Http::packResponse(
-                        statusCode: $statusCode,
-                        headers: $headers
-                    ),
-                    $body,
-                ]);
+                $this->sendResponse($statusCode, $headers, $body);
                 break;
             case static::PROTOCOL_TYPE_WEBSOCKET:
                 // TODO: impl
@@ -188,13 +191,7 @@ class ServerConnection extends Socket implements ProtocolTypeInterface
                     $message = HttpStatus::getReasonPhraseOf($statusCode);
                 }
                 $message = "<html lang=\"en\"><body><h2>HTTP {$statusCode} {$message}</h2><hr><i>Powered by Swow</i></body></html>";
-                $this->write([
-                    Http::packResponse(
-                        statusCode: $statusCode,
-                        headers: $this->generateResponseHeaders($message, $close)
-                    ),
-                    $message,
-                ]);
+                $this->sendResponse($statusCode, $this->generateResponseHeaders($message, $close), $message);
                 break;
             case static::PROTOCOL_TYPE_WEBSOCKET:
                 // TODO: impl
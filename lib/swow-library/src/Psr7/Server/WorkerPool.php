@@ -0,0 +1,493 @@
+<?php
+/**
+ * This file is part of Swow
+ *
+ * @link    https://github.com/swow/swow
+ * @contact twosee <twosee@php.net>
+ *
+ * For the full copyright and license information,
+ * please view the LICENSE file that was distributed with this source code
+ */
+
+declare(strict_types=1);
+
+namespace Swow\Psr7\Server;
+
+use Closure;
+use RuntimeException;
+use Swow\Channel;
+use Swow\ChannelException;
+use Swow\Coroutine;
+use Swow\Errno;
+use Swow\Signal;
+use Swow\SignalException;
+use Swow\Socket;
+use ValueError;
+
+use function array_values;
+use function function_exists;
+use function hrtime;
+use function iterator_count;
+use function max;
+use function min;
+use function pcntl_fork;
+use function pcntl_waitpid;
+use function pcntl_wexitstatus;
+use function pcntl_wifexited;
+use function pcntl_wifsignaled;
+use function sprintf;
+use function usleep;
+
+use const WNOHANG;
+
+/**
+ * Forks a fixed number of worker processes which all listen on the same address with SO_REUSEPORT,
+ * the kernel balances incoming connections between them.
+ *
+ * The master process restarts workers which crash (exit with a non-zero status or are killed by a signal),
+ * workers which exit with status 0 are done and run() returns when all of them are done,
+ * reloads all workers one by one on SIGHUP (a new worker is started before the old one is stopped,
+ * so the address always has a listener) and stops all workers on SIGTERM or SIGINT.
+ * Workers stop accepting on SIGTERM and exit after their connections are closed or the graceful timeout expires.
+ *
+ * Child processes are reaped with pcntl_waitpid(), so do not use proc_open() in the master process.
+ */
+class WorkerPool
+{
+    public const DEFAULT_GRACEFUL_TIMEOUT = 5000;
+
+    public const DEFAULT_RESTART_DELAY = 1000;
+
+    protected const EVENT_WAKEUP = 0;
+    protected const EVENT_RELOAD = 1;
+    protected const EVENT_STOP = 2;
+
+    /** @var Closure(Server, int): mixed */
+    protected Closure $handler;
+
+    protected int $gracefulTimeout = self::DEFAULT_GRACEFUL_TIMEOUT;
+
+    protected int $restartDelay = self::DEFAULT_RESTART_DELAY;
+
+    protected bool $running = false;
+
+    protected Channel $events;
+
+    /** @var array<int, int> worker id => pid */
+    protected array $workers = [];
+
+    /** @var array<int, int> worker id => start time in nanoseconds */
+    protected array $startTimes = [];
+
+    /** @var array<int, int> worker id => time in nanoseconds when it should be restarted */
+    protected array $pendingRestarts = [];
+
+    /** @var array<int, int> worker id => time in nanoseconds when its reloading should be retried */
+    protected array $pendingReloads = [];
+
+    /** @var array<int, Channel> pid => channel to receive the exit status */
+    protected array $exitWaiters = [];
+
+    /** @var array<int, Coroutine> */
+    protected array $watchers = [];
+
+    /**
+     * @param Closure(Server $server, int $workerId): mixed $handler
+     * runs in every worker, it is expected to accept connections until the server is closed
+     */
+    public function __construct(
+        Closure $handler,
+        protected int $workerCount,
+        protected string $host,
+        protected int $port,
+        protected int $backlog = Socket::DEFAULT_BACKLOG,
+    ) {
+        if ($workerCount <= 0) {
+            throw new ValueError(sprintf('%s(): Argument#2 ($workerCount) must be greater than 0', __METHOD__));
+        }
+        $this->handler = $handler;
+        $this->events = new Channel(1);
+    }
+
+    public function getWorkerCount(): int
+    {
+        return $this->workerCount;
+    }
+
+    public function getGracefulTimeout(): int
+    {
+        return $this->gracefulTimeout;
+    }
+
+    /** @param int $timeout in milliseconds, -1 means waiting for connections forever */
+    public function setGracefulTimeout(int $timeout): static
+    {
+        $this->gracefulTimeout = $timeout;
+
+        return $this;
+    }
+
+    public function getRestartDelay(): int
+    {
+        return $this->restartDelay;
+    }
+
+    /** @param int $delay in milliseconds, workers which crashed within this delay after starting are restarted after it */
+    public function setRestartDelay(int $delay): static
+    {
+        $this->restartDelay = max(0, $delay);
+
+        return $this;
+    }
+
+    /** @return array<int, int> worker id => pid */
+    public function getWorkerPids(): array
+    {
+        return $this->workers;
+    }
+
+    public function isRunning(): bool
+    {
+        return $this->running;
+    }
+
+    /**
+     * Starts all workers and supervises them until stop() is called, SIGTERM/SIGINT is received or all workers are done.
+     * It must be called in the main coroutine and never returns in worker processes,
+     * other coroutines are killed in workers after fork.
+     */
+    public function run(): void
+    {
+        if (!function_exists('pcntl_fork')) {
+            throw new RuntimeException('WorkerPool requires ext-pcntl');
+        }
+        if ($this->running) {
+            throw new RuntimeException('WorkerPool is already running');
+        }
+        if (Coroutine::getCurrent() !== Coroutine::getMain()) {
+            /* workers exit() when they are done, it only works in the main coroutine */
+            throw new RuntimeException('WorkerPool can only be run in the main coroutine');
+        }
+        $this->running = true;
+        $this->startWatchers();
+        try {
+            for ($workerId = 0; $workerId < $this->workerCount; $workerId++) {
+                $this->startWorker($workerId);
+            }
+            while ($this->workers || $this->pendingRestarts) {
+                switch ($this->waitEvent()) {
+                    case static::EVENT_WAKEUP:
+                        $this->restartPendingWorkers();
+                        break;
+                    case static::EVENT_RELOAD:
+                        $this->reloadWorkers();
+                        break;
+                    case static::EVENT_STOP:
+                        /* no more restarts from now on */
+                        $this->running = false;
+                        $this->stopWorkers();
+                        return;
+                }
+            }
+        } finally {
+            $this->running = false;
+            $this->stopWatchers();
+            /* e.g. stop() was called while the last worker was exiting */
+            while ($this->events->getLength() > 0) {
+                $this->events->pop(0);
+            }
+        }
+    }
+
+    /** Asks the master to restart all workers one by one */
+    public function reload(): void
+    {
+        if ($this->running) {
+            $this->events->push(static::EVENT_RELOAD);
+        }
+    }
+
+    /** Asks the master to stop all workers and return from run() */
+    public function stop(): void
+    {
+        if ($this->running) {
+            $this->events->push(static::EVENT_STOP);
+        }
+    }
+
+    /** Creates the listening server of a worker, it can be overridden to configure the server */
+    protected function createServer(int $workerId): Server
+    {
+        $server = new Server();
+        $server->setTcpAcceptBalance(true);
+        $server
+            ->bind($this->host, $this->port, Server::BIND_FLAG_REUSEPORT)
+            ->listen($this->backlog);
+
+        return $server;
+    }
+
+    protected function startWorker(int $workerId): void
+    {
+        unset($this->pendingRestarts[$workerId]);
+        if (!$this->forkWorker($workerId)) {
+            /* try again later */
+            $this->pendingRestarts[$workerId] = hrtime(true) + $this->restartDelay * 1000000;
+        }
+    }
+
+    /** Returns false if fork failed, the previous worker (if any) is left as it is */
+    protected function forkWorker(int $workerId): bool
+    {
+        $pid = $this->fork();
+        if ($pid < 0) {
+            return false;
+        }
+        if ($pid === 0) {
+            exit($this->runWorker($workerId));
+        }
+        $this->workers[$workerId] = $pid;
+        $this->startTimes[$workerId] = hrtime(true);
+
+        return true;
+    }
+
+    protected function fork(): int
+    {
+        return pcntl_fork();
+    }
+
+    protected function runWorker(int $workerId): int
+    {
+        /* coroutines and master state are inherited by fork, they do not belong to this process */
+        $this->running = false;
+        $this->workers = $this->startTimes = $this->pendingRestarts = $this->pendingReloads = $this->exitWaiters = [];
+        Coroutine::killAll();
+        $this->watchers = [];
+
+        $server = $this->createServer($workerId);
+        $terminator = Coroutine::run(static function () use ($server): void {
+            Signal::wait(Signal::TERM);
+            $server->close();
+        });
+        ($this->handler)($server, $workerId);
+        if ($terminator->isAvailable()) {
+            $terminator->kill();
+        }
+        if ($server->isAvailable()) {
+            $server->close();
+        }
+        $this->drainConnections($server);
+
+        return 0;
+    }
+
+    protected function drainConnections(Server $server): void
+    {
+        $deadline = $this->gracefulTimeout >= 0 ? hrtime(true) + $this->gracefulTimeout * 1000000 : null;
+        while (iterator_count($server->getConnections()) > 0) {
+            if ($deadline !== null && hrtime(true) >= $deadline) {
+                $server->closeConnections();
+                break;
+            }
+            usleep(10 * 1000);
+        }
+    }
+
+    /** The worker has finished its work, it is not restarted */
+    protected function handleExit(int $workerId): void
+    {
+        unset($this->workers[$workerId], $this->startTimes[$workerId], $this->pendingReloads[$workerId]);
+        /* let the master see whether all workers are done */
+        if (!$this->events->isFull()) {
+            $this->events->push(static::EVENT_WAKEUP);
+        }
+    }
+
+    protected function handleUnexpectedExit(int $workerId): void
+    {
+        $startTime = $this->startTimes[$workerId];
+        unset($this->workers[$workerId], $this->startTimes[$workerId], $this->pendingReloads[$workerId]);
+        if (!$this->running) {
+            return;
+        }
+        $restartTime = hrtime(true);
+        if ($restartTime - $startTime < $this->restartDelay * 1000000) {
+            /* avoid restarting a worker which keeps crashing in a busy loop */
+            $restartTime = $startTime + $this->restartDelay * 1000000;
+        }
+        $this->pendingRestarts[$workerId] = $restartTime;
+        /* workers are only forked by the master coroutine, the reaper must not block on it */
+        if (!$this->events->isFull()) {
+            $this->events->push(static::EVENT_WAKEUP);
+        }
+    }
+
+    protected function restartPendingWorkers(): void
+    {
+        $now = hrtime(true);
+        foreach ($this->pendingRestarts as $workerId => $restartTime) {
+            if ($restartTime <= $now) {
+                $this->startWorker($workerId);
+            }
+        }
+        foreach ($this->pendingReloads as $workerId => $reloadTime) {
+            if ($reloadTime <= $now && isset($this->workers[$workerId])) {
+                $this->reloadWorker($workerId, $this->workers[$workerId]);
+            }
+        }
+    }
+
+    protected function reloadWorkers(): void
+    {
+        foreach ($this->workers as $workerId => $pid) {
+            $this->reloadWorker($workerId, $pid);
+        }
+    }
+
+    /** The old worker is only terminated after the new one has been started, otherwise it keeps serving and reloading is retried later */
+    protected function reloadWorker(int $workerId, int $pid): void
+    {
+        unset($this->pendingReloads[$workerId]);
+        if (($this->workers[$workerId] ?? null) !== $pid) {
+            /* it has exited while we were waiting for the previous worker */
+            return;
+        }
+        $this->forkWorker($workerId);
+        if ($this->workers[$workerId] === $pid) {
+            $this->pendingReloads[$workerId] = hrtime(true) + $this->restartDelay * 1000000;
+            return;
+        }
+        $this->terminateWorker($pid);
+    }
+
+    protected function stopWorkers(): void
+    {
+        $this->pendingRestarts = $this->pendingReloads = [];
+        $pids = $this->workers;
+        $this->workers = $this->startTimes = [];
+        foreach ($pids as $pid) {
+            $this->exitWaiters[$pid] = new Channel(1);
+            $this->signalWorker($pid, Signal::TERM);
+        }
+        foreach ($pids as $pid) {
+            $this->waitWorker($pid);
+        }
+    }
+
+    /** Sends SIGTERM to the worker and waits for it to exit, it will be killed if it does not exit in time */
+    protected function terminateWorker(int $pid): void
+    {
+        $this->exitWaiters[$pid] = new Channel(1);
+        $this->signalWorker($pid, Signal::TERM);
+        $this->waitWorker($pid);
+    }
+
+    protected function waitWorker(int $pid): void
+    {
+        $channel = $this->exitWaiters[$pid];
+        try {
+            /* give workers a bit more time than they give to their connections */
+            $timeout = $this->gracefulTimeout >= 0 ? $this->gracefulTimeout + 1000 : -1;
+            try {
+                $channel->pop($timeout);
+            } catch (ChannelException $exception) {
+                if ($exception->getCode() !== Errno::ETIMEDOUT) {
+                    throw $exception;
+                }
+                $this->signalWorker($pid, Signal::KILL);
+                $channel->pop();
+            }
+        } finally {
+            unset($this->exitWaiters[$pid]);
+        }
+    }
+
+    protected function signalWorker(int $pid, int $signal): void
+    {
+        try {
+            Signal::kill($pid, $signal);
+        } catch (SignalException) {
+            /* it has already exited, the reaper will see it */
+        }
+    }
+
+    protected function waitEvent(): int
+    {
+        $timeout = -1;
+        $retryTimes = [...array_values($this->pendingRestarts), ...array_values($this->pendingReloads)];
+        if ($retryTimes) {
+            $timeout = max(0, (int) ((min($retryTimes) - hrtime(true)) / 1000000));
+        }
+        try {
+            return $this->events->pop($timeout);
+        } catch (ChannelException $exception) {
+            if ($exception->getCode() !== Errno::ETIMEDOUT) {
+                throw $exception;
+            }
+            return static::EVENT_WAKEUP;
+        }
+    }
+
+    protected function reap(): void
+    {
+        while (($pid = pcntl_waitpid(-1, $status, WNOHANG)) > 0) {
+            if (!pcntl_wifexited($status) && !pcntl_wifsignaled($status)) {
+                continue;
+            }
+            if (isset($this->exitWaiters[$pid])) {
+                $this->exitWaiters[$pid]->push($status);
+                continue;
+            }
+            foreach ($this->workers as $workerId => $workerPid) {
+                if ($workerPid === $pid) {
+                    if (pcntl_wifexited($status) && pcntl_wexitstatus($status) === 0) {
+                        $this->handleExit($workerId);
+                    } else {
+                        $this->handleUnexpectedExit($workerId);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    protected function startWatchers(): void
+    {
+        $this->watchers[] = Coroutine::run(function (): void {
+            while (true) {
+                try {
+                    /* SIGCHLD may come between two waits, so poll it periodically */
+                    Signal::wait(Signal::CHLD, 1000);
+                } catch (SignalException $exception) {
+                    if ($exception->getCode() !== Errno::ETIMEDOUT) {
+                        throw $exception;
+                    }
+                }
+                $this->reap();
+            }
+        });
+        $this->watchers[] = Coroutine::run(function (): void {
+            while (true) {
+                Signal::wait(Signal::HUP);
+                $this->events->push(static::EVENT_RELOAD);
+            }
+        });
+        foreach ([Signal::TERM, Signal::INT] as $signal) {
+            $this->watchers[] = Coroutine::run(function () use ($signal): void {
+                Signal::wait($signal);
+                $this->events->push(static::EVENT_STOP);
+            });
+        }
+    }
+
+    protected function stopWatchers(): void
+    {
+        foreach ($this->watchers as $watcher) {
+            if ($watcher->isAvailable()) {
+                $watcher->kill();
+            }
+        }
+        $this->watchers = [];
+    }
+}
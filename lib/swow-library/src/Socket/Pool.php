@@ -0,0 +1,399 @@
+<?php
+/**
+ * This file is part of Swow
+ *
+ * @link    https://github.com/swow/swow
+ * @contact twosee <twosee@php.net>
+ *
+ * For the full copyright and license information,
+ * please view the LICENSE file that was distributed with this source code
+ */
+
+declare(strict_types=1);
+
+namespace Swow\Socket;
+
+use Swow\Channel;
+use Swow\ChannelException;
+use Swow\Errno;
+use Swow\Socket;
+use Throwable;
+use ValueError;
+use WeakMap;
+use WeakReference;
+
+use function array_pop;
+use function array_search;
+use function array_shift;
+use function array_splice;
+use function count;
+use function hrtime;
+use function ksort;
+use function md5;
+use function serialize;
+use function sprintf;
+
+/**
+ * Keeps established outbound connections for reuse, connections are grouped by key (host, port and SSL options).
+ *
+ * Connections which are acquired should be given back by release(), the slot of a connection which is destroyed
+ * without being released is given back as well, but the connection is not reused. A connection is checked for liveness
+ * before it is reused, idle connections are closed after the idle timeout expires.
+ * At most maxPerKey connections are opened for one key, callers wait for a free connection in FIFO order.
+ */
+class Pool
+{
+    public const DEFAULT_MAX_PER_KEY = 64;
+
+    public const DEFAULT_IDLE_TIMEOUT = 60 * 1000;
+
+    /** @var array<string, array<int, array{0: Socket, 1: int}>> key => idle connections with the time they were released (in nanoseconds), the most recently released one is the last */
+    protected array $idle = [];
+
+    /** @var array<string, int> key => number of connections (idle and connecting ones included) */
+    protected array $counts = [];
+
+    /** @var array<string, array<int, Channel>> key => waiters in FIFO order */
+    protected array $waiters = [];
+
+    /** @var WeakMap<Socket, PoolSlot> acquired connection => its slot */
+    protected WeakMap $keys;
+
+    protected int $lastReapTime;
+
+    protected bool $closed = false;
+
+    /**
+     * @param int $maxPerKey max number of connections for one key
+     * @param int $idleTimeout in milliseconds, idle connections are closed after it expires, -1 means never
+     * @param int $type socket type of connections
+     */
+    public function __construct(
+        protected int $maxPerKey = self::DEFAULT_MAX_PER_KEY,
+        protected int $idleTimeout = self::DEFAULT_IDLE_TIMEOUT,
+        protected int $type = Socket::TYPE_TCP,
+    ) {
+        if ($maxPerKey <= 0) {
+            throw new ValueError(sprintf('%s(): Argument#1 ($maxPerKey) must be greater than 0', __METHOD__));
+        }
+        $this->keys = new WeakMap();
+        $this->lastReapTime = hrtime(true);
+    }
+
+    /** @param array<string, mixed>|null $sslOptions */
+    public static function makeKey(string $host, int $port, ?array $sslOptions = null): string
+    {
+        $key = "{$host}:{$port}";
+        if ($sslOptions !== null) {
+            ksort($sslOptions);
+            $key .= '#' . md5(serialize($sslOptions));
+        }
+
+        return $key;
+    }
+
+    public function getMaxPerKey(): int
+    {
+        return $this->maxPerKey;
+    }
+
+    public function getIdleTimeout(): int
+    {
+        return $this->idleTimeout;
+    }
+
+    public function isClosed(): bool
+    {
+        return $this->closed;
+    }
+
+    /** @return int number of connections of the key, or of all keys if key is null */
+    public function getConnectionCount(?string $key = null): int
+    {
+        if ($key !== null) {
+            return $this->counts[$key] ?? 0;
+        }
+        $count = 0;
+        foreach ($this->counts as $keyCount) {
+            $count += $keyCount;
+        }
+
+        return $count;
+    }
+
+    /** @return int number of idle connections of the key, or of all keys if key is null */
+    public function getIdleCount(?string $key = null): int
+    {
+        if ($key !== null) {
+            return count($this->idle[$key] ?? []);
+        }
+        $count = 0;
+        foreach ($this->idle as $idle) {
+            $count += count($idle);
+        }
+
+        return $count;
+    }
+
+    /** @return int number of coroutines which are waiting for a free connection of the key */
+    public function getWaiterCount(string $key): int
+    {
+        return count($this->waiters[$key] ?? []);
+    }
+
+    /**
+     * Get a connection to host:port, SSL is enabled with the given options if they are not null
+     * @param array<string, mixed>|null $sslOptions options of Socket::enableCrypto()
+     * @param int|null $timeout in milliseconds, time to wait for a free connection when the limit has been reached, null means forever
+     */
+    public function acquire(string $host, int $port = 0, ?array $sslOptions = null, ?int $timeout = null): Socket
+    {
+        if ($this->closed) {
+            throw new PoolException('Pool has been closed', Errno::ECANCELED);
+        }
+        $key = static::makeKey($host, $port, $sslOptions);
+        $this->reapIfNeeded();
+
+        $socket = $this->popIdle($key);
+        if ($socket !== null) {
+            return $socket;
+        }
+        if (($this->counts[$key] ?? 0) >= $this->maxPerKey) {
+            $socket = $this->wait($key, $timeout);
+            if ($socket !== null) {
+                return $socket;
+            }
+            /* we got the slot of a discarded connection */
+            if ($this->closed) {
+                $this->releaseSlot($key);
+                throw new PoolException('Pool has been closed', Errno::ECANCELED);
+            }
+        } else {
+            $this->counts[$key] = ($this->counts[$key] ?? 0) + 1;
+        }
+        try {
+            $socket = $this->connect($host, $port, $sslOptions);
+        } catch (Throwable $throwable) {
+            $this->releaseSlot($key);
+            throw $throwable;
+        }
+        $this->keys[$socket] = $this->createSlot($key);
+
+        return $socket;
+    }
+
+    /**
+     * Give back the connection which was acquired from this pool
+     * @param bool $reusable false means the connection is in an unknown state (e.g. a response was not read completely), it will be closed
+     */
+    public function release(Socket $socket, bool $reusable = true): static
+    {
+        $slot = $this->keys[$socket] ?? null;
+        if ($slot === null) {
+            throw new ValueError(sprintf('%s(): Argument#1 ($socket) was not acquired from this pool', __METHOD__));
+        }
+        $key = $slot->getKey();
+        if (!$reusable || $this->closed || !static::isAlive($socket)) {
+            $slot->disarm();
+            unset($this->keys[$socket]);
+            $this->discard($key, $socket);
+
+            return $this;
+        }
+        /* the slot goes with the connection */
+        $waiter = $this->shiftWaiter($key);
+        if ($waiter !== null) {
+            $waiter->push($socket);
+
+            return $this;
+        }
+        $slot->disarm();
+        unset($this->keys[$socket]);
+        $this->idle[$key][] = [$socket, hrtime(true)];
+
+        return $this;
+    }
+
+    /** @return int number of idle connections which were closed */
+    public function reap(): int
+    {
+        $this->lastReapTime = $now = hrtime(true);
+        $reaped = 0;
+        foreach ($this->idle as $key => $_) {
+            $reaped += $this->reapKey($key, $now);
+        }
+
+        return $reaped;
+    }
+
+    /** Close idle connections and wake up waiters, connections which are in use will be closed on release */
+    public function close(): void
+    {
+        $this->closed = true;
+        foreach ($this->waiters as $key => $waiters) {
+            unset($this->waiters[$key]);
+            foreach ($waiters as $waiter) {
+                $waiter->close();
+            }
+        }
+        foreach ($this->idle as $key => $idle) {
+            unset($this->idle[$key]);
+            foreach ($idle as [$socket]) {
+                $this->discard($key, $socket);
+            }
+        }
+    }
+
+    /** @param array<string, mixed>|null $sslOptions */
+    protected function connect(string $host, int $port, ?array $sslOptions): Socket
+    {
+        $socket = new Socket($this->type);
+        try {
+            $socket->connect($host, $port);
+            if ($sslOptions !== null) {
+                $socket->enableCrypto($sslOptions);
+            }
+        } catch (Throwable $throwable) {
+            $socket->close();
+            throw $throwable;
+        }
+
+        return $socket;
+    }
+
+    protected static function isAlive(Socket $socket): bool
+    {
+        return $socket->isAvailable() && $socket->getConnectionError() === 0;
+    }
+
+    protected function popIdle(string $key): ?Socket
+    {
+        if (!isset($this->idle[$key])) {
+            return null;
+        }
+        $this->reapKey($key, hrtime(true));
+        while (($entry = array_pop($this->idle[$key])) !== null) {
+            [$socket] = $entry;
+            if (static::isAlive($socket)) {
+                if (count($this->idle[$key]) === 0) {
+                    unset($this->idle[$key]);
+                }
+                $this->keys[$socket] = $this->createSlot($key);
+
+                return $socket;
+            }
+            $this->discard($key, $socket);
+        }
+        unset($this->idle[$key]);
+
+        return null;
+    }
+
+    protected function createSlot(string $key): PoolSlot
+    {
+        /* slots must not keep the pool alive */
+        $pool = WeakReference::create($this);
+
+        return new PoolSlot($key, static function (string $key) use ($pool): void {
+            $pool->get()?->releaseSlot($key);
+        });
+    }
+
+    protected function reapIfNeeded(): void
+    {
+        if ($this->idleTimeout >= 0 && hrtime(true) - $this->lastReapTime >= $this->idleTimeout * 1000000) {
+            $this->reap();
+        }
+    }
+
+    protected function reapKey(string $key, int $now): int
+    {
+        if ($this->idleTimeout < 0) {
+            return 0;
+        }
+        $deadline = $now - $this->idleTimeout * 1000000;
+        $reaped = 0;
+        /* the oldest one is the first */
+        while (isset($this->idle[$key][0]) && $this->idle[$key][0][1] <= $deadline) {
+            [$socket] = array_shift($this->idle[$key]);
+            $this->discard($key, $socket);
+            $reaped++;
+        }
+        if (isset($this->idle[$key]) && count($this->idle[$key]) === 0) {
+            unset($this->idle[$key]);
+        }
+
+        return $reaped;
+    }
+
+    protected function discard(string $key, Socket $socket): void
+    {
+        if ($socket->isAvailable()) {
+            $socket->close();
+        }
+        $this->releaseSlot($key);
+    }
+
+    /** the slot is handed over to the first waiter if there is any, the waiter will open a new connection */
+    protected function releaseSlot(string $key): void
+    {
+        $waiter = $this->shiftWaiter($key);
+        if ($waiter !== null) {
+            $waiter->push(null);
+
+            return;
+        }
+        if (--$this->counts[$key] === 0) {
+            unset($this->counts[$key]);
+        }
+    }
+
+    protected function shiftWaiter(string $key): ?Channel
+    {
+        if (!isset($this->waiters[$key])) {
+            return null;
+        }
+        $waiter = array_shift($this->waiters[$key]);
+        if (count($this->waiters[$key]) === 0) {
+            unset($this->waiters[$key]);
+        }
+
+        return $waiter;
+    }
+
+    /** @return Socket|null null means we got a slot and should open a new connection */
+    protected function wait(string $key, ?int $timeout): ?Socket
+    {
+        $channel = new Channel(1);
+        $this->waiters[$key][] = $channel;
+        try {
+            return $channel->pop($timeout ?? -1);
+        } catch (Throwable $throwable) {
+            if (isset($this->waiters[$key])) {
+                $index = array_search($channel, $this->waiters[$key], true);
+                if ($index !== false) {
+                    array_splice($this->waiters[$key], $index, 1);
+                    if (count($this->waiters[$key]) === 0) {
+                        unset($this->waiters[$key]);
+                    }
+                }
+            }
+            /* we were woken up and interrupted at the same time, give it back */
+            if ($channel->getLength() > 0) {
+                $socket = $channel->pop(0);
+                if ($socket !== null) {
+                    $this->release($socket);
+                } else {
+                    $this->releaseSlot($key);
+                }
+            }
+            if ($throwable instanceof ChannelException) {
+                if ($this->closed) {
+                    throw new PoolException('Pool has been closed', Errno::ECANCELED, $throwable);
+                }
+                throw new PoolException(sprintf('Waiting for a free connection of %s timed out', $key), $throwable->getCode(), $throwable);
+            }
+            throw $throwable;
+        }
+    }
+}
@@ -0,0 +1,48 @@
+<?php
+/**
+ * This file is part of Swow
+ *
+ * @link    https://github.com/swow/swow
+ * @contact twosee <twosee@php.net>
+ *
+ * For the full copyright and license information,
+ * please view the LICENSE file that was distributed with this source code
+ */
+
+declare(strict_types=1);
+
+namespace Swow\Socket;
+
+use Closure;
+
+/**
+ * Slot of a connection which has been acquired from a pool,
+ * it is given back to the pool if the connection is destroyed without being released.
+ *
+ * @internal
+ */
+final class PoolSlot
+{
+    /** @param Closure(string): void|null $release */
+    public function __construct(protected string $key, protected ?Closure $release)
+    {
+    }
+
+    public function getKey(): string
+    {
+        return $this->key;
+    }
+
+    /** the connection has been released, the pool takes care of the slot */
+    public function disarm(): void
+    {
+        $this->release = null;
+    }
+
+    public function __destruct()
+    {
+        if ($this->release !== null) {
+            ($this->release)($this->key);
+        }
+    }
+}
@@ -0,0 +1,217 @@
+<?php
+/**
+ * This file is part of Swow
+ *
+ * @link    https://github.com/swow/swow
+ * @contact twosee <twosee@php.net>
+ *
+ * For the full copyright and license information,
+ * please view the LICENSE file that was distributed with this source code
+ */
+
+declare(strict_types=1);
+
+namespace Swow\Tests\Psr7\Server;
+
+use Exception;
+use PHPUnit\Framework\TestCase;
+use Swow\Coroutine;
+use Swow\Psr7\Client\Client;
+use Swow\Psr7\Psr7;
+use Swow\Psr7\Server\Server;
+use Swow\Psr7\Server\WorkerPool;
+use Swow\Signal;
+use Swow\Socket;
+use Throwable;
+use ValueError;
+
+use function array_values;
+use function extension_loaded;
+use function usleep;
+
+/**
+ * @internal
+ * @covers \Swow\Psr7\Server\WorkerPool
+ */
+final class WorkerPoolTest extends TestCase
+{
+    public function testBadWorkerCount(): void
+    {
+        $this->expectException(ValueError::class);
+        new WorkerPool(static function (): void { }, 0, '127.0.0.1', 0);
+    }
+
+    public function testWorkerPool(): void
+    {
+        if (!extension_loaded('pcntl')) {
+            $this->markTestSkipped('pcntl extension is required');
+        }
+        $socket = new Socket(Socket::TYPE_TCP);
+        $port = $socket->bind('127.0.0.1')->getSockPort();
+        $socket->close();
+
+        $workerCount = 2;
+        $pool = new WorkerPool(static function (Server $server, int $workerId): void {
+            while (true) {
+                try {
+                    $connection = $server->acceptConnection();
+                } catch (Exception) {
+                    break;
+                }
+                Coroutine::run(static function () use ($connection, $workerId): void {
+                    try {
+                        $connection->recvHttpRequest();
+                        $connection->respond((string) $workerId);
+                    } finally {
+                        $connection->close();
+                    }
+                });
+            }
+        }, $workerCount, '127.0.0.1', $port);
+        $pool->setGracefulTimeout(1000)->setRestartDelay(0);
+
+        $exception = null;
+        Coroutine::run(function () use ($pool, $port, $workerCount, &$exception): void {
+            try {
+                $request = static function () use ($port): string {
+                    for ($n = 0; $n < 100; $n++) {
+                        try {
+                            return (string) (new Client())
+                                ->connect('127.0.0.1', $port)
+                                ->sendRequest(Psr7::createRequest('GET', '/'))
+                                ->getBody();
+                        } catch (Exception) {
+                            usleep(10 * 1000);
+                        }
+                    }
+                    return '';
+                };
+                $this->assertContains($request(), ['0', '1']);
+                $pids = $pool->getWorkerPids();
+                $this->assertCount($workerCount, $pids);
+
+                /* crashed worker will be restarted */
+                Signal::kill($pids[0], Signal::KILL);
+                for ($n = 0; $n < 100 && ($pool->getWorkerPids()[0] ?? $pids[0]) === $pids[0]; $n++) {
+                    usleep(10 * 1000);
+                }
+                $restartedPids = $pool->getWorkerPids();
+                $this->assertCount($workerCount, $restartedPids);
+                $this->assertNotSame($pids[0], $restartedPids[0]);
+                $this->assertSame($pids[1], $restartedPids[1]);
+
+                /* all workers are replaced by reloading */
+                $pool->reload();
+                for ($n = 0; $n < 300 && $pool->getWorkerPids()[1] === $restartedPids[1]; $n++) {
+                    usleep(10 * 1000);
+                }
+                $reloadedPids = $pool->getWorkerPids();
+                $this->assertCount($workerCount, $reloadedPids);
+                $this->assertNotSame($restartedPids[0], $reloadedPids[0]);
+                $this->assertNotSame($restartedPids[1], $reloadedPids[1]);
+                $this->assertContains($request(), ['0', '1']);
+            } catch (Throwable $throwable) {
+                $exception = $throwable;
+            } finally {
+                $pool->stop();
+            }
+        });
+        $pool->run();
+        if ($exception) {
+            throw $exception;
+        }
+        $this->assertFalse($pool->isRunning());
+        $this->assertSame([], array_values($pool->getWorkerPids()));
+    }
+
+    public function testReloadWithForkFailure(): void
+    {
+        if (!extension_loaded('pcntl')) {
+            $this->markTestSkipped('pcntl extension is required');
+        }
+        $socket = new Socket(Socket::TYPE_TCP);
+        $port = $socket->bind('127.0.0.1')->getSockPort();
+        $socket->close();
+
+        $pool = new class(static function (Server $server): void {
+            while (true) {
+                try {
+                    $server->acceptConnection()->close();
+                } catch (Exception) {
+                    break;
+                }
+            }
+        }, 1, '127.0.0.1', $port) extends WorkerPool {
+            public int $forkFailures = 0;
+
+            protected function fork(): int
+            {
+                if ($this->forkFailures > 0) {
+                    $this->forkFailures--;
+                    return -1;
+                }
+                return parent::fork();
+            }
+        };
+        $pool->setGracefulTimeout(1000)->setRestartDelay(200);
+
+        $exception = null;
+        Coroutine::run(function () use ($pool, &$exception): void {
+            try {
+                for ($n = 0; $n < 100 && !$pool->getWorkerPids(); $n++) {
+                    usleep(10 * 1000);
+                }
+                $pid = $pool->getWorkerPids()[0];
+
+                /* old worker keeps serving until the new one can be forked */
+                $pool->forkFailures = 1;
+                $pool->reload();
+                usleep(50 * 1000);
+                $this->assertSame([0 => $pid], $pool->getWorkerPids());
+                Signal::kill($pid, 0);
+
+                for ($n = 0; $n < 300 && $pool->getWorkerPids()[0] === $pid; $n++) {
+                    usleep(10 * 1000);
+                }
+                $reloadedPids = $pool->getWorkerPids();
+                $this->assertCount(1, $reloadedPids);
+                $this->assertNotSame($pid, $reloadedPids[0]);
+            } catch (Throwable $throwable) {
+                $exception = $throwable;
+            } finally {
+                $pool->stop();
+            }
+        });
+        $pool->run();
+        if ($exception) {
+            throw $exception;
+        }
+        $this->assertSame([], array_values($pool->getWorkerPids()));
+    }
+
+    public function testWorkerExitingNormallyIsNotRestarted(): void
+    {
+        if (!extension_loaded('pcntl')) {
+            $this->markTestSkipped('pcntl extension is required');
+        }
+        $socket = new Socket(Socket::TYPE_TCP);
+        $port = $socket->bind('127.0.0.1')->getSockPort();
+        $socket->close();
+
+        /* workers are done at once, run() returns when all of them have exited */
+        $pool = new class(static function (): void { }, 2, '127.0.0.1', $port) extends WorkerPool {
+            public int $forks = 0;
+
+            protected function fork(): int
+            {
+                $this->forks++;
+                return parent::fork();
+            }
+        };
+        $pool->setRestartDelay(0);
+        $pool->run();
+        $this->assertFalse($pool->isRunning());
+        $this->assertSame(2, $pool->forks);
+        $this->assertSame([], array_values($pool->getWorkerPids()));
+    }
+}
@@ -0,0 +1,191 @@
+<?php
+/**
+ * This file is part of Swow
+ *
+ * @link    https://github.com/swow/swow
+ * @contact twosee <twosee@php.net>
+ *
+ * For the full copyright and license information,
+ * please view the LICENSE file that was distributed with this source code
+ */
+
+declare(strict_types=1);
+
+namespace Swow\Tests\Socket;
+
+use PHPUnit\Framework\TestCase;
+use Swow\Coroutine;
+use Swow\Errno;
+use Swow\Socket;
+use Swow\Socket\Pool;
+use Swow\Socket\PoolException;
+use Swow\SocketException;
+use Swow\Sync\WaitGroup;
+use ValueError;
+
+use function usleep;
+
+/**
+ * @internal
+ * @covers \Swow\Socket\Pool
+ */
+final class PoolTest extends TestCase
+{
+    protected Socket $server;
+
+    /** @var array<int, Socket> */
+    protected array $connections = [];
+
+    protected function setUp(): void
+    {
+        $this->server = (new Socket(Socket::TYPE_TCP))->bind('127.0.0.1')->listen();
+        Coroutine::run(function (): void {
+            try {
+                while (true) {
+                    $this->connections[] = $this->server->accept();
+                }
+            } catch (SocketException) {
+            }
+        });
+    }
+
+    protected function tearDown(): void
+    {
+        $this->server->close();
+        foreach ($this->connections as $connection) {
+            $connection->close();
+        }
+        $this->connections = [];
+    }
+
+    public function testBadMaxPerKey(): void
+    {
+        $this->expectException(ValueError::class);
+        new Pool(0);
+    }
+
+    public function testReuse(): void
+    {
+        $pool = new Pool();
+        $address = $this->server->getSockAddress();
+        $port = $this->server->getSockPort();
+        $key = Pool::makeKey($address, $port);
+
+        $socket = $pool->acquire($address, $port);
+        $pool->release($socket);
+        $this->assertSame(1, $pool->getIdleCount($key));
+        $this->assertSame($socket, $pool->acquire($address, $port));
+        $this->assertSame(0, $pool->getIdleCount());
+        $this->assertSame(1, $pool->getConnectionCount($key));
+
+        /* not reusable connection is closed */
+        $pool->release($socket, false);
+        $this->assertFalse($socket->isAvailable());
+        $this->assertSame(0, $pool->getConnectionCount());
+
+        $this->expectException(ValueError::class);
+        $pool->release($socket);
+    }
+
+    public function testBrokenConnectionIsNotReused(): void
+    {
+        $pool = new Pool();
+        $address = $this->server->getSockAddress();
+        $port = $this->server->getSockPort();
+
+        $socket = $pool->acquire($address, $port);
+        $pool->release($socket);
+        usleep(1000);
+        foreach ($this->connections as $connection) {
+            $connection->close();
+        }
+        usleep(1000);
+        $newSocket = $pool->acquire($address, $port);
+        $this->assertNotSame($socket, $newSocket);
+        $this->assertSame(1, $pool->getConnectionCount());
+    }
+
+    public function testIdleTimeout(): void
+    {
+        $pool = new Pool(idleTimeout: 1);
+        $address = $this->server->getSockAddress();
+        $port = $this->server->getSockPort();
+
+        $socket = $pool->acquire($address, $port);
+        $pool->release($socket);
+        usleep(10 * 1000);
+        $this->assertSame(1, $pool->reap());
+        $this->assertFalse($socket->isAvailable());
+        $this->assertSame(0, $pool->getConnectionCount());
+    }
+
+    public function testMaxPerKey(): void
+    {
+        $pool = new Pool(2);
+        $address = $this->server->getSockAddress();
+        $port = $this->server->getSockPort();
+        $key = Pool::makeKey($address, $port);
+
+        $a = $pool->acquire($address, $port);
+        $b = $pool->acquire($address, $port);
+        try {
+            $pool->acquire($address, $port, timeout: 1);
+            $this->fail('Never here');
+        } catch (PoolException $exception) {
+            $this->assertSame(Errno::ETIMEDOUT, $exception->getCode());
+        }
+        $this->assertSame(0, $pool->getWaiterCount($key));
+
+        /* waiters are woken up in FIFO order */
+        $order = [];
+        $wg = new WaitGroup();
+        for ($n = 0; $n < 3; $n++) {
+            $wg->add();
+            Coroutine::run(static function () use ($pool, $address, $port, $n, &$order, $wg): void {
+                $socket = $pool->acquire($address, $port);
+                $order[] = $n;
+                usleep(1000);
+                $pool->release($socket);
+                $wg->done();
+            });
+        }
+        $this->assertSame(3, $pool->getWaiterCount($key));
+        $pool->release($a);
+        $pool->release($b, false);
+        $wg->wait();
+        $this->assertSame([0, 1, 2], $order);
+        $this->assertSame(2, $pool->getConnectionCount($key));
+
+        $pool->close();
+        $this->assertSame(0, $pool->getConnectionCount());
+        $this->expectException(PoolException::class);
+        $pool->acquire($address, $port);
+    }
+
+    public function testSlotOfLostConnectionIsReleased(): void
+    {
+        $pool = new Pool(1);
+        $address = $this->server->getSockAddress();
+        $port = $this->server->getSockPort();
+        $key = Pool::makeKey($address, $port);
+
+        $socket = $pool->acquire($address, $port);
+        $this->assertSame(1, $pool->getConnectionCount($key));
+        unset($socket);
+        $this->assertSame(0, $pool->getConnectionCount($key));
+
+        /* the slot is handed over to the waiter */
+        $socket = $pool->acquire($address, $port);
+        $wg = new WaitGroup();
+        $wg->add();
+        Coroutine::run(static function () use ($pool, $address, $port, $wg): void {
+            $pool->release($pool->acquire($address, $port));
+            $wg->done();
+        });
+        $this->assertSame(1, $pool->getWaiterCount($key));
+        unset($socket);
+        $wg->wait();
+        $this->assertSame(1, $pool->getConnectionCount($key));
+        $this->assertSame(1, $pool->getIdleCount($key));
+    }
+}
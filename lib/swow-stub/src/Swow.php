@@ -62,6 +62,9 @@ namespace Swow
         public const EXTRA_VERSION = 'dev';
 
         public static function isBuiltWith(string $lib): bool { }
+
+        /** Whether file-system operations go through io_uring (enabled by CAT_IO_URING=1 and supported by the kernel) */
+        public static function isIoUringAvailable(): bool { }
     }
 }
 
@@ -769,6 +772,45 @@ namespace Swow
 
         public static function getGlobalSwitches(): int { }
 
+        /**
+         * Get C stack usage in bytes (sampled when coroutine is switched out)
+         */
+        public function getStackUsage(): int { }
+
+        /**
+         * Get peak C stack usage in bytes (sampled when coroutine is switched out)
+         */
+        public function getPeakStackUsage(): int { }
+
+        /**
+         * Get peak C stack usage in bytes of all coroutines
+         */
+        public static function getGlobalPeakStackUsage(): int { }
+
+        /**
+         * Give back the unused physical pages of the C stack of a waiting coroutine
+         *
+         * @return int the number of bytes trimmed
+         */
+        public function trimStack(): int { }
+
+        /**
+         * Get max number of idle coroutine stacks kept for reuse
+         */
+        public static function getStackPoolSize(): int { }
+
+        /**
+         * Set max number of idle coroutine stacks kept for reuse (0 means disabled)
+         */
+        public static function setStackPoolSize(int $size): void { }
+
+        /**
+         * Get coroutine stack pool info
+         *
+         * @return array{'available': bool, 'size': int, 'count': int, 'hits': int, 'misses': int}
+         */
+        public static function getStackPoolInfo(): array { }
+
         public function getElapsed(): int { }
 
         public function getElapsedAsString(): string { }
@@ -991,6 +1033,31 @@ namespace Swow
          */
         public function pop(int $timeout = -1): mixed { }
 
+        /**
+         * push all items into channel, consumers are woken up once per batch instead of once per item
+         *
+         * @note if it fails (e.g. timed out), items before the failed one have been pushed
+         *
+         * @phan-param array<T> $items
+         * @phpstan-param array<T> $items
+         * @psalm-param array<T> $items
+         * @param array<mixed> $items
+         * @param int $timeout in microseconds
+         * @return static
+         */
+        public function pushMany(array $items, int $timeout = -1): static { }
+
+        /**
+         * pop at least one and at most $max items from channel, it only waits when channel is empty
+         *
+         * @param int $timeout in microseconds
+         * @phan-return array<T>
+         * @phpstan-return array<T>
+         * @psalm-return array<T>
+         * @return array<mixed>
+         */
+        public function popMany(int $max, int $timeout = -1): array { }
+
         public function close(): void { }
 
         public function getCapacity(): int { }
@@ -1087,6 +1154,19 @@ namespace Swow
     class SyncException extends \Swow\Exception { }
 }
 
+namespace Swow
+{
+    class Event
+    {
+        public static function getRound(): int { }
+
+        /**
+         * @return array{'pending': int, 'capacity': int, 'last_round': int, 'peak_round': int, 'total': int}
+         */
+        public static function getDeferInfo(): array { }
+    }
+}
+
 namespace Swow
 {
     class Buffer implements \Stringable
@@ -1256,6 +1336,10 @@ namespace Swow
         public const BIND_FLAG_IPV6ONLY = 1;
         public const BIND_FLAG_REUSEADDR = 2;
         public const BIND_FLAG_REUSEPORT = 4;
+        public const INLINE_READ_MODE_DEFAULT = 0;
+        public const INLINE_READ_MODE_ALWAYS = 1;
+        public const INLINE_READ_MODE_ADAPTIVE = 2;
+        public const INLINE_READ_MODE_NEVER = 3;
 
         public function __construct(int $type) { }
 
@@ -1319,6 +1403,19 @@ namespace Swow
          */
         public function acceptTo(self $connection, ?int $timeout = null): static { }
 
+        /**
+         * Waits for the first connection, then accepts the connections which are already pending in the backlog,
+         * at most $max connections are returned in one call.
+         * @var int $timeout [optional] = $this->getAcceptTimeout()
+         * @return static[] Notice: it returns new un-constructed connections
+         */
+        public function acceptMany(int $max, ?int $timeout = null): array { }
+
+        /**
+         * @return array{'batches': int, 'connections': int, 'last_batch_size': int, 'max_batch_size': int} backlog depth observed by acceptMany()
+         */
+        public function getAcceptStats(): array { }
+
         /** @var int $timeout [optional] = $this->getConnectTimeout() */
         public function connect(string $name, int $port = 0, ?int $timeout = null): static { }
 
@@ -1671,6 +1768,47 @@ namespace Swow
         /** @var int $timeout [optional] = $this->getWriteTimeout() */
         public function sendHandle(self $handle, ?int $timeout = null): static { }
 
+        /**
+         * @param string|resource $file file path or file stream
+         * @param int $length -1 means sending till the end of file
+         * @var int $timeout [optional] = $this->getWriteTimeout()
+         */
+        public function sendFile(mixed $file, int $offset = 0, int $length = -1, ?int $timeout = null): int { }
+
+        /**
+         * Send a http response, the body is written as it is without being copied into the head
+         * @var int $timeout [optional] = $this->getWriteTimeout()
+         */
+        public function sendResponse(int $statusCode, array $headers = [], \Stringable|string $body = '', string $reasonPhrase = '', string $protocolVersion = \Swow\Http\Http::DEFAULT_PROTOCOL_VERSION, ?int $timeout = null): static { }
+
+        /**
+         * Receive pending datagrams in one call (it waits for the first one only)
+         * @return array<array{0: string, 1: string, 2: int}> list of [data, address, port]
+         * @var int $timeout [optional] = $this->getReadTimeout()
+         */
+        public function recvMany(int $count = 64, int $size = \Swow\Buffer::COMMON_SIZE, ?int $timeout = null): array { }
+
+        /**
+         * Send datagrams in one call
+         * @param array<string|array{0: \Stringable|string, 1?: string|null, 2?: int}> $datagrams list of data (for connected socket) or [data, address, port], address must be an IP address or path (for UDG type)
+         * @return int the number of sent datagrams
+         * @var int $timeout [optional] = $this->getWriteTimeout()
+         */
+        public function sendMany(array $datagrams, ?int $timeout = null): int { }
+
+        /**
+         * Buffer writes of stream socket and flush them as one write
+         * @param int $threshold buffered data will be flushed once its length reaches the threshold, 0 means default (64K)
+         * @param bool $autoFlush flush buffered data when the current coroutine yields
+         */
+        public function cork(int $threshold = 0, bool $autoFlush = true): static { }
+
+        /**
+         * Flush buffered data and stop buffering writes
+         * @var int $timeout [optional] = $this->getWriteTimeout()
+         */
+        public function uncork(?int $timeout = null): static { }
+
         public function close(): bool { }
 
         /** @return bool Whether the socket has been constructed and has not been closed */
@@ -1691,6 +1829,8 @@ namespace Swow
 
         public function isClient(): bool { }
 
+        public function isCorked(): bool { }
+
         /**
          * @return int return Errno constants if the socket is broken, zero otherwise,
          * it's a silent version of {@see Socket::checkLiveness()}
@@ -1711,6 +1851,13 @@ namespace Swow
 
         public function getSendBufferSize(): int { }
 
+        public function getTcpZeroCopyThreshold(): int { }
+
+        public function getInlineReadMode(): int { }
+
+        /** @return array{hits: int, misses: int, skips: int} */
+        public function getInlineReadStats(): array { }
+
         public function setRecvBufferSize(int $size): static { }
 
         public function setSendBufferSize(int $size): static { }
@@ -1721,6 +1868,18 @@ namespace Swow
 
         public function setTcpAcceptBalance(bool $enable): static { }
 
+        /**
+         * Writes whose length >= threshold will be sent with MSG_ZEROCOPY (Linux only),
+         * they return after the kernel released the data, 0 means disabled
+         */
+        public function setTcpZeroCopyThreshold(int $threshold): static { }
+
+        /**
+         * Connections accepted by this socket inherit the mode
+         * @param int $mode self::INLINE_READ_MODE_* constants
+         */
+        public function setInlineReadMode(int $mode): static { }
+
         /** @return array<string, mixed> debug information for var_dump */
         public function __debugInfo(): array { }
 
@@ -1753,6 +1912,50 @@ namespace Swow
         public static function setGlobalReadTimeout(int $timeout): void { }
 
         public static function setGlobalWriteTimeout(int $timeout): void { }
+
+        public static function getGlobalInlineReadMode(int $type): int { }
+
+        /**
+         * @param int $mode self::INLINE_READ_MODE_* constants
+         * @param int $type it takes effect on all types which match it (TCP, PIPE, UDP)
+         */
+        public static function setGlobalInlineReadMode(int $mode, int $type = \Swow\Socket::TYPE_ANY): void { }
+
+        public static function getGlobalDnsCacheCapacity(): int { }
+
+        /** @param int $capacity max number of cached results, 0 means disabled (concurrent lookups of the same name are still coalesced) */
+        public static function setGlobalDnsCacheCapacity(int $capacity): void { }
+
+        public static function getGlobalDnsCacheTtl(): int { }
+
+        /** @param int $ttl in milliseconds, how long resolved addresses are cached */
+        public static function setGlobalDnsCacheTtl(int $ttl): void { }
+
+        public static function getGlobalDnsCacheNegativeTtl(): int { }
+
+        /** @param int $ttl in milliseconds, how long names which do not exist are cached */
+        public static function setGlobalDnsCacheNegativeTtl(int $ttl): void { }
+
+        /** @return array{'hits': int, 'misses': int, 'coalesced': int, 'count': int} */
+        public static function getGlobalDnsCacheStats(): array { }
+
+        public static function flushGlobalDnsCache(): void { }
+
+        public static function isGlobalDnsResolverEnabled(): bool { }
+
+        /** @param bool $enabled names are resolved by the native resolver on the event loop instead of getaddrinfo() in the threadpool */
+        public static function setGlobalDnsResolverEnabled(bool $enabled): void { }
+
+        public static function getGlobalDnsServers(): ?string { }
+
+        /** @param string|null $servers separated by commas (e.g. "127.0.0.1:53,[::1]:53"), null means nameservers of resolv.conf */
+        public static function setGlobalDnsServers(?string $servers): void { }
+
+        /**
+         * @param int|null $timeout in milliseconds
+         * @return array<int, array{'target': string, 'port': int, 'priority': int, 'weight': int, 'ttl': int}> sorted by priority and weight
+         */
+        public static function resolveSrv(string $name, ?int $timeout = null): array { }
     }
 }
 
@@ -2074,6 +2277,28 @@ namespace Swow
     class WatchdogException extends \Swow\Exception { }
 }
 
+namespace Swow
+{
+    /**
+     * Only available on ZTS builds, closure and arguments are passed to the thread by serialization
+     */
+    class Thread
+    {
+        public function __construct(\Closure $closure, mixed ...$args) { }
+
+        public function getId(): int { }
+
+        public function isRunning(): bool { }
+
+        public function join(): mixed { }
+    }
+}
+
+namespace Swow
+{
+    class ThreadException extends \Swow\Exception { }
+}
+
 namespace Swow
 {
     class IpAddress
@@ -2170,6 +2395,40 @@ namespace Swow\Sync
     function waitAll(int $timeout = -1): void { }
 }
 
+namespace Swow\Thread
+{
+    /**
+     * Only available on ZTS builds, values are passed between threads by serialization
+     */
+    class Channel
+    {
+        public const FLAG_NONE = 0;
+        /**
+         * Only the thread which created the channel can pop from it,
+         * then push and pop are lock-free unless producers have to wait for space
+         */
+        public const FLAG_SINGLE_CONSUMER = 1;
+
+        public function __construct(int $capacity = 1, int $flags = self::FLAG_NONE) { }
+
+        public function push(mixed $value, int $timeout = -1): static { }
+
+        public function pop(int $timeout = -1): mixed { }
+
+        public function close(): static { }
+
+        public function getCapacity(): int { }
+
+        public function getLength(): int { }
+
+        public function isAvailable(): bool { }
+
+        public function __serialize(): array { }
+
+        public function __unserialize(array $data): void { }
+    }
+}
+
 namespace Swow\Http
 {
     class Http
@@ -2296,6 +2555,16 @@ namespace Swow\Http
         /** @return int the length of the data which was parsed, same with $this->getParsedLength() */
         public function execute(\Stringable|string $data, int $start = 0, int $length = -1): int { }
 
+        /**
+         * Parse the start-line and headers (and the body if all of it is in the data) of the message which begins at $start,
+         * the parser is reset before parsing, if the message is not completed, the rest of it can be parsed by execute()
+         * @param int $maxHeaderLength -1 means unlimited
+         * @param int $maxContentLength -1 means unlimited
+         * @return array{'method'?: string, 'uri'?: string, 'statusCode'?: int, 'reasonPhrase'?: string, 'protocolVersion': string, 'headers': array<string, array<string>>, 'headerNames': array<string, string>, 'contentLength': int, 'shouldKeepAlive': bool, 'isChunked': bool, 'isMultipart': bool, 'isUpgrade': bool, 'bodyOffset': int, 'bodyLength': int, 'parsedLength': int, 'completed': bool}|null null means more data is needed
+         * @throws \Swow\Http\ParserException the code is the HTTP status code (413, 414 or 431) if limits are exceeded
+         */
+        public function parseMessage(\Stringable|string $data, int $start = 0, int $maxHeaderLength = -1, int $maxContentLength = -1): ?array { }
+
         public function getEvent(): int { }
 
         public function getEventName(): string { }
@@ -2340,6 +2609,26 @@ namespace Swow\Http
 
         public function reset(): static { }
 
+        public function getMaxUploadedFileSize(): int { }
+
+        /** @param int $size exceeding it makes the uploaded file fail with UPLOAD_ERR_INI_SIZE, -1 means unlimited */
+        public function setMaxUploadedFileSize(int $size): static { }
+
+        public function getMaxUploadedFilesSize(): int { }
+
+        /** @param int $size exceeding it makes execute() throw ParserException with 413 code, -1 means unlimited */
+        public function setMaxUploadedFilesSize(int $size): static { }
+
+        /**
+         * Body data of the current multipart part will be written to a new temp file
+         * instead of being reported by EVENT_MULTIPART_BODY, until finishUploadedFile() is called.
+         * @return string the temp file name, it is empty if the file could not be created
+         */
+        public function startUploadedFile(string $directory, string $prefix = 'swow_uploaded_file_'): string { }
+
+        /** @return array{'tmpName': string, 'error': int, 'size': int} */
+        public function finishUploadedFile(): array { }
+
         public static function getEventNameFor(int $event): string { }
     }
 }
@@ -2349,6 +2638,35 @@ namespace Swow\Http
     class ParserException extends \Swow\Exception { }
 }
 
+namespace Swow\Http
+{
+    class ResponseTemplate
+    {
+        /** @param array<string, string|string[]> $headers static headers which are serialized only once (Content-Length is not allowed, neither is Date if $withDate is true) */
+        public function __construct(int $statusCode = \Swow\Http\Status::OK, string $reasonPhrase = '', array $headers = [], string $protocolVersion = \Swow\Http\Http::DEFAULT_PROTOCOL_VERSION, bool $withDate = true) { }
+
+        public function getStatusCode(): int { }
+
+        /** @return string the status line and static headers */
+        public function getHead(): string { }
+
+        /**
+         * Date (cached per second) and Content-Length headers are filled in automatically,
+         * Content-Length is omitted for 1xx, 204 and 304 responses (it can be given by $headers of 304 responses),
+         * Date can be given by $headers only if the template was constructed with $withDate = false
+         * @param array<string, string|string[]> $headers dynamic headers
+         */
+        public function pack(\Stringable|string $body = '', array $headers = []): string { }
+
+        /**
+         * Same as pack(), but the response is appended to the buffer
+         * @param array<string, string|string[]> $headers dynamic headers
+         * @return int the length of the response
+         */
+        public function packTo(\Swow\Buffer $buffer, \Stringable|string $body = '', array $headers = []): int { }
+    }
+}
+
 namespace Swow\WebSocket
 {
     class WebSocket